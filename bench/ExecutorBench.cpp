@@ -0,0 +1,198 @@
+// Thread-per-component loops against tasks on the shared executor.
+//
+//   straf_executor_bench [seconds]
+//
+// Runs the agent's background components for [seconds] (default 5) twice:
+// (a) as the tree had them - a thread each, polling with sleeps: the silent
+//     audio source (20 ms packets), the recognizer supervisor and the SAPI
+//     loop (50 ms polls), the transcriber stub (1 s) and the demo detector
+//     (5 s), with the packets going through a condition-variable queue to a
+//     decoder thread;
+// (b) as tasks on a two-worker Executor: the audio task sleeps until each
+//     packet is due and sends it on a Channel to a decoder task, and the
+//     other components wait on an Event that nothing sets, as a component
+//     waiting for work does.
+// Reported per variant: threads added to the process (Linux, from
+// /proc/self/status), wakeups per second (returns from a sleep or wait, any
+// thread), packets decoded, and how long Stop takes to join everything.
+#include "Straf/Executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Straf;
+using clock_type = std::chrono::steady_clock;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr auto kPacket = 20ms;
+constexpr size_t kPacketSamples = 320; // 20 ms at 16 kHz
+
+struct Result {
+    int threads{-1};
+    double wakeupsPerSecond{0};
+    uint64_t packets{0};
+    double stopMs{0};
+};
+
+// Threads in this process, or -1 where it cannot be read.
+int ThreadCount() {
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);) {
+        if (line.rfind("Threads:", 0) == 0) return std::atoi(line.c_str() + 8);
+    }
+#endif
+    return -1;
+}
+
+double Ms(clock_type::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+Result RunThreads(std::chrono::seconds runFor) {
+    const int before = ThreadCount();
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<uint64_t> packets{0};
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::vector<float>> queue;
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&] { // silent audio source
+        while (!stop) {
+            std::this_thread::sleep_for(kPacket);
+            ++wakeups;
+            {
+                std::lock_guard lock(mutex);
+                queue.emplace_back(kPacketSamples);
+            }
+            ready.notify_one();
+        }
+    });
+    threads.emplace_back([&] { // decoder
+        std::unique_lock lock(mutex);
+        while (!stop) {
+            ready.wait(lock, [&] { return stop || !queue.empty(); });
+            ++wakeups;
+            while (!queue.empty()) {
+                queue.pop_front();
+                ++packets;
+            }
+        }
+    });
+    auto poller = [&](std::chrono::milliseconds every) {
+        return [&, every] {
+            while (!stop) {
+                std::this_thread::sleep_for(every);
+                ++wakeups;
+            }
+        };
+    };
+    threads.emplace_back(poller(50ms));   // recognizer supervisor
+    threads.emplace_back(poller(50ms));   // SAPI loop
+    threads.emplace_back(poller(1000ms)); // transcriber stub
+    threads.emplace_back(poller(5000ms)); // demo detector
+
+    std::this_thread::sleep_for(200ms); // let every thread start
+    Result result;
+    result.threads = before < 0 ? -1 : ThreadCount() - before;
+    const uint64_t wakeups0 = wakeups;
+    std::this_thread::sleep_for(runFor);
+    result.wakeupsPerSecond = static_cast<double>(wakeups - wakeups0) / static_cast<double>(runFor.count());
+
+    const auto t0 = clock_type::now();
+    {
+        std::lock_guard lock(mutex);
+        stop = true;
+    }
+    ready.notify_all();
+    for (auto& t : threads) t.join();
+    result.stopMs = Ms(clock_type::now() - t0);
+    result.packets = packets;
+    return result;
+}
+
+Task AudioTask(Channel<std::vector<float>>& packets) {
+    auto next = Executor::clock::now();
+    for (;;) {
+        next += kPacket;
+        const bool due = co_await SleepUntil(next);
+        if (!due) break;
+        packets.Send(std::vector<float>(kPacketSamples));
+    }
+}
+
+Task DecoderTask(Channel<std::vector<float>>& packets, std::atomic<uint64_t>& decoded) {
+    for (;;) {
+        const auto packet = co_await packets.Receive();
+        if (!packet) break;
+        ++decoded;
+    }
+}
+
+Task IdleTask(Event& work) {
+    for (;;) {
+        const bool set = co_await work.Wait();
+        if (!set) break;
+    }
+}
+
+Result RunTasks(std::chrono::seconds runFor) {
+    const int before = ThreadCount();
+    Executor executor(2);
+    Channel<std::vector<float>> channel(64, executor);
+    Event never(executor);
+    std::atomic<uint64_t> decoded{0};
+
+    std::vector<TaskHandle> tasks;
+    tasks.push_back(executor.Spawn(AudioTask(channel)));
+    tasks.push_back(executor.Spawn(DecoderTask(channel, decoded)));
+    for (int i = 0; i < 4; ++i) tasks.push_back(executor.Spawn(IdleTask(never)));
+
+    std::this_thread::sleep_for(200ms);
+    Result result;
+    result.threads = before < 0 ? -1 : ThreadCount() - before;
+    const uint64_t wakeups0 = executor.GetStats().wakeups;
+    std::this_thread::sleep_for(runFor);
+    result.wakeupsPerSecond =
+        static_cast<double>(executor.GetStats().wakeups - wakeups0) / static_cast<double>(runFor.count());
+
+    const auto t0 = clock_type::now();
+    for (auto& task : tasks) task.RequestStop();
+    for (auto& task : tasks) task.Join();
+    result.stopMs = Ms(clock_type::now() - t0);
+    result.packets = decoded;
+    return result;
+}
+
+void Print(const char* name, const Result& r) {
+    char threads[16];
+    if (r.threads < 0) std::snprintf(threads, sizeof threads, "n/a");
+    else std::snprintf(threads, sizeof threads, "%d", r.threads);
+    std::printf("%-24s %8s %12.1f %9llu %10.2f\n", name, threads, r.wakeupsPerSecond,
+                static_cast<unsigned long long>(r.packets), r.stopMs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const auto runFor = std::chrono::seconds(std::max(1, argc > 1 ? std::atoi(argv[1]) : 5));
+    std::printf("%lld s per variant; packets every %lld ms\n\n", static_cast<long long>(runFor.count()),
+                static_cast<long long>(kPacket.count()));
+    std::printf("%-24s %8s %12s %9s %10s\n", "variant", "threads", "wakeups/s", "packets", "stop ms");
+    Print("thread per component", RunThreads(runFor));
+    Print("tasks on 2 workers", RunTasks(runFor));
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Throughput and wakeup benchmark for the shared-memory event feed
+// (EventFeed.h). Linux only: readers are forked processes.
+//
+//   straf_feed_bench [records]
+//
+// Part 1 publishes [records] (default 2M) with no reader attached, from one
+// and from four threads.
+// Part 2 publishes them back to back with 1 and 4 reader processes that wait
+// on the futex whenever they catch up; each reader reports records received
+// and overrun (received + overrun must equal the records published).
+// Part 3 attaches a reader that never reads and checks the writer does not
+// slow down for it.
+// Part 4 paces 20k records 200 us apart to 1 reader and reports publish to
+// receive latency, which includes the futex wakeup of a sleeping reader.
+#include "Straf/EventFeed.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Straf;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+struct ReaderResult {
+    uint64_t received{0};
+    uint64_t overruns{0};
+    uint64_t waits{0};
+    double p50Us{0};
+    double p99Us{0};
+};
+
+struct Child {
+    pid_t pid{-1};
+    int fd{-1}; // reads the child's ReaderResult
+};
+
+int64_t NowUnixNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Forks a reader that attaches, says so through the pipe, then reads until it
+// has accounted for `expected` records (or just sleeps when `stall`).
+Child ForkReader(const std::string& name, uint64_t expected, bool stall) {
+    int fds[2];
+    if (pipe(fds) != 0) return {};
+    const pid_t pid = fork();
+    if (pid != 0) {
+        close(fds[1]);
+        char ready = 0;
+        if (read(fds[0], &ready, 1) != 1) {
+            close(fds[0]);
+            return {};
+        }
+        return {pid, fds[0]};
+    }
+    close(fds[0]);
+    auto reader = feed::FeedReader::Open(name);
+    const char ok = reader ? 1 : 0;
+    if (write(fds[1], &ok, 1) != 1 || !reader) _exit(1);
+    if (stall) {
+        pause();
+        _exit(0);
+    }
+    ReaderResult result;
+    std::vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(std::min<uint64_t>(expected, 1 << 20)));
+    feed::Record record;
+    while (result.received + reader->Overruns() < expected && !reader->Closed()) {
+        if (reader->Next(record)) {
+            ++result.received;
+            if (latencies.size() < latencies.capacity()) latencies.push_back(static_cast<double>(NowUnixNanos() - record.unixNanos) / 1000.0);
+            continue;
+        }
+        ++result.waits;
+        reader->Wait(std::chrono::milliseconds(1000));
+    }
+    result.overruns = reader->Overruns();
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result.p50Us = latencies[latencies.size() / 2];
+        result.p99Us = latencies[latencies.size() * 99 / 100];
+    }
+    if (write(fds[1], &result, sizeof result) != static_cast<ssize_t>(sizeof result)) _exit(1);
+    _exit(0);
+}
+
+ReaderResult Collect(Child& child) {
+    ReaderResult result;
+    if (read(child.fd, &result, sizeof result) != static_cast<ssize_t>(sizeof result)) result = {};
+    close(child.fd);
+    waitpid(child.pid, nullptr, 0);
+    return result;
+}
+
+double PublishAll(feed::FeedWriter& writer, uint64_t records, unsigned threads) {
+    const WordId word = Words().Intern("bench");
+    const auto start = clock_type::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        pool.emplace_back([&] {
+            for (uint64_t i = 0; i < records / threads; ++i) writer.PublishDetection(word, 0.9f, DetectionSource::Microphone);
+        });
+    }
+    for (auto& t : pool) t.join();
+    return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / static_cast<double>(records);
+}
+
+std::string FeedName() { return "straf-bench-" + std::to_string(getpid()); }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const uint64_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    const std::string name = FeedName();
+
+    std::printf("part 1: publish, no readers (%llu records, 4096-slot ring)\n", static_cast<unsigned long long>(records));
+    for (unsigned threads : {1u, 4u}) {
+        auto writer = feed::FeedWriter::Create(name);
+        if (!writer) {
+            std::fprintf(stderr, "cannot create feed %s\n", name.c_str());
+            return 1;
+        }
+        std::printf("  %u thread(s): %7.1f ns/record\n", threads, PublishAll(*writer, records, threads));
+    }
+
+    std::printf("\npart 2: publish back to back to waiting readers\n");
+    for (int readers : {1, 4}) {
+        auto writer = feed::FeedWriter::Create(name);
+        if (!writer) return 1;
+        std::vector<Child> children;
+        for (int i = 0; i < readers; ++i) children.push_back(ForkReader(name, records, false));
+        const double ns = PublishAll(*writer, records, 1);
+        const auto stats = writer->GetStats();
+        std::printf("  %d reader(s): %7.1f ns/record, %llu wakeups\n", readers, ns, static_cast<unsigned long long>(stats.wakeups));
+        for (auto& child : children) {
+            const ReaderResult r = Collect(child);
+            std::printf("    reader: %llu received, %llu overrun, %llu waits%s\n", static_cast<unsigned long long>(r.received),
+                        static_cast<unsigned long long>(r.overruns), static_cast<unsigned long long>(r.waits),
+                        r.received + r.overruns == records ? "" : "  MISMATCH");
+        }
+    }
+
+    std::printf("\npart 3: a reader that never reads\n");
+    {
+        auto writer = feed::FeedWriter::Create(name);
+        if (!writer) return 1;
+        Child stalled = ForkReader(name, records, true);
+        const double ns = PublishAll(*writer, records, 1);
+        const auto readers = writer->Readers();
+        const uint64_t lag = readers.empty() ? 0 : writer->GetStats().published - readers.front().position;
+        std::printf("  %7.1f ns/record; stalled reader is %llu records behind\n", ns, static_cast<unsigned long long>(lag));
+        kill(stalled.pid, SIGKILL);
+        close(stalled.fd);
+        waitpid(stalled.pid, nullptr, 0);
+    }
+
+    std::printf("\npart 4: paced, 20000 records 200 us apart, 1 reader\n");
+    {
+        constexpr uint64_t kPaced = 20000;
+        auto writer = feed::FeedWriter::Create(name);
+        if (!writer) return 1;
+        Child child = ForkReader(name, kPaced, false);
+        const WordId word = Words().Intern("bench");
+        auto next = clock_type::now();
+        for (uint64_t i = 0; i < kPaced; ++i) {
+            next += std::chrono::microseconds(200);
+            std::this_thread::sleep_until(next);
+            writer->PublishDetection(word, 0.9f, DetectionSource::Microphone);
+        }
+        const ReaderResult r = Collect(child);
+        std::printf("  latency p50 %.1f us, p99 %.1f us; %llu waits, %llu wakeups for %llu records\n", r.p50Us, r.p99Us,
+                    static_cast<unsigned long long>(r.waits), static_cast<unsigned long long>(writer->GetStats().wakeups),
+                    static_cast<unsigned long long>(kPaced));
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Penalty journal write amplification and replay speed.
+//
+//   straf_journal_bench [records] [directory]
+//
+// For several snapshot intervals the tool appends a penalty-like record mix
+// (phrase cooldowns over a rotating vocabulary, debounces, queue/start/end
+// transitions) from one producer, flushes, and reports producer-side append
+// cost, fsyncs, bytes written per logical record byte, and then the time to
+// reopen and replay the resulting snapshot + journal.
+#include "Straf/PenaltyJournal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Straf;
+using clock_type = std::chrono::steady_clock;
+
+int main(int argc, char** argv) {
+    const size_t records = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const std::filesystem::path dir = argc > 2 ? argv[2] : (std::filesystem::temp_directory_path() / "straf_journal_bench");
+
+    std::vector<WordId> vocab;
+    for (int i = 0; i < 2000; ++i) vocab.push_back(Words().Intern("phrase" + std::to_string(i)));
+
+    std::printf("%zu records into %s\n\n", records, dir.string().c_str());
+    std::printf("%10s %12s %12s %8s %8s %10s %12s %14s\n", "snapshot", "append ns", "worst us", "dropped", "fsyncs",
+                "write amp", "replay us", "replay rec/s");
+
+    for (size_t every : {size_t{1024}, size_t{16384}, size_t{262144}}) {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+
+        JournalOptions options;
+        options.snapshotEvery = every;
+        options.flushDelay = std::chrono::milliseconds(1);
+        auto journal = PenaltyJournal::Open(dir.string(), options);
+        if (!journal) { std::fprintf(stderr, "cannot open journal in %s\n", dir.string().c_str()); return 1; }
+
+        double worst = 0;
+        double appendTotal = 0;
+        const auto base = clock_type::now();
+        for (size_t i = 0; i < records; ++i) {
+            const auto at = base + std::chrono::seconds(15) + std::chrono::milliseconds(i);
+            const auto t0 = clock_type::now();
+            switch (i % 5) {
+                case 0: journal->Append(JournalRecordType::Phrase, vocab[i % vocab.size()], at); break;
+                case 1: journal->Append(JournalRecordType::Debounce, kNoWord, at); break;
+                case 2: journal->Append(JournalRecordType::Queued, vocab[i % vocab.size()], {}, std::chrono::seconds(5)); break;
+                case 3: journal->Append(JournalRecordType::Started, vocab[i % vocab.size()], at, std::chrono::seconds(5)); break;
+                default: journal->Append(JournalRecordType::Ended, kNoWord, at); break;
+            }
+            const double us = std::chrono::duration<double, std::micro>(clock_type::now() - t0).count();
+            appendTotal += us;
+            worst = std::max(worst, us);
+            // Pace the producer a little so the bench measures steady state rather than ring overflow.
+            if ((i & 511) == 511) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        journal->Flush();
+        const JournalStats written = journal->GetStats();
+        journal.reset();
+
+        auto reopened = PenaltyJournal::Open(dir.string(), options);
+        const JournalStats replay = reopened->GetStats();
+        const double logical = static_cast<double>(written.appended) * sizeof(JournalRecord);
+        const double appendNs = appendTotal * 1000.0 / static_cast<double>(records);
+        const double amp = logical > 0 ? static_cast<double>(written.journalBytes + written.snapshotBytes) / logical : 0.0;
+        const double replaySec = std::chrono::duration<double>(replay.replayTime).count();
+        std::printf("%10zu %12.1f %12.1f %8llu %8llu %10.3f %12lld %14.0f\n", every, appendNs, worst,
+                    static_cast<unsigned long long>(written.dropped), static_cast<unsigned long long>(written.syncs), amp,
+                    static_cast<long long>(replay.replayTime.count()),
+                    replaySec > 0 ? static_cast<double>(replay.replayedRecords) / replaySec : 0.0);
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    return 0;
+}
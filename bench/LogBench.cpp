@@ -0,0 +1,114 @@
+// Per-call cost of logging on a capture thread.
+//
+//   straf_log_bench [calls]
+//
+// One thread stands in for the audio capture thread and logs a packet line
+// (three numbers and a short string) per call, either paced (batches of 256
+// calls with a 1 ms gap, roughly what a chatty capture loop produces) or in a
+// burst (every call back to back, which overflows any queue). Compared:
+//   hot stripped   STRAF_HOT_TRACE compiled out (this file keeps debug and up)
+//   hot disabled   STRAF_HOT_DEBUG with the runtime level at info
+//   hot enabled    STRAF_HOT_DEBUG into the thread's ring, formatted by the writer
+//   spdlog block   async logger with the old overflow policy
+//   spdlog overrun async logger that overwrites its oldest message
+// All sinks discard their output. Reported per call: mean, p50, p99, max
+// (timer overhead subtracted) and how many records were dropped or overwritten.
+#define STRAF_HOTLOG_MIN_LEVEL 1
+#include "Straf/HotLog.h"
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/null_sink.h>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+struct Result {
+    double mean, p50, p99, max;
+};
+
+double TimerOverhead() {
+    std::vector<double> samples(10000);
+    for (double& s : samples) {
+        const auto t0 = clock_type::now();
+        s = std::chrono::duration<double, std::nano>(clock_type::now() - t0).count();
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+template <typename Fn>
+Result Measure(size_t calls, bool paced, double overhead, Fn&& log) {
+    std::vector<double> ns(calls);
+    for (size_t i = 0; i < calls; ++i) {
+        if (paced && i % 256 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const auto t0 = clock_type::now();
+        log(i);
+        ns[i] = std::max(0.0, std::chrono::duration<double, std::nano>(clock_type::now() - t0).count() - overhead);
+    }
+    double sum = 0;
+    for (double v : ns) sum += v;
+    std::sort(ns.begin(), ns.end());
+    return {sum / calls, ns[calls / 2], ns[calls * 99 / 100], ns.back()};
+}
+
+void Print(const char* name, const char* mode, const Result& r, unsigned long long lost) {
+    std::printf("%-15s %-6s %9.1f %9.1f %9.1f %11.1f %10llu\n", name, mode, r.mean, r.p50, r.p99, r.max, lost);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t calls = argc > 1 ? static_cast<size_t>(std::max(1024, std::atoi(argv[1]))) : 200000;
+    const double overhead = TimerOverhead();
+    const std::string device = "wasapi";
+    namespace hotlog = Straf::hotlog;
+
+    hotlog::Start([](const hotlog::Message&) {});
+    std::printf("%zu calls, timer overhead %.1f ns subtracted\n", calls, overhead);
+    std::printf("%-15s %-6s %9s %9s %9s %11s %10s\n", "logger", "mode", "mean ns", "p50 ns", "p99 ns", "max ns", "lost");
+
+    for (const bool paced : {true, false}) {
+        const char* mode = paced ? "paced" : "burst";
+        hotlog::SetLevel(hotlog::Level::Trace);
+        Print("hot stripped", mode, Measure(calls, paced, overhead, [&]([[maybe_unused]] size_t i) {
+            STRAF_HOT_TRACE("packet {} frames {} peak {:.3f} from {}", i, size_t{480}, 0.25, device);
+        }), 0);
+
+        hotlog::SetLevel(hotlog::Level::Info);
+        Print("hot disabled", mode, Measure(calls, paced, overhead, [&](size_t i) {
+            STRAF_HOT_DEBUG("packet {} frames {} peak {:.3f} from {}", i, size_t{480}, 0.25, device);
+        }), 0);
+
+        hotlog::SetLevel(hotlog::Level::Debug);
+        const auto before = hotlog::GetStats().dropped;
+        const Result hot = Measure(calls, paced, overhead, [&](size_t i) {
+            STRAF_HOT_DEBUG("packet {} frames {} peak {:.3f} from {}", i, size_t{480}, 0.25, device);
+        });
+        Print("hot enabled", mode, hot, hotlog::GetStats().dropped - before);
+
+        for (const auto policy : {spdlog::async_overflow_policy::block, spdlog::async_overflow_policy::overrun_oldest}) {
+            auto pool = std::make_shared<spdlog::details::thread_pool>(8192, 1);
+            auto logger = std::make_shared<spdlog::async_logger>("bench", std::make_shared<spdlog::sinks::null_sink_mt>(), pool, policy);
+            logger->set_level(spdlog::level::debug);
+            const Result r = Measure(calls, paced, overhead, [&](size_t i) {
+                logger->debug("packet {} frames {} peak {:.3f} from {}", i, size_t{480}, 0.25, device);
+            });
+            Print(policy == spdlog::async_overflow_policy::block ? "spdlog block" : "spdlog overrun", mode, r, pool->overrun_counter());
+        }
+    }
+    hotlog::Stop();
+    const auto stats = hotlog::GetStats();
+    std::printf("hot log: %llu records written, %llu dropped\n",
+                static_cast<unsigned long long>(stats.written), static_cast<unsigned long long>(stats.dropped));
+    return 0;
+}
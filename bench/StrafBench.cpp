@@ -0,0 +1,195 @@
+// Microbenchmark suite for the DSP, detection and penalty hot paths, on
+// Google Benchmark. Needs no audio device or GPU.
+//
+//   straf_bench [--benchmark_filter=REGEX] [--benchmark_out=results.json]
+//               [--benchmark_out_format=json] [--benchmark_repetitions=N]
+//
+// Everything runs on the calling thread against StrafCore:
+//   DownmixResample/<rate>/<channels>  10 ms capture packets to 16 kHz mono
+//   FloatToPcm16/<samples>             the recognizer's int16 conversion
+//   AnalyzeText/<entries>              gamer-chat utterances against a vocabulary
+//                                      of the sample config padded to <entries>
+//   TriggerTick/<burst>                <burst> distinct detections at once, then
+//                                      the manager loop draining them, virtual clock
+//   LoadConfig/<entries>               parse and validate a config.json
+// Keep the JSON from --benchmark_out per release and compare runs with
+// Google Benchmark's tools/compare.py.
+#include "Straf/AudioDsp.h"
+#include "Straf/Clock.h"
+#include "Straf/Config.h"
+#include "Straf/Detector.h"
+#include "Straf/Overlay.h"
+#include "Straf/PenaltyManager.h"
+#include "Straf/WordTable.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Straf;
+
+namespace {
+
+class NullOverlay : public IOverlayRenderer {
+public:
+    bool Initialize() override { return true; }
+    void ShowPenalty(WordId) override {}
+    void UpdateStatus(int, WordId) override {}
+    void Hide() override {}
+};
+
+// Vocabulary of config.sample.json
+const std::vector<std::string> kSampleWords{
+    "noob", "bot", "trash", "ez", "rekt", "camping rat", "hacker", "cheater", "smurf", "toxic", "tryhard", "lucker",
+    "lagger", "dog", "clown", "idiot", "moron", "stupid", "dumbass", "loser", "fk", "ffs", "wtf", "shit", "bullshit",
+    "fuck", "fucking", "asshole", "bitch", "cunt", "retard", "gay", "pussy", "motherfucker", "suck my dick", "dickhead"};
+
+// Sample words, then synthetic single words, phrases and a few patterns up to `entries`.
+std::vector<std::string> MakeVocabulary(size_t entries) {
+    std::vector<std::string> vocab(kSampleWords.begin(), kSampleWords.begin() + std::min(entries, kSampleWords.size()));
+    for (size_t i = 0; vocab.size() < entries; ++i) {
+        const std::string word = "zq" + std::to_string(i) + "x";
+        if (i % 16 == 5) vocab.push_back("re:" + word + "[0-9]+");
+        else if (i % 4 == 1) vocab.push_back(word + " camper");
+        else vocab.push_back(word);
+    }
+    return vocab;
+}
+
+// Recognizer-style utterances: lower case, no punctuation, 4-14 words, about
+// one in eight containing a vocabulary hit.
+std::vector<std::string> MakeTranscript(size_t utterances) {
+    static const char* filler[] = {"push", "b", "site", "rotate", "they", "are", "on", "the", "left", "one", "shot",
+                                   "nice", "try", "i", "need", "heals", "watch", "flank", "drop", "me", "a", "gun",
+                                   "go", "go", "go", "reload", "behind", "you", "what", "was", "that", "again"};
+    std::mt19937 rng(42);
+    std::vector<std::string> out;
+    out.reserve(utterances);
+    for (size_t u = 0; u < utterances; ++u) {
+        const size_t words = 4 + rng() % 11;
+        std::string text;
+        for (size_t w = 0; w < words; ++w) {
+            if (!text.empty()) text += ' ';
+            text += filler[rng() % std::size(filler)];
+        }
+        if (rng() % 8 == 0) text += ' ' + kSampleWords[rng() % kSampleWords.size()];
+        out.push_back(std::move(text));
+    }
+    return out;
+}
+
+void BM_DownmixResample(benchmark::State& state) {
+    const int rate = static_cast<int>(state.range(0));
+    const int channels = static_cast<int>(state.range(1));
+    const size_t frames = static_cast<size_t>(rate / 100);
+    std::vector<float> in(frames * channels);
+    for (size_t i = 0; i < in.size(); ++i) in[i] = static_cast<float>(std::sin(0.01 * static_cast<double>(i)));
+    std::vector<float> out;
+    for (auto _ : state) {
+        DownmixAndResample(in.data(), frames, channels, rate, out, 16000);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * frames));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * in.size() * sizeof(float)));
+}
+BENCHMARK(BM_DownmixResample)
+    ->ArgNames({"rate", "channels"})
+    ->ArgsProduct({{16000, 44100, 48000, 96000}, {1, 2, 6}});
+
+void BM_FloatToPcm16(benchmark::State& state) {
+    const size_t count = static_cast<size_t>(state.range(0));
+    std::vector<float> in(count);
+    for (size_t i = 0; i < count; ++i) in[i] = static_cast<float>(1.2 * std::sin(0.003 * static_cast<double>(i)));
+    std::vector<int16_t> out(count);
+    for (auto _ : state) {
+        FloatToPcm16(in.data(), count, out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * count));
+}
+BENCHMARK(BM_FloatToPcm16)->ArgName("samples")->Arg(160)->Arg(1600)->Arg(16000);
+
+void BM_AnalyzeText(benchmark::State& state) {
+    const size_t entries = static_cast<size_t>(state.range(0));
+    auto detector = CreateTextAnalysisDetector();
+    if (!detector->Initialize(MakeVocabulary(entries))) {
+        state.SkipWithError("vocabulary did not compile");
+        return;
+    }
+    uint64_t detections = 0;
+    detector->Start([&](const DetectionResult&) { ++detections; });
+    const auto transcript = MakeTranscript(512);
+    size_t i = 0;
+    for (auto _ : state) {
+        detector->AnalyzeText(transcript[i]);
+        if (++i == transcript.size()) i = 0;
+    }
+    detector->Stop();
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["detections"] = benchmark::Counter(static_cast<double>(detections), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_AnalyzeText)->ArgName("entries")->Arg(36)->Arg(1000)->Arg(10000)->Arg(50000);
+
+void BM_TriggerTick(benchmark::State& state) {
+    const size_t burst = static_cast<size_t>(state.range(0));
+    std::vector<WordId> words;
+    for (size_t i = 0; i < 4096; ++i) words.push_back(Words().Intern("burst" + std::to_string(i)));
+    NullOverlay overlay;
+    VirtualClock clock;
+    auto manager = CreatePenaltyManager(&overlay, &clock);
+    manager->Configure(10, std::chrono::seconds(30), std::chrono::seconds(60));
+    size_t next = 0;
+    for (auto _ : state) {
+        // A burst arrives at one instant, then the manager loop runs once per
+        // millisecond for as many rounds as there were detections
+        for (size_t i = 0; i < burst; ++i) {
+            manager->Trigger(words[next]);
+            if (++next == words.size()) next = 0;
+        }
+        for (size_t i = 0; i < burst; ++i) {
+            clock.Advance(std::chrono::milliseconds(1));
+            manager->Tick();
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * burst));
+    state.counters["stars"] = manager->GetStarCount();
+}
+BENCHMARK(BM_TriggerTick)->ArgName("burst")->Arg(16)->Arg(256)->Arg(4096);
+
+void BM_LoadConfig(benchmark::State& state) {
+    const size_t entries = static_cast<size_t>(state.range(0));
+    const auto path = std::filesystem::temp_directory_path() / ("straf_bench_config_" + std::to_string(entries) + ".json");
+    {
+        std::ofstream out(path);
+        out << "{\n  \"words\": [";
+        const auto vocab = MakeVocabulary(entries);
+        for (size_t i = 0; i < vocab.size(); ++i) out << (i ? ", \"" : "\"") << vocab[i] << '"';
+        out << "],\n  \"penalty\": {\"durationSeconds\": 30, \"cooldownSeconds\": 60, \"queueLimit\": 10},\n"
+               "  \"audio\": {\"sampleRate\": 16000, \"channels\": 1},\n"
+               "  \"detector\": {\"phraseWindowMs\": 4000, \"silenceResetMs\": 2000},\n"
+               "  \"logging\": {\"level\": \"info\"},\n  \"metrics\": {\"port\": 0}\n}\n";
+    }
+    const auto bytes = static_cast<int64_t>(std::filesystem::file_size(path));
+    for (auto _ : state) {
+        auto config = LoadConfig(path.string());
+        if (!config) {
+            state.SkipWithError("config did not load");
+            break;
+        }
+        benchmark::DoNotOptimize(config->words.data());
+    }
+    std::filesystem::remove(path);
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_LoadConfig)->ArgName("entries")->Arg(36)->Arg(1000)->Arg(10000);
+
+} // namespace
+
+BENCHMARK_MAIN();
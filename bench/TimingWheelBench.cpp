@@ -0,0 +1,125 @@
+// Stress benchmark for the phrase-cooldown timers.
+//
+//   straf_timer_bench [triggers]
+//
+// Part 1 replays a flood of distinct phrase triggers under simulated time
+// through (a) the old scheme - an unordered_map of timestamps swept every 30 s -
+// and (b) the timing wheel, reporting throughput and the worst single call
+// once the containers have reached steady-state size.
+// Part 2 drives the real PenaltyManager::Trigger/Tick with the same number of
+// distinct reasons on the wall clock.
+#include "Straf/Overlay.h"
+#include "Straf/PenaltyManager.h"
+#include "Straf/TimingWheel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace Straf;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+class NullOverlay : public IOverlayRenderer {
+public:
+    bool Initialize() override { return true; }
+    void ShowPenalty(WordId) override {}
+    void UpdateStatus(int, WordId) override {}
+    void Hide() override {}
+};
+
+struct Result {
+    double nsPerTrigger;
+    double worstUs;
+    size_t peakLive;
+};
+
+constexpr auto kCooldown = std::chrono::seconds(15);
+constexpr auto kStep = std::chrono::microseconds(50); // simulated gap between triggers (20k/s)
+
+template <typename Fn>
+Result Drive(size_t triggers, Fn&& trigger) {
+    auto simNow = clock_type::time_point{} + std::chrono::hours(1);
+    double worst = 0;
+    size_t peak = 0;
+    const auto start = clock_type::now();
+    for (size_t i = 0; i < triggers; ++i) {
+        simNow += kStep;
+        const auto t0 = clock_type::now();
+        peak = std::max(peak, trigger(i, simNow));
+        // Worst case is taken after warm-up so container growth does not dominate it.
+        if (i >= triggers / 4) worst = std::max(worst, std::chrono::duration<double, std::micro>(clock_type::now() - t0).count());
+    }
+    const double total = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+    return {total / static_cast<double>(triggers), worst, peak};
+}
+
+Result RunSweep(size_t triggers) {
+    std::unordered_map<uint64_t, clock_type::time_point> recent;
+    clock_type::time_point lastCleanup{};
+    return Drive(triggers, [&](size_t i, clock_type::time_point now) {
+        if (now - lastCleanup > std::chrono::seconds(30)) {
+            for (auto it = recent.begin(); it != recent.end();) {
+                if (it->second + kCooldown * 2 < now) it = recent.erase(it);
+                else ++it;
+            }
+            lastCleanup = now;
+        }
+        auto it = recent.find(i);
+        if (it == recent.end() || it->second + kCooldown <= now) recent[i] = now;
+        return recent.size();
+    });
+}
+
+Result RunWheel(size_t triggers) {
+    TimingWheel wheel(std::chrono::milliseconds(1), clock_type::time_point{} + std::chrono::hours(1));
+    std::unordered_map<uint64_t, TimingWheel::TimerId> cooling;
+    return Drive(triggers, [&](size_t i, clock_type::time_point now) {
+        wheel.Advance(now, [&](uint64_t tag) { cooling.erase(tag); });
+        if (cooling.find(i) == cooling.end()) cooling.emplace(i, wheel.Schedule(now + kCooldown, i));
+        return cooling.size();
+    });
+}
+
+void RunManager(size_t triggers) {
+    NullOverlay overlay;
+    auto manager = CreatePenaltyManager(&overlay);
+    // Word ids are bounded by the intern table, so cycle through a large vocabulary.
+    std::vector<WordId> reasons;
+    const size_t vocab = std::min<size_t>(triggers, WordTable::kCapacity / 2);
+    reasons.reserve(vocab);
+    for (size_t i = 0; i < vocab; ++i) reasons.push_back(Words().Intern("phrase" + std::to_string(i)));
+
+    double worst = 0;
+    const auto start = clock_type::now();
+    for (size_t i = 0; i < triggers; ++i) {
+        const auto t0 = clock_type::now();
+        manager->Trigger(reasons[i % reasons.size()]);
+        if ((i & 63) == 0) manager->Tick();
+        worst = std::max(worst, std::chrono::duration<double, std::micro>(clock_type::now() - t0).count());
+    }
+    const double total = std::chrono::duration<double, std::nano>(clock_type::now() - start).count();
+    std::printf("PenaltyManager  %8.1f ns/trigger  worst %8.1f us  stars %d\n",
+        total / static_cast<double>(triggers), worst, manager->GetStarCount());
+}
+
+}
+
+int main(int argc, char** argv) {
+    const size_t triggers = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    std::printf("%zu distinct triggers, %lld us apart (simulated), %lld s phrase cooldown\n\n",
+        triggers, static_cast<long long>(kStep.count()), static_cast<long long>(kCooldown.count()));
+
+    const Result sweep = RunSweep(triggers);
+    std::printf("map + 30 s sweep %7.1f ns/trigger  worst %8.1f us  peak entries %zu\n", sweep.nsPerTrigger, sweep.worstUs, sweep.peakLive);
+    const Result wheel = RunWheel(triggers);
+    std::printf("timing wheel     %7.1f ns/trigger  worst %8.1f us  peak entries %zu\n\n", wheel.nsPerTrigger, wheel.worstUs, wheel.peakLive);
+
+    RunManager(triggers);
+    return 0;
+}
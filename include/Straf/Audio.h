@@ -1,5 +1,6 @@
 #pragma once
 #include <functional>
+#include <string>
 #include <vector>
 #include <memory>
 
@@ -20,4 +21,13 @@ std::unique_ptr<IAudioSource> CreateAudioSilent();
 // WASAPI-based microphone capture (shared mode), outputs mono 16kHz float frames (20ms typical)
 std::unique_ptr<IAudioSource> CreateAudioWasapi();
 
+struct AudioFileOptions {
+    bool realtime{true};          // deliver packets at the recording's pace; false: back to back
+    std::function<void()> onEnd;  // called on the audio task after the last packet
+};
+// Plays a WAV file (16-bit PCM or 32-bit float, any rate and channel count)
+// as if it were captured live: 20 ms packets, downmixed and resampled to the
+// format passed to Initialize(). Initialize() fails if the file is unreadable.
+std::unique_ptr<IAudioSource> CreateAudioFile(const std::string& path, AudioFileOptions options = {});
+
 }
@@ -0,0 +1,30 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Straf {
+
+// Downmixes interleaved float frames to mono and linearly resamples them to
+// `outRate`. Each call stands alone: no state carries over between packets.
+void DownmixAndResample(const float* in, size_t inFrames, int inChannels, int inRate,
+                        std::vector<float>& out, int outRate);
+
+// Converts float samples in [-1, 1] to 16-bit PCM for recognizers that take
+// integer input; out-of-range samples clip.
+void FloatToPcm16(const float* in, size_t count, int16_t* out);
+
+// Delivery jitter of a capture stream: how far each packet's arrival strays
+// from the previous arrival plus the previous packet's duration. Each
+// Arrived() call records one sample in straf_audio_packet_jitter_seconds.
+class PacketJitter {
+public:
+    void Arrived(size_t frames, int rate);
+
+private:
+    std::chrono::steady_clock::time_point last_{};
+    std::chrono::duration<double> expected_{0.0}; // duration of the previous packet
+};
+
+}
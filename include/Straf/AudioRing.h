@@ -0,0 +1,179 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Straf/Audio.h"
+#include "Straf/Executor.h"
+
+/**
+ * @brief Captured audio for a recognizer in another process, through shared
+ * memory, so capture keeps running while the recognizer restarts.
+ *
+ * The capture process owns a ring of float samples named after the stream
+ * and writes each packet into it in place; the one consumer maps the same
+ * ring and reads the samples where they are. Positions count samples from
+ * the start of the stream and never wrap, so a position names the same
+ * sample in both processes. Next to the samples, a small ring of packet
+ * records (seqlocks, like the event feed's slots) keeps where each packet
+ * starts, how long it is and when it was captured.
+ *
+ * Single producer, single consumer, and the producer never waits: it
+ * announces the range it is about to overwrite before writing it, so a
+ * consumer that reads a packet and then finds it announced knows it was
+ * lapped. A consumer that falls a whole ring behind resumes at the live edge
+ * and counts the samples it skipped as overruns. A waiting consumer sleeps on
+ * a futex (Linux) or named event (Windows) and is signalled once per wait.
+ *
+ * Consumers attach and re-attach at any time and start at the live edge; a
+ * consumer whose process died is replaced by the next one to attach. When the
+ * producer exits or a new one takes the name over, the consumer sees the
+ * ring close.
+ */
+namespace Straf {
+
+namespace detail {
+struct AudioRingLayout; // the mapped layout, in AudioRing.cpp
+}
+
+inline constexpr uint32_t kAudioRingVersion = 1;
+
+// Shared memory object name for a stream name.
+std::string AudioRingObjectName(const std::string& name);
+
+struct AudioRingStats {
+    uint64_t samples{0};  // written so far
+    uint64_t packets{0};
+    uint64_t wakeups{0};  // consumer signalled
+    uint64_t consumerPid{0}; // 0 if none attached
+    uint64_t consumerPosition{0};
+    uint64_t consumerOverruns{0}; // samples the consumer skipped
+    uint64_t attaches{0};         // consumers attached so far
+};
+
+/**
+ * @brief Capture side: creates the ring and writes packets into it. One
+ * thread at a time.
+ */
+class AudioRingWriter {
+public:
+    // Fails if another live process owns a ring of the same name. The ring
+    // holds at least `seconds` of audio.
+    static std::unique_ptr<AudioRingWriter> Create(const std::string& name, int sampleRate, int channels,
+                                                   std::chrono::seconds seconds = std::chrono::seconds(8));
+    ~AudioRingWriter();
+
+    AudioRingWriter(const AudioRingWriter&) = delete;
+    AudioRingWriter& operator=(const AudioRingWriter&) = delete;
+
+    // Copies `count` samples (interleaved if stereo) into the ring as one
+    // packet captured at `captured`; packets longer than a quarter of the
+    // ring are split.
+    void Write(const float* samples, size_t count, std::chrono::steady_clock::time_point captured);
+
+    const std::string& Name() const { return name_; }
+    int SampleRate() const;
+    int Channels() const;
+    size_t Capacity() const; // samples
+    AudioRingStats GetStats() const;
+
+private:
+    AudioRingWriter(std::string name, detail::AudioRingLayout* ring, size_t bytes, intptr_t handle, uint32_t generation);
+    void WritePacket(const float* samples, size_t count, int64_t capturedNanos);
+
+    std::string name_;
+    detail::AudioRingLayout* ring_;
+    size_t bytes_;
+    intptr_t handle_;
+    intptr_t event_; // Windows: the consumer's wake event
+    uint32_t generation_; // the ring's generation while this writer owns it
+    uint64_t samples_{0}; // mirrors the ring's counters; only this side writes them
+    uint64_t packets_{0};
+    std::atomic<uint64_t> wakeups_{0};
+};
+
+// A packet still in the ring: the samples are read where they are, in up to
+// two pieces when the packet wraps around the end of the ring.
+struct AudioRingPacket {
+    uint64_t position{0}; // of the first sample
+    const float* first{nullptr};
+    size_t firstCount{0};
+    const float* second{nullptr};
+    size_t secondCount{0};
+    std::chrono::steady_clock::time_point captured{};
+
+    size_t Count() const { return firstCount + secondCount; }
+};
+
+/**
+ * @brief Recognizer side: the ring's one consumer. Not thread-safe except
+ * Interrupt().
+ */
+class AudioRingReader {
+public:
+    // Attaches at the live edge. nullptr if there is no such ring, the layout
+    // differs or a live consumer is already attached.
+    static std::unique_ptr<AudioRingReader> Open(const std::string& name);
+    ~AudioRingReader();
+
+    AudioRingReader(const AudioRingReader&) = delete;
+    AudioRingReader& operator=(const AudioRingReader&) = delete;
+
+    // The next packet, in place; false when caught up. The view stays valid
+    // until the producer laps it: use it, then check Intact(). Each call
+    // moves past the packet it returns.
+    bool Next(AudioRingPacket& packet);
+    // Whether the producer has not started overwriting `packet` yet, so what
+    // was read from it is what was captured. A lapped packet counts as an
+    // overrun.
+    bool Intact(const AudioRingPacket& packet);
+    // Next() copied into `out` (resized to the packet) and checked with
+    // Intact(); false when caught up. Lapped packets are skipped.
+    bool Read(AudioBuffer& out, std::chrono::steady_clock::time_point& captured);
+    // Blocks until Next() has something, the ring closes, Interrupt() is
+    // called or `timeout` passes. True when a packet is ready.
+    bool Wait(std::chrono::milliseconds timeout);
+    // Ends a Wait() in progress from another thread.
+    void Interrupt();
+    // The producer exited, was replaced or died; open again to follow the
+    // next one.
+    bool Closed() const;
+
+    int SampleRate() const;
+    int Channels() const;
+    uint64_t Position() const { return position_; } // next sample to read
+    uint64_t Overruns() const { return overruns_; } // samples skipped
+
+private:
+    AudioRingReader(detail::AudioRingLayout* ring, size_t bytes, intptr_t handle, intptr_t event);
+    bool Ready() const;
+    bool Lapped(uint64_t position) const;
+    void Skip();
+
+    detail::AudioRingLayout* ring_;
+    size_t bytes_;
+    intptr_t handle_;
+    intptr_t event_;
+    uint32_t generation_;
+    uint64_t writerPid_;
+    uint64_t packet_{0};   // next packet record to read
+    uint64_t position_{0};
+    uint64_t overruns_{0};
+    std::atomic<bool> interrupted_{false};
+};
+
+// Writes every packet `inner` captures into `ring`, then passes it on.
+// Initialize() fails unless the format matches the ring's. `ring` must
+// outlive the returned source.
+std::unique_ptr<IAudioSource> PublishingAudioSource(std::unique_ptr<IAudioSource> inner, AudioRingWriter& ring);
+
+// Audio from the ring called `name`, as a task on `executor`: waits for a
+// producer with the format passed to Initialize(), delivers its packets as
+// they are written and re-attaches when the producer restarts. The waits run
+// in Blocking() on the ring's wake word, and while there is no ring on a
+// per-stream doorbell the producer rings when it sets one up.
+std::unique_ptr<IAudioSource> CreateAudioRing(const std::string& name, Executor& executor = Tasks());
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Straf {
+
+// Compiled blocklist file (.sfst): a minimized acyclic automaton (DAWG) over
+// lowercased UTF-8 bytes. The layout is plain arrays so the file can be
+// memory-mapped and queried in place with no parse step.
+//
+//   BlocklistHeader | BlocklistState[stateCount] | BlocklistArc[arcCount]
+//
+// Arcs of a state are contiguous and sorted by label.
+constexpr char kBlocklistMagic[4] = {'S', 'F', 'S', 'T'};
+constexpr uint32_t kBlocklistVersion = 1;
+
+struct BlocklistHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t stateCount;
+    uint32_t arcCount;
+    uint32_t wordCount;
+    uint32_t rootState;
+};
+
+struct BlocklistState {
+    uint32_t firstArc;
+    uint16_t arcCount;
+    uint16_t flags; // bit 0: accepting
+};
+
+struct BlocklistArc {
+    uint32_t target;
+    uint8_t label;
+    uint8_t pad[3];
+};
+
+struct BlocklistStats {
+    size_t words{0};
+    size_t states{0};
+    size_t arcs{0};
+    size_t fileBytes{0};
+};
+
+class IBlocklist {
+public:
+    virtual ~IBlocklist() = default;
+    // Exact match of an already-lowercased word.
+    virtual bool Contains(std::string_view word) const = 0;
+    virtual size_t Size() const = 0;
+    // Calls `visit` with every word in byte order until it returns false.
+    virtual void ForEachWord(const std::function<bool(std::string_view)>& visit) const = 0;
+};
+
+// Builds the minimized automaton for `words` (lowercased, deduplicated) and
+// writes it to `outPath`. Returns false if the file cannot be written.
+bool CompileBlocklist(std::vector<std::string> words, const std::string& outPath, BlocklistStats* stats = nullptr);
+
+// Memory-maps a compiled blocklist. Returns nullptr if the file is missing,
+// truncated, corrupt (an arc or state index out of range, unsorted arcs) or
+// was written by an incompatible version. Every state and arc is checked once
+// here, so Contains() never reads outside the file.
+std::unique_ptr<IBlocklist> OpenBlocklist(const std::string& path);
+
+}
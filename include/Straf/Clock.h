@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+
+namespace Straf {
+
+/**
+ * @brief Time source for components whose policy depends on elapsed time.
+ *
+ * Production code uses SystemClock(); simulations and replays pass a
+ * VirtualClock and move it explicitly, so hours of penalty behaviour can be
+ * evaluated without waiting.
+ */
+class IClock {
+public:
+    using clock = std::chrono::steady_clock;
+    virtual ~IClock() = default;
+    virtual clock::time_point Now() const = 0;
+};
+
+// Process-wide steady_clock adapter.
+inline IClock& SystemClock() {
+    class Steady final : public IClock {
+    public:
+        clock::time_point Now() const override { return clock::now(); }
+    };
+    static Steady instance;
+    return instance;
+}
+
+// Manually driven clock. Not thread-safe; owned by the thread that drives it.
+class VirtualClock final : public IClock {
+public:
+    explicit VirtualClock(clock::time_point start = clock::time_point{} + std::chrono::hours(1)) : now_(start) {}
+
+    clock::time_point Now() const override { return now_; }
+    void Set(clock::time_point t) { now_ = t; }
+    void Advance(clock::duration d) { now_ += d; }
+
+private:
+    clock::time_point now_;
+};
+
+}
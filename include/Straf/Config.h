@@ -16,10 +16,34 @@ struct AudioConfig {
     int channels{1};
 };
 
+struct DetectorConfig {
+    int phraseWindowMs{4000};   // max span of a phrase across recognizer results
+    int silenceResetMs{2000};   // gap that resets streaming phrase state
+};
+
+struct LoggingConfig {
+    std::string level{"info"}; // trace, debug, info, warn, error, off
+};
+
+struct MetricsConfig {
+    int port{0}; // Prometheus endpoint on 127.0.0.1; 0 = off
+};
+
+struct FeedConfig {
+    std::string name; // shared-memory event feed for other processes; empty = off
+};
+
 struct AppConfig {
     std::vector<std::string> words;
+    // Optional compiled blocklist (.sfst) mapped alongside `words`; relative
+    // paths resolve against the config file's directory.
+    std::string blocklist;
     PenaltyConfig penalty{};
     AudioConfig audio{};
+    DetectorConfig detector{};
+    LoggingConfig logging{};
+    MetricsConfig metrics{};
+    FeedConfig feed{};
 };
 
 std::optional<AppConfig> LoadConfig(const std::string& path);
@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace Straf {
+
+struct ConfigWatchOptions {
+    // Quiet period after the last change before reloading; editors often save
+    // in several steps (truncate, write, rename).
+    std::chrono::milliseconds debounce{250};
+    // Where change notifications are unavailable (non-Windows) the file's
+    // timestamp and size are polled at this interval.
+    std::chrono::milliseconds pollInterval{1000};
+};
+
+// Reload counters and latency. Latency runs from the end of the debounce
+// period to the return of the reload callback: parse, compile and publish.
+struct ConfigReloadStats {
+    uint64_t reloads{0};   // callback reported success
+    uint64_t failures{0};  // callback rejected the file (unreadable, invalid)
+    std::chrono::nanoseconds lastLatency{0};
+    std::chrono::nanoseconds maxLatency{0};
+    std::chrono::nanoseconds meanLatency{0}; // over all attempts
+};
+
+/**
+ * @brief Calls back on its own thread whenever a file changes.
+ *
+ * On Windows the thread blocks on a directory change notification for the
+ * file's parent directory and costs no wakeups while nothing is written;
+ * elsewhere it polls. Changes to other files in the directory are filtered
+ * out by comparing the file's last write time and size. Several changes in
+ * quick succession produce one callback after the debounce period. The
+ * callback runs on the watcher thread, so slow work (re-parsing, compiling a
+ * vocabulary) never stalls the threads it reconfigures.
+ */
+class ConfigWatcher {
+public:
+    using clock = std::chrono::steady_clock;
+    // Returns false when the new file could not be applied; the previous
+    // configuration then stays in effect.
+    using ReloadCallback = std::function<bool()>;
+
+    // Starts watching `path`. Returns nullptr if its directory cannot be watched.
+    static std::unique_ptr<ConfigWatcher> Start(const std::filesystem::path& path, ReloadCallback onChange,
+                                                ConfigWatchOptions options = {});
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    ConfigReloadStats Stats() const;
+
+private:
+    class ChangeSource;
+    // Last write time and size; a changed stamp means the file was rewritten.
+    struct Stamp {
+        std::filesystem::file_time_type written{};
+        uintmax_t size{0};
+        bool exists{false};
+        bool operator==(const Stamp&) const = default;
+    };
+
+    ConfigWatcher(const std::filesystem::path& path, ReloadCallback onChange, ConfigWatchOptions options);
+    static Stamp StampOf(const std::filesystem::path& path);
+    void Run();
+    void Record(bool applied, clock::duration latency);
+
+    std::filesystem::path path_;
+    ReloadCallback onChange_;
+    ConfigWatchOptions options_;
+    std::unique_ptr<ChangeSource> source_;
+    std::thread thread_;
+
+    std::atomic<uint64_t> reloads_{0};
+    std::atomic<uint64_t> failures_{0};
+    std::atomic<int64_t> lastLatencyNs_{0};
+    std::atomic<int64_t> maxLatencyNs_{0};
+    std::atomic<int64_t> totalLatencyNs_{0};
+};
+
+}
@@ -1,14 +1,28 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <functional>
 #include <vector>
 #include <memory>
+#include "Straf/WordTable.h"
 
 namespace Straf {
 
+class IBlocklist; // Forward declaration
+
+enum class DetectionSource : uint8_t {
+    Microphone, // final recognizer results
+    Partial,    // partial recognizer hypotheses
+    Chat,       // text chat / external feeds
+};
+
+// Words are ids into Words(); resolve with Words().Name(id) when text is needed.
 struct DetectionResult {
-    std::string word;
+    WordId word{kNoWord}; // matched phrase or token
     float confidence{1.0f};
+    WordId rule{kNoWord}; // vocabulary entry that fired (literal, pattern, or "blocklist")
+    DetectionSource source{DetectionSource::Microphone};
 };
 
 /**
@@ -35,15 +49,40 @@ public:
     virtual void Stop() = 0;
 };
 
+/**
+ * @brief Streaming options for phrase detection across recognizer results.
+ *
+ * A phrase may span several AnalyzeText/AnalyzePartial calls as long as its
+ * first and last token are at most `window` apart. Matcher state resets when no
+ * token arrives for `silenceReset`.
+ */
+struct PhraseStreamOptions {
+    std::chrono::milliseconds window{4000};
+    std::chrono::milliseconds silenceReset{2000};
+};
+
 /**
  * @brief Interface for text-based detection that can analyze recognized speech.
  */
 class ITextDetector : public IDetector {
 public:
+    // Final recognizer result for an utterance.
     virtual void AnalyzeText(const std::string& recognizedText, float confidence = 1.0f) = 0;
+    // Partial hypothesis of the current utterance. Tokens after the part that
+    // agrees with the previous partial are examined, so words the recognizer
+    // revises are matched too; a word is reported once per position.
+    virtual void AnalyzePartial(const std::string& partialText, float confidence = 1.0f) = 0;
+    // Supplement the vocabulary with a compiled, memory-mapped blocklist (see Blocklist.h).
+    // Like Reload(), safe while analysis runs on another thread.
+    virtual void AttachBlocklist(std::unique_ptr<IBlocklist> blocklist) = 0;
+    // Compiles `vocabulary` on the calling thread and swaps it in atomically.
+    // Analysis already running finishes on the previous set; later calls see
+    // only the new one. Safe from any thread while AnalyzeText/AnalyzePartial
+    // run. Streaming phrase state restarts with the new set.
+    virtual bool Reload(const std::vector<std::string>& vocabulary, PhraseStreamOptions options) = 0;
 };
 
 std::unique_ptr<IDetector> CreateDetectorStub();
-std::unique_ptr<ITextDetector> CreateTextAnalysisDetector();
+std::unique_ptr<ITextDetector> CreateTextAnalysisDetector(PhraseStreamOptions options = {});
 
 }
@@ -0,0 +1,187 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "Straf/Detector.h"
+#include "Straf/Overlay.h"
+
+/**
+ * @brief Detections and penalty state for other processes (OBS widgets, bots,
+ * dashboards), through shared memory.
+ *
+ * The agent maps a ring of fixed 64-byte records named after the feed and
+ * writes every detection and overlay change into the next slot. Readers map
+ * the same ring read-mostly and copy records straight out of it; nothing goes
+ * through the kernel on either side except a wakeup for a reader that is
+ * waiting. Each slot is a seqlock over atomic words, like the trace rings:
+ * odd while being written, 2n+2 once record n is complete.
+ *
+ * The writer never waits for a reader. A reader that falls more than a ring
+ * behind finds its slots overwritten, skips to the oldest record still there
+ * and counts the skipped ones as overruns. A waiting reader sleeps on a futex
+ * (Linux) or a named event (Windows) in its own reader slot, and the writer
+ * signals it once per wait, not once per record.
+ *
+ * A control channel next to the ring (a Unix socket, or a named pipe on
+ * Windows) answers one line per connection: "subscribe" with what a reader
+ * needs to map the ring, "status" with the writer's counters and the
+ * attached readers. See tools/FeedRead.cpp for a reference reader.
+ */
+namespace Straf::feed {
+
+namespace detail {
+struct Ring; // the mapped layout, in EventFeed.cpp
+}
+
+inline constexpr uint32_t kLayoutVersion = 1;
+inline constexpr size_t kMaxReaders = 16;
+inline constexpr size_t kWordBytes = 40; // UTF-8, NUL-padded, cut at a character boundary
+
+enum class Kind : uint8_t {
+    Detection = 1, // a vocabulary hit, before rate limiting; `confidence` and `source` set
+    Penalty = 2,   // the overlay shows a penalty for `word`
+    Status = 3,    // star count or current word changed
+    Hidden = 4,    // the overlay hid the penalty
+};
+
+struct Record {
+    uint64_t seq{0};      // position in the feed, from 0; gaps are overruns
+    int64_t unixNanos{0}; // wall clock when published
+    Kind kind{Kind::Status};
+    DetectionSource source{DetectionSource::Microphone};
+    uint8_t stars{0};     // star count after the change (Penalty, Status, Hidden)
+    float confidence{0};
+    char word[kWordBytes]{};
+};
+
+// Ring object and control channel addresses for a feed name.
+std::string SharedMemoryName(const std::string& name);
+std::string ControlAddress(const std::string& name);
+
+struct WriterStats {
+    uint64_t published{0};
+    uint64_t wakeups{0}; // readers signalled
+    int stars{0};        // as last published
+};
+
+struct ReaderInfo {
+    uint64_t pid{0};
+    uint64_t position{0}; // next record it will read
+    uint64_t overruns{0};
+};
+
+/**
+ * @brief Agent side: creates the ring and publishes into it.
+ *
+ * Publish() is lock-free and safe from any number of threads: it claims a
+ * slot with one atomic add and fills it in place.
+ */
+class FeedWriter {
+public:
+    // Fails if another live process owns a feed of the same name. `capacity`
+    // is rounded up to a power of two.
+    static std::unique_ptr<FeedWriter> Create(const std::string& name, size_t capacity = 4096);
+    ~FeedWriter();
+
+    FeedWriter(const FeedWriter&) = delete;
+    FeedWriter& operator=(const FeedWriter&) = delete;
+
+    void PublishDetection(WordId word, float confidence, DetectionSource source);
+    // Also becomes the state a reader sees on attach; from one thread at a time.
+    void PublishState(Kind kind, WordId word, int stars);
+
+    const std::string& Name() const { return name_; }
+    size_t Capacity() const;
+    WriterStats GetStats() const;
+    std::vector<ReaderInfo> Readers() const;
+
+private:
+    FeedWriter(std::string name, detail::Ring* ring, size_t bytes, intptr_t handle, uint32_t generation);
+    void Publish(Record& record);
+    void WakeReaders();
+
+    std::string name_;
+    detail::Ring* ring_;
+    size_t bytes_;
+    intptr_t handle_; // shm fd, or the file mapping handle
+    uint32_t generation_; // the ring's generation while this writer owns it
+    std::atomic<uint64_t> wakeups_{0};
+    std::atomic<int> stars_{0};
+    std::vector<intptr_t> events_; // Windows: per-reader-slot wake events
+};
+
+/**
+ * @brief Consumer side: one reader slot on a feed. Not thread-safe; use one
+ * FeedReader per consuming thread.
+ */
+class FeedReader {
+public:
+    // Attaches to the feed's ring, starting at the newest record (or the
+    // oldest one still in the ring). nullptr if there is no such feed, the
+    // layout differs or all reader slots are taken.
+    static std::unique_ptr<FeedReader> Open(const std::string& name, bool fromOldest = false);
+    ~FeedReader();
+
+    FeedReader(const FeedReader&) = delete;
+    FeedReader& operator=(const FeedReader&) = delete;
+
+    // Copies the next record out of the ring; false when caught up.
+    bool Next(Record& out);
+    // Blocks until Next() has something, the writer closes or `timeout`
+    // passes. True when a record is ready.
+    bool Wait(std::chrono::milliseconds timeout);
+    // The last Penalty, Status or Hidden record, even if it left the ring.
+    std::optional<Record> State() const;
+    // The writer went away; reopen to follow a restarted agent.
+    bool Closed() const;
+
+    uint64_t Position() const { return position_; }
+    uint64_t Overruns() const { return overruns_; }
+
+private:
+    FeedReader(detail::Ring* ring, size_t bytes, intptr_t handle, size_t slot, intptr_t event);
+    bool Ready() const;
+
+    detail::Ring* ring_;
+    size_t bytes_;
+    intptr_t handle_;
+    size_t slot_;
+    intptr_t event_; // Windows: this slot's wake event
+    uint32_t generation_;
+    uint64_t position_{0};
+    uint64_t overruns_{0};
+};
+
+// Publishes every ShowPenalty/UpdateStatus/Hide to `writer` and forwards it
+// to `inner`. `writer` must outlive the returned overlay.
+std::unique_ptr<IOverlayRenderer> PublishingOverlay(std::unique_ptr<IOverlayRenderer> inner, FeedWriter& writer);
+
+/**
+ * @brief Control channel of a feed, on a thread of its own; one request per
+ * connection, answered with one line of JSON:
+ *   subscribe  {"shm", "version", "recordSize", "capacity", "head", "stars"}
+ *   status     {"pid", "published", "wakeups", "capacity", "stars", "readers": [{"pid", "position", "lag", "overruns"}]}
+ * Local only: a Unix socket readable by the user, or a named pipe that
+ * rejects remote clients.
+ */
+class FeedServer {
+public:
+    virtual ~FeedServer() = default;
+    // Requests answered; counted before the reply is sent
+    virtual uint64_t Requests() const = 0;
+};
+
+// nullptr if the channel cannot be created. `writer` must outlive the server.
+std::unique_ptr<FeedServer> StartFeedServer(FeedWriter& writer);
+
+// Client side: sends `command` to the feed's control channel and returns the
+// reply line; nullopt if no agent answers within `timeout`.
+std::optional<std::string> QueryFeed(const std::string& name, const std::string& command,
+                                     std::chrono::milliseconds timeout = std::chrono::milliseconds(2000));
+
+} // namespace Straf::feed
@@ -0,0 +1,401 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Straf {
+
+class Executor;
+
+namespace detail {
+
+using TaskClock = std::chrono::steady_clock;
+
+// Shared by a running task and its TaskHandle.
+struct TaskState {
+    Executor* executor{nullptr};
+    std::stop_source stop;
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done{false};
+};
+
+// One suspended co_await. Armed under the executor lock and resolved exactly
+// once under it, by its deadline, its event or channel, or by the task being
+// stopped; resolving unlinks it from all of them and queues the coroutine.
+struct Waiter {
+    std::coroutine_handle<> handle;
+    bool armed{false};
+    bool result{false};
+    bool timeoutResult{false}; // what the deadline resolves to
+    std::optional<std::multimap<TaskClock::time_point, Waiter*>::iterator> timer;
+    std::vector<Waiter*>* list{nullptr}; // event or channel waited on
+    void* slot{nullptr};                 // channel: where Send() puts the value
+};
+
+class Suspension;
+
+} // namespace detail
+
+/**
+ * @brief Coroutine that runs on an Executor once spawned.
+ *
+ * A function returning Task does nothing until Executor::Spawn() queues it.
+ * Every co_await inside it is one of the awaitables below; they return false
+ * (or nullopt) as soon as the task is asked to stop, so a stopped task leaves
+ * its loop at the next suspension instead of finishing a sleep. Bind the
+ * result of a co_await before testing it: GCC 12 miscompiles some coroutines
+ * with a co_await in a while condition (the body never runs).
+ */
+class Task {
+public:
+    struct promise_type {
+        std::shared_ptr<detail::TaskState> state = std::make_shared<detail::TaskState>();
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+        ~promise_type();
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task& operator=(Task&&) = delete;
+    ~Task() {
+        if (handle_) handle_.destroy(); // never spawned
+    }
+
+private:
+    friend class Executor;
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Owner's side of a spawned task. Dropping it leaves the task running.
+class TaskHandle {
+public:
+    TaskHandle() = default;
+
+    bool Joinable() const { return state_ != nullptr; }
+    // Wakes the task at its current or next co_await with a false result.
+    void RequestStop() {
+        if (state_) state_->stop.request_stop();
+    }
+    // Blocks until the task returned. Not from a task of the same executor.
+    void Join();
+    // RequestStop() and Join().
+    void Stop() {
+        RequestStop();
+        Join();
+    }
+
+private:
+    friend class Executor;
+    explicit TaskHandle(std::shared_ptr<detail::TaskState> state) : state_(std::move(state)) {}
+    std::shared_ptr<detail::TaskState> state_;
+};
+
+/**
+ * @brief Fixed set of worker threads that run Tasks.
+ *
+ * Ready coroutines go to one queue that idle workers take from; timers sit
+ * in a deadline-ordered map, and at most one idle worker waits for the
+ * earliest of them while the rest block without a deadline. Nothing polls:
+ * with no ready task and no timer due, every worker sleeps. What a worker
+ * makes ready itself it runs next rather than waking another worker for it,
+ * unless more piles up behind. Tasks must not
+ * block for long (a blocking call holds a worker; wrap it in Blocking()),
+ * and the executor must outlive every task spawned on it.
+ */
+class Executor {
+public:
+    using clock = detail::TaskClock;
+
+    struct Stats {
+        size_t workers{0};
+        size_t tasks{0};        // spawned and not yet finished
+        uint64_t resumes{0};    // coroutine resumptions
+        uint64_t wakeups{0};    // worker returns from waiting, any cause
+        uint64_t timersFired{0};
+        size_t blockingThreads{0}; // running or parked for the next Blocking() call
+    };
+
+    explicit Executor(size_t workers);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // Safe from any thread, also from a task.
+    TaskHandle Spawn(Task task);
+    Stats GetStats() const;
+
+private:
+    friend class detail::Suspension;
+    friend class Event;
+    template <typename T> friend class Channel;
+    friend struct YieldAwaiter;
+    template <typename F> friend class BlockingAwaiter;
+    friend struct Task::promise_type;
+
+    void Work(size_t index);
+    void PostLocked(std::coroutine_handle<> handle);
+    void Post(std::coroutine_handle<> handle);
+    void ArmLocked(detail::Waiter& waiter, std::optional<clock::time_point> deadline, std::vector<detail::Waiter*>* list);
+    void ResolveLocked(detail::Waiter& waiter, bool result);
+    void ExpireLocked(clock::time_point now);
+    void TaskFinished();
+    void RunBlocking(std::function<void()> fn, std::coroutine_handle<> resume);
+    void BlockingWork();
+
+    mutable std::mutex mutex_; // everything below, and every Event and Channel on this executor
+    std::condition_variable idle_;      // workers without a deadline
+    std::condition_variable timerWait_; // the one worker waiting for the earliest timer
+    std::deque<std::coroutine_handle<>> ready_;
+    std::multimap<clock::time_point, detail::Waiter*> timers_;
+    size_t idleWorkers_{0};
+    bool timerKeeper_{false};
+    bool stop_{false};
+    size_t tasks_{0};
+    uint64_t resumes_{0};
+    uint64_t wakeups_{0};
+    uint64_t timersFired_{0};
+    std::vector<std::thread> workers_;
+
+    // Threads for Blocking(); an idle one waits a while for the next call
+    // before it exits, so frequent short calls do not start a thread each.
+    mutable std::mutex blockingMutex_;
+    std::condition_variable blockingWork_;
+    std::condition_variable blockingExited_;
+    struct BlockingJob {
+        std::function<void()> fn;
+        std::coroutine_handle<> resume; // posted once fn returned
+    };
+    std::deque<BlockingJob> blockingJobs_;
+    size_t blockingThreads_{0};
+    size_t blockingIdle_{0};
+    bool blockingStop_{false};
+};
+
+// Process-wide executor with two workers. Never destroyed.
+Executor& Tasks();
+
+namespace detail {
+
+// Common part of the awaitables that wait on a deadline, an event or a channel.
+class Suspension {
+public:
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) {
+        return Suspend(handle, *handle.promise().state);
+    }
+    bool await_resume() const noexcept { return waiter_.result; }
+
+protected:
+    Suspension(Executor* executor, std::optional<TaskClock::time_point> deadline, std::vector<Waiter*>* list, bool timeoutResult)
+        : executor_(executor), deadline_(deadline), list_(list) {
+        waiter_.timeoutResult = timeoutResult;
+    }
+    Suspension(const Suspension&) = delete;
+    Suspension& operator=(const Suspension&) = delete;
+    ~Suspension() = default;
+
+    // Under the executor lock, before suspending: true completes the await
+    // at once with `result`.
+    virtual bool TakeLocked(bool& result) {
+        (void)result;
+        return false;
+    }
+
+    Waiter waiter_;
+
+private:
+    struct OnStop {
+        Suspension* self;
+        void operator()() const;
+    };
+
+    bool Suspend(std::coroutine_handle<> handle, TaskState& task);
+
+    Executor* executor_;
+    std::optional<TaskClock::time_point> deadline_;
+    std::vector<Waiter*>* list_;
+    std::optional<std::stop_callback<OnStop>> onStop_;
+};
+
+class SleepAwaiter final : public Suspension {
+public:
+    explicit SleepAwaiter(TaskClock::time_point deadline) : Suspension(nullptr, deadline, nullptr, true) {}
+};
+
+} // namespace detail
+
+// co_await SleepUntil(t): true at `t`, false once the task is asked to stop.
+inline detail::SleepAwaiter SleepUntil(detail::TaskClock::time_point deadline) { return detail::SleepAwaiter(deadline); }
+template <typename Rep, typename Period>
+detail::SleepAwaiter SleepFor(std::chrono::duration<Rep, Period> duration) {
+    return detail::SleepAwaiter(detail::TaskClock::now() + std::chrono::duration_cast<detail::TaskClock::duration>(duration));
+}
+
+// co_await Yield(): lets queued tasks run first; false once asked to stop.
+struct YieldAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        stop_ = handle.promise().state->stop.get_token();
+        handle.promise().state->executor->Post(handle);
+    }
+    bool await_resume() const noexcept { return !stop_.stop_requested(); }
+
+    std::stop_token stop_;
+};
+inline YieldAwaiter Yield() { return {}; }
+
+template <typename F>
+class BlockingAwaiter {
+public:
+    explicit BlockingAwaiter(F fn) : fn_(std::move(fn)) {}
+    bool await_ready() const noexcept { return false; }
+    template <typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        stop_ = handle.promise().state->stop.get_token();
+        handle.promise().state->executor->RunBlocking([this] { fn_(); }, handle);
+    }
+    bool await_resume() const noexcept { return !stop_.stop_requested(); }
+
+private:
+    F fn_;
+    std::stop_token stop_;
+};
+
+// co_await Blocking(fn): runs `fn` on a thread outside the workers and
+// resumes the task on its executor when `fn` returns, so a blocking call (a
+// model load, a wait on another process) holds no worker. `fn` is not
+// interrupted: a task asked to stop meanwhile still waits for it, then gets
+// false. The threads are kept for reuse for a few seconds after a call, so a
+// task may block this way once per packet; each call still costs a thread
+// handoff both ways.
+template <typename F>
+BlockingAwaiter<F> Blocking(F fn) { return BlockingAwaiter<F>(std::move(fn)); }
+
+/**
+ * @brief Auto-reset event for tasks, set from any thread.
+ *
+ * Set() wakes one waiting task, or is remembered until the next Wait() if
+ * none is waiting; several Set() calls before that collapse into one, like
+ * WakeSignal::Notify().
+ */
+class Event {
+public:
+    explicit Event(Executor& executor = Tasks()) : executor_(executor) {}
+
+    void Set();
+
+    class Awaiter final : public detail::Suspension {
+    public:
+        Awaiter(Event& event, std::optional<detail::TaskClock::time_point> deadline)
+            : Suspension(&event.executor_, deadline, &event.waiters_, false), event_(event) {}
+
+    private:
+        bool TakeLocked(bool& result) override {
+            if (!event_.set_) return false;
+            event_.set_ = false;
+            result = true;
+            return true;
+        }
+        Event& event_;
+    };
+
+    // co_await Wait(deadline): true when set, false at the deadline or once
+    // the task is asked to stop. No deadline waits for Set() only.
+    Awaiter Wait(std::optional<detail::TaskClock::time_point> deadline = std::nullopt) { return Awaiter(*this, deadline); }
+
+private:
+    Executor& executor_;
+    bool set_{false};                       // under the executor lock
+    std::vector<detail::Waiter*> waiters_;  // under the executor lock
+};
+
+/**
+ * @brief Bounded queue from any thread into tasks.
+ *
+ * Send() never blocks: it hands the value straight to a waiting receiver, or
+ * queues it, or fails when `capacity` values are already queued or the
+ * channel is closed. Receivers get values in send order.
+ */
+template <typename T>
+class Channel {
+public:
+    explicit Channel(size_t capacity, Executor& executor = Tasks()) : executor_(executor), capacity_(capacity) {}
+
+    bool Send(T value) {
+        std::lock_guard lock(executor_.mutex_);
+        if (closed_) return false;
+        if (!receivers_.empty()) {
+            detail::Waiter* receiver = receivers_.front();
+            *static_cast<std::optional<T>*>(receiver->slot) = std::move(value);
+            executor_.ResolveLocked(*receiver, true);
+            return true;
+        }
+        if (queue_.size() >= capacity_) return false;
+        queue_.push_back(std::move(value));
+        return true;
+    }
+
+    // Receivers drain what is queued, then get nullopt.
+    void Close() {
+        std::lock_guard lock(executor_.mutex_);
+        closed_ = true;
+        while (!receivers_.empty()) executor_.ResolveLocked(*receivers_.front(), false);
+    }
+
+    class Awaiter final : public detail::Suspension {
+    public:
+        explicit Awaiter(Channel& channel) : Suspension(&channel.executor_, std::nullopt, &channel.receivers_, false), channel_(channel) {
+            waiter_.slot = &value_;
+        }
+        std::optional<T> await_resume() { return std::move(value_); }
+
+    private:
+        bool TakeLocked(bool& result) override {
+            if (!channel_.queue_.empty()) {
+                value_ = std::move(channel_.queue_.front());
+                channel_.queue_.pop_front();
+                result = true;
+                return true;
+            }
+            result = false;
+            return channel_.closed_;
+        }
+        Channel& channel_;
+        std::optional<T> value_;
+    };
+
+    // co_await Receive(): the next value; nullopt once closed and drained, or
+    // once the task is asked to stop.
+    Awaiter Receive() { return Awaiter(*this); }
+
+private:
+    Executor& executor_;
+    const size_t capacity_;
+    std::deque<T> queue_;                     // under the executor lock
+    std::vector<detail::Waiter*> receivers_;  // under the executor lock
+    bool closed_{false};                      // under the executor lock
+};
+
+}
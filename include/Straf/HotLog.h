@@ -0,0 +1,321 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <fmt/format.h>
+
+// Lowest level compiled in: 0 trace, 1 debug, 2 info, 3 warn, 4 error, 5 off.
+// Calls below it expand to nothing, arguments included. Release builds keep
+// info and above unless the build says otherwise.
+#ifndef STRAF_HOTLOG_MIN_LEVEL
+#ifdef NDEBUG
+#define STRAF_HOTLOG_MIN_LEVEL 2
+#else
+#define STRAF_HOTLOG_MIN_LEVEL 0
+#endif
+#endif
+
+/**
+ * @brief Logging for threads that must never wait: audio capture, decoding,
+ * detection.
+ *
+ * A call checks the runtime level (one relaxed load), then copies its
+ * arguments in binary form into the calling thread's own ring: scalars as
+ * bytes, strings as length plus bytes. No formatting and no allocation happen
+ * there, and no lock is taken. When the ring is full the record is dropped and
+ * counted. Only a record that finds its ring empty wakes the writer; while the
+ * writer is draining, later records need no signal. A writer thread drains all rings, formats each record with fmt and
+ * hands it to the sink with the caller's timestamp and thread id. Format
+ * strings are checked at compile time against the argument types.
+ *
+ * Arguments must be arithmetic, enums, `const void*` or strings (C strings,
+ * std::string, std::string_view); strings are cut at kMaxString bytes.
+ */
+namespace Straf::hotlog {
+
+enum class Level : uint8_t { Trace, Debug, Info, Warn, Error, Off };
+
+struct Message {
+    Level level;
+    const char* file;
+    int line;
+    std::chrono::system_clock::time_point time;
+    uint64_t threadId; // OS id of the logging thread
+    std::string_view text;
+};
+// Called on the writer thread only.
+using Sink = std::function<void(const Message&)>;
+
+struct Options {
+    size_t ringBytes{64 * 1024}; // per logging thread, rounded up to a power of two
+};
+
+struct Stats {
+    uint64_t written{0}; // records accepted into a ring
+    uint64_t dropped{0}; // ring full, or record larger than a ring
+    uint64_t threads{0}; // threads that have logged
+};
+
+// Starts the writer thread. Records logged before Start() wait in their rings.
+void Start(Sink sink, Options options = {});
+// Formats everything logged so far, then stops the writer thread.
+void Stop();
+
+void SetLevel(Level level);
+Level GetLevel();
+// "trace", "debug", "info", "warn"/"warning", "error", "off"; case-sensitive.
+bool ParseLevel(std::string_view name, Level& level);
+Stats GetStats();
+
+inline constexpr size_t kMaxString = 4096;
+
+namespace detail {
+
+inline std::atomic<uint8_t> g_level{static_cast<uint8_t>(Level::Info)};
+
+using RenderFn = void (*)(const char* format, const std::byte* payload, std::string& out);
+
+// Record layout in a ring: header, then the encoded arguments, padded to 8
+// bytes. A record with level Off is padding up to the end of the buffer.
+struct RecordHeader {
+    uint32_t size;
+    Level level;
+    uint32_t line;
+    const char* file;
+    const char* format;
+    RenderFn render;
+    int64_t timeNs; // system_clock since the epoch
+};
+
+// Single-producer/single-consumer byte ring owned by one logging thread.
+class Ring {
+public:
+    Ring(size_t capacity, uint64_t threadId);
+
+    // Producer. Space for `bytes` (a multiple of 8), or nullptr when full.
+    std::byte* Reserve(size_t bytes) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t offset = static_cast<size_t>(tail & mask_);
+        const size_t toEnd = capacity_ - offset;
+        const size_t needed = bytes + (toEnd < bytes ? toEnd : 0); // wrap instead of splitting
+        if (tail + needed - headCache_ > capacity_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail + needed - headCache_ > capacity_) {
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        reserved_ = tail + needed;
+        if (toEnd < bytes) {
+            // Padding is published together with the record by Commit()
+            const uint32_t pad = static_cast<uint32_t>(toEnd);
+            std::memcpy(data_.get() + offset, &pad, sizeof pad);
+            data_[offset + offsetof(RecordHeader, level)] = static_cast<std::byte>(Level::Off);
+            return data_.get();
+        }
+        return data_.get() + offset;
+    }
+
+    // Producer. Publishes the record filled in after Reserve(). Returns true
+    // when the ring was empty before it: the writer may be asleep and needs a
+    // wake. Pairs with the fence in the writer's sleep check.
+    bool Commit() {
+        const uint64_t before = tail_.load(std::memory_order_relaxed);
+        tail_.store(reserved_, std::memory_order_release);
+        written_.store(written_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return head_.load(std::memory_order_relaxed) == before;
+    }
+
+    // Consumer. Calls fn(header, payload) for every published record; returns the count.
+    template <typename Fn>
+    size_t Drain(Fn&& fn) {
+        const uint64_t tail = tail_.load(std::memory_order_acquire);
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        size_t records = 0;
+        while (head != tail) {
+            const std::byte* at = data_.get() + (head & mask_);
+            RecordHeader header;
+            std::memcpy(&header.size, at, sizeof header.size);
+            header.level = static_cast<Level>(at[offsetof(RecordHeader, level)]);
+            if (header.level != Level::Off) {
+                std::memcpy(&header, at, sizeof header);
+                fn(header, at + sizeof header);
+                ++records;
+            }
+            head += header.size;
+        }
+        head_.store(head, std::memory_order_release);
+        return records;
+    }
+
+    uint64_t ThreadId() const { return threadId_; }
+    uint64_t Written() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    bool Closed() const { return closed_.load(std::memory_order_acquire); }
+    void Close() { closed_.store(true, std::memory_order_release); }
+    bool Empty() const { return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire); }
+
+private:
+    const size_t capacity_;
+    const uint64_t mask_;
+    const uint64_t threadId_;
+    std::unique_ptr<std::byte[]> data_;
+
+    alignas(64) std::atomic<uint64_t> tail_{0};    // producer
+    uint64_t headCache_{0};                        // producer's last look at head_
+    uint64_t reserved_{0};                         // producer: tail after the reserved record
+    std::atomic<uint64_t> written_{0};             // producer writes, anyone reads
+    std::atomic<uint64_t> dropped_{0};
+    alignas(64) std::atomic<uint64_t> head_{0};    // consumer
+    std::atomic<bool> closed_{false};              // owning thread has exited
+};
+
+inline thread_local Ring* t_ring = nullptr;
+// Registers the calling thread's ring; nullptr while the thread is exiting.
+Ring* AttachThisThread();
+// Wakes the writer thread after a record landed in an empty ring.
+void NotifyWriter();
+
+inline Ring* LocalRing() {
+    Ring* ring = t_ring;
+    return ring ? ring : AttachThisThread();
+}
+
+template <typename T>
+inline constexpr bool kIsString = std::is_same_v<T, const char*> || std::is_same_v<T, char*> ||
+                                  std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+// Binary encoding of one argument type and the type it is formatted as.
+template <typename T, typename = void>
+struct Codec {
+    static_assert(std::is_arithmetic_v<T> || std::is_same_v<T, const void*> || std::is_same_v<T, void*>,
+                  "hot-path log arguments must be arithmetic, enums, pointers to void or strings");
+    using Decoded = T;
+    static size_t Size(const T&) { return sizeof(T); }
+    static void Encode(std::byte*& out, const T& value) {
+        std::memcpy(out, &value, sizeof(T));
+        out += sizeof(T);
+    }
+    static Decoded Decode(const std::byte*& in) {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+template <typename T>
+struct Codec<T, std::enable_if_t<std::is_enum_v<T>>> : Codec<std::underlying_type_t<T>> {
+    using Base = Codec<std::underlying_type_t<T>>;
+    static size_t Size(const T&) { return sizeof(T); }
+    static void Encode(std::byte*& out, const T& value) { Base::Encode(out, static_cast<std::underlying_type_t<T>>(value)); }
+};
+
+template <typename T>
+struct Codec<T, std::enable_if_t<kIsString<T>>> {
+    using Decoded = std::string_view;
+    static std::string_view View(const T& value) {
+        if constexpr (std::is_pointer_v<T>) return value ? std::string_view(value) : std::string_view("(null)");
+        else return std::string_view(value);
+    }
+    static size_t Size(const T& value) { return sizeof(uint32_t) + std::min(View(value).size(), kMaxString); }
+    static void Encode(std::byte*& out, const T& value) {
+        const std::string_view s = View(value);
+        const uint32_t length = static_cast<uint32_t>(std::min(s.size(), kMaxString));
+        std::memcpy(out, &length, sizeof length);
+        std::memcpy(out + sizeof length, s.data(), length);
+        out += sizeof length + length;
+    }
+    static Decoded Decode(const std::byte*& in) {
+        uint32_t length;
+        std::memcpy(&length, in, sizeof length);
+        const std::string_view s(reinterpret_cast<const char*>(in + sizeof length), length);
+        in += sizeof length + length;
+        return s;
+    }
+};
+
+// Encoded type of an argument; `const` first so string literals become const char*.
+template <typename T>
+using StoredOf = std::decay_t<const T>;
+template <typename T>
+using DecodedOf = typename Codec<StoredOf<T>>::Decoded;
+
+// Writer thread: decodes in argument order (braced initialization) and formats.
+template <typename... Args>
+void Render(const char* format, const std::byte* payload, std::string& out) {
+    const std::byte* in = payload;
+    const std::tuple<typename Codec<Args>::Decoded...> values{Codec<Args>::Decode(in)...};
+    std::apply([&](const auto&... v) { fmt::format_to(std::back_inserter(out), fmt::runtime(format), v...); }, values);
+}
+
+} // namespace detail
+
+inline bool Enabled(Level level) {
+    return static_cast<uint8_t>(level) >= detail::g_level.load(std::memory_order_relaxed);
+}
+
+// Use the STRAF_HOT_* macros, which also strip levels below STRAF_HOTLOG_MIN_LEVEL.
+template <typename... Args>
+void Write(Level level, const char* file, int line, fmt::format_string<detail::DecodedOf<Args>...> format,
+           const Args&... args) {
+    using namespace detail;
+    Ring* ring = LocalRing();
+    if (!ring) return;
+    const size_t payload = (size_t{0} + ... + Codec<StoredOf<Args>>::Size(args));
+    const size_t bytes = (sizeof(RecordHeader) + payload + 7) & ~size_t{7};
+    std::byte* out = ring->Reserve(bytes);
+    if (!out) return;
+    const RecordHeader header{
+        static_cast<uint32_t>(bytes), level, static_cast<uint32_t>(line), file, static_cast<fmt::string_view>(format).data(),
+        &Render<StoredOf<Args>...>,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count()};
+    std::memcpy(out, &header, sizeof header);
+    std::byte* cursor = out + sizeof header;
+    (Codec<StoredOf<Args>>::Encode(cursor, args), ...);
+    if (ring->Commit()) NotifyWriter();
+}
+
+} // namespace Straf::hotlog
+
+#define STRAF_HOTLOG_AT(level, ...) \
+    do { \
+        if (::Straf::hotlog::Enabled(level)) ::Straf::hotlog::Write(level, __FILE__, __LINE__, __VA_ARGS__); \
+    } while (0)
+
+#if STRAF_HOTLOG_MIN_LEVEL <= 0
+#define STRAF_HOT_TRACE(...) STRAF_HOTLOG_AT(::Straf::hotlog::Level::Trace, __VA_ARGS__)
+#else
+#define STRAF_HOT_TRACE(...) (void)0
+#endif
+#if STRAF_HOTLOG_MIN_LEVEL <= 1
+#define STRAF_HOT_DEBUG(...) STRAF_HOTLOG_AT(::Straf::hotlog::Level::Debug, __VA_ARGS__)
+#else
+#define STRAF_HOT_DEBUG(...) (void)0
+#endif
+#if STRAF_HOTLOG_MIN_LEVEL <= 2
+#define STRAF_HOT_INFO(...) STRAF_HOTLOG_AT(::Straf::hotlog::Level::Info, __VA_ARGS__)
+#else
+#define STRAF_HOT_INFO(...) (void)0
+#endif
+#if STRAF_HOTLOG_MIN_LEVEL <= 3
+#define STRAF_HOT_WARN(...) STRAF_HOTLOG_AT(::Straf::hotlog::Level::Warn, __VA_ARGS__)
+#else
+#define STRAF_HOT_WARN(...) (void)0
+#endif
+#if STRAF_HOTLOG_MIN_LEVEL <= 4
+#define STRAF_HOT_ERROR(...) STRAF_HOTLOG_AT(::Straf::hotlog::Level::Error, __VA_ARGS__)
+#else
+#define STRAF_HOT_ERROR(...) (void)0
+#endif
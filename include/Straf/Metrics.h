@@ -0,0 +1,200 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Process-wide metrics: counters, gauges and log-linear (HDR-style)
+ * histograms, rendered in the Prometheus text exposition format.
+ *
+ * Recording is one or two relaxed atomic adds on the metric itself; no lock,
+ * no allocation, no lookup by name. Call sites register their metric once
+ * (get-or-create by name) and keep the reference. Rendering reads the same
+ * atomics, so a scrape never stalls a recording thread; the registry mutex
+ * only guards registration and the list walk.
+ *
+ * Values already kept elsewhere (penalty queue counters, process memory) are
+ * read at scrape time by collectors instead of being counted twice.
+ */
+namespace Straf::metrics {
+
+class Counter {
+public:
+    void Inc(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void Set(double v) { value_.store(v, std::memory_order_relaxed); }
+    double Value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+// Counters keyed by a small dense id (e.g. WordId), labelled at scrape time.
+// Storage for a range of ids is allocated the first time one of them is
+// counted; after that Inc() is a single relaxed add.
+class CounterFamily {
+public:
+    static constexpr size_t kChunkSize = 1024;
+    static constexpr size_t kMaxChunks = 64; // ids >= 65536 are not counted
+
+    using LabelFn = std::function<std::string(uint32_t id)>;
+    explicit CounterFamily(LabelFn label) : label_(std::move(label)) {}
+    ~CounterFamily();
+
+    void Inc(uint32_t id, uint64_t n = 1);
+    // Calls fn(label, value) for every id counted so far.
+    void ForEach(const std::function<void(const std::string&, uint64_t)>& fn) const;
+
+private:
+    struct Chunk {
+        std::atomic<uint64_t> values[kChunkSize]{};
+    };
+    LabelFn label_;
+    std::atomic<Chunk*> chunks_[kMaxChunks]{};
+};
+
+struct HistogramOptions {
+    double lowest{1e-6};  // smallest value told apart from zero, in exported units
+    double highest{60.0}; // larger values only land in +Inf
+};
+
+// Log-linear buckets: each power of two above `lowest` is split into four,
+// so a bucket spans at most 25% of its lower bound. Observe() maps the value
+// to its bucket with one bit scan and adds to it.
+class Histogram {
+public:
+    explicit Histogram(HistogramOptions options);
+
+    void Observe(double value);
+    void Observe(std::chrono::nanoseconds d) { Observe(std::chrono::duration<double>(d).count()); }
+
+    struct Snapshot {
+        std::vector<double> bounds;   // bucket upper bounds
+        std::vector<uint64_t> counts; // per bucket; one more for values above the last bound
+        uint64_t count{0};
+        double sum{0.0};
+        // Upper bound of the bucket holding the q-th value; 0 when empty.
+        double Quantile(double q) const;
+    };
+    Snapshot Read() const;
+
+private:
+    static constexpr int kSubBits = 2;
+
+    static size_t Index(uint64_t units);
+    double UpperBound(size_t index) const;
+
+    double unit_;  // value of one internal step, lowest / 4
+    double scale_; // 1 / unit_
+    std::vector<std::atomic<uint64_t>> buckets_; // last entry: above highest
+    std::atomic<double> sum_{0.0};
+};
+
+// Exposition writer handed to collectors.
+class Writer {
+public:
+    void WriteCounter(std::string_view name, std::string_view help, double value);
+    void WriteGauge(std::string_view name, std::string_view help, double value);
+    // For labelled families: one Header(), then a Sample() per series.
+    // `labels` is the text between the braces, already escaped.
+    void Header(std::string_view name, std::string_view help, const char* type);
+    void Sample(std::string_view name, std::string_view labels, double value);
+    const std::string& Text() const { return out_; }
+
+private:
+    std::string out_;
+};
+
+class Registry {
+public:
+    using Collector = std::function<void(Writer&)>;
+
+    Registry();
+    ~Registry();
+
+    // Get-or-create by name. Returned references stay valid for the
+    // registry's lifetime. A name already registered with another type is
+    // rejected: the error is logged and the caller gets a metric that is
+    // never exported.
+    Counter& AddCounter(const std::string& name, const std::string& help);
+    Gauge& AddGauge(const std::string& name, const std::string& help);
+    CounterFamily& AddCounterFamily(const std::string& name, const std::string& help, const std::string& labelName,
+                                    CounterFamily::LabelFn label);
+    Histogram& AddHistogram(const std::string& name, const std::string& help, HistogramOptions options);
+
+    // Collectors run on the scraping thread, after the registered metrics.
+    // RemoveCollector() returns once no scrape is running it.
+    size_t AddCollector(Collector collector);
+    void RemoveCollector(size_t id);
+
+    // The whole registry in Prometheus text format (version 0.0.4).
+    std::string Render() const;
+
+private:
+    struct Entry;
+    Entry& FindOrAdd(const std::string& name, const std::string& help, int kind);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::vector<std::unique_ptr<Entry>> rejected_; // kind mismatches, kept alive but not rendered
+    std::vector<std::pair<size_t, Collector>> collectors_;
+    size_t nextCollector_{1};
+};
+
+// Process-wide registry.
+Registry& Metrics();
+
+namespace detail {
+inline thread_local std::chrono::steady_clock::time_point t_audioArrival{};
+}
+
+// Arrival time of the audio packet the calling thread is decoding. Opened by
+// recognizers around each packet; detections made while it is open report
+// their latency from that arrival.
+class AudioScope {
+public:
+    explicit AudioScope(std::chrono::steady_clock::time_point arrived) : previous_(detail::t_audioArrival) {
+        detail::t_audioArrival = arrived;
+    }
+    ~AudioScope() { detail::t_audioArrival = previous_; }
+    AudioScope(const AudioScope&) = delete;
+    AudioScope& operator=(const AudioScope&) = delete;
+
+private:
+    std::chrono::steady_clock::time_point previous_;
+};
+
+// Epoch (zero) time_point when no AudioScope is open.
+inline std::chrono::steady_clock::time_point CurrentAudioArrival() { return detail::t_audioArrival; }
+
+// Serves Registry::Render() over HTTP on 127.0.0.1 (any path; Prometheus
+// scrapes /metrics). One request at a time on a thread of its own.
+class MetricsServer {
+public:
+    virtual ~MetricsServer() = default;
+    virtual uint16_t Port() const = 0;
+    virtual uint64_t Scrapes() const = 0;
+};
+
+// Port 0 picks a free one. Returns nullptr if the port cannot be bound.
+std::unique_ptr<MetricsServer> StartMetricsServer(uint16_t port, Registry& registry = Metrics());
+
+// Registers the process_resident_memory_bytes / process_virtual_memory_bytes
+// collector on `registry`; safe to call more than once.
+void AddProcessCollector(Registry& registry = Metrics());
+
+} // namespace Straf::metrics
@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Straf {
+
+/**
+ * @brief Bounded lock-free multi-producer/single-consumer ring.
+ *
+ * Each cell carries a sequence number (Vyukov's bounded queue): producers claim
+ * a slot with one CAS on the tail, publish with a release store of the cell
+ * sequence, and never wait on each other or on the consumer. The consumer owns
+ * the head exclusively. TryPush fails instead of blocking when the ring is full.
+ */
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscQueue() : cells_(std::make_unique<Cell[]>(Capacity)) {
+        for (size_t i = 0; i < Capacity; ++i) cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Safe to call concurrently from any number of threads.
+    template <typename U>
+    bool TryPush(U&& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & kMask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::forward<U>(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only.
+    bool TryPop(T& out) {
+        Cell& cell = cells_[head_ & kMask];
+        const size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(head_ + 1) < 0) return false; // empty
+        out = std::move(cell.value);
+        cell.sequence.store(head_ + Capacity, std::memory_order_release);
+        ++head_;
+        return true;
+    }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) size_t head_{0};
+};
+
+}
@@ -1,28 +1,48 @@
 #pragma once
-#include <string>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include "Straf/WordTable.h"
 
 namespace Straf {
 
+struct OverlayFrameStats {
+    uint64_t frames{0};      // frames drawn and presented
+    uint64_t wakeups{0};     // render thread wakeups, any cause
+    uint64_t updates{0};     // scene changes; several may share one frame
+    std::chrono::nanoseconds drawTime{0};     // CPU time recording and flushing layer draws, presents excluded
+    std::chrono::nanoseconds maxDrawTime{0};  // slowest single frame
+};
+
+// Calls come from the penalty manager thread; implementations resolve words
+// with Words().Name()/WideName() when they draw.
 class IOverlayRenderer {
 public:
     virtual ~IOverlayRenderer() = default;
     virtual bool Initialize() = 0;
-    virtual void ShowPenalty(const std::string& label) = 0;
-    // Update the overlay status (e.g., number of stars and label). Stars clamped to [0,5].
-    virtual void UpdateStatus(int stars, const std::string& label) = 0;
+    virtual void ShowPenalty(WordId word) = 0;
+    // Update the overlay status (e.g., number of stars and word). Stars clamped to [0,5].
+    virtual void UpdateStatus(int stars, WordId word) = 0;
     virtual void Hide() = 0;
+    // Render activity so far; overlays without a render thread report zeros.
+    virtual OverlayFrameStats GetFrameStats() const { return {}; }
 };
 
-// Factory functions for pluggable overlays
+// Factory functions for pluggable overlays. The styles are layers on one
+// shared compositor (OverlayCompositor.h); each factory hosts a single layer.
 // Classic: existing GTA-like stars banner
 std::unique_ptr<IOverlayRenderer> CreateOverlayClassic();
 // Bar: alternative style (bottom bar with status)
 std::unique_ptr<IOverlayRenderer> CreateOverlayBar();
 // Vignette: elegant rounded vignette style
 std::unique_ptr<IOverlayRenderer> CreateOverlayVignette();
+// Headless: portable compositor on a device that only counts frames
+std::unique_ptr<IOverlayRenderer> CreateOverlayHeadless();
 // Default selection based on environment (STRAF_NO_OVERLAY, STRAF_OVERLAY_STYLE)
-// STRAF_OVERLAY_STYLE: "classic" (default), "bar", or "vignette"
+// STRAF_OVERLAY_STYLE: "classic" (default), "bar", "vignette", or "headless";
+// "+"-separated styles (e.g. "vignette+classic") stack on one device, first at the bottom.
+// The styles render in software when no GPU device can be created or
+// STRAF_OVERLAY_SOFTWARE is set (OverlaySoft.h).
 std::unique_ptr<IOverlayRenderer> CreateOverlayStub();
 
 }
@@ -0,0 +1,99 @@
+#pragma once
+// Portable: bookkeeping of the device resources overlay layers cache between frames.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Straf/WordTable.h"
+
+namespace Straf {
+
+// What a cached resource depends on. Fields a resource doesn't depend on keep
+// their defaults so one entry serves every frame.
+struct OverlayCacheKey {
+    std::string_view style;       // layer Name(); must have static storage
+    int stars{-1};                // star level, or -1
+    WordId label{kNoWord};        // word shown, or kNoWord
+    float width{0}, height{0};    // surface size in DIPs
+    uint32_t part{0};             // which resource of the layer
+
+    bool operator==(const OverlayCacheKey&) const = default;
+};
+
+/**
+ * @brief Device resources built once and reused by every frame.
+ *
+ * Maps OverlayCacheKey to a resource handle (a COM pointer on Windows).
+ * Entries live until the device is lost (the device clears the cache) or the
+ * layer's surface changes size (the style's entries are dropped on the first
+ * lookup with the new size). Render thread only.
+ */
+template <class Handle>
+class OverlayResourceCache {
+public:
+    static constexpr size_t kMaxEntries = 1024;
+
+    // The entry for `key`, or nullptr. Valid until the next Insert, Clear or Trim.
+    Handle* Find(const OverlayCacheKey& key) {
+        auto seen = std::find_if(sizes_.begin(), sizes_.end(), [&](const SeenSize& s){ return s.style == key.style; });
+        if (seen == sizes_.end()) {
+            sizes_.push_back({key.style, key.width, key.height});
+        } else if (seen->width != key.width || seen->height != key.height) {
+            // The surface was resized: everything this style built is stale
+            std::erase_if(entries_, [&](const auto& e){ return e.first.style == key.style; });
+            seen->width = key.width;
+            seen->height = key.height;
+        }
+        auto it = entries_.find(key);
+        return it == entries_.end() ? nullptr : std::addressof(it->second); // COM pointers overload operator&
+    }
+
+    // Stores what a Find() miss built.
+    void Insert(const OverlayCacheKey& key, Handle resource) {
+        ++misses_;
+        entries_.insert_or_assign(key, std::move(resource));
+    }
+
+    void Clear() {
+        entries_.clear();
+        sizes_.clear();
+    }
+
+    // Drops everything once more than kMaxEntries accumulated (many distinct
+    // words). Call between frames: it invalidates what Find() returned.
+    void Trim() {
+        if (entries_.size() > kMaxEntries) Clear();
+    }
+
+    size_t Size() const { return entries_.size(); }
+    uint64_t Misses() const { return misses_; }
+
+private:
+    struct KeyHash {
+        size_t operator()(const OverlayCacheKey& k) const {
+            size_t h = std::hash<std::string_view>{}(k.style);
+            auto mix = [&h](size_t v){ h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+            mix(static_cast<size_t>(k.stars));
+            mix(k.label);
+            mix(std::hash<float>{}(k.width));
+            mix(std::hash<float>{}(k.height));
+            mix(k.part);
+            return h;
+        }
+    };
+    struct SeenSize {
+        std::string_view style;
+        float width, height; // last size seen for the style
+    };
+
+    std::unordered_map<OverlayCacheKey, Handle, KeyHash> entries_;
+    std::vector<SeenSize> sizes_;
+    uint64_t misses_{0};
+};
+
+}
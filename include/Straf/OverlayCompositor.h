@@ -0,0 +1,174 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "Straf/Overlay.h"
+#include "Straf/OverlayRenderLoop.h"
+
+namespace Straf {
+
+// Screen-space rectangle in pixels.
+struct OverlayRect {
+    float left{0}, top{0}, right{0}, bottom{0};
+    float Width() const { return right - left; }
+    float Height() const { return bottom - top; }
+};
+
+// Drawing context a device hands to layers. Layers downcast it to the type
+// their device provides (D2DCanvas on Windows) and refuse anything else.
+class IOverlayCanvas {
+public:
+    virtual ~IOverlayCanvas() = default;
+};
+
+// One overlay style. Layers own only drawing resources; the window, device,
+// swap chains and render thread belong to the compositor.
+class IOverlayLayer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    virtual ~IOverlayLayer() = default;
+    virtual std::string_view Name() const = 0;
+    // Where the layer's surface sits on a screen of the given size. Asked once
+    // when the compositor starts.
+    virtual OverlayRect Placement(float screenWidth, float screenHeight) const = 0;
+    // Whether the layer shows anything for `scene`. Hidden layers are neither
+    // drawn nor composed.
+    virtual bool Visible(const OverlayScene& scene) const { return scene.visible; }
+    // Device-dependent resources (brushes, text formats). Render thread; called
+    // before the first Draw and again after every device reset.
+    virtual bool CreateResources(IOverlayCanvas& canvas) = 0;
+    virtual void ReleaseResources() = 0;
+    // Draws `scene` into the layer's cleared surface. Returns when the next
+    // frame is due if an animation is running, nullopt for a static frame.
+    virtual std::optional<clock::time_point> Draw(IOverlayCanvas& canvas, const OverlayScene& scene, clock::time_point now) = 0;
+};
+
+// Output side of the compositor: one window and one device with a surface per
+// layer. Initialize() runs on the owning thread, everything else on the
+// render thread.
+class ICompositorDevice {
+public:
+    virtual ~ICompositorDevice() = default;
+    virtual bool Initialize() = 0;
+    virtual OverlayRect Screen() const = 0;
+    // Creates the next surface (index = number of earlier calls). Later
+    // surfaces stack above earlier ones. Surfaces start hidden.
+    virtual bool AddSurface(OverlayRect placement) = 0;
+    // Shared drawing context; valid until Reset().
+    virtual IOverlayCanvas& Canvas() = 0;
+    // Targets `surface` and clears it to transparent.
+    virtual bool BeginDraw(size_t surface) = 0;
+    // Finishes drawing `surface`; Commit() presents it. False if the device
+    // was lost.
+    virtual bool EndDraw(size_t surface) = 0;
+    virtual void ShowSurface(size_t surface, bool shown) = 0;
+    // Presents the surfaces drawn this frame and applies surface changes.
+    virtual bool Commit() = 0;
+    // Shows or hides the whole output window.
+    virtual void SetVisible(bool visible) = 0;
+    // Recreates the device and every surface (hidden) after a loss.
+    virtual bool Reset() = 0;
+};
+
+/**
+ * @brief One device, one render thread, any number of overlay layers.
+ *
+ * Styles are IOverlayLayer plugins. The compositor gives each layer its own
+ * surface on a shared ICompositorDevice and drives them all from a single
+ * OverlayRenderLoop, so stacking styles costs a swap chain rather than a
+ * device and a thread. A frame redraws only the layers whose scene changed
+ * or whose animation is due; the rest keep their presented content. Layer
+ * resources are created lazily on the render thread and rebuilt after a
+ * device loss; the window is shown while any layer is visible.
+ */
+class OverlayCompositor : public IOverlayRenderer, private IOverlayBackend {
+public:
+    explicit OverlayCompositor(std::unique_ptr<ICompositorDevice> device);
+    ~OverlayCompositor() override;
+
+    // Before Initialize(). The first layer added is drawn at the bottom.
+    void AddLayer(std::unique_ptr<IOverlayLayer> layer);
+    size_t LayerCount() const { return layers_.size(); }
+
+    bool Initialize() override;
+    void ShowPenalty(WordId word) override { loop_.ShowPenalty(word); }
+    void UpdateStatus(int stars, WordId word) override { loop_.UpdateStatus(stars, word); }
+    void Hide() override { loop_.SetVisible(false); }
+    OverlayFrameStats GetFrameStats() const override;
+
+private:
+    struct Slot {
+        std::unique_ptr<IOverlayLayer> layer;
+        bool ready{false}; // resources created on the current device
+        bool shown{false}; // surface composed
+        bool drawn{false}; // surface holds the frame for `version`
+        uint64_t version{0};
+        std::optional<clock::time_point> due; // layer's next animation frame
+    };
+
+    bool ShouldShow(const OverlayScene& scene) const override;
+    std::optional<clock::time_point> DrawFrame(const OverlayScene& scene, clock::time_point now) override;
+    void SetVisible(bool visible) override;
+    std::optional<clock::time_point> Recover(clock::time_point now);
+
+    std::unique_ptr<ICompositorDevice> device_;
+    std::vector<Slot> layers_; // render thread only once started
+    std::atomic<int64_t> drawNanos_{0};
+    std::atomic<int64_t> maxDrawNanos_{0};
+    OverlayRenderLoop loop_{*this};
+};
+
+/**
+ * @brief Portable compositor device without output.
+ *
+ * Surfaces are counters. Runs the compositor where there is no display and
+ * lets layer scheduling, visibility and device-loss recovery be exercised
+ * off Windows. Safe to inspect from any thread.
+ */
+class HeadlessCompositorDevice : public ICompositorDevice {
+public:
+    struct Surface {
+        OverlayRect placement;
+        uint64_t draws{0};
+        bool shown{false};
+    };
+
+    explicit HeadlessCompositorDevice(float width = 1920.0f, float height = 1080.0f) : screen_{0, 0, width, height} {}
+
+    bool Initialize() override { return true; }
+    OverlayRect Screen() const override { return screen_; }
+    bool AddSurface(OverlayRect placement) override;
+    IOverlayCanvas& Canvas() override { return canvas_; }
+    bool BeginDraw(size_t surface) override;
+    bool EndDraw(size_t surface) override;
+    void ShowSurface(size_t surface, bool shown) override;
+    bool Commit() override;
+    void SetVisible(bool visible) override;
+    bool Reset() override;
+
+    // The next EndDraw reports a lost device.
+    void LoseDevice();
+
+    std::vector<Surface> Surfaces() const;
+    bool Visible() const;
+    uint64_t Commits() const;
+    uint64_t Resets() const;
+
+private:
+    OverlayRect screen_;
+    IOverlayCanvas canvas_;
+    mutable std::mutex mutex_;
+    std::vector<Surface> surfaces_;
+    bool visible_{false};
+    bool lost_{false};
+    uint64_t commits_{0};
+    uint64_t resets_{0};
+};
+
+}
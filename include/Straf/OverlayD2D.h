@@ -0,0 +1,77 @@
+#pragma once
+// Windows-only: Direct2D/DirectWrite canvas and the built-in overlay layers.
+#include <windows.h>
+#include <d2d1_1.h>
+#include <d2d1_2.h>
+#include <d2d1helper.h>
+#include <dwrite.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include "Straf/OverlayCache.h"
+#include "Straf/OverlayCompositor.h"
+
+namespace Straf {
+
+using D2DCacheKey = OverlayCacheKey;
+
+/**
+ * @brief Direct2D resources of the overlay layers: geometry and its
+ * realizations, gradient brushes and text layouts.
+ *
+ * Pointers returned by Get() are borrowed for the current frame.
+ */
+class D2DResourceCache : public OverlayResourceCache<Microsoft::WRL::ComPtr<IUnknown>> {
+public:
+    // Returns the resource for `key`, creating it with `make(T**)` on a miss.
+    // nullptr if creation failed; failures are not cached.
+    template <class T, class Make>
+    T* Get(const D2DCacheKey& key, Make&& make) {
+        if (auto* hit = Find(key)) return static_cast<T*>(hit->Get());
+        Microsoft::WRL::ComPtr<T> made;
+        if (FAILED(make(made.GetAddressOf())) || !made) return nullptr;
+        T* raw = made.Get();
+        Insert(key, std::move(made));
+        return raw;
+    }
+};
+
+// Canvas of the DirectComposition device. Pointers stay valid until the
+// device is reset; the context is already targeting the layer's surface when
+// Draw() is called. GetSize() on the context is the surface size in DIPs.
+struct D2DCanvas : IOverlayCanvas {
+    ID2D1Factory1* factory{nullptr};
+    ID2D1DeviceContext* context{nullptr};
+    ID2D1DeviceContext1* context1{nullptr}; // geometry realizations; nullptr before Windows 8.1
+    IDWriteFactory* dwrite{nullptr};
+    D2DResourceCache* cache{nullptr};       // cleared with the device
+};
+
+// Five-point star of outer radius `r` centred on `center`. The outline is
+// built once per key at the origin and, where supported, realized for fill
+// and stroke; drawing only translates. Uses key.part, key.part + 1 and
+// key.part + 2.
+void DrawCachedStar(D2DCanvas& canvas, D2DCacheKey key, D2D1_POINT_2F center, float r, float innerRatio,
+                    float strokeWidth, ID2D1Brush* brush, bool filled);
+
+// Layout of "<prefix><separator><word>" for the word key.label, or of
+// `prefix` alone when the word has no text, in a `width` x `height` box. The
+// caption string is only built on a miss.
+IDWriteTextLayout* CachedCaption(D2DCanvas& canvas, const D2DCacheKey& key, std::wstring_view prefix,
+                                 std::wstring_view separator, IDWriteTextFormat* format, float width, float height);
+
+// One D3D11 device, DirectComposition tree and D2D context behind a single
+// full-screen, topmost, click-through window. Each surface is a composition
+// swap chain on its own visual.
+std::unique_ptr<ICompositorDevice> CreateD2DCompositorDevice();
+
+// Classic: GTA-like stars banner, top-left
+std::unique_ptr<IOverlayLayer> CreateClassicLayer();
+// Bar: progress bar with status near the bottom edge
+std::unique_ptr<IOverlayLayer> CreateBarLayer();
+// Vignette: full-screen darkening with a status indicator; visible while stars > 0
+std::unique_ptr<IOverlayLayer> CreateVignetteLayer();
+
+}
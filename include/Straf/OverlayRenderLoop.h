@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "Straf/Overlay.h"
+#include "Straf/TripleBuffer.h"
+#include "Straf/WakeSignal.h"
+
+namespace Straf {
+
+// Retained overlay state: everything a frame depends on. A frame is only
+// needed when this changes or a backend animation asks for one.
+struct OverlayScene {
+    bool visible{false};
+    int stars{0};            // clamped to [0,5]
+    WordId word{kNoWord};
+    uint64_t version{0};     // bumped by every change
+    uint64_t flow{0};        // trace flow of the latest edit (Trace.h), 0 if none
+};
+
+// Draws scenes for an OverlayRenderLoop. Called only on the render thread.
+class IOverlayBackend {
+public:
+    using clock = std::chrono::steady_clock;
+
+    virtual ~IOverlayBackend() = default;
+    // Whether `scene` puts anything on screen. Scenes that don't are not drawn.
+    virtual bool ShouldShow(const OverlayScene& scene) const { return scene.visible; }
+    // Draws and presents `scene`. Returns when the next frame is due if an
+    // animation is running, nullopt for a static frame.
+    virtual std::optional<clock::time_point> DrawFrame(const OverlayScene& scene, clock::time_point now) = 0;
+    // Shows or hides the output surface. Showing follows the first frame of
+    // the new scene, so no stale frame flashes up.
+    virtual void SetVisible(bool visible) = 0;
+};
+
+/**
+ * @brief Render thread that draws only when something changed.
+ *
+ * Writers edit the scene and wake the thread; it draws the latest scene once
+ * (changes made while a frame is in flight fold into the next one), then
+ * blocks on a WakeSignal with no deadline unless the backend requested an
+ * animation frame. A static or hidden overlay therefore costs no frames and
+ * no wakeups.
+ *
+ * Every edit publishes a whole versioned OverlayScene through a TripleBuffer,
+ * so the render thread picks up a consistent scene with one atomic exchange
+ * (never stars from one edit with the word of another) and learns from the
+ * same exchange whether anything changed. Scene edits are safe from any
+ * thread; concurrent writers serialize on a mutex of their own that the
+ * render thread never takes.
+ */
+class OverlayRenderLoop {
+public:
+    explicit OverlayRenderLoop(IOverlayBackend& backend) : backend_(backend) {}
+    ~OverlayRenderLoop() { Stop(); }
+
+    OverlayRenderLoop(const OverlayRenderLoop&) = delete;
+    OverlayRenderLoop& operator=(const OverlayRenderLoop&) = delete;
+
+    void Start();
+    void Stop();
+
+    // Makes the overlay visible with at least one star.
+    void ShowPenalty(WordId word);
+    // Sets the star count, and the word unless it is kNoWord.
+    void UpdateStatus(int stars, WordId word);
+    void SetVisible(bool visible);
+
+    // Latest scene written; takes the writers' lock.
+    OverlayScene Scene() const;
+    OverlayFrameStats Stats() const;
+
+private:
+    void PublishLocked();
+    void Run();
+
+    IOverlayBackend& backend_;
+    mutable std::mutex writeMutex_;           // writers only
+    OverlayScene latest_;                     // guarded by writeMutex_
+    TripleBuffer<OverlayScene> published_;    // writers -> render thread
+    std::atomic<uint64_t> version_{0};        // latest_.version, for Stats()
+
+    WakeSignal wake_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+    std::atomic<uint64_t> frames_{0};
+};
+
+}
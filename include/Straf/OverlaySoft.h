@@ -0,0 +1,70 @@
+#pragma once
+// Portable: software compositor device and the built-in layers drawn on the CPU.
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Straf/OverlayCompositor.h"
+#include "Straf/SoftRaster.h"
+
+namespace Straf {
+
+// Canvas of SoftCompositorDevice: the surface being drawn, sized to the
+// layer's placement. Null outside BeginDraw/EndDraw.
+struct SoftOverlayCanvas : IOverlayCanvas {
+    SoftCanvas* target{nullptr};
+};
+
+/**
+ * @brief Compositor device that renders every surface with SoftCanvas.
+ *
+ * Needs no GPU: each surface is a premultiplied BGRA buffer drawn by the
+ * software layers. Commit() hands the surfaces drawn this frame to Present(),
+ * which outputs them (the Windows fallback updates layered windows); the base
+ * class keeps them in memory only, for benchmarks and headless checks. The
+ * device cannot be lost. Render thread only, except Surface() once the
+ * compositor has stopped.
+ */
+class SoftCompositorDevice : public ICompositorDevice {
+public:
+    explicit SoftCompositorDevice(float width = 1920.0f, float height = 1080.0f) : screen_{0, 0, width, height} {}
+
+    bool Initialize() override { return true; }
+    OverlayRect Screen() const override { return screen_; }
+    bool AddSurface(OverlayRect placement) override;
+    IOverlayCanvas& Canvas() override { return canvas_; }
+    bool BeginDraw(size_t surface) override;
+    bool EndDraw(size_t surface) override;
+    void ShowSurface(size_t surface, bool shown) override;
+    bool Commit() override;
+    void SetVisible(bool visible) override { visible_ = visible; }
+    bool Reset() override;
+
+    const SoftCanvas& Surface(size_t surface) const { return surfaces_[surface].pixels; }
+    bool Shown(size_t surface) const { return surfaces_[surface].shown; }
+
+protected:
+    // Outputs a surface drawn since the last commit. False reports a lost output.
+    virtual bool Present(size_t surface, OverlayRect placement, const SoftCanvas& pixels);
+
+    OverlayRect screen_;
+    bool visible_{false};
+
+private:
+    struct SoftSurface {
+        OverlayRect placement;
+        SoftCanvas pixels;
+        bool shown{false};
+        bool dirty{false}; // drawn since the last commit
+    };
+
+    SoftOverlayCanvas canvas_;
+    std::vector<SoftSurface> surfaces_;
+};
+
+// Software counterparts of the Direct2D layers (same placement, geometry and
+// colours; bitmap-font text).
+std::unique_ptr<IOverlayLayer> CreateSoftClassicLayer();
+std::unique_ptr<IOverlayLayer> CreateSoftBarLayer();
+std::unique_ptr<IOverlayLayer> CreateSoftVignetteLayer();
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Straf {
+
+/**
+ * @brief Pattern vocabulary entries compiled together into one minimized DFA.
+ *
+ * Supported entry forms (matched against a whole lowercased token):
+ *  - Wildcards: `*` matches any run of characters, e.g. "fuck*", "*fucker", "f*ck".
+ *  - Bounded regex with a `re:` prefix: literals, `.`, `[a-z]` / `[^...]` classes,
+ *    `(...)`, `|`, `?`, `*`, `+` and `{m}` / `{m,n}` with n <= kMaxRepeat. Nested
+ *    repeats multiply, so a rule whose expansion would exceed kMaxRuleStates
+ *    automaton states (e.g. "re:((a{32}){32}){32}") is rejected. There is
+ *    no backtracking; every token is scanned once through the combined DFA, so
+ *    cost does not grow with the number of rules.
+ *
+ * Tokens hold letters, digits and UTF-8 bytes only, so a rule that can match
+ * nothing else - one containing a space or other punctuation, such as
+ * "bad *" - is rejected like a malformed one.
+ *
+ * When several rules accept a token, the one listed first wins, except that a
+ * rule which becomes certain mid-token (a stem with a trailing `*`) decides the
+ * match at that point and the scan stops early.
+ */
+class PatternSet {
+public:
+    static constexpr int kMaxRepeat = 32;
+    static constexpr size_t kMaxPatternLength = 256;
+    static constexpr size_t kMaxRuleStates = 4096;
+    static constexpr size_t kMaxDfaStates = 65536;
+
+    // True for entries that should be compiled here rather than matched literally.
+    static bool IsPattern(std::string_view entry);
+
+    // Compiles all valid patterns. Malformed patterns are skipped and described
+    // in `errors`. Returns false if the combined automaton exceeds kMaxDfaStates.
+    bool Compile(const std::vector<std::string>& patterns, std::vector<std::string>* errors = nullptr);
+
+    // Index of the rule that matches the whole token, or -1.
+    int Match(std::string_view token) const {
+        if (table_.empty()) return -1;
+        uint32_t state = start_;
+        for (char ch : token) {
+            state = table_[state * classCount_ + byteClass_[static_cast<uint8_t>(ch)]];
+            if (settled_[state]) break;
+        }
+        return accept_[state];
+    }
+
+    const std::string& Rule(size_t index) const { return rules_[index]; }
+    size_t RuleCount() const { return rules_.size(); }
+    size_t StateCount() const { return accept_.size(); }
+
+private:
+    std::vector<std::string> rules_;
+    uint8_t byteClass_[256]{};
+    uint32_t classCount_{0};
+    std::vector<uint32_t> table_;  // StateCount() x classCount_
+    std::vector<int32_t> accept_;  // rule index per state, -1 if not accepting
+    std::vector<uint8_t> settled_; // dead or decided: every transition loops back
+    uint32_t start_{0};
+};
+
+}
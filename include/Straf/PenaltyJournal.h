@@ -0,0 +1,162 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Straf/MpscQueue.h"
+#include "Straf/WakeSignal.h"
+#include "Straf/WordTable.h"
+
+namespace Straf {
+
+enum class JournalRecordType : uint16_t {
+    Snapshot = 1,  // first record of a snapshot file; sequence = last journal record it covers
+    Queued,        // label, durationMs
+    Started,       // label, durationMs, atMs = expiry
+    Ended,         // atMs = end of the following cooldown
+    Phrase,        // label, atMs = end of its cooldown
+    Debounce,      // atMs = end of the debounce window
+    LabelTail,     // the next kLabelBytes of the label of the record before it
+};
+
+// Fixed-size on-disk record. Times are wall-clock milliseconds since the Unix
+// epoch so they stay meaningful across restarts. The first kLabelBytes of the
+// label are stored inline; a longer label continues in LabelTail records
+// written right after it, so long phrases restore exactly.
+struct JournalRecord {
+    static constexpr size_t kLabelBytes = 32;
+    static constexpr size_t kMaxLabelBytes = UINT16_MAX;
+
+    uint32_t crc{0};        // CRC-32 of the remaining 60 bytes
+    JournalRecordType type{};
+    uint16_t labelLength{0}; // whole label, tails included
+    uint64_t sequence{0};
+    int64_t atMs{0};
+    int64_t durationMs{0};
+    char label[kLabelBytes]{};
+
+    std::string_view InlineLabel() const { return {label, labelLength < kLabelBytes ? labelLength : kLabelBytes}; }
+};
+static_assert(sizeof(JournalRecord) == 64, "journal records are fixed 64-byte entries");
+
+// Penalty state rebuilt from snapshot + journal tail, in steady_clock time of
+// the current process. Expired timers are already dropped.
+struct RecoveredPenaltyState {
+    struct Entry {
+        std::string label;
+        std::chrono::milliseconds duration{0};
+    };
+    std::vector<Entry> queue;                                         // oldest first
+    std::optional<Entry> current;
+    std::chrono::steady_clock::time_point currentEnd{};
+    std::optional<std::chrono::steady_clock::time_point> cooldownEnd;
+    std::optional<std::chrono::steady_clock::time_point> debounceEnd;
+    std::vector<std::pair<std::string, std::chrono::steady_clock::time_point>> phrases; // cooling phrases
+};
+
+struct JournalOptions {
+    size_t snapshotEvery{4096};                        // journal records between snapshots
+    std::chrono::milliseconds flushDelay{20};          // group-commit window before fsync
+};
+
+struct JournalStats {
+    uint64_t appended{0};       // accepted by Append()
+    uint64_t dropped{0};        // ring full or label over kMaxLabelBytes; never blocks the caller
+    uint64_t syncs{0};
+    uint64_t journalBytes{0};   // bytes written to the journal
+    uint64_t snapshotBytes{0};  // bytes written to snapshots
+    uint64_t snapshots{0};
+    uint64_t replayedRecords{0};
+    std::chrono::microseconds replayTime{0};
+};
+
+/**
+ * @brief Crash-safe append-only log of penalty state transitions.
+ *
+ * Append() copies a record into a lock-free ring and returns; a writer thread
+ * assigns sequence numbers and CRCs, writes batches, and issues one fsync per
+ * batch (group commit). The writer mirrors the state the records describe and,
+ * every snapshotEvery records, writes it to `penalty.snap` (temp file + fsync +
+ * atomic rename) and truncates the journal. Recovery loads the snapshot, then
+ * applies journal records newer than it, stopping at the first torn or
+ * corrupt record.
+ */
+class PenaltyJournal {
+public:
+    // Creates `directory`/penalty.journal and penalty.snap as needed and
+    // replays them. Returns nullptr if the journal cannot be opened for writing.
+    static std::unique_ptr<PenaltyJournal> Open(const std::string& directory, JournalOptions options = {});
+    ~PenaltyJournal();
+
+    PenaltyJournal(const PenaltyJournal&) = delete;
+    PenaltyJournal& operator=(const PenaltyJournal&) = delete;
+
+    const RecoveredPenaltyState& Recovered() const { return recovered_; }
+
+    // Lock-free and non-blocking; times are in the caller's steady_clock. The
+    // writer thread resolves `word` with Words().Name().
+    bool Append(JournalRecordType type, WordId word = kNoWord,
+                std::chrono::steady_clock::time_point at = {},
+                std::chrono::milliseconds duration = std::chrono::milliseconds{0});
+
+    // Blocks until everything appended so far is durable. For shutdown and tests.
+    void Flush();
+
+    JournalStats GetStats() const;
+
+private:
+    struct State;
+    class File;
+
+    // An Append() waiting for the writer thread.
+    struct Pending {
+        JournalRecordType type{};
+        WordId word{kNoWord};
+        int64_t atMs{0};
+        int64_t durationMs{0};
+    };
+
+    PenaltyJournal(const std::filesystem::path& directory, JournalOptions options);
+    bool Recover();
+    void Run();
+    bool WriteBatch(std::vector<Pending>& batch);
+    bool WriteSnapshot();
+    int64_t ToWallMs(std::chrono::steady_clock::time_point t) const;
+    std::chrono::steady_clock::time_point FromWallMs(int64_t ms) const;
+
+    std::filesystem::path journalPath_;
+    std::filesystem::path snapshotPath_;
+    JournalOptions options_;
+    std::chrono::nanoseconds wallOffset_{0}; // system_clock - steady_clock at Open()
+
+    RecoveredPenaltyState recovered_;
+    std::unique_ptr<State> mirror_;   // writer thread only
+    std::unique_ptr<File> journal_;   // writer thread only after Open()
+    std::vector<JournalRecord> encoded_; // writer thread only
+    uint64_t nextSequence_{1};
+    uint64_t sinceSnapshot_{0};
+
+    MpscQueue<Pending, 4096> ring_;
+    WakeSignal wake_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> flushRequested_{0}; // Flush() target, in appended records
+    std::atomic<uint64_t> flushed_{0};        // records durable on disk
+    std::thread writer_;
+
+    std::atomic<uint64_t> appended_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> syncs_{0};
+    std::atomic<uint64_t> journalBytes_{0};
+    std::atomic<uint64_t> snapshotBytes_{0};
+    std::atomic<uint64_t> snapshots_{0};
+    uint64_t replayedRecords_{0};
+    std::chrono::microseconds replayTime_{0};
+};
+
+}
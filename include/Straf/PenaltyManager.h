@@ -1,30 +1,112 @@
 #pragma once
-#include <queue>
-#include <string>
+#include <array>
 #include <optional>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <vector>
+#include "Straf/Clock.h"
+#include "Straf/Detector.h"
 
 namespace Straf {
 
 struct Penalty {
-    std::string label;
+    WordId word{kNoWord};
     std::chrono::milliseconds duration{10000};
     std::chrono::milliseconds cooldown{60000};
+    uint64_t flow{0}; // trace flow of the detection that queued it (Trace.h)
+};
+
+// Escalation and rate-limiting knobs. Defaults are the shipped policy.
+struct PenaltyPolicy {
+    std::chrono::milliseconds debounce{3000};        // minimum gap between any two penalties; 0 = off
+    std::chrono::milliseconds phraseCooldown{15000}; // before the same phrase can be penalized again; 0 = off
+    // Penalty duration indexed by the star count when it is queued; the last
+    // entry applies to all higher counts.
+    std::vector<std::chrono::milliseconds> progressiveDurations{
+        std::chrono::milliseconds{5000},   // 0 stars -> 5s
+        std::chrono::milliseconds{8000},   // 1 star -> 8s
+        std::chrono::milliseconds{12000},  // 2 stars -> 12s
+        std::chrono::milliseconds{18000},  // 3 stars -> 18s
+        std::chrono::milliseconds{25000}   // 4+ stars -> 25s
+    };
+};
+
+// A detection handed from a recognizer thread to the penalty manager.
+struct DetectionEvent {
+    WordId word{kNoWord};
+    DetectionSource source{DetectionSource::Microphone};
+    float confidence{1.0f};
+    std::chrono::steady_clock::time_point detectedAt{}; // when the detector fired
+    std::chrono::steady_clock::time_point enqueuedAt{}; // stamped by Submit()
+    uint64_t flow{0}; // trace flow of the utterance (Trace.h), 0 when not tracing
+};
+
+// Counters and enqueue-to-apply latency of the detection queue. Latencies are
+// measured on the manager thread when an event is applied.
+struct PenaltyQueueStats {
+    uint64_t submitted{0};
+    uint64_t dropped{0}; // queue full at Submit()
+    uint64_t applied{0};
+    std::chrono::nanoseconds lastQueueLatency{0};  // enqueuedAt -> applied
+    std::chrono::nanoseconds maxQueueLatency{0};
+    std::chrono::nanoseconds meanQueueLatency{0};
+    std::chrono::nanoseconds lastDetectLatency{0}; // detectedAt -> applied
+    uint64_t wakeups{0};      // manager thread wakeups, any cause
+    uint64_t timerWakeups{0}; // wakeups because a deadline was reached
+    std::array<uint64_t, 4> outcomes{}; // Trigger() results, indexed by WordOutcome
 };
 
 class IOverlayRenderer; // Forward declaration
+class PenaltyJournal;
+class WordStats;
 
 class IPenaltyManager {
 public:
+    static constexpr int kMaxQueueLimit = 64;
+
     virtual ~IPenaltyManager() = default;
+    // Safe from any thread, also after Start(): the settings are handed over as
+    // one snapshot and apply from the next transition on. Penalties already
+    // queued and timers already running keep the values they started with.
+    // `queueLimit` is clamped to [0, kMaxQueueLimit]; a larger value logs a warning.
     virtual void Configure(int queueLimit, std::chrono::milliseconds defaultDuration, std::chrono::milliseconds defaultCooldown) = 0;
-    virtual void Trigger(const std::string& reason) = 0;
-    virtual void Tick() = 0; // call frequently from main loop
-    // Returns current star count (active+queued, clamped 1..5 when any active/queued)
+    virtual void SetPolicy(const PenaltyPolicy& policy) = 0;
+    // Restores the state recovered by `journal` and records every later
+    // transition to it. Call after Configure() and before Start().
+    virtual void AttachJournal(std::unique_ptr<PenaltyJournal> journal) = 0;
+    // Counts the outcome of every Trigger() per word. Not owned; must outlive
+    // the manager. Call before Start().
+    virtual void AttachStats(WordStats* stats) = 0;
+    // Starts the manager thread, which drains submitted detections and drives Tick().
+    virtual void Start() = 0;
+    virtual void Stop() = 0;
+    // Lock-free; safe from any number of detector threads. Returns false if the queue is full.
+    virtual bool Submit(DetectionEvent event) = 0;
+    // Direct state transitions. Once Start() has been called only the manager
+    // thread may use these; without Start() the caller owns the manager.
+    virtual void Trigger(WordId word) = 0;
+    virtual void Tick() = 0;
+    // One pass of the manager thread: applies every submitted detection, then
+    // Tick(). Same threading rules as Tick(); lets a caller that owns the
+    // manager drive the Submit() path on a VirtualClock.
+    virtual void Pump() = 0;
+    // When Tick() next has work to do (penalty expiry, cooldown end, debounce or
+    // phrase cooldown expiry), or nullopt when idle. May be early, never late.
+    // Same threading rules as Tick().
+    virtual std::optional<std::chrono::steady_clock::time_point> NextDeadline() const = 0;
+    // Returns current star count (active+queued, clamped 1..5 when any active/queued). Thread-safe.
     virtual int GetStarCount() const = 0;
+    virtual PenaltyQueueStats GetQueueStats() const = 0;
 };
 
-std::unique_ptr<IPenaltyManager> CreatePenaltyManager(IOverlayRenderer* overlay);
+// `clock` defaults to SystemClock(). A VirtualClock is meant for driving
+// Trigger()/Tick() synchronously (see tools/PenaltySim.cpp), not with Start().
+std::unique_ptr<IPenaltyManager> CreatePenaltyManager(IOverlayRenderer* overlay, IClock* clock = nullptr);
+
+// Exposes `manager`'s GetQueueStats() through the process metrics registry,
+// read at scrape time. Returns the collector id; pass it to
+// metrics::Metrics().RemoveCollector() before the manager is destroyed.
+size_t AddPenaltyMetrics(const IPenaltyManager& manager);
 
 }
@@ -0,0 +1,102 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Straf {
+
+/**
+ * @brief Token-level Aho-Corasick automaton over vocabulary phrases.
+ *
+ * Each vocabulary entry is split on whitespace into tokens; single words are
+ * one-token phrases. The goto/failure functions are folded into a transition
+ * map per state at build time (root's transitions are shared rather than
+ * copied), so advancing the automaton by one token is a word lookup plus at
+ * most two transition lookups regardless of how many tokens have been seen. The automaton itself is immutable after Build() and
+ * all streaming state lives in a Cursor.
+ */
+class PhraseMatcher {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Streaming state carried across AnalyzeText calls.
+    class Cursor {
+    public:
+        void Reset() { state_ = 0; }
+
+    private:
+        friend class PhraseMatcher;
+        uint32_t state_{0};
+        uint64_t pos_{0};                         // tokens fed since construction
+        clock::time_point last_{};                // time of the previous token
+        std::vector<clock::time_point> recent_;   // ring of the last MaxDepth() token times
+    };
+
+    // Entries are lowercased; empty entries are ignored.
+    void Build(const std::vector<std::string>& phrases);
+
+    // Advances `cursor` by one lowercased token observed at `now`. Invokes
+    // onMatch(phraseIndex) for every phrase ending at this token whose first
+    // token is no older than `window`. State is reset first when the gap since
+    // the previous token exceeds `silenceReset`.
+    template <typename OnMatch>
+    void Feed(Cursor& cursor, std::string_view token, clock::time_point now, clock::duration window,
+              clock::duration silenceReset, OnMatch&& onMatch) const {
+        if (cursor.recent_.size() != maxDepth_) {
+            cursor.recent_.assign(maxDepth_, clock::time_point{});
+            cursor.state_ = 0;
+        }
+        if (maxDepth_ == 0) return;
+        if (cursor.pos_ > 0 && now - cursor.last_ > silenceReset) cursor.state_ = 0;
+        cursor.last_ = now;
+        cursor.recent_[cursor.pos_ % maxDepth_] = now;
+        ++cursor.pos_;
+
+        cursor.state_ = Next(cursor.state_, token);
+        for (int32_t out = states_[cursor.state_].output; out >= 0; out = outputs_[out].next) {
+            const uint32_t len = phrases_[outputs_[out].phrase].length;
+            const auto first = cursor.recent_[(cursor.pos_ - len) % maxDepth_];
+            if (now - first <= window) onMatch(outputs_[out].phrase);
+        }
+    }
+
+    const std::string& Phrase(size_t index) const { return phrases_[index].text; }
+    size_t PhraseLength(size_t index) const { return phrases_[index].length; }
+    size_t PhraseCount() const { return phrases_.size(); }
+    // Length in tokens of the longest phrase; bounds the history a Cursor keeps.
+    size_t MaxDepth() const { return maxDepth_; }
+
+private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+    using TokenMap = std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>>;
+
+    struct State {
+        std::unordered_map<uint32_t, uint32_t> next; // own and inherited transitions; the rest fall through to root's
+        int32_t output{-1};                          // head of this state's output chain
+    };
+    struct Output {
+        uint32_t phrase;
+        int32_t next; // next output on the dictionary-suffix chain, -1 at the end
+    };
+    struct PhraseEntry {
+        std::string text;
+        uint32_t length;
+    };
+
+    uint32_t Step(uint32_t state, uint32_t token) const;
+    uint32_t Next(uint32_t state, std::string_view token) const;
+
+    TokenMap tokens_;
+    std::vector<State> states_;
+    std::vector<Output> outputs_;
+    std::vector<PhraseEntry> phrases_;
+    size_t maxDepth_{0};
+};
+
+}
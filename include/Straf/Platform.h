@@ -0,0 +1,46 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace Straf {
+
+/**
+ * @brief Environment variables behind an interface, like IClock for time.
+ *
+ * Portable code reads settings through SystemEnvironment(); values are UTF-8
+ * on every platform (Windows reads the wide environment and converts).
+ */
+class IEnvironment {
+public:
+    virtual ~IEnvironment() = default;
+    // Value of `name`; nullopt when unset.
+    virtual std::optional<std::string> Get(const char* name) const = 0;
+    // Set to a non-empty value.
+    bool IsSet(const char* name) const {
+        const auto value = Get(name);
+        return value && !value->empty();
+    }
+};
+
+// Process environment.
+IEnvironment& SystemEnvironment();
+
+namespace platform {
+
+// OS thread id of the calling thread, as debuggers and profilers show it.
+uint64_t CurrentThreadId();
+uint64_t ProcessId();
+// Whether a process with this id is running (or the id is in use).
+bool ProcessAlive(uint64_t pid);
+// Names the calling thread for debuggers and profilers (Linux keeps 15 bytes).
+void SetCurrentThreadName(const char* name);
+// User plus kernel CPU time of all threads of the process so far.
+std::chrono::nanoseconds ProcessCpuTime();
+// Largest resident set (working set on Windows) the process has had; 0 if unknown.
+uint64_t PeakResidentBytes();
+
+} // namespace platform
+
+}
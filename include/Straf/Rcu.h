@@ -0,0 +1,145 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Straf {
+
+/**
+ * @brief Atomically replaceable pointer to an immutable value, with
+ * epoch-based deferred reclamation.
+ *
+ * A reader pins the current epoch in one of a fixed set of slots, loads the
+ * pointer and uses the value until its guard goes out of scope: a CAS on its
+ * slot, one load and one store, with no lock and no shared reference count.
+ * Publish() swaps in a new value and retires the old one under the epoch it
+ * closes; a retired value is freed once every pinned slot has moved past that
+ * epoch. Readers therefore see either the old or the new value, whole, and a
+ * value is never freed under them. Freeing happens on the writer side, in
+ * later Publish() and Collect() calls. Writers serialize on a mutex readers
+ * never take.
+ *
+ * More concurrent readers than slots spin until one frees up.
+ */
+template <typename T, size_t ReaderSlots = 16>
+class RcuCell {
+public:
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept
+            : slot_(std::exchange(other.slot_, nullptr)), value_(other.value_) {}
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard() {
+            if (slot_) slot_->store(kIdle, std::memory_order_release);
+        }
+
+        const T* get() const { return value_; }
+        const T* operator->() const { return value_; }
+        const T& operator*() const { return *value_; }
+        explicit operator bool() const { return value_ != nullptr; }
+
+    private:
+        friend class RcuCell;
+        ReadGuard(std::atomic<uint64_t>* slot, const T* value) : slot_(slot), value_(value) {}
+
+        std::atomic<uint64_t>* slot_;
+        const T* value_;
+    };
+
+    RcuCell() = default;
+    explicit RcuCell(std::unique_ptr<T> initial) : current_(initial.release()) {}
+    // No reader may still hold a guard.
+    ~RcuCell() {
+        delete current_.load(std::memory_order_relaxed);
+        for (const Retired& r : retired_) delete r.value;
+    }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    // Any thread. The value stays valid until the guard is destroyed; nullptr
+    // before the first Publish().
+    ReadGuard Read() const {
+        size_t i = std::hash<std::thread::id>{}(std::this_thread::get_id()) % ReaderSlots;
+        for (size_t probes = 1;; ++probes, i = (i + 1) % ReaderSlots) {
+            // Pin before loading the pointer. A pin older than the writer's
+            // epoch keeps the old value alive; a newer one proves this load
+            // comes after the swap (all seq_cst, see Collect()).
+            uint64_t idle = kIdle;
+            const uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+            if (slots_[i].pin.compare_exchange_strong(idle, epoch, std::memory_order_seq_cst)) {
+                return ReadGuard(&slots_[i].pin, current_.load(std::memory_order_seq_cst));
+            }
+            if (probes % ReaderSlots == 0) std::this_thread::yield();
+        }
+    }
+
+    // Any thread. Replaces the value; the previous one is freed once no reader
+    // can still see it.
+    void Publish(std::unique_ptr<T> next) {
+        std::lock_guard lock(writeMutex_);
+        T* old = current_.exchange(next.release(), std::memory_order_seq_cst);
+        const uint64_t closed = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+        if (old) retired_.push_back(Retired{old, closed});
+        CollectLocked();
+    }
+
+    // Frees retired values no reader can still see. Returns how many remain.
+    size_t Collect() {
+        std::lock_guard lock(writeMutex_);
+        return CollectLocked();
+    }
+
+private:
+    static constexpr uint64_t kIdle = 0;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> pin{kIdle}; // epoch the reader entered at, kIdle when free
+    };
+    struct Retired {
+        T* value;
+        uint64_t epoch; // first epoch whose readers cannot see it
+    };
+
+    // A reader pinned at `epoch` >= r.epoch read the epoch after Publish()
+    // bumped it, so its pointer load follows the swap and returns the new
+    // value. A slot seen idle whose reader pins a stale epoch later still
+    // loads the pointer after this scan, hence after the swap. Only pins
+    // older than r.epoch can hold r.value.
+    size_t CollectLocked() {
+        if (retired_.empty()) return 0;
+        uint64_t oldest = UINT64_MAX;
+        for (const Slot& s : slots_) {
+            const uint64_t pin = s.pin.load(std::memory_order_seq_cst);
+            if (pin != kIdle && pin < oldest) oldest = pin;
+        }
+        size_t kept = 0;
+        for (const Retired& r : retired_) {
+            if (r.epoch <= oldest) {
+                delete r.value;
+            } else {
+                retired_[kept++] = r;
+            }
+        }
+        retired_.resize(kept);
+        return kept;
+    }
+
+    std::atomic<T*> current_{nullptr};
+    std::atomic<uint64_t> epoch_{1};
+    mutable std::array<Slot, ReaderSlots> slots_{};
+
+    std::mutex writeMutex_;          // writers only
+    std::vector<Retired> retired_;   // guarded by writeMutex_
+};
+
+}
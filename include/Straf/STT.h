@@ -1,9 +1,11 @@
 #pragma once
+#include <chrono>
 #include <string>
 #include <vector>
 #include <functional>
 #include <memory>
 #include <spdlog/spdlog.h>
+#include "Straf/Audio.h"
 
 namespace Straf {
 
@@ -16,11 +18,30 @@ public:
     virtual bool Initialize(const std::vector<std::string>& vocabulary, const std::shared_ptr<spdlog::logger>& logger) = 0;
     virtual void Start(TokenCallback onToken) = 0;
     virtual void Stop() = 0;
+    // Optional: receive growing partial hypotheses of the current utterance. Set before Start().
+    virtual void SetPartialCallback(TokenCallback onPartial) { (void) onPartial; }
+    // Optional: recognize this source (e.g. CreateAudioFile) instead of the
+    // default microphone. Initialize(16000, 1) is called on Start(). Set before Start().
+    virtual void SetAudioSource(std::unique_ptr<IAudioSource> source) { (void) source; }
 };
 
+// One recognizer result, stamped with the audio position where it was produced.
+struct TranscriptEntry {
+    std::chrono::milliseconds at{0};
+    std::string text;
+    bool partial{false};
+};
+// Reads "<seconds> <text>" lines; a text starting with '~' is a partial
+// result. '#' starts a comment. Returns false if the file cannot be read.
+bool LoadTranscript(const std::string& path, std::vector<TranscriptEntry>& transcript);
+
 // Implementations
 std::unique_ptr<ITranscriber> CreateTranscriberStub();
 std::unique_ptr<ITranscriber> CreateTranscriberSapi();
 std::unique_ptr<ITranscriber> CreateTranscriberVosk();
+// Stands in for a speech model: replays `transcript` against its audio
+// source, emitting each entry once that much audio has been consumed, so
+// the rest of the pipeline runs with real timing and no model. Needs SetAudioSource().
+std::unique_ptr<ITranscriber> CreateTranscriberReplay(std::vector<TranscriptEntry> transcript);
 
 }
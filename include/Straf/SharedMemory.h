@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * @brief Named shared memory and cross-process wakeups for the rings other
+ * processes map (EventFeed.h, AudioRing.h).
+ *
+ * Regions are POSIX shared memory objects (shm_open) or pagefile-backed file
+ * mappings on Windows; handles are the fd or HANDLE in an intptr_t. A
+ * sleeper waits on a 32-bit word inside the region: a shared futex on Linux,
+ * a named auto-reset event on Windows, short naps elsewhere.
+ */
+namespace Straf::platform {
+
+#ifdef _WIN32
+inline constexpr intptr_t kNoSharedHandle = 0;
+#else
+inline constexpr intptr_t kNoSharedHandle = -1;
+#endif
+
+// Object name for a region or event called `name`: "/name" or "Local\name".
+std::string SharedObjectName(const std::string& name);
+
+// Creates region `name` of `bytes` (zero-filled when new), readable by the
+// user only. If the name is taken, `takeOver` is called with the existing
+// region mapped and its size; it returns false to leave it alone (creation
+// then fails) or true once it has marked the old region abandoned, and the
+// name is then replaced (on Windows the old region is reused while another
+// process still maps it, if large enough). kNoSharedHandle on failure.
+intptr_t CreateSharedMemory(const std::string& name, size_t bytes,
+                            const std::function<bool(void* old, size_t oldBytes)>& takeOver);
+intptr_t OpenSharedMemory(const std::string& name);
+void CloseSharedMemory(intptr_t handle);
+// Removes the name; processes that mapped the region keep it (POSIX only).
+void RemoveSharedMemory(const std::string& name);
+// Size of the region behind `handle`, 0 if unknown.
+size_t SharedMemoryBytes(intptr_t handle);
+void* MapSharedMemory(intptr_t handle, size_t bytes);
+void UnmapSharedMemory(void* view, size_t bytes);
+
+// Windows: the auto-reset event named `name` that stands in for a futex on
+// a word (created on first open). kNoSharedHandle elsewhere.
+intptr_t OpenSharedEvent(const std::string& name);
+void CloseSharedEvent(intptr_t event);
+
+// Sleeps until `word` moves off `seen`, `event` is set or `timeout` passes.
+void WaitOnWord(std::atomic<uint32_t>& word, uint32_t seen, std::chrono::milliseconds timeout, intptr_t event);
+// Bumps `word` and wakes one process sleeping on it.
+void WakeWord(std::atomic<uint32_t>& word, intptr_t event);
+
+} // namespace Straf::platform
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Straf {
+
+// Straight (not premultiplied) colour with components in [0,1], like D2D1::ColorF.
+struct SoftColor {
+    float r{0}, g{0}, b{0}, a{0};
+};
+
+struct SoftPoint {
+    float x{0}, y{0};
+};
+
+struct SoftGradientStop {
+    float position{0};  // [0,1] from the centre outwards
+    SoftColor color;
+};
+
+// Closed polygons for SoftCanvas::FillPath. Contours are implicitly closed.
+class SoftPath {
+public:
+    void MoveTo(SoftPoint p);
+    void LineTo(SoftPoint p);
+    void Clear() { points_.clear(); starts_.clear(); }
+    bool Empty() const { return points_.empty(); }
+
+    // Outline of every contour as `width`-wide quads, one per edge, with
+    // miter-less joins. Fill it (nonzero) to stroke this path.
+    SoftPath Stroke(float width) const;
+
+    // Five-point star of outer radius `r` around the origin, tip up.
+    static SoftPath Star(float r, float innerRatio);
+    // Rectangle with circular corners, clockwise.
+    static SoftPath RoundedRect(float left, float top, float right, float bottom, float radius);
+
+private:
+    friend class SoftCanvas;
+    std::vector<SoftPoint> points_;
+    std::vector<size_t> starts_; // first point of each contour
+};
+
+/**
+ * @brief CPU rasterizer for the overlay drawing primitives.
+ *
+ * Draws into a premultiplied BGRA8 buffer, the layout of a
+ * DXGI_FORMAT_B8G8R8A8_UNORM premultiplied surface and of a ULW_ALPHA DIB,
+ * with source-over blending. Paths are filled with the nonzero rule and
+ * antialiased with four sub-scanlines and exact horizontal coverage; fully
+ * covered spans, rectangles and gradient rows are blended four pixels at a
+ * time with SSE2 when the target has it. Text uses a built-in 8x8 bitmap
+ * font scaled by whole pixels (ASCII; other characters draw as '?').
+ * Scratch buffers are kept between calls, so steady frames do not allocate.
+ */
+class SoftCanvas {
+public:
+    SoftCanvas() = default;
+    SoftCanvas(int width, int height) { Resize(width, height); }
+
+    void Resize(int width, int height);
+    int Width() const { return width_; }
+    int Height() const { return height_; }
+    // Row-major pixels, Width() per row, 0xAARRGGBB (B in the lowest byte).
+    const uint32_t* Pixels() const { return pixels_.data(); }
+    uint32_t Pixel(int x, int y) const { return pixels_[static_cast<size_t>(y) * width_ + x]; }
+
+    void Clear(SoftColor color = {});
+    void FillRect(float left, float top, float right, float bottom, SoftColor color);
+    // Fills the whole canvas with a radial gradient around `center`; beyond
+    // `radius` the last stop's colour continues (clamp).
+    void FillRadialGradient(SoftPoint center, float radius, const SoftGradientStop* stops, size_t count);
+    void FillPath(const SoftPath& path, SoftColor color, SoftPoint offset = {});
+    // Draws UTF-8 `text` with its top-left corner at (x, y). Returns the advance.
+    float FillText(float x, float y, std::string_view text, float height, SoftColor color);
+    static float MeasureText(std::string_view text, float height);
+    // Height of the glyphs FillText() renders for `height`.
+    static float LineHeight(float height);
+
+    // FNV-1a of the pixels; identifies a rendered frame.
+    uint64_t Hash() const;
+
+private:
+    void BlendSpan(uint32_t* dst, int count, uint32_t src);
+    void BlendCoverageRow(int y, int x0, int x1, uint32_t src);
+
+    int width_{0};
+    int height_{0};
+    std::vector<uint32_t> pixels_;
+    // FillPath scratch
+    struct Edge {
+        float x0, y0, y1, dxdy;
+        int dir;  // +1 downwards, -1 upwards
+    };
+    std::vector<Edge> edges_;
+    std::vector<std::pair<float, int>> crossings_; // x and direction on one sub-scanline
+    std::vector<float> coverage_;                  // one row, 0..1 per pixel
+};
+
+}
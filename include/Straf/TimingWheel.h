@@ -0,0 +1,100 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace Straf {
+
+/**
+ * @brief Hierarchical timing wheel with O(1) schedule, cancel and expiry.
+ *
+ * Four levels of 64 slots cover 64^4 ticks (about 4.6 hours at the default
+ * 1 ms tick); later timers wait on an overflow list that is re-filed once per
+ * level-3 revolution. A timer sits in the level of the highest tick digit in
+ * which it differs from the current tick and is cascaded one level down each
+ * time the wheel reaches its slot, so every timer is moved at most four times
+ * no matter how many others are pending. Advancing skips empty spans using
+ * per-level occupancy masks, so a long idle gap costs nothing.
+ *
+ * Each timer carries a caller-defined 64-bit tag that is handed back on
+ * expiry. Not thread-safe; owned by one thread.
+ */
+class TimingWheel {
+public:
+    using clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+    static constexpr TimerId kNoTimer = 0;
+
+    explicit TimingWheel(clock::duration tick = std::chrono::milliseconds(1), clock::time_point origin = clock::now());
+
+    // Fires on the first Advance() at or after `when` (rounded up to a tick).
+    TimerId Schedule(clock::time_point when, uint64_t tag);
+    // Returns false if the timer already fired or was cancelled.
+    bool Cancel(TimerId id);
+    bool Pending(TimerId id) const;
+
+    // Expires every timer due at or before `now`, calling onExpire(tag) for
+    // each in deadline order. Callbacks may schedule and cancel timers.
+    template <typename OnExpire>
+    size_t Advance(clock::time_point now, OnExpire&& onExpire) {
+        const uint64_t target = FloorTick(now);
+        size_t fired = 0;
+        while (current_ < target && StepToward(target)) {
+            uint64_t tag;
+            while (PopDue(tag)) {
+                ++fired;
+                onExpire(tag);
+            }
+        }
+        return fired;
+    }
+
+    // Lower bound on the next expiry: exact for timers within the current
+    // 64-tick span, otherwise the start of the slot that must be cascaded next.
+    // Waiting until this time and calling Advance() never misses a timer.
+    std::optional<clock::time_point> NextExpiry() const;
+
+    size_t Size() const { return size_; }
+    bool Empty() const { return size_ == 0; }
+
+private:
+    static constexpr int kLevelBits = 6;
+    static constexpr int kLevels = 4;
+    static constexpr uint64_t kSlots = uint64_t{1} << kLevelBits;
+    static constexpr uint64_t kSlotMask = kSlots - 1;
+    static constexpr uint32_t kOverflow = kLevels * kSlots; // slot index of the overflow list
+    static constexpr uint32_t kFree = kOverflow + 1;        // slot index of unused nodes
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    struct Node {
+        uint64_t expires{0}; // tick
+        uint64_t tag{0};
+        uint32_t prev{kNil};
+        uint32_t next{kNil};
+        uint32_t generation{1};
+        uint32_t slot{kFree};
+    };
+
+    uint64_t FloorTick(clock::time_point t) const;
+    uint64_t CeilTick(clock::time_point t) const;
+    std::optional<uint64_t> NextTick() const;
+    bool StepToward(uint64_t target);
+    bool PopDue(uint64_t& tag);
+    void File(uint32_t index);
+    void Link(uint32_t index, uint32_t slot);
+    void Unlink(uint32_t index);
+    void Release(uint32_t index);
+    void Cascade(uint32_t slot);
+
+    clock::duration tick_;
+    clock::time_point origin_;
+    uint64_t current_{0}; // last tick processed
+    size_t size_{0};
+    std::vector<Node> nodes_;
+    uint32_t freeHead_{kNil};
+    uint32_t heads_[kOverflow + 1];
+    uint64_t occupied_[kLevels]{}; // non-empty slots per level
+};
+
+}
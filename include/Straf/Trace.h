@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/**
+ * @brief Pipeline tracing: scoped spans on every stage between the
+ * microphone and the overlay, exported as Chrome trace-event JSON (opens in
+ * Perfetto or chrome://tracing).
+ *
+ * Off by default. A disabled span costs one relaxed load. An enabled one
+ * reads the clock twice and writes one slot of the calling thread's own
+ * ring: no lock, no allocation after the ring exists, nothing shared with
+ * other threads. Each ring keeps the thread's latest `eventsPerThread`
+ * spans and overwrites the oldest, so WriteChromeJson() captures the last
+ * stretch of activity whenever it is called, while threads keep recording.
+ * A thread's ring passes to the next new thread once it exits, so its spans
+ * stay exportable until then.
+ *
+ * Flows tie the stages of one utterance together across threads. The
+ * recognizer opens a flow when it emits text and makes it the thread's
+ * current flow (FlowScope); code downstream carries CurrentFlow() along
+ * with the data it hands to other threads (DetectionEvent, Penalty,
+ * OverlayScene), and each stage attaches it to its span. The viewer draws
+ * arrows from the recognizer result to the detection, the penalty and the
+ * frames that show it.
+ */
+namespace Straf::trace {
+
+enum class FlowPhase : uint8_t { None, Begin, Step };
+
+struct Options {
+    size_t eventsPerThread{16384}; // ring size; rounded up to a power of two
+};
+
+struct Stats {
+    uint64_t recorded{0};    // spans written, including overwritten ones
+    uint64_t overwritten{0}; // spans lost to ring wrap-around
+    uint64_t threads{0};     // threads that have recorded
+    uint64_t rings{0};       // rings allocated; exited threads' rings are reused
+};
+
+// Starts recording on every thread. Options only apply to rings created afterwards.
+void Enable(Options options = {});
+// Stops recording; what was recorded stays available to WriteChromeJson().
+void Disable();
+Stats GetStats();
+
+// Names the calling thread in the exported trace.
+void SetThreadName(const char* name);
+
+// New flow id; 0 while tracing is disabled.
+uint64_t NewFlow();
+// The flow the calling thread is working on, 0 if none.
+uint64_t CurrentFlow();
+
+// Writes every thread's retained spans to `path` as a Chrome trace-event
+// JSON object. Safe while other threads record; spans being written at that
+// moment are left out. Returns false if the file cannot be written.
+bool WriteChromeJson(const std::filesystem::path& path);
+
+namespace detail {
+
+inline std::atomic<bool> g_enabled{false};
+inline thread_local uint64_t t_flow = 0;
+
+struct Event {
+    const char* category;
+    const char* name;
+    int64_t startNs;    // steady_clock since its epoch
+    int64_t durationNs;
+    uint64_t flow;
+    FlowPhase phase;
+};
+
+void Record(const Event& event);
+
+inline int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace detail
+
+inline bool Enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+
+// Makes `flow` the calling thread's current flow until the scope ends.
+class FlowScope {
+public:
+    explicit FlowScope(uint64_t flow) : previous_(detail::t_flow) { detail::t_flow = flow; }
+    ~FlowScope() { detail::t_flow = previous_; }
+    FlowScope(const FlowScope&) = delete;
+    FlowScope& operator=(const FlowScope&) = delete;
+
+private:
+    uint64_t previous_;
+};
+
+// Records [construction, destruction) on the calling thread. `category` and
+// `name` must be string literals (they are stored as pointers).
+class Span {
+public:
+    Span(const char* category, const char* name)
+        : category_(category), name_(name), startNs_(Enabled() ? detail::NowNs() : -1) {}
+    ~Span() {
+        if (startNs_ >= 0) detail::Record({category_, name_, startNs_, detail::NowNs() - startNs_, flow_, phase_});
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    // Attaches the span to `flow`; Begin starts the flow's arrow, Step
+    // continues it. No-op for flow 0.
+    void Flow(uint64_t flow, FlowPhase phase = FlowPhase::Step) {
+        if (flow == 0) return;
+        flow_ = flow;
+        phase_ = phase;
+    }
+
+private:
+    const char* category_;
+    const char* name_;
+    int64_t startNs_; // -1 when tracing was off at construction
+    uint64_t flow_{0};
+    FlowPhase phase_{FlowPhase::None};
+};
+
+} // namespace Straf::trace
+
+#define STRAF_TRACE_CONCAT_(a, b) a##b
+#define STRAF_TRACE_CONCAT(a, b) STRAF_TRACE_CONCAT_(a, b)
+// Anonymous span covering the rest of the enclosing scope.
+#define STRAF_TRACE_SCOPE(category, name) \
+    ::Straf::trace::Span STRAF_TRACE_CONCAT(strafTraceSpan_, __LINE__)(category, name)
@@ -1,12 +1,15 @@
 #pragma once
 #include <functional>
 #include <memory>
+#include <string>
 
 namespace Straf {
 class ITray {
 public:
     virtual ~ITray() = default;
     virtual void Run(std::function<void()> onExit) = 0;
+    // Adds a menu entry above "Exit"; `onClick` runs on the tray thread. Call before Run().
+    virtual void AddMenuItem(std::wstring label, std::function<void()> onClick) { (void) label; (void) onClick; }
 };
 std::unique_ptr<ITray> CreateTray();
 }
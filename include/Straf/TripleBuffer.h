@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Straf {
+
+/**
+ * @brief Wait-free single-writer/single-reader snapshot exchange.
+ *
+ * Three copies of T: the writer fills its back copy and publishes it by
+ * swapping it with the middle one; the reader adopts the middle copy by
+ * swapping it with its front one. Each side is a single atomic exchange, so
+ * neither ever waits for the other and the reader always sees a whole value
+ * written by one Publish(), never a mix of two. Intermediate values the reader
+ * did not pick up in time are skipped. Several writers must serialize among
+ * themselves.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& initial) { slots_.fill(initial); }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer: the copy to fill before Publish(). Holds stale data; overwrite it whole.
+    T& Back() { return slots_[back_]; }
+    void Publish() {
+        back_ = middle_.exchange(static_cast<uint8_t>(back_ | kFresh), std::memory_order_acq_rel) & kIndex;
+    }
+
+    // Reader: switches to the newest published value. False (and no change)
+    // if nothing was published since the last call.
+    bool Refresh() {
+        if (!(middle_.load(std::memory_order_relaxed) & kFresh)) return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndex;
+        return true;
+    }
+    // Reader: the value adopted by the last Refresh().
+    const T& Front() const { return slots_[front_]; }
+
+private:
+    static constexpr uint8_t kIndex = 0x3;
+    static constexpr uint8_t kFresh = 0x4; // middle holds a value the reader has not taken
+
+    std::array<T, 3> slots_{};
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t back_{0};   // writer only
+    alignas(64) uint8_t front_{2};  // reader only
+};
+
+}
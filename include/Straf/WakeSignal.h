@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <semaphore>
+
+namespace Straf {
+
+/**
+ * @brief Portable "sleep until the next deadline or until poked" primitive.
+ *
+ * A worker loop computes its next real deadline and calls WaitUntil(); other
+ * threads call Notify() when they hand it work. Repeated notifications before
+ * the worker wakes collapse into one release, and a loop with no deadline
+ * blocks indefinitely, so an idle loop costs no wakeups at all. Every return
+ * from WaitUntil() is counted, which makes idle wakeups measurable.
+ */
+class WakeSignal {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // Safe from any thread.
+    void Notify() {
+        if (!pending_.exchange(true, std::memory_order_acq_rel)) signal_.release();
+    }
+
+    // Single waiter. Blocks until Notify() or `deadline`; no deadline waits for
+    // Notify() only. Returns true when woken by Notify().
+    bool WaitUntil(std::optional<clock::time_point> deadline) {
+        bool notified = true;
+        if (deadline) {
+            notified = signal_.try_acquire_until(*deadline);
+        } else {
+            signal_.acquire();
+        }
+        // The flag is cleared only together with the release it stands for. A
+        // Notify() that raced with the timeout has set it and released, or is
+        // about to: take that release as well, or the next Notify() would
+        // release a semaphore that is already full.
+        if (pending_.exchange(false, std::memory_order_acq_rel) && !notified) {
+            signal_.acquire();
+            notified = true;
+        }
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+        if (!notified) timerWakeups_.fetch_add(1, std::memory_order_relaxed);
+        return notified;
+    }
+
+    uint64_t Wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+    uint64_t TimerWakeups() const { return timerWakeups_.load(std::memory_order_relaxed); }
+
+private:
+    std::binary_semaphore signal_{0};
+    std::atomic<bool> pending_{false};
+    std::atomic<uint64_t> wakeups_{0};
+    std::atomic<uint64_t> timerWakeups_{0};
+};
+
+}
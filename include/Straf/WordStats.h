@@ -0,0 +1,140 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Straf/WakeSignal.h"
+#include "Straf/WordTable.h"
+
+namespace Straf {
+
+// What happened to a detection once it reached the penalty manager.
+enum class WordOutcome : uint8_t {
+    Triggered,      // queued as a penalty
+    Debounced,      // inside the global debounce window
+    PhraseCooldown, // same word penalized too recently
+    QueueFull,      // queueLimit reached
+};
+inline constexpr size_t kWordOutcomeCount = 4;
+
+using WordOutcomeCounts = std::array<uint64_t, kWordOutcomeCount>;
+
+struct WordStatsOptions {
+    std::chrono::hours minuteRetention{48};      // minute buckets kept this long
+    std::chrono::hours hourRetention{24 * 90};   // hour buckets kept this long; day buckets forever
+    size_t compactEvery{1 << 16};                // appended records before the file is rewritten
+};
+
+struct WordStatsRow {
+    std::string word;
+    WordOutcomeCounts counts{};
+};
+
+struct WordStatsRange {
+    std::chrono::system_clock::time_point from{}; // snapped to `resolution`
+    std::chrono::system_clock::time_point to{};
+    std::chrono::minutes resolution{1};
+    WordOutcomeCounts totals{};
+    std::vector<WordStatsRow> top; // highest count of the ranked outcome first
+
+    // Average rate of `count` over the range.
+    double PerHour(uint64_t count) const {
+        const double hours = std::chrono::duration<double, std::ratio<3600>>(to - from).count();
+        return hours > 0 ? static_cast<double>(count) / hours : 0.0;
+    }
+};
+
+/**
+ * @brief Per-word outcome counters rolled up into minute/hour/day buckets.
+ *
+ * Record() is lock-free: each thread bumps relaxed atomics in its own shard,
+ * in blocks indexed by WordId that are allocated once on first use. A
+ * background thread wakes at the end of each minute that saw activity (never
+ * while idle), sums the shards, and folds the deltas into minute, hour and
+ * day buckets keyed by word text. Each roll appends compact fixed-size records
+ * to `word-stats.bin`; the file is rewritten with coarser buckets replacing
+ * expired minutes whenever it grows by compactEvery records.
+ */
+class WordStats {
+public:
+    // Loads `directory`/word-stats.bin if present. Returns nullptr if the file
+    // cannot be written.
+    static std::unique_ptr<WordStats> Open(const std::string& directory, WordStatsOptions options = {});
+    ~WordStats();
+
+    WordStats(const WordStats&) = delete;
+    WordStats& operator=(const WordStats&) = delete;
+
+    // Lock-free; any thread. Allocates only the first time a block of word ids is seen.
+    void Record(WordId word, WordOutcome outcome) {
+        if (word >= WordTable::kCapacity) return;
+        const size_t shard = ShardIndex();
+        Block* block = shards_[shard].blocks[word / kBlockWords].load(std::memory_order_acquire);
+        if (!block) block = AllocateBlock(shard, word / kBlockWords);
+        block->counts[word % kBlockWords][static_cast<size_t>(outcome)].fetch_add(1, std::memory_order_relaxed);
+        if (!dirty_.load(std::memory_order_relaxed) && !dirty_.exchange(true, std::memory_order_acq_rel)) wake_.Notify();
+    }
+
+    // Rolls everything recorded so far into the current minute and writes it.
+    void Flush();
+
+    // Outcome totals and the `topN` words ranked by `by` for [from, to). Uses
+    // the finest buckets still retained at `from`.
+    WordStatsRange Query(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+                         WordOutcome by = WordOutcome::Triggered, size_t topN = 10) const;
+
+private:
+    static constexpr size_t kBlockWords = 256;
+    static constexpr size_t kShards = 8;
+
+    struct alignas(64) Block {
+        std::atomic<uint64_t> counts[kBlockWords][kWordOutcomeCount]{};
+    };
+    struct Shard {
+        std::atomic<Block*> blocks[WordTable::kCapacity / kBlockWords]{};
+    };
+
+    enum Level : uint8_t { Minute, Hour, Day, kLevels };
+    using Buckets = std::map<uint32_t, std::unordered_map<std::string, WordOutcomeCounts>>; // start minute -> word -> counts
+
+    explicit WordStats(const std::filesystem::path& directory, WordStatsOptions options);
+    // Threads are spread round-robin over the shards on first use.
+    static size_t ShardIndex() {
+        static std::atomic<size_t> next{0};
+        thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+        return shard;
+    }
+    Block* AllocateBlock(size_t shard, size_t index);
+    void Run();
+    void Roll(uint32_t minute);
+    void Add(Level level, uint32_t minute, const std::string& word, const WordOutcomeCounts& counts);
+    void Prune(uint32_t nowMinute);
+    bool Load();
+    bool Compact();
+    bool AppendMinute(uint32_t minute, const std::vector<std::pair<std::string, WordOutcomeCounts>>& rows);
+
+    std::filesystem::path path_;
+    WordStatsOptions options_;
+
+    std::unique_ptr<Shard[]> shards_;
+    std::atomic<bool> dirty_{false};
+    WakeSignal wake_;
+    std::atomic<bool> stop_{false};
+    std::thread roller_;
+
+    mutable std::mutex mutex_; // everything below; never taken by Record()
+    std::vector<WordOutcomeCounts> rolled_;                  // by WordId: totals already in buckets
+    std::array<Buckets, kLevels> buckets_;
+    std::unordered_map<std::string, uint32_t> fileWords_;    // word -> index in the current file
+    size_t appended_{0};                                     // bucket records since the last rewrite
+};
+
+}
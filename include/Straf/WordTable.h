@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace Straf {
+
+// Compact handle for an interned word, phrase or rule name.
+using WordId = uint32_t;
+inline constexpr WordId kNoWord = 0;
+
+/**
+ * @brief Append-only intern table shared by detection, penalties and overlays.
+ *
+ * Vocabulary entries and blocklist words are interned when they are loaded;
+ * words first seen at runtime (pattern hits) are interned on first sight.
+ * After that every stage passes 32-bit ids, and repeated detections allocate
+ * nothing. Entries never move or change once published, so Find(), Name()
+ * and WideName() are lock-free and safe from any thread, including render and
+ * analysis threads; only adding a new word takes the write lock. Each entry
+ * also keeps a UTF-16/32 copy for text renderers.
+ */
+class WordTable {
+public:
+    static constexpr size_t kCapacity = size_t{1} << 16;
+
+    WordTable();
+
+    // Returns the id for `word`, adding it if new. Returns kNoWord for empty
+    // input or when the table is full (see Full()). Lock-free when `word` is
+    // already present.
+    WordId Intern(std::string_view word);
+    // Returns kNoWord if `word` was never interned. Lock-free.
+    WordId Find(std::string_view word) const;
+    bool Full() const { return Size() >= kCapacity; }
+
+    std::string_view Name(WordId id) const;
+    std::wstring_view WideName(WordId id) const;
+    size_t Size() const { return count_.load(std::memory_order_acquire); }
+
+private:
+    static constexpr size_t kChunkBits = 10;
+    static constexpr size_t kChunkSize = size_t{1} << kChunkBits;
+
+    struct Entry {
+        std::string name;
+        std::wstring wide;
+    };
+
+    // Open-addressed, at most half full. A slot goes from kNoWord to an id
+    // once, after the entry is published, so readers probe without a lock.
+    static constexpr size_t kIndexSlots = kCapacity * 2;
+
+    const Entry* Get(WordId id) const;
+
+    std::unique_ptr<Entry[]> chunks_[kCapacity / kChunkSize];
+    std::atomic<size_t> count_{0}; // published entries; id 0 is the empty kNoWord entry
+    std::mutex writeMutex_;
+    std::unique_ptr<std::atomic<WordId>[]> index_;
+};
+
+// Process-wide table.
+WordTable& Words();
+
+}
@@ -1,9 +1,20 @@
 // src/logging.hpp
 #pragma once
 #include <memory>
+#include <string_view>
 #include <spdlog/spdlog.h>
 
 namespace logsys {
+// Console + rotating file, behind an async logger that drops the oldest
+// message rather than block when its queue is full. Hot paths log through
+// Straf/HotLog.h, whose records end up in the same sinks. Info by default,
+// debug when `verbose`.
 void init(bool verbose = false);
 std::shared_ptr<spdlog::logger> get(); // optional helper
+// Sets the level of both loggers from a config name ("trace", "debug",
+// "info", "warn", "error", "off"); `verbose` keeps at least debug. Safe while
+// other threads log. Returns false for an unknown name.
+bool set_level(std::string_view name);
+// Writes out pending hot-path records and flushes the sinks.
+void shutdown();
 }
@@ -0,0 +1,57 @@
+#include "Straf/AudioDsp.h"
+#include "Straf/Metrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Straf {
+
+void DownmixAndResample(const float* in, size_t inFrames, int inChannels, int inRate,
+                        std::vector<float>& out, int outRate){
+    if (inFrames == 0){ out.clear(); return; }
+    // Downmix to mono
+    std::vector<float> mono;
+    mono.resize(inFrames);
+    if (inChannels <= 1){
+        std::copy(in, in + inFrames, mono.begin());
+    } else {
+        for (size_t i = 0; i < inFrames; ++i){
+            double acc = 0.0;
+            const float* frame = in + i * inChannels;
+            for (int ch = 0; ch < inChannels; ++ch){ acc += frame[ch]; }
+            mono[i] = static_cast<float>(acc / inChannels);
+        }
+    }
+    if (inRate == outRate){ out = std::move(mono); return; }
+    // Linear resample
+    const double ratio = static_cast<double>(outRate) / static_cast<double>(inRate);
+    const size_t outFrames = static_cast<size_t>(std::floor(mono.size() * ratio));
+    out.resize(outFrames);
+    for (size_t i = 0; i < outFrames; ++i){
+        const double pos = static_cast<double>(i) / ratio;
+        const size_t i0 = static_cast<size_t>(pos);
+        const size_t i1 = std::min(i0 + 1, mono.size() - 1);
+        const double t = pos - static_cast<double>(i0);
+        out[i] = static_cast<float>((1.0 - t) * mono[i0] + t * mono[i1]);
+    }
+}
+
+void FloatToPcm16(const float* in, size_t count, int16_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        const float s = std::clamp(in[i], -1.0f, 1.0f);
+        out[i] = static_cast<int16_t>(std::lrintf(s * 32767.0f));
+    }
+}
+
+void PacketJitter::Arrived(size_t frames, int rate) {
+    static metrics::Histogram& jitter = metrics::Metrics().AddHistogram(
+        "straf_audio_packet_jitter_seconds", "Deviation of each capture packet's arrival from the expected packet interval.",
+        {1e-5, 1.0});
+    const auto now = std::chrono::steady_clock::now();
+    if (last_.time_since_epoch().count() != 0) {
+        jitter.Observe(std::abs((std::chrono::duration<double>(now - last_) - expected_).count()));
+    }
+    last_ = now;
+    expected_ = std::chrono::duration<double>(rate > 0 ? static_cast<double>(frames) / rate : 0.0);
+}
+
+}
@@ -0,0 +1,136 @@
+#include "Straf/Audio.h"
+#include "Straf/AudioDsp.h"
+#include "Straf/Executor.h"
+#include "Straf/Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace Straf {
+
+namespace {
+
+struct WavData {
+    int rate{0};
+    int channels{0};
+    std::vector<float> samples; // interleaved
+};
+
+uint16_t ReadU16(const unsigned char* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+uint32_t ReadU32(const unsigned char* p) { return ReadU16(p) | (static_cast<uint32_t>(ReadU16(p + 2)) << 16); }
+
+// RIFF/WAVE with a 16-bit PCM or 32-bit float "data" chunk; other chunks are skipped.
+bool LoadWav(const std::string& path, WavData& wav) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    const std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    uint16_t format = 0, bits = 0;
+    for (size_t at = 12; at + 8 <= bytes.size();) {
+        const unsigned char* chunk = bytes.data() + at;
+        const size_t size = std::min<size_t>(ReadU32(chunk + 4), bytes.size() - at - 8);
+        const unsigned char* body = chunk + 8;
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            format = ReadU16(body);
+            wav.channels = ReadU16(body + 2);
+            wav.rate = static_cast<int>(ReadU32(body + 4));
+            bits = ReadU16(body + 14);
+            if (format == 0xFFFE && size >= 26) format = ReadU16(body + 24); // WAVE_FORMAT_EXTENSIBLE sub-format
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            if (wav.channels <= 0 || wav.rate <= 0) return false;
+            if (format == 1 && bits == 16) {
+                wav.samples.resize(size / 2);
+                for (size_t i = 0; i < wav.samples.size(); ++i) {
+                    wav.samples[i] = static_cast<int16_t>(ReadU16(body + 2 * i)) / 32768.0f;
+                }
+            } else if (format == 3 && bits == 32) {
+                wav.samples.resize(size / 4);
+                std::memcpy(wav.samples.data(), body, wav.samples.size() * 4);
+            } else {
+                return false;
+            }
+            wav.samples.resize(wav.samples.size() - wav.samples.size() % wav.channels);
+            return true;
+        }
+        at += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+}
+
+class AudioFile final : public IAudioSource {
+public:
+    AudioFile(std::string path, AudioFileOptions options) : path_(std::move(path)), options_(std::move(options)) {}
+    ~AudioFile() override { Stop(); }
+
+    bool Initialize(int sampleRate, int channels) override {
+        targetRate_ = sampleRate;
+        targetChannels_ = channels;
+        if (targetRate_ <= 0 || targetChannels_ <= 0) return false;
+        return LoadWav(path_, wav_);
+    }
+
+    void Start(AudioCallback onAudio) override {
+        if (task_.Joinable()) return;
+        task_ = Tasks().Spawn(Run(std::move(onAudio)));
+    }
+
+    void Stop() override {
+        task_.Stop();
+    }
+
+private:
+    Task Run(AudioCallback onAudio) {
+        const size_t packetFrames = static_cast<size_t>(std::max(1, wav_.rate / 50)); // 20 ms
+        const size_t totalFrames = wav_.samples.size() / wav_.channels;
+        const auto start = Executor::clock::now();
+        std::vector<float> out;
+        std::vector<float> up;
+        PacketJitter jitter; // only meaningful when paced
+        for (size_t frame = 0; frame < totalFrames; frame += packetFrames) {
+            // Paced: sleep until the packet is due. Back to back: still give
+            // other tasks a turn between packets
+            const bool live = options_.realtime
+                ? co_await SleepUntil(start + std::chrono::microseconds(frame * 1000000 / wav_.rate))
+                : co_await Yield();
+            if (!live) co_return;
+            STRAF_TRACE_SCOPE("audio", "packet");
+            const size_t frames = std::min(packetFrames, totalFrames - frame);
+            if (options_.realtime) jitter.Arrived(frames, wav_.rate);
+            {
+                STRAF_TRACE_SCOPE("audio", "resample");
+                DownmixAndResample(wav_.samples.data() + frame * wav_.channels, frames, wav_.channels, wav_.rate, out, targetRate_);
+            }
+            if (targetChannels_ <= 1) {
+                onAudio(out);
+            } else {
+                up.resize(out.size() * targetChannels_);
+                for (size_t i = 0; i < out.size(); ++i) {
+                    for (int ch = 0; ch < targetChannels_; ++ch) up[i * targetChannels_ + ch] = out[i];
+                }
+                onAudio(up);
+            }
+        }
+        if (options_.onEnd) options_.onEnd();
+    }
+
+    std::string path_;
+    AudioFileOptions options_;
+    WavData wav_;
+    int targetRate_{16000};
+    int targetChannels_{1};
+    TaskHandle task_;
+};
+
+std::unique_ptr<IAudioSource> CreateAudioFile(const std::string& path, AudioFileOptions options) {
+    return std::make_unique<AudioFile>(path, std::move(options));
+}
+
+}
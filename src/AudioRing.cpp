@@ -0,0 +1,578 @@
+#include "Straf/AudioRing.h"
+#include "Straf/Executor.h"
+#include "Straf/Platform.h"
+#include "Straf/SharedMemory.h"
+#include "Straf/Trace.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace Straf {
+
+namespace detail {
+
+// Where packet k starts, how long it is and when it was captured, behind a
+// seqlock: odd while being written, 2k+2 once complete.
+struct alignas(32) PacketSlot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> position{0};
+    std::atomic<uint64_t> count{0};
+    std::atomic<int64_t> capturedNanos{0}; // steady clock, shared by all processes on the machine
+};
+
+// Mapped at offset 0, followed by `packetSlots` PacketSlots and `capacity`
+// floats. `magic` is stored last when the producer sets the ring up.
+struct AudioRingLayout {
+    std::atomic<uint32_t> magic{0};
+    uint32_t version{0};
+    uint32_t sampleRate{0};
+    uint32_t channels{0};
+    uint32_t capacity{0};    // samples, a power of two
+    uint32_t packetSlots{0}; // a power of two
+    uint64_t writerPid{0};
+    std::atomic<uint32_t> generation{0}; // bumped when a producer takes the ring over
+    std::atomic<uint32_t> closed{0};
+
+    // Producer. Samples up to `reserved` may be mid-write; up to `written`
+    // they are complete.
+    alignas(64) std::atomic<uint64_t> reserved{0};
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> packets{0};
+
+    // Consumer
+    alignas(64) std::atomic<uint64_t> consumerPid{0}; // 0 = none; taken over when its process is gone
+    std::atomic<uint64_t> consumerPosition{0};
+    std::atomic<uint64_t> consumerOverruns{0};
+    std::atomic<uint64_t> attaches{0};
+    std::atomic<uint32_t> waiting{0}; // set by the consumer about to sleep, cleared by the producer waking it
+    std::atomic<uint32_t> wake{0};    // futex word, bumped per wakeup
+
+    PacketSlot* Packets() { return reinterpret_cast<PacketSlot*>(this + 1); }
+    const PacketSlot* Packets() const { return reinterpret_cast<const PacketSlot*>(this + 1); }
+    float* Samples() { return reinterpret_cast<float*>(Packets() + packetSlots); }
+    const float* Samples() const { return reinterpret_cast<const float*>(Packets() + packetSlots); }
+};
+
+static_assert(sizeof(AudioRingLayout) % 64 == 0 && sizeof(PacketSlot) == 32);
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "the ring is shared between processes and needs address-free atomics");
+
+} // namespace detail
+
+namespace {
+
+using detail::AudioRingLayout;
+using detail::PacketSlot;
+using platform::kNoSharedHandle;
+
+constexpr uint32_t kMagic = 0x41465453; // "STFA"
+constexpr size_t kMinPacket = 64;       // samples per packet slot when sizing the packet ring
+
+size_t RoundUpPow2(size_t n) {
+    size_t p = 4096;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+size_t RingBytes(size_t capacity, size_t packetSlots) {
+    return sizeof(AudioRingLayout) + packetSlots * sizeof(PacketSlot) + capacity * sizeof(float);
+}
+
+std::string RegionName(const std::string& name) { return name + ".audio"; }
+std::string EventName(const std::string& name) { return RegionName(name) + ".wake"; }
+
+int64_t SteadyNanos(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+class RingPublisher final : public IAudioSource {
+public:
+    RingPublisher(std::unique_ptr<IAudioSource> inner, AudioRingWriter& ring) : inner_(std::move(inner)), ring_(ring) {}
+
+    bool Initialize(int sampleRate, int channels) override {
+        if (sampleRate != ring_.SampleRate() || channels != ring_.Channels()) return false;
+        return inner_->Initialize(sampleRate, channels);
+    }
+    void Start(AudioCallback onAudio) override {
+        inner_->Start([this, onAudio = std::move(onAudio)](const AudioBuffer& buf) {
+            ring_.Write(buf.data(), buf.size(), std::chrono::steady_clock::now());
+            if (onAudio) onAudio(buf);
+        });
+    }
+    void Stop() override { inner_->Stop(); }
+
+private:
+    std::unique_ptr<IAudioSource> inner_;
+    AudioRingWriter& ring_;
+};
+
+// Per-stream word a consumer without a ring sleeps on. The consumer creates
+// it and removes it when it stops; AudioRingWriter::Create() rings it once a
+// new ring is set up, so the consumer attaches without polling for one.
+class Doorbell {
+public:
+    static std::unique_ptr<Doorbell> Open(const std::string& name) {
+        intptr_t handle = platform::OpenSharedMemory(BellName(name));
+        if (handle == kNoSharedHandle) {
+            // Another consumer creating it at the same time wins; open theirs
+            handle = platform::CreateSharedMemory(BellName(name), kBellBytes, [](void*, size_t) { return false; });
+            if (handle == kNoSharedHandle) handle = platform::OpenSharedMemory(BellName(name));
+        }
+        if (handle == kNoSharedHandle) return nullptr;
+        if (platform::SharedMemoryBytes(handle) < kBellBytes) {
+            platform::CloseSharedMemory(handle);
+            return nullptr;
+        }
+        auto* word = static_cast<std::atomic<uint32_t>*>(platform::MapSharedMemory(handle, kBellBytes));
+        if (!word) {
+            platform::CloseSharedMemory(handle);
+            return nullptr;
+        }
+        return std::unique_ptr<Doorbell>(new Doorbell(name, word, handle));
+    }
+
+    // Wakes the consumer waiting on `name`'s bell, if there is one.
+    static void Ring(const std::string& name) {
+        const intptr_t handle = platform::OpenSharedMemory(BellName(name));
+        if (handle == kNoSharedHandle) return;
+        if (platform::SharedMemoryBytes(handle) >= kBellBytes) {
+            if (auto* word = static_cast<std::atomic<uint32_t>*>(platform::MapSharedMemory(handle, kBellBytes))) {
+                const intptr_t event = platform::OpenSharedEvent(BellEventName(name));
+                platform::WakeWord(*word, event);
+                platform::CloseSharedEvent(event);
+                platform::UnmapSharedMemory(word, kBellBytes);
+            }
+        }
+        platform::CloseSharedMemory(handle);
+    }
+
+    ~Doorbell() {
+        platform::CloseSharedEvent(event_);
+        platform::UnmapSharedMemory(word_, kBellBytes);
+        platform::CloseSharedMemory(handle_);
+        platform::RemoveSharedMemory(BellName(name_));
+    }
+
+    // Read before looking for a ring; Wait() returns as soon as it moves.
+    uint32_t Seen() const { return word_->load(std::memory_order_acquire); }
+    void Wait(uint32_t seen, std::chrono::milliseconds timeout) {
+        if (!interrupted_.exchange(false)) platform::WaitOnWord(*word_, seen, timeout, event_);
+    }
+    void Interrupt() {
+        interrupted_.store(true);
+        platform::WakeWord(*word_, event_);
+    }
+
+private:
+    static constexpr size_t kBellBytes = 64;
+    static std::string BellName(const std::string& name) { return RegionName(name) + ".bell"; }
+    static std::string BellEventName(const std::string& name) { return BellName(name) + ".wake"; }
+
+    Doorbell(std::string name, std::atomic<uint32_t>* word, intptr_t handle)
+        : name_(std::move(name)), word_(word), handle_(handle), event_(platform::OpenSharedEvent(BellEventName(name_))) {}
+
+    std::string name_;
+    std::atomic<uint32_t>* word_;
+    intptr_t handle_;
+    intptr_t event_;
+    std::atomic<bool> interrupted_{false};
+};
+
+class AudioRingSource final : public IAudioSource {
+public:
+    AudioRingSource(std::string name, Executor& executor) : name_(std::move(name)), executor_(executor) {}
+    ~AudioRingSource() override { Stop(); }
+
+    bool Initialize(int sampleRate, int channels) override {
+        sampleRate_ = sampleRate;
+        channels_ = channels;
+        return sampleRate_ > 0 && channels_ > 0;
+    }
+
+    void Start(AudioCallback onAudio) override {
+        if (task_.Joinable()) return;
+        stop_ = false;
+        bell_ = Doorbell::Open(name_);
+        if (!bell_) SPDLOG_WARN("Audio ring '{}': no doorbell, looking for a producer every second", name_);
+        task_ = executor_.Spawn(Run(std::move(onAudio)));
+    }
+
+    void Stop() override {
+        task_.RequestStop();
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+            if (reader_) reader_->Interrupt();
+        }
+        if (bell_) bell_->Interrupt();
+        task_.Join();
+        task_ = {};
+        bell_.reset();
+    }
+
+private:
+    Task Run(AudioCallback onAudio) {
+        AudioBuffer buffer;
+        std::chrono::steady_clock::time_point captured;
+        bool live = true;
+        while (live && !stop_) {
+            const uint32_t rung = bell_ ? bell_->Seen() : 0;
+            if (!Attach()) {
+                // No producer yet: sleep until one rings. The timeout only
+                // matters when the consumer slot of a ring frees up
+                if (bell_) {
+                    live = co_await Blocking([this, rung] { bell_->Wait(rung, std::chrono::seconds(2)); });
+                } else {
+                    live = co_await SleepFor(std::chrono::seconds(1));
+                }
+                continue;
+            }
+            while (live && !stop_) {
+                if (reader_->Read(buffer, captured)) {
+                    STRAF_TRACE_SCOPE("audio", "ring packet");
+                    onAudio(buffer);
+                    continue;
+                }
+                if (reader_->Closed()) break;
+                // Woken per packet; the timeout notices a producer that died
+                live = co_await Blocking([this] { reader_->Wait(std::chrono::milliseconds(500)); });
+            }
+            if (reader_->Overruns() > 0) SPDLOG_WARN("Audio ring '{}': skipped {} samples", name_, reader_->Overruns());
+            std::lock_guard lock(mutex_);
+            reader_.reset();
+        }
+    }
+
+    bool Attach() {
+        auto reader = AudioRingReader::Open(name_);
+        if (!reader) return false;
+        if (reader->SampleRate() != sampleRate_ || reader->Channels() != channels_) {
+            if (!formatWarned_) {
+                SPDLOG_WARN("Audio ring '{}' is {} Hz x{}, need {} Hz x{}", name_, reader->SampleRate(), reader->Channels(),
+                            sampleRate_, channels_);
+            }
+            formatWarned_ = true;
+            return false;
+        }
+        SPDLOG_INFO("Attached to audio ring '{}' at sample {}", name_, reader->Position());
+        formatWarned_ = false;
+        std::lock_guard lock(mutex_);
+        if (stop_) return false;
+        reader_ = std::move(reader);
+        return true;
+    }
+
+    std::string name_;
+    Executor& executor_;
+    int sampleRate_{16000};
+    int channels_{1};
+    TaskHandle task_;
+    std::unique_ptr<Doorbell> bell_;
+    std::mutex mutex_; // guards reader_ against Stop(); the task reads it freely
+    std::atomic<bool> stop_{false};
+    std::unique_ptr<AudioRingReader> reader_;
+    bool formatWarned_{false};
+};
+
+} // namespace
+
+std::string AudioRingObjectName(const std::string& name) { return platform::SharedObjectName(RegionName(name)); }
+
+// --- Producer --------------------------------------------------------------
+
+std::unique_ptr<AudioRingWriter> AudioRingWriter::Create(const std::string& name, int sampleRate, int channels,
+                                                         std::chrono::seconds seconds) {
+    if (sampleRate <= 0 || channels <= 0 || seconds.count() <= 0) return nullptr;
+    const size_t capacity = RoundUpPow2(static_cast<size_t>(sampleRate) * static_cast<size_t>(channels) * static_cast<size_t>(seconds.count()));
+    const size_t packetSlots = capacity / kMinPacket;
+    const size_t bytes = RingBytes(capacity, packetSlots);
+    const intptr_t handle = platform::CreateSharedMemory(RegionName(name), bytes, [&name](void* view, size_t oldBytes) {
+        if (oldBytes < sizeof(AudioRingLayout)) return true;
+        AudioRingLayout* old = static_cast<AudioRingLayout*>(view);
+        if (old->magic.load(std::memory_order_acquire) == kMagic && platform::ProcessAlive(old->writerPid) &&
+            old->writerPid != platform::ProcessId()) {
+            return false;
+        }
+        // A consumer still attached to it sees the ring close
+        old->closed.store(1, std::memory_order_release);
+        old->generation.fetch_add(1, std::memory_order_acq_rel);
+        const intptr_t event = platform::OpenSharedEvent(EventName(name));
+        platform::WakeWord(old->wake, event);
+        platform::CloseSharedEvent(event);
+        return true;
+    });
+    if (handle == kNoSharedHandle) return nullptr;
+    auto* ring = static_cast<AudioRingLayout*>(platform::MapSharedMemory(handle, bytes));
+    if (!ring) {
+        platform::CloseSharedMemory(handle);
+        return nullptr;
+    }
+    const uint32_t generation = ring->generation.load(std::memory_order_relaxed);
+    ring->magic.store(0, std::memory_order_relaxed);
+    std::memset(static_cast<void*>(ring->Packets()), 0, packetSlots * sizeof(PacketSlot));
+    ring->version = kAudioRingVersion;
+    ring->sampleRate = static_cast<uint32_t>(sampleRate);
+    ring->channels = static_cast<uint32_t>(channels);
+    ring->capacity = static_cast<uint32_t>(capacity);
+    ring->packetSlots = static_cast<uint32_t>(packetSlots);
+    ring->writerPid = platform::ProcessId();
+    ring->reserved.store(0, std::memory_order_relaxed);
+    ring->written.store(0, std::memory_order_relaxed);
+    ring->packets.store(0, std::memory_order_relaxed);
+    ring->consumerPid.store(0, std::memory_order_relaxed);
+    ring->attaches.store(0, std::memory_order_relaxed);
+    ring->closed.store(0, std::memory_order_relaxed);
+    ring->generation.store(generation + 1, std::memory_order_relaxed);
+    ring->magic.store(kMagic, std::memory_order_release);
+    Doorbell::Ring(name);
+    return std::unique_ptr<AudioRingWriter>(new AudioRingWriter(name, ring, bytes, handle, generation + 1));
+}
+
+AudioRingWriter::AudioRingWriter(std::string name, detail::AudioRingLayout* ring, size_t bytes, intptr_t handle,
+                                 uint32_t generation)
+    : name_(std::move(name)), ring_(ring), bytes_(bytes), handle_(handle), event_(platform::OpenSharedEvent(EventName(name_))),
+      generation_(generation) {}
+
+AudioRingWriter::~AudioRingWriter() {
+    // A producer that took the name over has already closed this ring and
+    // owns the name (and, on Windows, possibly this very region) now
+    const bool owner = ring_->generation.load(std::memory_order_acquire) == generation_;
+    if (owner) {
+        ring_->closed.store(1, std::memory_order_release);
+        platform::WakeWord(ring_->wake, event_);
+    }
+    platform::CloseSharedEvent(event_);
+    platform::UnmapSharedMemory(ring_, bytes_);
+    platform::CloseSharedMemory(handle_);
+    if (owner) platform::RemoveSharedMemory(RegionName(name_));
+}
+
+int AudioRingWriter::SampleRate() const { return static_cast<int>(ring_->sampleRate); }
+int AudioRingWriter::Channels() const { return static_cast<int>(ring_->channels); }
+size_t AudioRingWriter::Capacity() const { return ring_->capacity; }
+
+void AudioRingWriter::Write(const float* samples, size_t count, std::chrono::steady_clock::time_point captured) {
+    const size_t maxPacket = ring_->capacity / 4;
+    const int64_t nanos = SteadyNanos(captured);
+    for (size_t done = 0; done < count;) {
+        const size_t n = std::min(count - done, maxPacket);
+        WritePacket(samples + done, n, nanos);
+        done += n;
+    }
+}
+
+void AudioRingWriter::WritePacket(const float* samples, size_t count, int64_t capturedNanos) {
+    const uint64_t start = samples_;
+    const uint64_t end = start + count;
+    const size_t mask = ring_->capacity - 1;
+
+    // Announce the samples about to be overwritten before touching them; a
+    // consumer that read them checks `reserved` afterwards (Intact())
+    ring_->reserved.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const size_t at = static_cast<size_t>(start & mask);
+    const size_t first = std::min(count, ring_->capacity - at);
+    std::memcpy(ring_->Samples() + at, samples, first * sizeof(float));
+    std::memcpy(ring_->Samples(), samples + first, (count - first) * sizeof(float));
+
+    const uint64_t k = packets_;
+    PacketSlot& slot = ring_->Packets()[k & (ring_->packetSlots - 1)];
+    slot.seq.store(2 * k + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.position.store(start, std::memory_order_relaxed);
+    slot.count.store(count, std::memory_order_relaxed);
+    slot.capturedNanos.store(capturedNanos, std::memory_order_relaxed);
+    slot.seq.store(2 * k + 2, std::memory_order_release);
+
+    samples_ = end;
+    packets_ = k + 1;
+    // Packets before samples: a consumer reading `written` then `packets`
+    // (AudioRingReader::Skip()) must not resume at a packet before `written`
+    ring_->packets.store(packets_, std::memory_order_release);
+    ring_->written.store(end, std::memory_order_release);
+
+    // Pairs with the fence in AudioRingReader::Wait(): either the consumer
+    // sees this packet before sleeping, or this sees it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (ring_->waiting.load(std::memory_order_relaxed) && ring_->waiting.exchange(0, std::memory_order_acq_rel)) {
+        platform::WakeWord(ring_->wake, event_);
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+AudioRingStats AudioRingWriter::GetStats() const {
+    AudioRingStats s;
+    s.samples = ring_->written.load(std::memory_order_relaxed);
+    s.packets = ring_->packets.load(std::memory_order_relaxed);
+    s.wakeups = wakeups_.load(std::memory_order_relaxed);
+    const uint64_t pid = ring_->consumerPid.load(std::memory_order_acquire);
+    if (pid != 0 && platform::ProcessAlive(pid)) {
+        s.consumerPid = pid;
+        s.consumerPosition = ring_->consumerPosition.load(std::memory_order_relaxed);
+        s.consumerOverruns = ring_->consumerOverruns.load(std::memory_order_relaxed);
+    }
+    s.attaches = ring_->attaches.load(std::memory_order_relaxed);
+    return s;
+}
+
+// --- Consumer --------------------------------------------------------------
+
+std::unique_ptr<AudioRingReader> AudioRingReader::Open(const std::string& name) {
+    const intptr_t handle = platform::OpenSharedMemory(RegionName(name));
+    if (handle == kNoSharedHandle) return nullptr;
+    const size_t bytes = platform::SharedMemoryBytes(handle);
+    auto* ring = bytes >= sizeof(AudioRingLayout) ? static_cast<AudioRingLayout*>(platform::MapSharedMemory(handle, bytes)) : nullptr;
+    const bool usable = ring && ring->magic.load(std::memory_order_acquire) == kMagic && ring->version == kAudioRingVersion &&
+                        RingBytes(ring->capacity, ring->packetSlots) <= bytes && ring->closed.load(std::memory_order_acquire) == 0;
+    bool attached = false;
+    if (usable) {
+        const uint64_t me = platform::ProcessId();
+        uint64_t pid = ring->consumerPid.load(std::memory_order_acquire);
+        const bool taken = pid == me || (pid != 0 && platform::ProcessAlive(pid));
+        attached = !taken && ring->consumerPid.compare_exchange_strong(pid, me, std::memory_order_acq_rel);
+    }
+    if (!attached) {
+        if (ring) platform::UnmapSharedMemory(ring, bytes);
+        platform::CloseSharedMemory(handle);
+        return nullptr;
+    }
+    ring->waiting.store(0, std::memory_order_relaxed);
+    ring->consumerOverruns.store(0, std::memory_order_relaxed);
+    ring->attaches.fetch_add(1, std::memory_order_relaxed);
+    auto out = std::unique_ptr<AudioRingReader>(new AudioRingReader(ring, bytes, handle, platform::OpenSharedEvent(EventName(name))));
+    // The live edge; `written` first, so packet `packet_` starts at or after it
+    out->position_ = ring->written.load(std::memory_order_acquire);
+    out->packet_ = ring->packets.load(std::memory_order_acquire);
+    ring->consumerPosition.store(out->position_, std::memory_order_relaxed);
+    return out;
+}
+
+AudioRingReader::AudioRingReader(detail::AudioRingLayout* ring, size_t bytes, intptr_t handle, intptr_t event)
+    : ring_(ring), bytes_(bytes), handle_(handle), event_(event),
+      generation_(ring->generation.load(std::memory_order_acquire)), writerPid_(ring->writerPid) {}
+
+AudioRingReader::~AudioRingReader() {
+    ring_->consumerPid.store(0, std::memory_order_release);
+    platform::CloseSharedEvent(event_);
+    platform::UnmapSharedMemory(ring_, bytes_);
+    platform::CloseSharedMemory(handle_);
+}
+
+int AudioRingReader::SampleRate() const { return static_cast<int>(ring_->sampleRate); }
+int AudioRingReader::Channels() const { return static_cast<int>(ring_->channels); }
+
+bool AudioRingReader::Next(AudioRingPacket& packet) {
+    const uint64_t slots = ring_->packetSlots;
+    for (;;) {
+        const PacketSlot& slot = ring_->Packets()[packet_ & (slots - 1)];
+        const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq < 2 * packet_ + 2) return false; // being written, or still the previous lap
+        const uint64_t position = slot.position.load(std::memory_order_relaxed);
+        const uint64_t count = slot.count.load(std::memory_order_relaxed);
+        const int64_t captured = slot.capturedNanos.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq != 2 * packet_ + 2 || slot.seq.load(std::memory_order_relaxed) != seq) {
+            Skip(); // the packet record was lapped
+            continue;
+        }
+        if (Lapped(position)) {
+            Skip(); // its samples are being overwritten
+            continue;
+        }
+        if (position > position_) {
+            overruns_ += position - position_;
+            ring_->consumerOverruns.store(overruns_, std::memory_order_relaxed);
+        }
+        const size_t capacity = ring_->capacity;
+        const size_t at = static_cast<size_t>(position & (capacity - 1));
+        packet.position = position;
+        packet.first = ring_->Samples() + at;
+        packet.firstCount = std::min<size_t>(count, capacity - at);
+        packet.second = ring_->Samples();
+        packet.secondCount = count - packet.firstCount;
+        packet.captured = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(captured));
+        ++packet_;
+        position_ = position + count;
+        ring_->consumerPosition.store(position_, std::memory_order_relaxed);
+        return true;
+    }
+}
+
+bool AudioRingReader::Lapped(uint64_t position) const {
+    // Pairs with the fence in AudioRingWriter::WritePacket(): if any sample
+    // read so far came from a newer lap, `reserved` already says so
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return ring_->reserved.load(std::memory_order_relaxed) > position + ring_->capacity;
+}
+
+bool AudioRingReader::Intact(const AudioRingPacket& packet) {
+    if (!Lapped(packet.position)) return true;
+    // Step back so the next packet read counts this one in the gap
+    if (packet.position + packet.Count() == position_) position_ = packet.position;
+    return false;
+}
+
+bool AudioRingReader::Read(AudioBuffer& out, std::chrono::steady_clock::time_point& captured) {
+    AudioRingPacket packet;
+    while (Next(packet)) {
+        out.resize(packet.Count());
+        std::memcpy(out.data(), packet.first, packet.firstCount * sizeof(float));
+        std::memcpy(out.data() + packet.firstCount, packet.second, packet.secondCount * sizeof(float));
+        if (Intact(packet)) {
+            captured = packet.captured;
+            return true;
+        }
+    }
+    return false;
+}
+
+void AudioRingReader::Skip() {
+    // Resume at the live edge. `written` is read first, so packet `packet_`
+    // starts at or after it, and the samples passed over are overruns
+    const uint64_t written = ring_->written.load(std::memory_order_acquire);
+    packet_ = std::max(packet_ + 1, ring_->packets.load(std::memory_order_acquire));
+    if (written > position_) {
+        overruns_ += written - position_;
+        position_ = written;
+        ring_->consumerOverruns.store(overruns_, std::memory_order_relaxed);
+    }
+}
+
+bool AudioRingReader::Ready() const {
+    const PacketSlot& slot = ring_->Packets()[packet_ & (ring_->packetSlots - 1)];
+    return slot.seq.load(std::memory_order_acquire) >= 2 * packet_ + 2;
+}
+
+bool AudioRingReader::Wait(std::chrono::milliseconds timeout) {
+    if (Ready()) return true;
+    if (Closed()) return false;
+    const uint32_t seen = ring_->wake.load(std::memory_order_acquire);
+    ring_->waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // see AudioRingWriter::WritePacket()
+    if (!Ready() && !interrupted_.exchange(false)) platform::WaitOnWord(ring_->wake, seen, timeout, event_);
+    ring_->waiting.store(0, std::memory_order_relaxed);
+    return Ready();
+}
+
+void AudioRingReader::Interrupt() {
+    interrupted_.store(true);
+    platform::WakeWord(ring_->wake, event_);
+}
+
+bool AudioRingReader::Closed() const {
+    return ring_->closed.load(std::memory_order_acquire) != 0 ||
+           ring_->generation.load(std::memory_order_acquire) != generation_ || !platform::ProcessAlive(writerPid_);
+}
+
+std::unique_ptr<IAudioSource> PublishingAudioSource(std::unique_ptr<IAudioSource> inner, AudioRingWriter& ring) {
+    return std::make_unique<RingPublisher>(std::move(inner), ring);
+}
+
+std::unique_ptr<IAudioSource> CreateAudioRing(const std::string& name, Executor& executor) {
+    return std::make_unique<AudioRingSource>(name, executor);
+}
+
+}
@@ -1,33 +1,37 @@
 #include "Straf/Audio.h"
-#include <thread>
-#include <atomic>
+#include "Straf/Executor.h"
 #include <chrono>
 
 namespace Straf {
 
 // AudioSilent: A silent audio generator that produces zero-filled audio buffers
 // at regular intervals (20ms, 320 samples at 16kHz). Used as a fallback when
-// real microphone capture is unavailable or for testing purposes.
+// real microphone capture is unavailable or for testing purposes. Runs as a
+// task on Tasks() rather than on a thread of its own.
 class AudioSilent : public IAudioSource {
 public:
+    ~AudioSilent() override { Stop(); }
     bool Initialize(int, int) override { return true; }
     void Start(AudioCallback onAudio) override {
-        stop_ = false;
-        worker_ = std::thread([this, onAudio]{
-            while(!stop_){
-                std::this_thread::sleep_for(std::chrono::milliseconds(20));
-                AudioBuffer buf(320); // 20ms at 16kHz
-                onAudio(buf);
-            }
-        });
+        if (task_.Joinable()) return;
+        task_ = Tasks().Spawn(Run(std::move(onAudio)));
     }
     void Stop() override {
-        stop_ = true;
-        if (worker_.joinable()) worker_.join();
+        task_.Stop();
     }
 private:
-    std::thread worker_;
-    std::atomic<bool> stop_{false};
+    static Task Run(AudioCallback onAudio) {
+        const AudioBuffer buf(320); // 20ms at 16kHz
+        auto next = Executor::clock::now();
+        for (;;) {
+            next += std::chrono::milliseconds(20);
+            const bool due = co_await SleepUntil(next);
+            if (!due) break;
+            onAudio(buf);
+        }
+    }
+
+    TaskHandle task_;
 };
 
 std::unique_ptr<IAudioSource> CreateAudioSilent(){ 
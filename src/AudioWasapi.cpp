@@ -1,4 +1,6 @@
 #include "Straf/Audio.h"
+#include "Straf/AudioDsp.h"
+#include "Straf/Trace.h"
 
 #include <windows.h>
 #include <mmdeviceapi.h>
@@ -34,37 +36,6 @@ namespace {
         WideCharToMultiByte(CP_UTF8, 0, w, -1, s.data(), len, nullptr, nullptr);
         return s;
     }
-
-    // Downmix to mono and linear-resample to outRate.
-    static void DownmixAndResample(const float* in, size_t inFrames, int inChannels, int inRate,
-                                   std::vector<float>& out, int outRate){
-        if (inFrames == 0){ out.clear(); return; }
-        // Downmix to mono
-        std::vector<float> mono;
-        mono.resize(inFrames);
-        if (inChannels <= 1){
-            std::copy(in, in + inFrames, mono.begin());
-        } else {
-            for (size_t i = 0; i < inFrames; ++i){
-                double acc = 0.0;
-                const float* frame = in + i * inChannels;
-                for (int ch = 0; ch < inChannels; ++ch){ acc += frame[ch]; }
-                mono[i] = static_cast<float>(acc / inChannels);
-            }
-        }
-        if (inRate == outRate){ out = std::move(mono); return; }
-        // Linear resample
-        const double ratio = static_cast<double>(outRate) / static_cast<double>(inRate);
-        const size_t outFrames = static_cast<size_t>(std::floor(mono.size() * ratio));
-        out.resize(outFrames);
-        for (size_t i = 0; i < outFrames; ++i){
-            const double pos = static_cast<double>(i) / ratio;
-            const size_t i0 = static_cast<size_t>(pos);
-            const size_t i1 = std::min(i0 + 1, mono.size() - 1);
-            const double t = pos - static_cast<double>(i0);
-            out[i] = static_cast<float>((1.0 - t) * mono[i0] + t * mono[i1]);
-        }
-    }
 }
 
 class AudioWasapi final : public IAudioSource {
@@ -82,6 +53,7 @@ public:
         running_ = true;
         worker_ = std::thread([this, onAudio]{
             CoInit _co; // ensure COM apartment in this thread
+            trace::SetThreadName("audio capture");
 
             // Discover default capture endpoint
             ComPtr<IMMDeviceEnumerator> deviceEnumerator;
@@ -159,6 +131,7 @@ public:
             std::vector<float> inFloatScratch; // for PCM->float conversion or channel gather
             const int outRate = targetRate_;
             const int outChannels = targetChannels_;
+            PacketJitter jitter;
 
             while(!stop_){
                 DWORD wait = WaitForSingleObject(hEvent, 50);
@@ -167,9 +140,11 @@ public:
                 UINT32 packet = 0;
                 if (FAILED(capture->GetNextPacketSize(&packet))) continue;
                 while(packet > 0){
+                    STRAF_TRACE_SCOPE("audio", "packet");
                     BYTE* pData = nullptr; UINT32 frames = 0; DWORD flags = 0; UINT64 devpos = 0; UINT64 qpcpos = 0;
                     hr = capture->GetBuffer(&pData, &frames, &flags, &devpos, &qpcpos);
                     if (FAILED(hr)) break;
+                    jitter.Arrived(frames, inRate);
 
                     const bool silent = (flags & AUDCLNT_BUFFERFLAGS_SILENT) != 0;
 
@@ -202,7 +177,10 @@ public:
                     }
 
                     if (frames > 0){
-                        DownmixAndResample(fin, frames, inChannels, inRate, out, outRate);
+                        {
+                            STRAF_TRACE_SCOPE("audio", "resample");
+                            DownmixAndResample(fin, frames, inChannels, inRate, out, outRate);
+                        }
                         if (outChannels <= 1){
                             onAudio(out);
                         } else {
@@ -0,0 +1,303 @@
+#include "Straf/Blocklist.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Straf {
+
+namespace {
+
+// Incremental construction of a minimal acyclic automaton from sorted input
+// (Daciuk, Mihov, Watson, Watson 2000). States on the path of the previous
+// word stay mutable; everything left of it is deduplicated via the register.
+class DawgBuilder {
+public:
+    DawgBuilder() { states_.emplace_back(); }
+
+    void Add(const std::string& word) {
+        uint32_t state = 0;
+        size_t i = 0;
+        while (i < word.size()) {
+            auto& arcs = states_[state].arcs;
+            if (arcs.empty() || arcs.back().first != static_cast<uint8_t>(word[i])) break;
+            state = arcs.back().second;
+            ++i;
+        }
+        if (!states_[state].arcs.empty()) ReplaceOrRegister(state);
+        for (; i < word.size(); ++i) {
+            uint32_t next = static_cast<uint32_t>(states_.size());
+            states_.emplace_back();
+            states_[state].arcs.emplace_back(static_cast<uint8_t>(word[i]), next);
+            state = next;
+        }
+        states_[state].accepting = true;
+        ++words_;
+    }
+
+    // Finalizes the automaton and returns the flat, renumbered layout.
+    void Finish(std::vector<BlocklistState>& outStates, std::vector<BlocklistArc>& outArcs) {
+        if (!states_[0].arcs.empty()) ReplaceOrRegister(0);
+
+        // Renumber reachable states breadth-first so the root is state 0 and
+        // arcs of each state are contiguous.
+        std::vector<uint32_t> remap(states_.size(), UINT32_MAX);
+        std::vector<uint32_t> order{0};
+        remap[0] = 0;
+        for (size_t head = 0; head < order.size(); ++head) {
+            for (const auto& [label, target] : states_[order[head]].arcs) {
+                (void) label;
+                if (remap[target] == UINT32_MAX) {
+                    remap[target] = static_cast<uint32_t>(order.size());
+                    order.push_back(target);
+                }
+            }
+        }
+        outStates.clear();
+        outArcs.clear();
+        outStates.reserve(order.size());
+        for (uint32_t id : order) {
+            const auto& s = states_[id];
+            BlocklistState st{};
+            st.firstArc = static_cast<uint32_t>(outArcs.size());
+            st.arcCount = static_cast<uint16_t>(s.arcs.size());
+            st.flags = s.accepting ? 1 : 0;
+            outStates.push_back(st);
+            for (const auto& [label, target] : s.arcs) {
+                BlocklistArc arc{};
+                arc.label = label;
+                arc.target = remap[target];
+                outArcs.push_back(arc);
+            }
+        }
+    }
+
+    size_t Words() const { return words_; }
+
+private:
+    struct State {
+        bool accepting{false};
+        std::vector<std::pair<uint8_t, uint32_t>> arcs; // sorted by label (input is sorted)
+    };
+
+    void ReplaceOrRegister(uint32_t state) {
+        uint32_t child = states_[state].arcs.back().second;
+        if (!states_[child].arcs.empty()) ReplaceOrRegister(child);
+        std::string key = Signature(child);
+        auto it = register_.find(key);
+        if (it != register_.end()) {
+            states_[state].arcs.back().second = it->second;
+            states_[child].arcs.clear(); // orphaned; dropped by Finish()
+        } else {
+            register_.emplace(std::move(key), child);
+        }
+    }
+
+    std::string Signature(uint32_t state) const {
+        const auto& s = states_[state];
+        std::string key;
+        key.reserve(1 + s.arcs.size() * 5);
+        key.push_back(s.accepting ? 'F' : 'N');
+        for (const auto& [label, target] : s.arcs) {
+            key.push_back(static_cast<char>(label));
+            key.append(reinterpret_cast<const char*>(&target), sizeof(target));
+        }
+        return key;
+    }
+
+    std::vector<State> states_;
+    std::unordered_map<std::string, uint32_t> register_;
+    size_t words_{0};
+};
+
+// Read-only view over a mapped (or otherwise resident) .sfst image.
+class MappedBlocklist : public IBlocklist {
+public:
+    ~MappedBlocklist() override { Unmap(); }
+
+    bool Map(const std::string& path) {
+#ifdef _WIN32
+        int wlen = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring wpath(wlen > 0 ? wlen - 1 : 0, L'\0');
+        if (wlen > 0) MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, wpath.data(), wlen);
+        file_ = CreateFileW(wpath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size{};
+        if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) return false;
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) return false;
+        base_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+        if (!base_) return false;
+        size_ = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        base_ = p;
+        size_ = static_cast<size_t>(st.st_size);
+        madvise(base_, size_, MADV_RANDOM);
+#endif
+        return Validate();
+    }
+
+    bool Contains(std::string_view word) const override {
+        uint32_t state = header_->rootState;
+        for (char ch : word) {
+            const BlocklistState& s = states_[state];
+            const BlocklistArc* first = arcs_ + s.firstArc;
+            const BlocklistArc* last = first + s.arcCount;
+            const uint8_t label = static_cast<uint8_t>(ch);
+            const BlocklistArc* it = std::lower_bound(first, last, label,
+                [](const BlocklistArc& a, uint8_t l) { return a.label < l; });
+            if (it == last || it->label != label) return false;
+            state = it->target;
+        }
+        return (states_[state].flags & 1) != 0;
+    }
+
+    size_t Size() const override { return header_->wordCount; }
+
+    // Depth-first over the arcs. Validate() does not prove the file acyclic,
+    // so the walk stops after as many steps as a valid file of this word
+    // count could need.
+    void ForEachWord(const std::function<bool(std::string_view)>& visit) const override {
+        struct Frame {
+            uint32_t state;
+            uint32_t next; // arc index to follow next
+        };
+        std::vector<Frame> stack{{header_->rootState, states_[header_->rootState].firstArc}};
+        std::string word;
+        if ((states_[header_->rootState].flags & 1) && !visit(word)) return;
+        uint64_t budget = (uint64_t{header_->wordCount} + 1) * kMaxWalkDepth;
+        while (!stack.empty() && budget-- > 0) {
+            Frame& top = stack.back();
+            const BlocklistState& s = states_[top.state];
+            if (top.next == s.firstArc + s.arcCount || word.size() == kMaxWalkDepth) {
+                stack.pop_back();
+                if (!word.empty()) word.pop_back();
+                continue;
+            }
+            const BlocklistArc& arc = arcs_[top.next++];
+            word.push_back(static_cast<char>(arc.label));
+            stack.push_back({arc.target, states_[arc.target].firstArc});
+            if ((states_[arc.target].flags & 1) && !visit(word)) return;
+        }
+    }
+
+private:
+    bool Validate() {
+        if (size_ < sizeof(BlocklistHeader)) return false;
+        header_ = static_cast<const BlocklistHeader*>(base_);
+        if (std::memcmp(header_->magic, kBlocklistMagic, sizeof(kBlocklistMagic)) != 0) return false;
+        if (header_->version != kBlocklistVersion) return false;
+        const size_t need = sizeof(BlocklistHeader) +
+                            static_cast<size_t>(header_->stateCount) * sizeof(BlocklistState) +
+                            static_cast<size_t>(header_->arcCount) * sizeof(BlocklistArc);
+        if (size_ < need || header_->stateCount == 0 || header_->rootState >= header_->stateCount) return false;
+        const auto* bytes = static_cast<const uint8_t*>(base_);
+        states_ = reinterpret_cast<const BlocklistState*>(bytes + sizeof(BlocklistHeader));
+        arcs_ = reinterpret_cast<const BlocklistArc*>(bytes + sizeof(BlocklistHeader) +
+                                                      header_->stateCount * sizeof(BlocklistState));
+        // Contains() trusts every index it follows, so a corrupt file must
+        // fail here rather than send it out of bounds
+        for (uint32_t i = 0; i < header_->stateCount; ++i) {
+            const BlocklistState& state = states_[i];
+            if (uint64_t{state.firstArc} + state.arcCount > header_->arcCount) return false;
+            for (uint32_t a = state.firstArc; a < state.firstArc + state.arcCount; ++a) {
+                if (arcs_[a].target >= header_->stateCount) return false;
+                if (a > state.firstArc && arcs_[a].label <= arcs_[a - 1].label) return false; // lower_bound needs sorted labels
+            }
+        }
+        return true;
+    }
+
+    void Unmap() {
+#ifdef _WIN32
+        if (base_) UnmapViewOfFile(base_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (base_) munmap(base_, size_);
+#endif
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+#ifdef _WIN32
+    HANDLE file_{INVALID_HANDLE_VALUE};
+    HANDLE mapping_{nullptr};
+#endif
+    static constexpr size_t kMaxWalkDepth = 256;
+
+    void* base_{nullptr};
+    size_t size_{0};
+    const BlocklistHeader* header_{nullptr};
+    const BlocklistState* states_{nullptr};
+    const BlocklistArc* arcs_{nullptr};
+};
+
+} // namespace
+
+bool CompileBlocklist(std::vector<std::string> words, const std::string& outPath, BlocklistStats* stats) {
+    for (auto& w : words) {
+        std::transform(w.begin(), w.end(), w.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+    }
+    words.erase(std::remove_if(words.begin(), words.end(), [](const std::string& w) { return w.empty(); }),
+                words.end());
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    DawgBuilder builder;
+    for (const auto& w : words) builder.Add(w);
+    std::vector<BlocklistState> states;
+    std::vector<BlocklistArc> arcs;
+    builder.Finish(states, arcs);
+
+    BlocklistHeader header{};
+    std::memcpy(header.magic, kBlocklistMagic, sizeof(kBlocklistMagic));
+    header.version = kBlocklistVersion;
+    header.stateCount = static_cast<uint32_t>(states.size());
+    header.arcCount = static_cast<uint32_t>(arcs.size());
+    header.wordCount = static_cast<uint32_t>(builder.Words());
+    header.rootState = 0;
+
+    std::ofstream f(outPath, std::ios::binary | std::ios::trunc);
+    if (!f.is_open()) return false;
+    f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    f.write(reinterpret_cast<const char*>(states.data()), static_cast<std::streamsize>(states.size() * sizeof(BlocklistState)));
+    f.write(reinterpret_cast<const char*>(arcs.data()), static_cast<std::streamsize>(arcs.size() * sizeof(BlocklistArc)));
+    if (!f.good()) return false;
+
+    if (stats) {
+        stats->words = builder.Words();
+        stats->states = states.size();
+        stats->arcs = arcs.size();
+        stats->fileBytes = sizeof(header) + states.size() * sizeof(BlocklistState) + arcs.size() * sizeof(BlocklistArc);
+    }
+    return true;
+}
+
+std::unique_ptr<IBlocklist> OpenBlocklist(const std::string& path) {
+    auto list = std::make_unique<MappedBlocklist>();
+    if (!list->Map(path)) return nullptr;
+    return list;
+}
+
+}
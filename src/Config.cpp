@@ -1,4 +1,5 @@
 #include "Straf/Config.h"
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
@@ -23,6 +24,11 @@ std::optional<AppConfig> LoadConfig(const std::string& path) {
     if (auto it = j.find("words"); it != j.end() && it->is_array()) {
         for (const auto& w : *it) if (w.is_string()) cfg.words.push_back(w.get<std::string>());
     }
+    if (auto it = j.find("blocklist"); it != j.end() && it->is_string()) {
+        std::filesystem::path p = it->get<std::string>();
+        if (p.is_relative()) p = std::filesystem::path(path).parent_path() / p;
+        cfg.blocklist = p.string();
+    }
     if (auto it = j.find("penalty"); it != j.end() && it->is_object()) {
         const auto& p = *it;
         if (p.contains("durationSeconds")) cfg.penalty.durationSeconds = p.value("durationSeconds", cfg.penalty.durationSeconds);
@@ -34,6 +40,23 @@ std::optional<AppConfig> LoadConfig(const std::string& path) {
         if (a.contains("sampleRate")) cfg.audio.sampleRate = a.value("sampleRate", cfg.audio.sampleRate);
         if (a.contains("channels")) cfg.audio.channels = a.value("channels", cfg.audio.channels);
     }
+    if (auto it = j.find("detector"); it != j.end() && it->is_object()) {
+        const auto& d = *it;
+        if (d.contains("phraseWindowMs")) cfg.detector.phraseWindowMs = d.value("phraseWindowMs", cfg.detector.phraseWindowMs);
+        if (d.contains("silenceResetMs")) cfg.detector.silenceResetMs = d.value("silenceResetMs", cfg.detector.silenceResetMs);
+    }
+    if (auto it = j.find("logging"); it != j.end() && it->is_object()) {
+        const auto& l = *it;
+        if (l.contains("level")) cfg.logging.level = l.value("level", cfg.logging.level);
+    }
+    if (auto it = j.find("metrics"); it != j.end() && it->is_object()) {
+        const auto& m = *it;
+        if (m.contains("port")) cfg.metrics.port = m.value("port", cfg.metrics.port);
+    }
+    if (auto it = j.find("feed"); it != j.end() && it->is_object()) {
+        const auto& f = *it;
+        if (f.contains("name")) cfg.feed.name = f.value("name", cfg.feed.name);
+    }
 
     return cfg;
 }
@@ -0,0 +1,144 @@
+#include "Straf/ConfigWatcher.h"
+#include <optional>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include "Straf/WakeSignal.h"
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Straf {
+
+namespace {
+
+enum class Wake { Changed, Timeout, Stopped };
+
+}
+
+// Blocks the watcher thread until something in the directory may have changed.
+class ConfigWatcher::ChangeSource {
+public:
+#ifdef _WIN32
+    ~ChangeSource() {
+        if (change_ != INVALID_HANDLE_VALUE) FindCloseChangeNotification(change_);
+        if (stop_) CloseHandle(stop_);
+    }
+
+    bool Open(const fs::path& directory, std::chrono::milliseconds) {
+        change_ = FindFirstChangeNotificationW(directory.c_str(), FALSE,
+            FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE);
+        stop_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        return change_ != INVALID_HANDLE_VALUE && stop_;
+    }
+
+    // A change notification, `timeout` elapsed, or Stop().
+    Wake Wait(std::optional<std::chrono::milliseconds> timeout) {
+        const HANDLE handles[2] = {stop_, change_};
+        const DWORD r = WaitForMultipleObjects(2, handles, FALSE, timeout ? static_cast<DWORD>(timeout->count()) : INFINITE);
+        if (r == WAIT_OBJECT_0 + 1) {
+            FindNextChangeNotification(change_); // re-arm before the caller looks at the file
+            return Wake::Changed;
+        }
+        return r == WAIT_TIMEOUT ? Wake::Timeout : Wake::Stopped;
+    }
+
+    void Stop() { SetEvent(stop_); }
+
+private:
+    HANDLE change_{INVALID_HANDLE_VALUE};
+    HANDLE stop_{nullptr};
+#else
+    bool Open(const fs::path&, std::chrono::milliseconds pollInterval) {
+        poll_ = pollInterval;
+        return true;
+    }
+
+    // Without notifications every poll interval counts as a possible change.
+    Wake Wait(std::optional<std::chrono::milliseconds> timeout) {
+        wake_.WaitUntil(WakeSignal::clock::now() + timeout.value_or(poll_));
+        if (stop_.load(std::memory_order_acquire)) return Wake::Stopped;
+        return timeout ? Wake::Timeout : Wake::Changed;
+    }
+
+    void Stop() {
+        stop_.store(true, std::memory_order_release);
+        wake_.Notify();
+    }
+
+private:
+    std::chrono::milliseconds poll_{1000};
+    WakeSignal wake_;
+    std::atomic<bool> stop_{false};
+#endif
+};
+
+std::unique_ptr<ConfigWatcher> ConfigWatcher::Start(const fs::path& path, ReloadCallback onChange, ConfigWatchOptions options) {
+    std::unique_ptr<ConfigWatcher> watcher(new ConfigWatcher(path, std::move(onChange), options));
+    fs::path directory = path.parent_path();
+    if (directory.empty()) directory = ".";
+    if (!watcher->source_->Open(directory, options.pollInterval)) return nullptr;
+    watcher->thread_ = std::thread([w = watcher.get()]{ w->Run(); });
+    return watcher;
+}
+
+ConfigWatcher::ConfigWatcher(const fs::path& path, ReloadCallback onChange, ConfigWatchOptions options)
+    : path_(path), onChange_(std::move(onChange)), options_(options), source_(std::make_unique<ChangeSource>()) {}
+
+ConfigWatcher::~ConfigWatcher() {
+    if (thread_.joinable()) {
+        source_->Stop();
+        thread_.join();
+    }
+}
+
+ConfigWatcher::Stamp ConfigWatcher::StampOf(const fs::path& path) {
+    std::error_code ec;
+    Stamp s;
+    s.written = fs::last_write_time(path, ec);
+    if (ec) return {};
+    s.size = fs::file_size(path, ec);
+    if (ec) return {};
+    s.exists = true;
+    return s;
+}
+
+void ConfigWatcher::Run() {
+    Stamp seen = StampOf(path_);
+    for (;;) {
+        Wake wake = source_->Wait(std::nullopt);
+        if (wake == Wake::Stopped) return;
+        if (StampOf(path_) == seen) continue; // another file in the directory
+        // Let a multi-step save finish; every further change restarts the wait
+        while ((wake = source_->Wait(options_.debounce)) == Wake::Changed) {}
+        if (wake == Wake::Stopped) return;
+        seen = StampOf(path_);
+        if (!seen.exists) continue; // deleted or mid-rename; reload when it reappears
+        const auto start = clock::now();
+        const bool applied = onChange_();
+        Record(applied, clock::now() - start);
+    }
+}
+
+void ConfigWatcher::Record(bool applied, clock::duration latency) {
+    const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    (applied ? reloads_ : failures_).fetch_add(1, std::memory_order_relaxed);
+    lastLatencyNs_.store(ns, std::memory_order_relaxed);
+    totalLatencyNs_.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > maxLatencyNs_.load(std::memory_order_relaxed)) maxLatencyNs_.store(ns, std::memory_order_relaxed);
+}
+
+ConfigReloadStats ConfigWatcher::Stats() const {
+    ConfigReloadStats s;
+    s.reloads = reloads_.load(std::memory_order_relaxed);
+    s.failures = failures_.load(std::memory_order_relaxed);
+    s.lastLatency = std::chrono::nanoseconds(lastLatencyNs_.load(std::memory_order_relaxed));
+    s.maxLatency = std::chrono::nanoseconds(maxLatencyNs_.load(std::memory_order_relaxed));
+    if (const uint64_t attempts = s.reloads + s.failures; attempts > 0) {
+        s.meanLatency = std::chrono::nanoseconds(totalLatencyNs_.load(std::memory_order_relaxed) / static_cast<int64_t>(attempts));
+    }
+    return s;
+}
+
+}
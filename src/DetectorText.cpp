@@ -1,9 +1,18 @@
 #include "Straf/Detector.h"
+#include "Straf/Blocklist.h"
+#include "Straf/Metrics.h"
+#include "Straf/PatternRules.h"
+#include "Straf/PhraseMatcher.h"
+#include "Straf/Platform.h"
+#include "Straf/Rcu.h"
+#include "Straf/Trace.h"
+#include <spdlog/spdlog.h>
 #include <algorithm>
-#include <sstream>
+#include <atomic>
 #include <cctype>
-#include <set>
-#include <windows.h>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace Straf {
 
@@ -31,17 +40,55 @@ public:
     void Stop() override {}
 };
 
+// Tokens of one recognizer result. The strings are reused from call to call,
+// so tokenizing a result allocates nothing once they have grown.
+struct TokenList {
+    std::vector<std::string> tokens;
+    size_t count{0};
+
+    std::string& Append() {
+        if (count == tokens.size()) tokens.emplace_back();
+        std::string& token = tokens[count++];
+        token.clear();
+        return token;
+    }
+    const std::string& operator[](size_t i) const { return tokens[i]; }
+};
+
+// Everything matching depends on, compiled once and never modified after it
+// is published.
+struct CompiledVocabulary {
+    uint64_t generation{0};
+    PhraseStreamOptions options;
+    PhraseMatcher matcher;
+    PatternSet patterns;
+    std::vector<WordId> phraseIds; // by phrase index
+    std::vector<WordId> ruleIds;   // by pattern rule index
+};
+
 class TextAnalysisDetector : public ITextDetector {
 public:
+    explicit TextAnalysisDetector(PhraseStreamOptions options)
+        : options_(options), blocklistId_(Words().Intern("blocklist")),
+          detections_(metrics::Metrics().AddCounterFamily(
+              "straf_detections_total", "Detections by the vocabulary entry that fired.", "rule",
+              [](uint32_t id) { return std::string(Words().Name(id)); })),
+          latency_(metrics::Metrics().AddHistogram(
+              "straf_speech_to_detection_seconds",
+              "From arrival of the audio packet whose recognizer result produced a detection to the detection.",
+              {1e-5, 30.0})) {
+        vocabulary_.Publish(Compile({}, options_)); // analysis never sees an empty cell
+    }
+
     bool Initialize(const std::vector<std::string>& vocabulary) override {
-        vocabulary_.clear();
-        
-        // Convert vocabulary to lowercase for case-insensitive matching
-        for (const auto& word : vocabulary) {
-            std::string lowerWord = ToLowerCase(word);
-            vocabulary_.insert(lowerWord);
-        }
-        
+        vocabulary_.Publish(Compile(vocabulary, options_));
+        cursor_ = PhraseMatcher::Cursor{};
+        EndUtterance();
+        return true;
+    }
+
+    bool Reload(const std::vector<std::string>& vocabulary, PhraseStreamOptions options) override {
+        vocabulary_.Publish(Compile(vocabulary, options));
         return true;
     }
     
@@ -52,81 +99,212 @@ public:
     void Stop() override {
         onDetect_ = nullptr;
     }
+
+    void AttachBlocklist(std::unique_ptr<IBlocklist> blocklist) override {
+        if (blocklist) InternBlocklist(*blocklist);
+        blocklist_.Publish(std::move(blocklist));
+    }
     
-    // Method to analyze recognized text and detect vocabulary words
+    // Final results end the utterance: whatever the final changed or added
+    // relative to the partials is fed, and matcher state carries over to the
+    // next utterance.
     void AnalyzeText(const std::string& recognizedText, float confidence = 1.0f) override {
         if (!onDetect_ || recognizedText.empty()) return;
-        
-        
-        // Split text into words and check each against vocabulary
-        std::vector<std::string> words = SplitIntoWords(recognizedText);
-        
-        for (const auto& word : words) {
-            std::string lowerWord = ToLowerCase(word);
-            if (vocabulary_.count(lowerWord) > 0) {
-                onDetect_(DetectionResult{word, confidence});
-            }
-        }
+        trace::Span span("detect", "AnalyzeText");
+        span.Flow(trace::CurrentFlow());
+        FeedText(recognizedText, confidence, DetectionSource::Microphone);
+        EndUtterance();
+    }
+
+    // Partial hypotheses usually grow, but the recognizer may revise words it
+    // already reported; each call feeds the tokens after the part that still
+    // agrees with what was fed before.
+    void AnalyzePartial(const std::string& partialText, float confidence = 1.0f) override {
+        if (!onDetect_ || partialText.empty()) return;
+        trace::Span span("detect", "AnalyzePartial");
+        span.Flow(trace::CurrentFlow());
+        FeedText(partialText, confidence, DetectionSource::Partial);
     }
 
 private:
-    std::set<std::string> vocabulary_;
+    PhraseStreamOptions options_; // for Initialize()
+    const WordId blocklistId_;
+    // Swapped whole by Reload()/AttachBlocklist(); analysis pins the current
+    // ones for the duration of a call and never blocks on a reload.
+    RcuCell<CompiledVocabulary> vocabulary_;
+    RcuCell<IBlocklist> blocklist_;
+    std::atomic<uint64_t> generations_{0};
+
+    // Analysis thread only
+    PhraseMatcher::Cursor cursor_;
+    PhraseMatcher::Cursor utteranceStart_; // cursor_ before the current utterance's first token
+    uint64_t cursorGeneration_{0};         // vocabulary the cursor's state belongs to
+    TokenList fed_;                        // tokens of the current utterance fed so far
+    TokenList tokens_;                     // the result being analysed
+    std::vector<std::pair<size_t, WordId>> reported_; // (token index, word) emitted this utterance
+    bool tableFullWarned_{false};
     DetectionCallback onDetect_;
-    
-    // Convert string to lowercase
-    std::string ToLowerCase(const std::string& str) {
-        std::string result = str;
-        std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
-            return std::tolower(c);
-        });
-        return result;
+    metrics::CounterFamily& detections_;
+    metrics::Histogram& latency_;
+
+    // Single words and multi-word phrases share one token automaton;
+    // wildcard/regex entries compile into one DFA. Matching is case-insensitive.
+    std::unique_ptr<CompiledVocabulary> Compile(const std::vector<std::string>& vocabulary, PhraseStreamOptions options) {
+        auto compiled = std::make_unique<CompiledVocabulary>();
+        compiled->generation = generations_.fetch_add(1, std::memory_order_relaxed) + 1;
+        compiled->options = options;
+        std::vector<std::string> literals, patterns;
+        for (const auto& entry : vocabulary) {
+            (PatternSet::IsPattern(entry) ? patterns : literals).push_back(entry);
+        }
+        compiled->matcher.Build(literals);
+        // Intern everything that can be reported so detections carry ids only
+        for (size_t i = 0; i < compiled->matcher.PhraseCount(); ++i) {
+            compiled->phraseIds.push_back(Words().Intern(compiled->matcher.Phrase(i)));
+        }
+        std::vector<std::string> errors;
+        if (!compiled->patterns.Compile(patterns, &errors)) {
+            SPDLOG_WARN("Pattern rules disabled: {}", errors.empty() ? std::string("compile failed") : errors.back());
+        } else {
+            for (const auto& e : errors) SPDLOG_WARN("Skipping pattern rule {}", e);
+        }
+        for (size_t i = 0; i < compiled->patterns.RuleCount(); ++i) {
+            compiled->ruleIds.push_back(Words().Intern(compiled->patterns.Rule(i)));
+        }
+        return compiled;
     }
-    
-    // Split text into individual words, removing punctuation
-    std::vector<std::string> SplitIntoWords(const std::string& text) {
-        std::vector<std::string> words;
-        std::string cleanText = RemovePunctuation(text);
-        std::istringstream iss(cleanText);
-        std::string word;
-        
-        while (iss >> word) {
-            if (!word.empty()) {
-                words.push_back(word);
+
+    static bool IsWordChar(unsigned char c) {
+        // Bytes >= 0x80 belong to multi-byte UTF-8 sequences; keep them in the token.
+        return std::isalnum(c) || c >= 0x80;
+    }
+
+    // Splits text into lowercase tokens; punctuation separates words.
+    static void Tokenize(const std::string& text, TokenList& out) {
+        out.count = 0;
+        size_t i = 0;
+        while (i < text.size()) {
+            while (i < text.size() && !IsWordChar(static_cast<unsigned char>(text[i]))) ++i;
+            if (i >= text.size()) break;
+            std::string& token = out.Append();
+            while (i < text.size() && IsWordChar(static_cast<unsigned char>(text[i]))) {
+                token.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(text[i]))));
+                ++i;
             }
         }
-        
-        return words;
     }
-    
-    // Remove common punctuation from text
-    std::string RemovePunctuation(const std::string& text) {
-        std::string result;
-        for (char c : text) {
-            if (std::isalnum(c) || std::isspace(c)) {
-                result += c;
-            } else {
-                result += ' ';  // Replace punctuation with space
-            }
+
+    // Feeds the tokens of `text` that differ from what this utterance has fed
+    // so far. When the recognizer revised a token already fed, the cursor
+    // rewinds to the start of the utterance and replays the unchanged prefix
+    // without reporting it again. The whole text is matched against one
+    // vocabulary, even if a reload lands meanwhile.
+    void FeedText(const std::string& text, float confidence, DetectionSource source) {
+        const auto vocabulary = vocabulary_.Read();
+        const auto blocklist = blocklist_.Read();
+        if (vocabulary->generation != cursorGeneration_) {
+            // Cursor states index the previous automaton
+            cursor_ = PhraseMatcher::Cursor{};
+            utteranceStart_ = PhraseMatcher::Cursor{};
+            cursorGeneration_ = vocabulary->generation;
+        }
+        if (fed_.count == 0) utteranceStart_ = cursor_;
+        Tokenize(text, tokens_);
+
+        size_t common = 0;
+        while (common < fed_.count && common < tokens_.count && fed_[common] == tokens_[common]) ++common;
+        const auto now = PhraseMatcher::clock::now();
+        if (common < fed_.count) {
+            cursor_ = utteranceStart_;
+            for (size_t i = 0; i < common; ++i) FeedToken(*vocabulary, blocklist.get(), i, now, confidence, source, false);
+        }
+        for (size_t i = common; i < tokens_.count; ++i) FeedToken(*vocabulary, blocklist.get(), i, now, confidence, source, true);
+        std::swap(fed_, tokens_);
+    }
+
+    void EndUtterance() {
+        fed_.count = 0;
+        reported_.clear();
+    }
+
+    // `index` is the token's position in the utterance; a word already
+    // reported at that position is not reported again after a revision.
+    void FeedToken(const CompiledVocabulary& vocabulary, const IBlocklist* blocklist, size_t index,
+                   PhraseMatcher::clock::time_point now, float confidence, DetectionSource source, bool report) {
+        const std::string& token = tokens_[index];
+        const auto emit = [&](WordId word, WordId rule) {
+            if (!report) return;
+            const std::pair<size_t, WordId> key{index, word};
+            if (std::find(reported_.begin(), reported_.end(), key) != reported_.end()) return;
+            reported_.push_back(key);
+            Emit(DetectionResult{word, confidence, rule, source});
+        };
+        bool wordMatched = false;
+        const PhraseMatcher& matcher = vocabulary.matcher;
+        matcher.Feed(cursor_, token, now, vocabulary.options.window, vocabulary.options.silenceReset, [&](size_t phrase) {
+            wordMatched = wordMatched || matcher.PhraseLength(phrase) == 1;
+            emit(vocabulary.phraseIds[phrase], vocabulary.phraseIds[phrase]);
+        });
+        // Patterns and the blocklist keep no state, so a replayed token skips them
+        if (wordMatched || !report) return;
+        if (int rule = vocabulary.patterns.Match(token); rule >= 0) {
+            const WordId ruleId = vocabulary.ruleIds[static_cast<size_t>(rule)];
+            emit(TokenWord(token, ruleId), ruleId);
+        } else if (blocklist && blocklist->Contains(token)) {
+            emit(TokenWord(token, blocklistId_), blocklistId_);
+        }
+    }
+
+    // Blocklist words were interned when the list was attached, and a pattern
+    // hit seen before is found without the table lock; only the first sight
+    // of a pattern-matched word interns it. Once the table is full such a
+    // word is reported under its rule's name instead.
+    WordId TokenWord(const std::string& token, WordId rule) {
+        if (WordId word = Words().Intern(token); word != kNoWord) return word;
+        if (!tableFullWarned_) {
+            tableFullWarned_ = true;
+            SPDLOG_WARN("Word table full ({} words); new matches are reported by rule, e.g. '{}' as '{}'",
+                        WordTable::kCapacity, token, Words().Name(rule));
+        }
+        return rule;
+    }
+
+    // Runs on the thread attaching the list, so analysis only ever looks the
+    // words up. A list too large to share the table with runtime words (more
+    // than half of what is left) keeps its words to be interned on first hit.
+    static void InternBlocklist(const IBlocklist& blocklist) {
+        const size_t room = WordTable::kCapacity - Words().Size();
+        if (blocklist.Size() > room / 2) {
+            SPDLOG_INFO("Blocklist has {} words, more than the word table can hold up front; interning them on first hit",
+                        blocklist.Size());
+            return;
         }
-        return result;
+        blocklist.ForEachWord([](std::string_view word) { return Words().Intern(word) != kNoWord; });
+    }
+
+    void Emit(const DetectionResult& result) {
+        detections_.Inc(result.rule);
+        const auto arrived = metrics::CurrentAudioArrival();
+        if (arrived.time_since_epoch().count() != 0) latency_.Observe(std::chrono::steady_clock::now() - arrived);
+        onDetect_(result);
     }
 };
 
 // Factory function for text analysis detector
-std::unique_ptr<ITextDetector> CreateTextAnalysisDetector() {
-    return std::make_unique<TextAnalysisDetector>();
+std::unique_ptr<ITextDetector> CreateTextAnalysisDetector(PhraseStreamOptions options) {
+    return std::make_unique<TextAnalysisDetector>(options);
 }
 
 // Extend the existing factory to provide the new detector
 std::unique_ptr<IDetector> CreateDetectorStub() { 
     // Check for explicit no-detector mode
-    wchar_t dummy[2]{};
-    if (GetEnvironmentVariableW(L"STRAF_NO_DETECTOR", dummy, 2) > 0) {
+    const IEnvironment& env = SystemEnvironment();
+    if (env.IsSet("STRAF_NO_DETECTOR")) {
         return std::make_unique<DetectorNoop>();
     }
     
     // Check if we should use the old stub detector for testing
-    if (GetEnvironmentVariableW(L"STRAF_USE_STUB_DETECTOR", dummy, 2) > 0) {
+    if (env.IsSet("STRAF_USE_STUB_DETECTOR")) {
         return std::make_unique<DetectorStub>();
     }
     
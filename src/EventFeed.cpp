@@ -0,0 +1,406 @@
+#include "Straf/EventFeed.h"
+#include "Straf/Platform.h"
+#include "Straf/SharedMemory.h"
+#include "Straf/WordTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace Straf::feed {
+
+namespace detail {
+
+// One record: a seqlock word, then the payload as atomic words so readers in
+// other processes never race on plain memory.
+struct alignas(64) Slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> words[7];
+};
+
+struct alignas(64) ReaderSlot {
+    std::atomic<uint64_t> pid{0}; // 0 = free; taken over when its process is gone
+    std::atomic<uint64_t> position{0};
+    std::atomic<uint64_t> overruns{0};
+    std::atomic<uint32_t> waiting{0}; // set by a reader about to sleep, cleared by the writer waking it
+    std::atomic<uint32_t> wake{0};    // futex word, bumped per wakeup
+};
+
+// Mapped at offset 0, followed by `capacity` Slots. `magic` is stored last
+// when the writer sets the ring up.
+struct Ring {
+    std::atomic<uint32_t> magic{0};
+    uint32_t version{0};
+    uint32_t recordSize{0};
+    uint32_t capacity{0};
+    uint64_t writerPid{0};
+    std::atomic<uint32_t> generation{0}; // bumped when a writer takes the ring over
+    std::atomic<uint32_t> closed{0};
+    alignas(64) std::atomic<uint64_t> head{0}; // records claimed so far
+    Slot state;                                // latest Penalty/Status/Hidden
+    ReaderSlot readers[kMaxReaders];
+
+    Slot* Slots() { return reinterpret_cast<Slot*>(this + 1); }
+    const Slot* Slots() const { return reinterpret_cast<const Slot*>(this + 1); }
+};
+
+static_assert(sizeof(Slot) == 64);
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "the ring is shared between processes and needs address-free atomics");
+
+} // namespace detail
+
+namespace {
+
+using detail::Ring;
+using detail::Slot;
+
+constexpr uint32_t kMagic = 0x44465453; // "STFD"
+using platform::kNoSharedHandle;
+
+size_t RoundUpPow2(size_t n) {
+    size_t p = 64;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+size_t RingBytes(size_t capacity) { return sizeof(Ring) + capacity * sizeof(Slot); }
+
+// Shared memory object and per-reader-slot event names, before the platform prefix.
+std::string RegionName(const std::string& name) { return name + ".feed"; }
+std::string EventName(const std::string& name, size_t slot) { return RegionName(name) + "." + std::to_string(slot); }
+
+// --- Records --------------------------------------------------------------
+
+void Pack(const Record& r, uint64_t (&words)[7]) {
+    uint32_t confidence = 0;
+    std::memcpy(&confidence, &r.confidence, sizeof confidence);
+    words[0] = static_cast<uint64_t>(r.unixNanos);
+    words[1] = static_cast<uint64_t>(r.kind) | (static_cast<uint64_t>(r.source) << 8) |
+               (static_cast<uint64_t>(r.stars) << 16) | (static_cast<uint64_t>(confidence) << 32);
+    std::memcpy(&words[2], r.word, kWordBytes);
+}
+
+void Unpack(const uint64_t (&words)[7], Record& r) {
+    r.unixNanos = static_cast<int64_t>(words[0]);
+    r.kind = static_cast<Kind>(words[1] & 0xff);
+    r.source = static_cast<DetectionSource>((words[1] >> 8) & 0xff);
+    r.stars = static_cast<uint8_t>((words[1] >> 16) & 0xff);
+    const uint32_t confidence = static_cast<uint32_t>(words[1] >> 32);
+    std::memcpy(&r.confidence, &confidence, sizeof confidence);
+    std::memcpy(r.word, &words[2], kWordBytes);
+}
+
+void WriteSlot(Slot& s, uint64_t n, const Record& r) {
+    uint64_t words[7];
+    Pack(r, words);
+    s.seq.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < 7; ++i) s.words[i].store(words[i], std::memory_order_relaxed);
+    s.seq.store(2 * n + 2, std::memory_order_release);
+}
+
+enum class SlotRead { Ok, NotYet, Overwritten };
+
+SlotRead ReadSlot(const Slot& s, uint64_t n, Record& out) {
+    const uint64_t seq = s.seq.load(std::memory_order_acquire);
+    if (seq < 2 * n + 2) return SlotRead::NotYet; // being written, or still the previous lap
+    if (seq > 2 * n + 2) return SlotRead::Overwritten;
+    uint64_t words[7];
+    for (size_t i = 0; i < 7; ++i) words[i] = s.words[i].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (s.seq.load(std::memory_order_relaxed) != seq) return SlotRead::Overwritten;
+    Unpack(words, out);
+    out.seq = n;
+    return SlotRead::Ok;
+}
+
+void SetWord(Record& r, WordId word) {
+    if (word == kNoWord) return;
+    const std::string_view name = Words().Name(word);
+    size_t len = std::min(name.size(), kWordBytes - 1);
+    while (len > 0 && len < name.size() && (static_cast<unsigned char>(name[len]) & 0xC0) == 0x80) --len;
+    std::memcpy(r.word, name.data(), len);
+}
+
+int64_t UnixNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+class FeedOverlay final : public IOverlayRenderer {
+public:
+    FeedOverlay(std::unique_ptr<IOverlayRenderer> inner, FeedWriter& writer) : inner_(std::move(inner)), writer_(writer) {}
+
+    bool Initialize() override { return inner_->Initialize(); }
+    void ShowPenalty(WordId word) override {
+        inner_->ShowPenalty(word);
+        writer_.PublishState(Kind::Penalty, word, stars_);
+    }
+    void UpdateStatus(int stars, WordId word) override {
+        inner_->UpdateStatus(stars, word);
+        stars_ = std::clamp(stars, 0, 5);
+        writer_.PublishState(Kind::Status, word, stars_);
+    }
+    void Hide() override {
+        inner_->Hide();
+        writer_.PublishState(Kind::Hidden, kNoWord, stars_);
+    }
+    OverlayFrameStats GetFrameStats() const override { return inner_->GetFrameStats(); }
+
+private:
+    std::unique_ptr<IOverlayRenderer> inner_;
+    FeedWriter& writer_;
+    int stars_{0}; // penalty manager thread only, like every overlay call
+};
+
+} // namespace
+
+std::string SharedMemoryName(const std::string& name) { return platform::SharedObjectName(RegionName(name)); }
+
+std::string ControlAddress(const std::string& name) {
+#ifdef _WIN32
+    return "\\\\.\\pipe\\" + name;
+#else
+    if (const auto dir = SystemEnvironment().Get("XDG_RUNTIME_DIR"); dir && !dir->empty()) return *dir + "/" + name + ".sock";
+    return "/tmp/" + name + "-" + std::to_string(getuid()) + ".sock";
+#endif
+}
+
+// --- Writer ----------------------------------------------------------------
+
+std::unique_ptr<FeedWriter> FeedWriter::Create(const std::string& name, size_t capacity) {
+    capacity = RoundUpPow2(capacity);
+    const size_t bytes = RingBytes(capacity);
+    // A feed of this name left by an agent that is gone, or owned by a running one
+    const intptr_t handle = platform::CreateSharedMemory(RegionName(name), bytes, [](void* view, size_t oldBytes) {
+        if (oldBytes < sizeof(Ring)) return true;
+        Ring* old = static_cast<Ring*>(view);
+        if (old->magic.load(std::memory_order_acquire) == kMagic && platform::ProcessAlive(old->writerPid) &&
+            old->writerPid != platform::ProcessId()) {
+            return false;
+        }
+        // Readers still attached to it see the ring close
+        old->closed.store(1, std::memory_order_release);
+        old->generation.fetch_add(1, std::memory_order_acq_rel);
+        return true;
+    });
+    if (handle == kNoSharedHandle) return nullptr;
+    Ring* ring = static_cast<Ring*>(platform::MapSharedMemory(handle, bytes));
+    if (!ring) {
+        platform::CloseSharedMemory(handle);
+        return nullptr;
+    }
+    const uint32_t generation = ring->generation.load(std::memory_order_relaxed);
+    ring->magic.store(0, std::memory_order_relaxed);
+    std::memset(static_cast<void*>(ring->Slots()), 0, capacity * sizeof(Slot));
+    ring->state.seq.store(0, std::memory_order_relaxed);
+    for (auto& r : ring->readers) r.pid.store(0, std::memory_order_relaxed);
+    ring->version = kLayoutVersion;
+    ring->recordSize = sizeof(Slot);
+    ring->capacity = static_cast<uint32_t>(capacity);
+    ring->writerPid = platform::ProcessId();
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->closed.store(0, std::memory_order_relaxed);
+    ring->generation.store(generation + 1, std::memory_order_relaxed);
+    ring->magic.store(kMagic, std::memory_order_release);
+    return std::unique_ptr<FeedWriter>(new FeedWriter(name, ring, bytes, handle, generation + 1));
+}
+
+FeedWriter::FeedWriter(std::string name, detail::Ring* ring, size_t bytes, intptr_t handle, uint32_t generation)
+    : name_(std::move(name)), ring_(ring), bytes_(bytes), handle_(handle), generation_(generation) {
+    for (size_t i = 0; i < kMaxReaders; ++i) events_.push_back(platform::OpenSharedEvent(EventName(name_, i)));
+}
+
+FeedWriter::~FeedWriter() {
+    // A writer that took the name over has already closed this ring and owns
+    // the name (and, on Windows, possibly this very region) now
+    const bool owner = ring_->generation.load(std::memory_order_acquire) == generation_;
+    if (owner) {
+        ring_->closed.store(1, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (size_t i = 0; i < kMaxReaders; ++i) {
+            if (ring_->readers[i].waiting.exchange(0, std::memory_order_acq_rel)) platform::WakeWord(ring_->readers[i].wake, events_[i]);
+        }
+    }
+    for (const intptr_t event : events_) platform::CloseSharedEvent(event);
+    platform::UnmapSharedMemory(ring_, bytes_);
+    platform::CloseSharedMemory(handle_);
+    if (owner) platform::RemoveSharedMemory(RegionName(name_));
+}
+
+size_t FeedWriter::Capacity() const { return ring_->capacity; }
+
+void FeedWriter::PublishDetection(WordId word, float confidence, DetectionSource source) {
+    Record r;
+    r.kind = Kind::Detection;
+    r.source = source;
+    r.confidence = confidence;
+    SetWord(r, word);
+    Publish(r);
+}
+
+void FeedWriter::PublishState(Kind kind, WordId word, int stars) {
+    Record r;
+    r.kind = kind;
+    r.stars = static_cast<uint8_t>(std::clamp(stars, 0, 255));
+    SetWord(r, word);
+    Publish(r);
+    stars_.store(r.stars, std::memory_order_relaxed);
+    // Its own seqlock count; only this thread writes the state slot
+    WriteSlot(ring_->state, ring_->state.seq.load(std::memory_order_relaxed) / 2, r);
+}
+
+void FeedWriter::Publish(Record& r) {
+    r.unixNanos = UnixNanos();
+    const uint64_t n = ring_->head.fetch_add(1, std::memory_order_acq_rel);
+    r.seq = n;
+    WriteSlot(ring_->Slots()[n & (ring_->capacity - 1)], n, r);
+    WakeReaders();
+}
+
+void FeedWriter::WakeReaders() {
+    // Pairs with the fence in FeedReader::Wait(): either the reader sees the
+    // record before sleeping, or this sees it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (size_t i = 0; i < kMaxReaders; ++i) {
+        auto& reader = ring_->readers[i];
+        if (reader.waiting.load(std::memory_order_relaxed) && reader.waiting.exchange(0, std::memory_order_acq_rel)) {
+            platform::WakeWord(reader.wake, events_[i]);
+            wakeups_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+WriterStats FeedWriter::GetStats() const {
+    WriterStats s;
+    s.published = ring_->head.load(std::memory_order_relaxed);
+    s.wakeups = wakeups_.load(std::memory_order_relaxed);
+    s.stars = stars_.load(std::memory_order_relaxed);
+    return s;
+}
+
+std::vector<ReaderInfo> FeedWriter::Readers() const {
+    std::vector<ReaderInfo> out;
+    for (const auto& reader : ring_->readers) {
+        const uint64_t pid = reader.pid.load(std::memory_order_acquire);
+        if (pid == 0 || !platform::ProcessAlive(pid)) continue;
+        out.push_back({pid, reader.position.load(std::memory_order_relaxed), reader.overruns.load(std::memory_order_relaxed)});
+    }
+    return out;
+}
+
+// --- Reader ----------------------------------------------------------------
+
+std::unique_ptr<FeedReader> FeedReader::Open(const std::string& name, bool fromOldest) {
+    const intptr_t handle = platform::OpenSharedMemory(RegionName(name));
+    if (handle == kNoSharedHandle) return nullptr;
+    const size_t bytes = platform::SharedMemoryBytes(handle);
+    Ring* ring = bytes >= sizeof(Ring) ? static_cast<Ring*>(platform::MapSharedMemory(handle, bytes)) : nullptr;
+    if (!ring || ring->magic.load(std::memory_order_acquire) != kMagic || ring->version != kLayoutVersion ||
+        ring->recordSize != sizeof(Slot) || RingBytes(ring->capacity) > bytes) {
+        if (ring) platform::UnmapSharedMemory(ring, bytes);
+        platform::CloseSharedMemory(handle);
+        return nullptr;
+    }
+    const uint64_t me = platform::ProcessId();
+    for (size_t i = 0; i < kMaxReaders; ++i) {
+        auto& reader = ring->readers[i];
+        uint64_t pid = reader.pid.load(std::memory_order_acquire);
+        if (pid != 0 && (pid == me || platform::ProcessAlive(pid))) continue;
+        if (!reader.pid.compare_exchange_strong(pid, me, std::memory_order_acq_rel)) continue;
+        reader.waiting.store(0, std::memory_order_relaxed);
+        reader.overruns.store(0, std::memory_order_relaxed);
+        auto out = std::unique_ptr<FeedReader>(new FeedReader(ring, bytes, handle, i, platform::OpenSharedEvent(EventName(name, i))));
+        const uint64_t head = ring->head.load(std::memory_order_acquire);
+        out->position_ = head;
+        if (fromOldest) out->position_ = head > ring->capacity ? head - ring->capacity : 0;
+        reader.position.store(out->position_, std::memory_order_relaxed);
+        return out;
+    }
+    platform::UnmapSharedMemory(ring, bytes);
+    platform::CloseSharedMemory(handle);
+    return nullptr;
+}
+
+FeedReader::FeedReader(detail::Ring* ring, size_t bytes, intptr_t handle, size_t slot, intptr_t event)
+    : ring_(ring), bytes_(bytes), handle_(handle), slot_(slot), event_(event),
+      generation_(ring->generation.load(std::memory_order_acquire)) {}
+
+FeedReader::~FeedReader() {
+    ring_->readers[slot_].pid.store(0, std::memory_order_release);
+    platform::CloseSharedEvent(event_);
+    platform::UnmapSharedMemory(ring_, bytes_);
+    platform::CloseSharedMemory(handle_);
+}
+
+bool FeedReader::Next(Record& out) {
+    const uint64_t capacity = ring_->capacity;
+    for (;;) {
+        switch (ReadSlot(ring_->Slots()[position_ & (capacity - 1)], position_, out)) {
+        case SlotRead::Ok:
+            ++position_;
+            ring_->readers[slot_].position.store(position_, std::memory_order_relaxed);
+            return true;
+        case SlotRead::NotYet:
+            return false;
+        case SlotRead::Overwritten: {
+            // Lapped: resume at the oldest record still in the ring
+            const uint64_t head = ring_->head.load(std::memory_order_acquire);
+            const uint64_t oldest = head > capacity ? head - capacity : 0;
+            overruns_ += oldest - position_;
+            position_ = oldest;
+            ring_->readers[slot_].overruns.store(overruns_, std::memory_order_relaxed);
+            break;
+        }
+        }
+    }
+}
+
+bool FeedReader::Ready() const {
+    const Slot& s = ring_->Slots()[position_ & (ring_->capacity - 1)];
+    return s.seq.load(std::memory_order_acquire) >= 2 * position_ + 2;
+}
+
+bool FeedReader::Wait(std::chrono::milliseconds timeout) {
+    if (Ready()) return true;
+    if (Closed()) return false;
+    auto& me = ring_->readers[slot_];
+    const uint32_t seen = me.wake.load(std::memory_order_acquire);
+    me.waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst); // see FeedWriter::WakeReaders()
+    if (!Ready() && !Closed()) platform::WaitOnWord(me.wake, seen, timeout, event_);
+    me.waiting.store(0, std::memory_order_relaxed);
+    return Ready();
+}
+
+std::optional<Record> FeedReader::State() const {
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        const uint64_t seq = ring_->state.seq.load(std::memory_order_acquire);
+        if (seq == 0) return std::nullopt;
+        if (seq & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        Record r;
+        if (ReadSlot(ring_->state, seq / 2 - 1, r) == SlotRead::Ok) {
+            r.seq = 0; // not a feed position
+            return r;
+        }
+    }
+    return std::nullopt;
+}
+
+bool FeedReader::Closed() const {
+    return ring_->closed.load(std::memory_order_acquire) != 0 || ring_->generation.load(std::memory_order_acquire) != generation_;
+}
+
+std::unique_ptr<IOverlayRenderer> PublishingOverlay(std::unique_ptr<IOverlayRenderer> inner, FeedWriter& writer) {
+    return std::make_unique<FeedOverlay>(std::move(inner), writer);
+}
+
+} // namespace Straf::feed
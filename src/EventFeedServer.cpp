@@ -0,0 +1,266 @@
+#include "Straf/EventFeed.h"
+#include "Straf/Platform.h"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Straf::feed {
+
+namespace {
+
+constexpr size_t kMaxRequest = 256;
+
+std::string Trim(std::string s) {
+    while (!s.empty() && (s.back() == '\n' || s.back() == '\r' || s.back() == ' ')) s.pop_back();
+    return s;
+}
+
+std::string Answer(const FeedWriter& writer, const std::string& command) {
+    const WriterStats stats = writer.GetStats();
+    nlohmann::json reply;
+    if (command == "subscribe") {
+        reply["shm"] = SharedMemoryName(writer.Name());
+        reply["version"] = kLayoutVersion;
+        reply["recordSize"] = 64;
+        reply["capacity"] = writer.Capacity();
+        reply["head"] = stats.published;
+        reply["stars"] = stats.stars;
+    } else if (command == "status") {
+        reply["pid"] = platform::ProcessId();
+        reply["published"] = stats.published;
+        reply["wakeups"] = stats.wakeups;
+        reply["capacity"] = writer.Capacity();
+        reply["stars"] = stats.stars;
+        auto& readers = reply["readers"] = nlohmann::json::array();
+        for (const ReaderInfo& r : writer.Readers()) {
+            readers.push_back({{"pid", r.pid},
+                               {"position", r.position},
+                               {"lag", stats.published > r.position ? stats.published - r.position : 0},
+                               {"overruns", r.overruns}});
+        }
+    } else {
+        reply["error"] = "unknown command; use subscribe or status";
+    }
+    return reply.dump() + "\n";
+}
+
+#ifdef _WIN32
+
+std::wstring Wide(const std::string& s) { return std::wstring(s.begin(), s.end()); }
+
+class PipeFeedServer final : public FeedServer {
+public:
+    explicit PipeFeedServer(FeedWriter& writer) : writer_(writer), path_(Wide(ControlAddress(writer.Name()))) {}
+
+    ~PipeFeedServer() override {
+        stop_ = true;
+        // Wakes the blocked ConnectNamedPipe()
+        HANDLE self = CreateFileW(path_.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (self != INVALID_HANDLE_VALUE) CloseHandle(self);
+        if (worker_.joinable()) worker_.join();
+    }
+
+    bool Listen() {
+        // One instance: requests are served one at a time, like the metrics endpoint
+        pipe_ = CreateNamedPipeW(path_.c_str(), PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                 PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 4096, 4096,
+                                 2000, nullptr);
+        if (pipe_ == INVALID_HANDLE_VALUE) return false;
+        worker_ = std::thread([this]{ Run(); });
+        return true;
+    }
+
+    uint64_t Requests() const override { return requests_.load(std::memory_order_relaxed); }
+
+private:
+    void Run() {
+        platform::SetCurrentThreadName("feed control");
+        while (!stop_) {
+            const bool connected = ConnectNamedPipe(pipe_, nullptr) || GetLastError() == ERROR_PIPE_CONNECTED;
+            if (connected && !stop_) Serve();
+            DisconnectNamedPipe(pipe_);
+        }
+        CloseHandle(pipe_);
+    }
+
+    void Serve() {
+        std::string request;
+        char buf[kMaxRequest];
+        DWORD got = 0;
+        while (request.find('\n') == std::string::npos && request.size() < kMaxRequest &&
+               ReadFile(pipe_, buf, sizeof buf, &got, nullptr) && got > 0) {
+            request.append(buf, got);
+        }
+        const std::string reply = Answer(writer_, Trim(request.substr(0, request.find('\n'))));
+        requests_.fetch_add(1, std::memory_order_relaxed); // before the client can see the reply
+        DWORD written = 0;
+        WriteFile(pipe_, reply.data(), static_cast<DWORD>(reply.size()), &written, nullptr);
+        FlushFileBuffers(pipe_);
+    }
+
+    FeedWriter& writer_;
+    std::wstring path_;
+    HANDLE pipe_{INVALID_HANDLE_VALUE};
+    std::thread worker_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> requests_{0};
+};
+
+#else
+
+bool Address(const std::string& path, sockaddr_un& addr) {
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) return false;
+    path.copy(addr.sun_path, path.size());
+    return true;
+}
+
+void SetTimeouts(int s, std::chrono::milliseconds timeout) {
+    timeval tv{static_cast<time_t>(timeout.count() / 1000), static_cast<suseconds_t>(timeout.count() % 1000 * 1000)};
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+    setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv);
+}
+
+class SocketFeedServer final : public FeedServer {
+public:
+    explicit SocketFeedServer(FeedWriter& writer) : writer_(writer), path_(ControlAddress(writer.Name())) {}
+
+    ~SocketFeedServer() override {
+        if (listen_ < 0) return;
+        stop_ = true;
+        shutdown(listen_, SHUT_RDWR); // wakes the blocked accept()
+        if (worker_.joinable()) worker_.join();
+        close(listen_);
+        unlink(path_.c_str());
+    }
+
+    bool Listen() {
+        sockaddr_un addr;
+        if (!Address(path_, addr)) return false;
+        listen_ = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_ < 0) return false;
+        // The feed writer already owns the name, so a socket file left here
+        // belongs to an agent that is gone
+        unlink(path_.c_str());
+        const mode_t mask = umask(0077); // user only, like the ring
+        const bool bound = bind(listen_, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0;
+        umask(mask);
+        if (!bound || listen(listen_, 8) != 0) {
+            close(listen_);
+            listen_ = -1;
+            return false;
+        }
+        worker_ = std::thread([this]{ Run(); });
+        return true;
+    }
+
+    uint64_t Requests() const override { return requests_.load(std::memory_order_relaxed); }
+
+private:
+    void Run() {
+        platform::SetCurrentThreadName("feed control");
+        while (!stop_) {
+            const int client = accept(listen_, nullptr, nullptr);
+            if (client < 0) {
+                if (stop_) break;
+                continue;
+            }
+            Serve(client);
+            close(client);
+        }
+    }
+
+    // A client that stalls gets dropped.
+    void Serve(int client) {
+        SetTimeouts(client, std::chrono::milliseconds(2000));
+        std::string request;
+        char buf[kMaxRequest];
+        while (request.find('\n') == std::string::npos && request.size() < kMaxRequest) {
+            const auto got = recv(client, buf, sizeof buf, 0);
+            if (got <= 0) break;
+            request.append(buf, static_cast<size_t>(got));
+        }
+        const std::string reply = Answer(writer_, Trim(request.substr(0, request.find('\n'))));
+        requests_.fetch_add(1, std::memory_order_relaxed); // before the client can see the reply
+        send(client, reply.data(), reply.size(), MSG_NOSIGNAL);
+    }
+
+    FeedWriter& writer_;
+    std::string path_;
+    int listen_{-1};
+    std::thread worker_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> requests_{0};
+};
+
+#endif
+
+} // namespace
+
+std::unique_ptr<FeedServer> StartFeedServer(FeedWriter& writer) {
+#ifdef _WIN32
+    auto server = std::make_unique<PipeFeedServer>(writer);
+#else
+    auto server = std::make_unique<SocketFeedServer>(writer);
+#endif
+    if (!server->Listen()) return nullptr;
+    return server;
+}
+
+std::optional<std::string> QueryFeed(const std::string& name, const std::string& command, std::chrono::milliseconds timeout) {
+    const std::string request = command + "\n";
+    std::string reply;
+#ifdef _WIN32
+    const std::wstring path = Wide(ControlAddress(name));
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+    for (;;) {
+        pipe = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (pipe != INVALID_HANDLE_VALUE || GetLastError() != ERROR_PIPE_BUSY) break;
+        // The one instance is serving another client, or was taken between
+        // WaitNamedPipeW() and CreateFileW(): wait for it again
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (left.count() <= 0 || !WaitNamedPipeW(path.c_str(), static_cast<DWORD>(left.count()))) break;
+    }
+    if (pipe == INVALID_HANDLE_VALUE) return std::nullopt;
+    DWORD io = 0;
+    if (WriteFile(pipe, request.data(), static_cast<DWORD>(request.size()), &io, nullptr)) {
+        char buf[4096];
+        while (reply.find('\n') == std::string::npos && ReadFile(pipe, buf, sizeof buf, &io, nullptr) && io > 0) reply.append(buf, io);
+    }
+    CloseHandle(pipe);
+#else
+    sockaddr_un addr;
+    if (!Address(ControlAddress(name), addr)) return std::nullopt;
+    const int s = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s < 0) return std::nullopt;
+    SetTimeouts(s, timeout);
+    if (connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0 &&
+        send(s, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size())) {
+        char buf[4096];
+        for (ssize_t got; reply.find('\n') == std::string::npos && (got = recv(s, buf, sizeof buf, 0)) > 0;) {
+            reply.append(buf, static_cast<size_t>(got));
+        }
+    }
+    close(s);
+#endif
+    if (reply.find('\n') == std::string::npos) return std::nullopt;
+    return Trim(reply);
+}
+
+} // namespace Straf::feed
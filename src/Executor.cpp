@@ -0,0 +1,241 @@
+#include "Straf/Executor.h"
+#include "Straf/Trace.h"
+#include <algorithm>
+#include <string>
+
+namespace Straf {
+
+namespace {
+thread_local const Executor* tWorkerOf = nullptr; // executor whose worker this thread is
+constexpr std::chrono::seconds kBlockingKeepAlive{5}; // idle Blocking() thread before it exits
+}
+
+Task::promise_type::~promise_type() {
+    // Runs as the frame is freed, after every local of the coroutine is gone,
+    // so a joiner may destroy what the task used as soon as Join() returns.
+    const std::shared_ptr<detail::TaskState> task = state;
+    if (task->executor) task->executor->TaskFinished();
+    std::lock_guard lock(task->mutex);
+    task->done = true;
+    task->finished.notify_all();
+}
+
+void TaskHandle::Join() {
+    if (!state_) return;
+    std::unique_lock lock(state_->mutex);
+    state_->finished.wait(lock, [this] { return state_->done; });
+    lock.unlock();
+    state_.reset();
+}
+
+Executor::Executor(size_t workers) {
+    workers_.reserve(std::max<size_t>(workers, 1));
+    for (size_t i = 0; i < std::max<size_t>(workers, 1); ++i) workers_.emplace_back([this, i] { Work(i); });
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+    }
+    idle_.notify_all();
+    timerWait_.notify_all();
+    for (auto& worker : workers_) worker.join();
+    // Blocking() threads are detached; wait until none touches this any more
+    std::unique_lock lock(blockingMutex_);
+    blockingStop_ = true;
+    blockingWork_.notify_all();
+    blockingExited_.wait(lock, [this] { return blockingThreads_ == 0; });
+}
+
+TaskHandle Executor::Spawn(Task task) {
+    auto handle = std::exchange(task.handle_, {});
+    std::shared_ptr<detail::TaskState> state = handle.promise().state;
+    state->executor = this;
+    {
+        std::lock_guard lock(mutex_);
+        ++tasks_;
+        PostLocked(handle);
+    }
+    return TaskHandle(std::move(state));
+}
+
+Executor::Stats Executor::GetStats() const {
+    std::lock_guard lock(mutex_);
+    Stats s;
+    s.workers = workers_.size();
+    s.tasks = tasks_;
+    s.resumes = resumes_;
+    s.wakeups = wakeups_;
+    s.timersFired = timersFired_;
+    std::lock_guard blockingLock(blockingMutex_);
+    s.blockingThreads = blockingThreads_;
+    return s;
+}
+
+void Executor::PostLocked(std::coroutine_handle<> handle) {
+    ready_.push_back(handle);
+    // A worker posting (a Send, a timer, a Set from a task) takes it itself
+    // once the running step suspends; Work() wakes a helper if work piles up
+    if (tWorkerOf == this) return;
+    if (idleWorkers_ > 0) idle_.notify_one();
+    else if (timerKeeper_) timerWait_.notify_one();
+}
+
+void Executor::Post(std::coroutine_handle<> handle) {
+    std::lock_guard lock(mutex_);
+    PostLocked(handle);
+}
+
+void Executor::ArmLocked(detail::Waiter& waiter, std::optional<clock::time_point> deadline, std::vector<detail::Waiter*>* list) {
+    waiter.armed = true;
+    if (list) {
+        waiter.list = list;
+        list->push_back(&waiter);
+    }
+    if (deadline) {
+        const bool earliest = timers_.empty() || *deadline < timers_.begin()->first;
+        waiter.timer = timers_.emplace(*deadline, &waiter);
+        // The worker waiting for the old earliest timer has to wait for this
+        // one instead. Without one, the arming worker becomes it when the
+        // step suspends.
+        if (earliest && timerKeeper_) timerWait_.notify_one();
+        else if (earliest && tWorkerOf != this && idleWorkers_ > 0) idle_.notify_one();
+    }
+}
+
+void Executor::ResolveLocked(detail::Waiter& waiter, bool result) {
+    if (!waiter.armed) return;
+    waiter.armed = false;
+    waiter.result = result;
+    if (waiter.timer) {
+        timers_.erase(*waiter.timer);
+        waiter.timer.reset();
+    }
+    if (waiter.list) {
+        waiter.list->erase(std::find(waiter.list->begin(), waiter.list->end(), &waiter));
+        waiter.list = nullptr;
+    }
+    PostLocked(waiter.handle);
+}
+
+void Executor::ExpireLocked(clock::time_point now) {
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+        detail::Waiter& waiter = *timers_.begin()->second;
+        ++timersFired_;
+        ResolveLocked(waiter, waiter.timeoutResult);
+    }
+}
+
+void Executor::TaskFinished() {
+    std::lock_guard lock(mutex_);
+    --tasks_;
+}
+
+void Executor::RunBlocking(std::function<void()> fn, std::coroutine_handle<> resume) {
+    std::lock_guard lock(blockingMutex_);
+    blockingJobs_.push_back({std::move(fn), resume});
+    if (blockingIdle_ >= blockingJobs_.size()) {
+        blockingWork_.notify_one();
+        return;
+    }
+    ++blockingThreads_;
+    std::thread([this] { BlockingWork(); }).detach();
+}
+
+void Executor::BlockingWork() {
+    std::unique_lock lock(blockingMutex_);
+    ++blockingIdle_;
+    for (;;) {
+        blockingWork_.wait_for(lock, kBlockingKeepAlive, [this] { return blockingStop_ || !blockingJobs_.empty(); });
+        if (blockingJobs_.empty()) break; // idle for too long, or the executor is going
+        BlockingJob job = std::move(blockingJobs_.front());
+        blockingJobs_.pop_front();
+        --blockingIdle_;
+        lock.unlock();
+        job.fn();
+        // Idle again before the task resumes, so its next call finds this thread
+        lock.lock();
+        ++blockingIdle_;
+        lock.unlock();
+        Post(job.resume);
+        lock.lock();
+    }
+    --blockingIdle_;
+    --blockingThreads_;
+    // Notified under the lock: the destructor cannot finish before it is released
+    blockingExited_.notify_all();
+}
+
+void Executor::Work(size_t index) {
+    trace::SetThreadName(("tasks " + std::to_string(index)).c_str());
+    tWorkerOf = this;
+    std::unique_lock lock(mutex_);
+    for (;;) {
+        if (!timers_.empty()) ExpireLocked(clock::now());
+        if (!ready_.empty()) {
+            const auto handle = ready_.front();
+            ready_.pop_front();
+            if (!ready_.empty() && idleWorkers_ > 0) idle_.notify_one();
+            ++resumes_;
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+            continue;
+        }
+        if (stop_) break;
+        if (!timers_.empty() && !timerKeeper_) {
+            timerKeeper_ = true;
+            const clock::time_point deadline = timers_.begin()->first; // the node may go while waiting
+            timerWait_.wait_until(lock, deadline);
+            timerKeeper_ = false;
+        } else {
+            ++idleWorkers_;
+            idle_.wait(lock);
+            --idleWorkers_;
+        }
+        ++wakeups_;
+    }
+}
+
+Executor& Tasks() {
+    static Executor* executor = new Executor(2); // tasks may still run during static destruction
+    return *executor;
+}
+
+namespace detail {
+
+void Suspension::OnStop::operator()() const {
+    std::lock_guard lock(self->executor_->mutex_);
+    self->executor_->ResolveLocked(self->waiter_, false);
+}
+
+bool Suspension::Suspend(std::coroutine_handle<> handle, TaskState& task) {
+    if (!executor_) executor_ = task.executor;
+    // Registered before arming: a stop that lands in between finds the waiter
+    // unarmed and does nothing, and the check below catches it instead
+    onStop_.emplace(task.stop.get_token(), OnStop{this});
+    std::lock_guard lock(executor_->mutex_);
+    if (task.stop.stop_requested()) {
+        waiter_.result = false;
+        return false;
+    }
+    bool result = false;
+    if (TakeLocked(result)) {
+        waiter_.result = result;
+        return false;
+    }
+    waiter_.handle = handle;
+    executor_->ArmLocked(waiter_, deadline_, list_);
+    return true; // not touched again here; another worker may already be resuming it
+}
+
+} // namespace detail
+
+void Event::Set() {
+    std::lock_guard lock(executor_.mutex_);
+    if (!waiters_.empty()) executor_.ResolveLocked(*waiters_.front(), true);
+    else set_ = true;
+}
+
+}
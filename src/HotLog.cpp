@@ -0,0 +1,185 @@
+#include "Straf/HotLog.h"
+#include "Straf/Platform.h"
+#include "Straf/WakeSignal.h"
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Straf::hotlog {
+
+namespace {
+
+size_t RoundUpPow2(size_t n) {
+    size_t p = 64;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Rings of all threads that have logged. The mutex is taken when a thread
+// logs for the first time and by the writer to list the rings, never per record.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<detail::Ring>> rings;
+    Options options;
+    uint64_t retiredWritten{0};  // counters of rings freed after their thread exited
+    uint64_t retiredDropped{0};
+    uint64_t threads{0};
+
+    WakeSignal wake;
+    std::atomic<bool> stop{false};
+    std::thread writer;
+    Sink sink;
+};
+
+Registry& Reg() {
+    static Registry* registry = new Registry; // outlives threads that log during static destruction
+    return *registry;
+}
+
+// Marks the ring closed when its thread exits; the writer frees it once drained.
+struct ThreadRingOwner {
+    detail::Ring* ring{nullptr};
+    ~ThreadRingOwner() {
+        detail::t_ring = nullptr;
+        t_exiting = true;
+        if (ring) ring->Close();
+    }
+    static inline thread_local bool t_exiting = false;
+};
+thread_local ThreadRingOwner t_owner;
+
+// Formats every record in `rings`; returns how many there were.
+size_t DrainAll(const std::vector<detail::Ring*>& rings, const Sink& sink, std::string& text) {
+    size_t records = 0;
+    for (detail::Ring* ring : rings) {
+        records += ring->Drain([&](const detail::RecordHeader& h, const std::byte* payload) {
+            text.clear();
+            try {
+                h.render(h.format, payload, text);
+            } catch (const std::exception& e) {
+                text.assign("bad log format \"").append(h.format).append("\": ").append(e.what());
+            }
+            if (!sink) return;
+            sink(Message{h.level, h.file, static_cast<int>(h.line),
+                         std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                             std::chrono::nanoseconds(h.timeNs))),
+                         ring->ThreadId(), text});
+        });
+    }
+    return records;
+}
+
+// Lists live rings and frees those whose thread exited and that are drained.
+std::vector<detail::Ring*> Snapshot(Registry& reg) {
+    std::lock_guard lock(reg.mutex);
+    std::vector<detail::Ring*> rings;
+    auto keep = reg.rings.begin();
+    for (auto& ring : reg.rings) {
+        if (ring->Closed() && ring->Empty()) {
+            reg.retiredWritten += ring->Written();
+            reg.retiredDropped += ring->Dropped();
+            ring.reset();
+            continue;
+        }
+        rings.push_back(ring.get());
+        *keep++ = std::move(ring);
+    }
+    reg.rings.erase(keep, reg.rings.end());
+    return rings;
+}
+
+// Producers signal only when a record lands in an empty ring, so before
+// sleeping the writer fences and looks once more: either it sees a record
+// committed meanwhile, or that record's Commit() sees the ring drained and
+// wakes it.
+void Run(Registry& reg) {
+    std::string text;
+    while (!reg.stop.load(std::memory_order_acquire)) {
+        if (DrainAll(Snapshot(reg), reg.sink, text) != 0) continue;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (DrainAll(Snapshot(reg), reg.sink, text) == 0) reg.wake.WaitUntil(std::nullopt);
+    }
+    DrainAll(Snapshot(reg), reg.sink, text);
+}
+
+} // namespace
+
+namespace detail {
+
+Ring::Ring(size_t capacity, uint64_t threadId)
+    : capacity_(RoundUpPow2(capacity)), mask_(capacity_ - 1), threadId_(threadId),
+      data_(std::make_unique<std::byte[]>(capacity_)) {}
+
+Ring* AttachThisThread() {
+    if (ThreadRingOwner::t_exiting) return nullptr;
+    Registry& reg = Reg();
+    std::lock_guard lock(reg.mutex);
+    reg.rings.push_back(std::make_unique<Ring>(reg.options.ringBytes, platform::CurrentThreadId()));
+    ++reg.threads;
+    t_owner.ring = reg.rings.back().get();
+    t_ring = t_owner.ring;
+    return t_ring;
+}
+
+void NotifyWriter() {
+    Reg().wake.Notify();
+}
+
+} // namespace detail
+
+void Start(Sink sink, Options options) {
+    Registry& reg = Reg();
+    if (reg.writer.joinable()) return;
+    {
+        std::lock_guard lock(reg.mutex);
+        reg.options = options;
+    }
+    reg.sink = std::move(sink);
+    reg.stop.store(false, std::memory_order_release);
+    reg.writer = std::thread([&reg] { Run(reg); });
+}
+
+void Stop() {
+    Registry& reg = Reg();
+    if (!reg.writer.joinable()) return;
+    reg.stop.store(true, std::memory_order_release);
+    reg.wake.Notify();
+    reg.writer.join();
+}
+
+void SetLevel(Level level) {
+    detail::g_level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+Level GetLevel() {
+    return static_cast<Level>(detail::g_level.load(std::memory_order_relaxed));
+}
+
+bool ParseLevel(std::string_view name, Level& level) {
+    static constexpr std::pair<std::string_view, Level> kNames[] = {
+        {"trace", Level::Trace}, {"debug", Level::Debug}, {"info", Level::Info}, {"warn", Level::Warn},
+        {"warning", Level::Warn}, {"error", Level::Error}, {"off", Level::Off}};
+    for (const auto& [n, l] : kNames) {
+        if (n == name) {
+            level = l;
+            return true;
+        }
+    }
+    return false;
+}
+
+Stats GetStats() {
+    Registry& reg = Reg();
+    std::lock_guard lock(reg.mutex);
+    Stats s;
+    s.written = reg.retiredWritten;
+    s.dropped = reg.retiredDropped;
+    s.threads = reg.threads;
+    for (const auto& ring : reg.rings) {
+        s.written += ring->Written();
+        s.dropped += ring->Dropped();
+    }
+    return s;
+}
+
+} // namespace Straf::hotlog
@@ -0,0 +1,321 @@
+#include "Straf/Metrics.h"
+#include "Straf/Platform.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#include <fstream>
+#endif
+
+namespace Straf::metrics {
+
+namespace {
+
+enum Kind { kCounter, kGauge, kFamily, kHistogram };
+constexpr const char* kKindNames[] = {"counter", "gauge", "counter family", "histogram"};
+
+void AppendNumber(std::string& out, double v) {
+    if (std::isinf(v)) {
+        out += v > 0 ? "+Inf" : "-Inf";
+        return;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.10g", v);
+    out += buf;
+}
+
+// Label values escape backslash, quote and newline; HELP text the first and last.
+void AppendEscaped(std::string& out, std::string_view s, bool quotes) {
+    for (char c : s) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else if (c == '"' && quotes) out += "\\\"";
+        else out += c;
+    }
+}
+
+} // namespace
+
+CounterFamily::~CounterFamily() {
+    for (auto& chunk : chunks_) delete chunk.load(std::memory_order_relaxed);
+}
+
+void CounterFamily::Inc(uint32_t id, uint64_t n) {
+    const size_t c = id / kChunkSize;
+    if (c >= kMaxChunks) return;
+    Chunk* chunk = chunks_[c].load(std::memory_order_acquire);
+    if (!chunk) {
+        // First id of this range: racing threads both allocate, one wins
+        auto* fresh = new Chunk;
+        if (chunks_[c].compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel)) chunk = fresh;
+        else delete fresh;
+    }
+    chunk->values[id % kChunkSize].fetch_add(n, std::memory_order_relaxed);
+}
+
+void CounterFamily::ForEach(const std::function<void(const std::string&, uint64_t)>& fn) const {
+    for (size_t c = 0; c < kMaxChunks; ++c) {
+        const Chunk* chunk = chunks_[c].load(std::memory_order_acquire);
+        if (!chunk) continue;
+        for (size_t i = 0; i < kChunkSize; ++i) {
+            const uint64_t v = chunk->values[i].load(std::memory_order_relaxed);
+            if (v > 0) fn(label_(static_cast<uint32_t>(c * kChunkSize + i)), v);
+        }
+    }
+}
+
+Histogram::Histogram(HistogramOptions options)
+    : unit_(options.lowest / (1 << kSubBits)), scale_(1.0 / unit_),
+      buckets_(Index(static_cast<uint64_t>(std::ceil(options.highest * scale_))) + 2) {}
+
+// Values below 2^kSubBits units map one to one; above, the top kSubBits bits
+// after the leading one pick the sub-bucket of the power of two.
+size_t Histogram::Index(uint64_t units) {
+    constexpr uint64_t kSub = uint64_t{1} << kSubBits;
+    if (units < kSub) return static_cast<size_t>(units);
+    const int exponent = std::bit_width(units) - 1;
+    const uint64_t mantissa = (units >> (exponent - kSubBits)) & (kSub - 1);
+    return static_cast<size_t>(kSub + (exponent - kSubBits) * kSub + mantissa);
+}
+
+double Histogram::UpperBound(size_t index) const {
+    constexpr size_t kSub = size_t{1} << kSubBits;
+    if (index < kSub) return static_cast<double>(index + 1) * unit_;
+    const size_t exponent = (index - kSub) / kSub + kSubBits;
+    const size_t mantissa = (index - kSub) % kSub;
+    return std::ldexp(static_cast<double>(kSub + mantissa + 1), static_cast<int>(exponent - kSubBits)) * unit_;
+}
+
+// Bounds are whole units, and a bucket holds the values up to and including
+// its bound (Prometheus `le`): a value of u units goes where the whole unit
+// count ceil(u) - 1 does, the bucket whose bound is the first >= ceil(u).
+void Histogram::Observe(double value) {
+    if (!(value > 0.0)) value = 0.0; // negative and NaN count as zero
+    const size_t overflow = buckets_.size() - 1;
+    const double units = std::ceil(value * scale_);
+    const size_t index = units < 1e18 ? std::min(Index(units > 0.0 ? static_cast<uint64_t>(units) - 1 : 0), overflow)
+                                      : overflow;
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::Read() const {
+    Snapshot s;
+    const size_t n = buckets_.size() - 1;
+    s.bounds.reserve(n);
+    s.counts.reserve(n + 1);
+    for (size_t i = 0; i <= n; ++i) {
+        if (i < n) s.bounds.push_back(UpperBound(i));
+        s.counts.push_back(buckets_[i].load(std::memory_order_relaxed));
+        s.count += s.counts.back();
+    }
+    s.sum = sum_.load(std::memory_order_relaxed);
+    return s;
+}
+
+double Histogram::Snapshot::Quantile(double q) const {
+    if (count == 0) return 0.0;
+    const auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bounds.size(); ++i) {
+        seen += counts[i];
+        if (seen >= std::max<uint64_t>(rank, 1)) return bounds[i];
+    }
+    return bounds.empty() ? 0.0 : bounds.back();
+}
+
+void Writer::Header(std::string_view name, std::string_view help, const char* type) {
+    out_ += "# HELP ";
+    out_ += name;
+    out_ += ' ';
+    AppendEscaped(out_, help, false);
+    out_ += "\n# TYPE ";
+    out_ += name;
+    out_ += ' ';
+    out_ += type;
+    out_ += '\n';
+}
+
+void Writer::Sample(std::string_view name, std::string_view labels, double value) {
+    out_ += name;
+    if (!labels.empty()) {
+        out_ += '{';
+        out_ += labels;
+        out_ += '}';
+    }
+    out_ += ' ';
+    AppendNumber(out_, value);
+    out_ += '\n';
+}
+
+void Writer::WriteCounter(std::string_view name, std::string_view help, double value) {
+    Header(name, help, "counter");
+    Sample(name, {}, value);
+}
+
+void Writer::WriteGauge(std::string_view name, std::string_view help, double value) {
+    Header(name, help, "gauge");
+    Sample(name, {}, value);
+}
+
+struct Registry::Entry {
+    std::string name;
+    std::string help;
+    int kind;
+    std::string labelName;
+    std::unique_ptr<metrics::Counter> counter;
+    std::unique_ptr<metrics::Gauge> gauge;
+    std::unique_ptr<metrics::CounterFamily> family;
+    std::unique_ptr<metrics::Histogram> histogram;
+};
+
+Registry::Registry() = default;
+Registry::~Registry() = default;
+
+Registry::Entry& Registry::FindOrAdd(const std::string& name, const std::string& help, int kind) {
+    for (auto& e : entries_) {
+        if (e->name != name) continue;
+        if (e->kind == kind) return *e;
+        // The caller still gets a working metric, but it is never exported
+        SPDLOG_ERROR("Metric {} is already registered as a {}; the {} of that name is not exported", name,
+                     kKindNames[e->kind], kKindNames[kind]);
+        rejected_.push_back(std::make_unique<Entry>(Entry{name, help, kind, {}, {}, {}, {}, {}}));
+        return *rejected_.back();
+    }
+    entries_.push_back(std::make_unique<Entry>(Entry{name, help, kind, {}, {}, {}, {}, {}}));
+    return *entries_.back();
+}
+
+Counter& Registry::AddCounter(const std::string& name, const std::string& help) {
+    std::lock_guard lock(mutex_);
+    Entry& e = FindOrAdd(name, help, kCounter);
+    if (!e.counter) e.counter = std::make_unique<metrics::Counter>();
+    return *e.counter;
+}
+
+Gauge& Registry::AddGauge(const std::string& name, const std::string& help) {
+    std::lock_guard lock(mutex_);
+    Entry& e = FindOrAdd(name, help, kGauge);
+    if (!e.gauge) e.gauge = std::make_unique<metrics::Gauge>();
+    return *e.gauge;
+}
+
+CounterFamily& Registry::AddCounterFamily(const std::string& name, const std::string& help, const std::string& labelName,
+                                          CounterFamily::LabelFn label) {
+    std::lock_guard lock(mutex_);
+    Entry& e = FindOrAdd(name, help, kFamily);
+    if (!e.family) {
+        e.labelName = labelName;
+        e.family = std::make_unique<metrics::CounterFamily>(std::move(label));
+    }
+    return *e.family;
+}
+
+Histogram& Registry::AddHistogram(const std::string& name, const std::string& help, HistogramOptions options) {
+    std::lock_guard lock(mutex_);
+    Entry& e = FindOrAdd(name, help, kHistogram);
+    if (!e.histogram) e.histogram = std::make_unique<metrics::Histogram>(options);
+    return *e.histogram;
+}
+
+size_t Registry::AddCollector(Collector collector) {
+    std::lock_guard lock(mutex_);
+    const size_t id = nextCollector_++;
+    collectors_.emplace_back(id, std::move(collector));
+    return id;
+}
+
+void Registry::RemoveCollector(size_t id) {
+    std::lock_guard lock(mutex_);
+    collectors_.erase(std::remove_if(collectors_.begin(), collectors_.end(), [id](const auto& c) { return c.first == id; }),
+                      collectors_.end());
+}
+
+std::string Registry::Render() const {
+    Writer w;
+    std::string labels;
+    std::lock_guard lock(mutex_);
+    for (const auto& e : entries_) {
+        switch (e->kind) {
+        case kCounter:
+            w.WriteCounter(e->name, e->help, static_cast<double>(e->counter->Value()));
+            break;
+        case kGauge:
+            w.WriteGauge(e->name, e->help, e->gauge->Value());
+            break;
+        case kFamily:
+            w.Header(e->name, e->help, "counter");
+            e->family->ForEach([&](const std::string& label, uint64_t value) {
+                labels = e->labelName + "=\"";
+                AppendEscaped(labels, label, true);
+                labels += '"';
+                w.Sample(e->name, labels, static_cast<double>(value));
+            });
+            break;
+        case kHistogram: {
+            // Count is the bucket total of this read, so +Inf and _count agree
+            // even while observations land
+            const Histogram::Snapshot s = e->histogram->Read();
+            w.Header(e->name, e->help, "histogram");
+            const std::string bucket = e->name + "_bucket";
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < s.bounds.size(); ++i) {
+                cumulative += s.counts[i];
+                labels = "le=\"";
+                AppendNumber(labels, s.bounds[i]);
+                labels += '"';
+                w.Sample(bucket, labels, static_cast<double>(cumulative));
+            }
+            w.Sample(bucket, "le=\"+Inf\"", static_cast<double>(s.count));
+            w.Sample(e->name + "_sum", {}, s.sum);
+            w.Sample(e->name + "_count", {}, static_cast<double>(s.count));
+            break;
+        }
+        }
+    }
+    for (const auto& c : collectors_) c.second(w);
+    return w.Text();
+}
+
+Registry& Metrics() {
+    static Registry* registry = new Registry; // outlives threads still recording at exit
+    return *registry;
+}
+
+void AddProcessCollector(Registry& registry) {
+    static std::once_flag once;
+    std::call_once(once, [&registry] {
+        registry.AddCollector([](Writer& w) {
+#ifdef _WIN32
+            PROCESS_MEMORY_COUNTERS_EX pmc{};
+            if (GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&pmc), sizeof pmc)) {
+                w.WriteGauge("process_resident_memory_bytes", "Working set size in bytes.", static_cast<double>(pmc.WorkingSetSize));
+                w.WriteGauge("process_private_memory_bytes", "Committed private memory in bytes.", static_cast<double>(pmc.PrivateUsage));
+                w.WriteGauge("straf_process_peak_resident_memory_bytes", "Peak working set size in bytes.",
+                             static_cast<double>(pmc.PeakWorkingSetSize));
+            }
+#else
+            std::ifstream statm("/proc/self/statm");
+            double pages = 0, resident = 0;
+            if (statm >> pages >> resident) {
+                const double page = static_cast<double>(sysconf(_SC_PAGESIZE));
+                w.WriteGauge("process_resident_memory_bytes", "Resident memory size in bytes.", resident * page);
+                w.WriteGauge("process_virtual_memory_bytes", "Virtual memory size in bytes.", pages * page);
+            }
+            if (const uint64_t peak = platform::PeakResidentBytes()) {
+                w.WriteGauge("straf_process_peak_resident_memory_bytes", "Peak resident memory size in bytes.",
+                             static_cast<double>(peak));
+            }
+#endif
+        });
+    });
+}
+
+} // namespace Straf::metrics
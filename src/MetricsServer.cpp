@@ -0,0 +1,164 @@
+#include "Straf/Metrics.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace Straf::metrics {
+
+namespace {
+
+#ifdef _WIN32
+using Socket = SOCKET;
+constexpr Socket kNoSocket = INVALID_SOCKET;
+void CloseSocket(Socket s) { closesocket(s); }
+#else
+using Socket = int;
+constexpr Socket kNoSocket = -1;
+void CloseSocket(Socket s) { close(s); }
+#endif
+
+bool SendAll(Socket s, const char* data, size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        const int sent = send(s, data, static_cast<int>(std::min<size_t>(size, 1 << 20)), 0);
+#else
+        const auto sent = send(s, data, size, MSG_NOSIGNAL);
+#endif
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+class HttpMetricsServer final : public MetricsServer {
+public:
+    explicit HttpMetricsServer(Registry& registry) : registry_(registry) {}
+
+    ~HttpMetricsServer() override {
+        if (listen_ != kNoSocket) {
+            stop_ = true;
+            // Wakes the blocked accept()
+#ifdef _WIN32
+            CloseSocket(listen_);
+#else
+            shutdown(listen_, SHUT_RDWR);
+#endif
+            if (worker_.joinable()) worker_.join();
+#ifndef _WIN32
+            CloseSocket(listen_);
+#endif
+        }
+#ifdef _WIN32
+        if (wsaStarted_) WSACleanup();
+#endif
+    }
+
+    bool Listen(uint16_t port) {
+#ifdef _WIN32
+        WSADATA wsa{};
+        if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return false;
+        wsaStarted_ = true;
+#endif
+        listen_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listen_ == kNoSocket) return false;
+        int exclusive = 1;
+#ifdef _WIN32
+        // SO_REUSEADDR would let another process take over the port on Windows
+        setsockopt(listen_, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&exclusive), sizeof exclusive);
+#else
+        setsockopt(listen_, SOL_SOCKET, SO_REUSEADDR, &exclusive, sizeof exclusive); // restart without waiting out TIME_WAIT
+#endif
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // never reachable from other hosts
+        addr.sin_port = htons(port);
+        socklen_t len = sizeof addr;
+        if (bind(listen_, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0 || listen(listen_, 8) != 0 ||
+            getsockname(listen_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+            CloseSocket(listen_);
+            listen_ = kNoSocket;
+            return false;
+        }
+        port_ = ntohs(addr.sin_port);
+        worker_ = std::thread([this]{ Run(); });
+        return true;
+    }
+
+    uint16_t Port() const override { return port_; }
+    uint64_t Scrapes() const override { return scrapes_.load(std::memory_order_relaxed); }
+
+private:
+    void Run() {
+        while (!stop_) {
+            const Socket client = accept(listen_, nullptr, nullptr);
+            if (client == kNoSocket) {
+                if (stop_) break;
+                continue;
+            }
+            Serve(client);
+            CloseSocket(client);
+        }
+    }
+
+    // Reads the request head (the path is ignored) and answers with the
+    // registry rendered at this moment. A client that stalls gets dropped.
+    void Serve(Socket client) {
+#ifdef _WIN32
+        DWORD timeout = 2000;
+#else
+        timeval timeout{2, 0};
+#endif
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof timeout);
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof timeout);
+        std::string request;
+        char buf[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            const auto got = recv(client, buf, sizeof buf, 0);
+            if (got <= 0) return;
+            request.append(buf, static_cast<size_t>(got));
+        }
+        std::string response;
+        if (request.compare(0, 4, "GET ") != 0) {
+            response = "HTTP/1.0 405 Method Not Allowed\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        } else {
+            const std::string body = registry_.Render();
+            response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " +
+                       std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            scrapes_.fetch_add(1, std::memory_order_relaxed);
+        }
+        SendAll(client, response.data(), response.size());
+    }
+
+    Registry& registry_;
+    Socket listen_{kNoSocket};
+    uint16_t port_{0};
+    std::thread worker_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> scrapes_{0};
+#ifdef _WIN32
+    bool wsaStarted_{false};
+#endif
+};
+
+} // namespace
+
+std::unique_ptr<MetricsServer> StartMetricsServer(uint16_t port, Registry& registry) {
+    auto server = std::make_unique<HttpMetricsServer>(registry);
+    if (!server->Listen(port)) return nullptr;
+    return server;
+}
+
+} // namespace Straf::metrics
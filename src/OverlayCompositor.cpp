@@ -0,0 +1,103 @@
+#include "Straf/OverlayCompositor.h"
+
+namespace Straf {
+
+namespace {
+// How long to wait before trying again when a lost device cannot be recreated.
+constexpr std::chrono::seconds kResetRetry{1};
+}
+
+OverlayCompositor::OverlayCompositor(std::unique_ptr<ICompositorDevice> device)
+    : device_(std::move(device)) {}
+
+OverlayCompositor::~OverlayCompositor() {
+    loop_.Stop();
+    for (auto& slot : layers_) {
+        if (slot.ready) slot.layer->ReleaseResources();
+    }
+}
+
+void OverlayCompositor::AddLayer(std::unique_ptr<IOverlayLayer> layer) {
+    if (!layer) return;
+    Slot slot;
+    slot.layer = std::move(layer);
+    layers_.push_back(std::move(slot));
+}
+
+bool OverlayCompositor::Initialize() {
+    if (!device_ || !device_->Initialize()) return false;
+    const OverlayRect screen = device_->Screen();
+    for (auto& slot : layers_) {
+        if (!device_->AddSurface(slot.layer->Placement(screen.Width(), screen.Height()))) return false;
+    }
+    loop_.Start();
+    return true;
+}
+
+OverlayFrameStats OverlayCompositor::GetFrameStats() const {
+    OverlayFrameStats s = loop_.Stats();
+    s.drawTime = std::chrono::nanoseconds(drawNanos_.load(std::memory_order_relaxed));
+    s.maxDrawTime = std::chrono::nanoseconds(maxDrawNanos_.load(std::memory_order_relaxed));
+    return s;
+}
+
+bool OverlayCompositor::ShouldShow(const OverlayScene& scene) const {
+    for (const auto& slot : layers_) {
+        if (slot.layer->Visible(scene)) return true;
+    }
+    return false;
+}
+
+std::optional<IOverlayBackend::clock::time_point> OverlayCompositor::DrawFrame(const OverlayScene& scene, clock::time_point now) {
+    std::optional<clock::time_point> next;
+    clock::duration drawTime{0};
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        Slot& slot = layers_[i];
+        bool visible = slot.layer->Visible(scene);
+        if (visible && !slot.ready) {
+            slot.ready = slot.layer->CreateResources(device_->Canvas());
+            slot.drawn = false;
+            visible = slot.ready; // a layer that can't draw on this device stays hidden
+        }
+        if (visible && (!slot.drawn || slot.version != scene.version || (slot.due && now >= *slot.due))) {
+            const auto started = clock::now();
+            if (!device_->BeginDraw(i)) return Recover(now);
+            slot.due = slot.layer->Draw(device_->Canvas(), scene, now);
+            if (!device_->EndDraw(i)) return Recover(now);
+            drawTime += clock::now() - started;
+            slot.drawn = true;
+            slot.version = scene.version;
+        }
+        if (!visible) slot.due.reset();
+        if (visible != slot.shown) {
+            device_->ShowSurface(i, visible);
+            slot.shown = visible;
+        }
+        if (slot.due && (!next || *slot.due < *next)) next = slot.due;
+    }
+    if (!device_->Commit()) return Recover(now);
+
+    const int64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(drawTime).count();
+    drawNanos_.fetch_add(nanos, std::memory_order_relaxed);
+    if (nanos > maxDrawNanos_.load(std::memory_order_relaxed)) maxDrawNanos_.store(nanos, std::memory_order_relaxed); // single writer
+    return next;
+}
+
+// Drops every layer's resources and rebuilds the device. The returned deadline
+// makes the loop redraw the whole scene at once, or retry later.
+std::optional<IOverlayBackend::clock::time_point> OverlayCompositor::Recover(clock::time_point now) {
+    for (auto& slot : layers_) {
+        if (slot.ready) slot.layer->ReleaseResources();
+        slot.ready = false;
+        slot.shown = false;
+        slot.drawn = false;
+        slot.due.reset();
+    }
+    return device_->Reset() ? now : now + kResetRetry;
+}
+
+void OverlayCompositor::SetVisible(bool visible) {
+    device_->SetVisible(visible);
+}
+
+}
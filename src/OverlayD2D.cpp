@@ -0,0 +1,83 @@
+// Cached drawing helpers shared by the overlay layers
+#include "Straf/OverlayD2D.h"
+
+#include <cmath>
+#include <string>
+
+using Microsoft::WRL::ComPtr;
+
+namespace Straf {
+
+// Outline around the origin: outer and inner points alternate, starting at the top.
+static HRESULT BuildStar(ID2D1Factory1* factory, float r, float innerRatio, ID2D1PathGeometry** out){
+    ComPtr<ID2D1PathGeometry> geo;
+    HRESULT hr = factory->CreatePathGeometry(&geo);
+    if (FAILED(hr)) return hr;
+    ComPtr<ID2D1GeometrySink> sink;
+    hr = geo->Open(&sink);
+    if (FAILED(hr)) return hr;
+    const int points = 5;
+    float angleStep = 3.14159265f * 2.0f / points;
+    float startAngle = -3.14159265f / 2.0f;
+    float rInner = r * innerRatio;
+    for (int i = 0; i < points; ++i){
+        float a0 = startAngle + i * angleStep;
+        float a1 = a0 + angleStep / 2.0f;
+        D2D1_POINT_2F p0 = D2D1::Point2F(r * cosf(a0), r * sinf(a0));
+        D2D1_POINT_2F p1 = D2D1::Point2F(rInner * cosf(a1), rInner * sinf(a1));
+        if (i == 0) sink->BeginFigure(p0, D2D1_FIGURE_BEGIN_FILLED);
+        else sink->AddLine(p0);
+        sink->AddLine(p1);
+    }
+    sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+    hr = sink->Close();
+    if (FAILED(hr)) return hr;
+    *out = geo.Detach();
+    return S_OK;
+}
+
+void DrawCachedStar(D2DCanvas& canvas, D2DCacheKey key, D2D1_POINT_2F center, float r, float innerRatio,
+                    float strokeWidth, ID2D1Brush* brush, bool filled){
+    D2DResourceCache& cache = *canvas.cache;
+    ID2D1PathGeometry* geo = cache.Get<ID2D1PathGeometry>(key, [&](ID2D1PathGeometry** out){
+        return BuildStar(canvas.factory, r, innerRatio, out);
+    });
+    if (!geo) return;
+
+    D2D1_MATRIX_3X2_F saved;
+    canvas.context->GetTransform(&saved);
+    canvas.context->SetTransform(D2D1::Matrix3x2F::Translation(center.x, center.y) * *D2D1::Matrix3x2F::ReinterpretBaseType(&saved));
+    if (canvas.context1){
+        // Tessellated once; later frames only replay the realization
+        ID2D1DeviceContext1* ctx1 = canvas.context1;
+        key.part += 1;
+        ID2D1GeometryRealization* fill = !filled ? nullptr : cache.Get<ID2D1GeometryRealization>(key, [&](ID2D1GeometryRealization** out){
+            return ctx1->CreateFilledGeometryRealization(geo, D2D1_DEFAULT_FLATTENING_TOLERANCE, out);
+        });
+        key.part += 1;
+        ID2D1GeometryRealization* stroke = cache.Get<ID2D1GeometryRealization>(key, [&](ID2D1GeometryRealization** out){
+            return ctx1->CreateStrokedGeometryRealization(geo, D2D1_DEFAULT_FLATTENING_TOLERANCE, strokeWidth, nullptr, out);
+        });
+        if (fill) ctx1->DrawGeometryRealization(fill, brush);
+        if (stroke) ctx1->DrawGeometryRealization(stroke, brush);
+    } else {
+        if (filled) canvas.context->FillGeometry(geo, brush);
+        canvas.context->DrawGeometry(geo, brush, strokeWidth);
+    }
+    canvas.context->SetTransform(saved);
+}
+
+IDWriteTextLayout* CachedCaption(D2DCanvas& canvas, const D2DCacheKey& key, std::wstring_view prefix,
+                                 std::wstring_view separator, IDWriteTextFormat* format, float width, float height){
+    return canvas.cache->Get<IDWriteTextLayout>(key, [&](IDWriteTextLayout** out){
+        std::wstring text(prefix);
+        std::wstring_view wide = Words().WideName(key.label);
+        if (!wide.empty()){
+            text.append(separator);
+            text.append(wide);
+        }
+        return canvas.dwrite->CreateTextLayout(text.c_str(), static_cast<UINT32>(text.size()), format, width, height, out);
+    });
+}
+
+}
@@ -0,0 +1,492 @@
+// D3D11 + DirectComposition compositor device (topmost, click-through) shared by all overlay styles,
+// with a layered-window software device as the fallback
+#include "Straf/Overlay.h"
+#include "Straf/OverlayD2D.h"
+#include "Straf/OverlaySoft.h"
+
+#include <d3d11.h>
+#include <dxgi1_2.h>
+#include <dcomp.h>
+#include <wrl/client.h>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+using Microsoft::WRL::ComPtr;
+
+namespace Straf {
+
+// Returns true if the given environment variable is set to any value
+static bool IsEnvSetA(const char* name){
+    char buf[2]{};
+    return GetEnvironmentVariableA(name, buf, static_cast<DWORD>(std::size(buf))) > 0;
+}
+
+static LRESULT CALLBACK OverlayWndProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam){
+    switch(msg){
+        case WM_NCHITTEST:
+            return HTTRANSPARENT; // click-through
+        case WM_ERASEBKGND:
+            return 1;
+        default:
+            return DefWindowProc(hWnd, msg, wParam, lParam);
+    }
+}
+
+class D2DCompositorDevice final : public ICompositorDevice {
+public:
+    ~D2DCompositorDevice() override {
+        releaseDevice();
+        if (hwnd_) DestroyWindow(hwnd_);
+        if (comInitialized_) CoUninitialize();
+    }
+
+    bool Initialize() override {
+        HRESULT hr = CoInitializeEx(nullptr, COINIT_APARTMENTTHREADED);
+        if (SUCCEEDED(hr)) {
+            comInitialized_ = true;
+        } else if (hr != RPC_E_CHANGED_MODE) { return false; }
+
+        if (!registerWindowClass()) return false;
+        if (!createWindow()) return false;
+        return createDevice();
+    }
+
+    OverlayRect Screen() const override {
+        return {0.0f, 0.0f, static_cast<float>(screenCx_), static_cast<float>(screenCy_)};
+    }
+
+    bool AddSurface(OverlayRect placement) override {
+        Surface& s = surfaces_.emplace_back();
+        s.placement = placement;
+        return createSurface(s) && SUCCEEDED(dcompDevice_->Commit());
+    }
+
+    IOverlayCanvas& Canvas() override { return canvas_; }
+
+    bool BeginDraw(size_t surface) override {
+        Surface& s = surfaces_[surface];
+        if (!d2dCtx_ || !s.target) return false;
+        cache_.Trim();
+        d2dCtx_->SetTarget(s.target.Get());
+        d2dCtx_->BeginDraw();
+        d2dCtx_->Clear(D2D1::ColorF(0, 0.0f)); // fully transparent
+        return true;
+    }
+
+    bool EndDraw(size_t surface) override {
+        HRESULT hr = d2dCtx_->EndDraw();
+        d2dCtx_->SetTarget(nullptr);
+        if (hr == D2DERR_RECREATE_TARGET) return false;
+        surfaces_[surface].dirty = true; // presented with the frame in Commit()
+        return true;
+    }
+
+    void ShowSurface(size_t surface, bool shown) override {
+        // Content is detached rather than the visual removed, so stacking order is kept
+        Surface& s = surfaces_[surface];
+        if (s.visual) s.visual->SetContent(shown ? s.swapChain.Get() : nullptr);
+    }
+
+    bool Commit() override {
+        if (!dcompDevice_) return false;
+        for (auto& s : surfaces_) {
+            if (!s.dirty) continue;
+            s.dirty = false;
+            HRESULT hr = s.swapChain->Present(1, 0);
+            if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET) return false;
+        }
+        return SUCCEEDED(dcompDevice_->Commit());
+    }
+
+    void SetVisible(bool visible) override {
+        // Async: the owning thread may be joining the render thread
+        ShowWindowAsync(hwnd_, visible ? SW_SHOWNA : SW_HIDE);
+    }
+
+    bool Reset() override {
+        releaseDevice();
+        if (!createDevice()) return false;
+        for (auto& s : surfaces_) {
+            if (!createSurface(s)) return false;
+        }
+        return SUCCEEDED(dcompDevice_->Commit());
+    }
+
+private:
+    struct Surface {
+        OverlayRect placement;
+        ComPtr<IDCompositionVisual> visual;
+        ComPtr<IDXGISwapChain1> swapChain;
+        ComPtr<ID2D1Bitmap1> target;
+        bool dirty{false}; // drawn since the last present
+    };
+
+    bool registerWindowClass(){
+        WNDCLASSW wc{};
+        wc.lpszClassName = L"StrafOverlayWindow";
+        wc.lpfnWndProc = OverlayWndProc;
+        wc.hInstance = GetModuleHandleW(nullptr);
+        wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+        // Registered by an earlier device in this process
+        return RegisterClassW(&wc) != 0 || GetLastError() == ERROR_CLASS_ALREADY_EXISTS;
+    }
+
+    bool createWindow(){
+        screenCx_ = GetSystemMetrics(SM_CXSCREEN);
+        screenCy_ = GetSystemMetrics(SM_CYSCREEN);
+        // Full-screen window; each layer's visual is offset to its placement.
+        // Click-through:
+        //  - WS_EX_TRANSPARENT: let mouse messages pass to windows underneath
+        //  - WS_EX_LAYERED + SetLayeredWindowAttributes: ensure proper composition/click-through on all setups
+        //  - Keep WS_EX_TOPMOST so overlay stays above by default
+        DWORD exStyle = WS_EX_TRANSPARENT | WS_EX_NOACTIVATE | WS_EX_TOOLWINDOW | WS_EX_LAYERED | WS_EX_TOPMOST;
+        hwnd_ = CreateWindowExW(
+            exStyle,
+            L"StrafOverlayWindow", L"StrafOverlay",
+            WS_POPUP,
+            0, 0, screenCx_, screenCy_,
+            nullptr, nullptr, GetModuleHandleW(nullptr), nullptr);
+        if (!hwnd_) { return false; }
+        SetLayeredWindowAttributes(hwnd_, 0, 255, LWA_ALPHA);
+        return true;
+    }
+
+    // Device, composition tree and D2D context; shared by every surface.
+    bool createDevice(){
+        UINT flags = D3D11_CREATE_DEVICE_BGRA_SUPPORT;
+#if defined(_DEBUG)
+        // flags |= D3D11_CREATE_DEVICE_DEBUG; // optional
+#endif
+        D3D_FEATURE_LEVEL flIn[] = { D3D_FEATURE_LEVEL_11_1, D3D_FEATURE_LEVEL_11_0 };
+        D3D_FEATURE_LEVEL flOut{};
+        HRESULT hr = D3D11CreateDevice(
+            nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr,
+            flags, flIn, ARRAYSIZE(flIn), D3D11_SDK_VERSION,
+            &d3dDevice_, &flOut, nullptr);
+        if (FAILED(hr)) { return false; }
+        hr = d3dDevice_.As(&dxgiDevice_);
+        if (FAILED(hr)) return false;
+        hr = CreateDXGIFactory2(0, IID_PPV_ARGS(&dxgiFactory_));
+        if (FAILED(hr)) { return false; }
+
+        hr = DCompositionCreateDevice(dxgiDevice_.Get(), IID_PPV_ARGS(&dcompDevice_));
+        if (FAILED(hr)) { return false; }
+        hr = dcompDevice_->CreateTargetForHwnd(hwnd_, TRUE, &dcompTarget_);
+        if (FAILED(hr)) { return false; }
+        hr = dcompDevice_->CreateVisual(&root_);
+        if (FAILED(hr)) { return false; }
+        hr = dcompTarget_->SetRoot(root_.Get());
+        if (FAILED(hr)) { return false; }
+
+        // Factories survive device loss
+        if (!d2dFactory_){
+            D2D1_FACTORY_OPTIONS opts{};
+            hr = D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, __uuidof(ID2D1Factory1), &opts, &d2dFactory_);
+            if (FAILED(hr)) { return false; }
+        }
+        if (!dwFactory_){
+            hr = DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory), &dwFactory_);
+            if (FAILED(hr)) { return false; }
+        }
+        hr = d2dFactory_->CreateDevice(dxgiDevice_.Get(), &d2dDevice_);
+        if (FAILED(hr)) { return false; }
+        hr = d2dDevice_->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE, &d2dCtx_);
+        if (FAILED(hr)) { return false; }
+
+        d2dCtx_.As(&d2dCtx1_); // optional: geometry realizations need Windows 8.1
+
+        canvas_.factory = d2dFactory_.Get();
+        canvas_.context = d2dCtx_.Get();
+        canvas_.context1 = d2dCtx1_.Get();
+        canvas_.dwrite = dwFactory_.Get();
+        canvas_.cache = &cache_;
+        return true;
+    }
+
+    // Swap chain sized to the placement, on a visual offset to its corner,
+    // stacked above the surfaces created before it. Starts hidden.
+    bool createSurface(Surface& s){
+        HRESULT hr = dcompDevice_->CreateVisual(&s.visual);
+        if (FAILED(hr)) { return false; }
+        s.visual->SetOffsetX(s.placement.left);
+        s.visual->SetOffsetY(s.placement.top);
+        hr = root_->AddVisual(s.visual.Get(), TRUE, topVisual_.Get());
+        if (FAILED(hr)) { return false; }
+        topVisual_ = s.visual;
+
+        DXGI_SWAP_CHAIN_DESC1 desc{};
+        desc.Width = static_cast<UINT>(s.placement.Width());
+        desc.Height = static_cast<UINT>(s.placement.Height());
+        desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        desc.Stereo = FALSE;
+        desc.SampleDesc = {1, 0};
+        desc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+        desc.BufferCount = 2;
+        desc.Scaling = DXGI_SCALING_STRETCH;
+        desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+        desc.AlphaMode = DXGI_ALPHA_MODE_PREMULTIPLIED;
+        desc.Flags = 0;
+        hr = dxgiFactory_->CreateSwapChainForComposition(d3dDevice_.Get(), &desc, nullptr, &s.swapChain);
+        if (FAILED(hr)) {
+            // Fallback: try with FLIP_SEQUENTIAL
+            desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+            hr = dxgiFactory_->CreateSwapChainForComposition(d3dDevice_.Get(), &desc, nullptr, &s.swapChain);
+            if (FAILED(hr)) { return false; }
+        }
+
+        ComPtr<IDXGISurface> surface;
+        hr = s.swapChain->GetBuffer(0, IID_PPV_ARGS(&surface));
+        if (FAILED(hr)) return false;
+        FLOAT dpiX = 96.0f, dpiY = 96.0f;
+        d2dFactory_->GetDesktopDpi(&dpiX, &dpiY);
+        D2D1_BITMAP_PROPERTIES1 bp = D2D1::BitmapProperties1(
+            D2D1_BITMAP_OPTIONS_TARGET | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
+            D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+            dpiX, dpiY);
+        hr = d2dCtx_->CreateBitmapFromDxgiSurface(surface.Get(), &bp, &s.target);
+        return SUCCEEDED(hr);
+    }
+
+    void releaseDevice(){
+        if (d2dCtx_) d2dCtx_->SetTarget(nullptr);
+        for (auto& s : surfaces_) {
+            s.target.Reset();
+            s.swapChain.Reset();
+            s.visual.Reset();
+            s.dirty = false;
+        }
+        topVisual_.Reset();
+        cache_.Clear();
+        canvas_ = D2DCanvas{};
+        d2dCtx1_.Reset();
+        d2dCtx_.Reset();
+        d2dDevice_.Reset();
+        if (dcompTarget_) dcompTarget_->SetRoot(nullptr);
+        if (dcompDevice_) dcompDevice_->Commit();
+        root_.Reset();
+        dcompTarget_.Reset();
+        dcompDevice_.Reset();
+        dxgiFactory_.Reset();
+        dxgiDevice_.Reset();
+        d3dDevice_.Reset();
+    }
+
+    HWND hwnd_{};
+    bool comInitialized_{false};
+    int screenCx_{0};
+    int screenCy_{0};
+
+    ComPtr<ID3D11Device> d3dDevice_;
+    ComPtr<IDXGIDevice> dxgiDevice_;
+    ComPtr<IDXGIFactory2> dxgiFactory_;
+
+    ComPtr<IDCompositionDevice> dcompDevice_;
+    ComPtr<IDCompositionTarget> dcompTarget_;
+    ComPtr<IDCompositionVisual> root_;
+    ComPtr<IDCompositionVisual> topVisual_;
+
+    // D2D / DWrite
+    ComPtr<ID2D1Factory1> d2dFactory_;
+    ComPtr<ID2D1Device> d2dDevice_;
+    ComPtr<ID2D1DeviceContext> d2dCtx_;
+    ComPtr<ID2D1DeviceContext1> d2dCtx1_;
+    ComPtr<IDWriteFactory> dwFactory_;
+    D2DResourceCache cache_;
+    D2DCanvas canvas_;
+
+    std::vector<Surface> surfaces_;
+};
+
+std::unique_ptr<ICompositorDevice> CreateD2DCompositorDevice(){
+    return std::make_unique<D2DCompositorDevice>();
+}
+
+// Software fallback: one layered window per surface, updated from the
+// SoftCanvas pixels with UpdateLayeredWindow, which takes premultiplied BGRA
+// like the canvas. Needs no Direct3D device.
+class LayeredWindowDevice final : public SoftCompositorDevice {
+public:
+    LayeredWindowDevice()
+        : SoftCompositorDevice(static_cast<float>(GetSystemMetrics(SM_CXSCREEN)), static_cast<float>(GetSystemMetrics(SM_CYSCREEN))) {}
+
+    ~LayeredWindowDevice() override {
+        for (auto& w : windows_) {
+            if (w.dc) DeleteDC(w.dc);
+            if (w.bitmap) DeleteObject(w.bitmap);
+            if (w.hwnd) DestroyWindow(w.hwnd);
+        }
+    }
+
+    bool Initialize() override {
+        WNDCLASSW wc{};
+        wc.lpszClassName = L"StrafOverlaySoftWindow";
+        wc.lpfnWndProc = OverlayWndProc;
+        wc.hInstance = GetModuleHandleW(nullptr);
+        wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+        return RegisterClassW(&wc) != 0 || GetLastError() == ERROR_CLASS_ALREADY_EXISTS;
+    }
+
+    bool AddSurface(OverlayRect placement) override {
+        if (!SoftCompositorDevice::AddSurface(placement)) return false;
+        const int cx = static_cast<int>(placement.Width());
+        const int cy = static_cast<int>(placement.Height());
+        Window& w = windows_.emplace_back();
+        w.hwnd = CreateWindowExW(
+            WS_EX_TRANSPARENT | WS_EX_NOACTIVATE | WS_EX_TOOLWINDOW | WS_EX_LAYERED | WS_EX_TOPMOST,
+            L"StrafOverlaySoftWindow", L"StrafOverlay", WS_POPUP,
+            static_cast<int>(placement.left), static_cast<int>(placement.top), cx, cy,
+            nullptr, nullptr, GetModuleHandleW(nullptr), nullptr);
+        if (!w.hwnd) return false;
+        BITMAPINFO bi{};
+        bi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+        bi.bmiHeader.biWidth = cx;
+        bi.bmiHeader.biHeight = -cy; // top-down, rows in canvas order
+        bi.bmiHeader.biPlanes = 1;
+        bi.bmiHeader.biBitCount = 32;
+        bi.bmiHeader.biCompression = BI_RGB;
+        w.dc = CreateCompatibleDC(nullptr);
+        if (!w.dc) return false;
+        w.bitmap = CreateDIBSection(w.dc, &bi, DIB_RGB_COLORS, &w.bits, nullptr, 0);
+        if (!w.bitmap) return false;
+        SelectObject(w.dc, w.bitmap);
+        return true;
+    }
+
+    void ShowSurface(size_t surface, bool shown) override {
+        SoftCompositorDevice::ShowSurface(surface, shown);
+        applyVisibility(surface);
+    }
+
+    void SetVisible(bool visible) override {
+        SoftCompositorDevice::SetVisible(visible);
+        for (size_t i = 0; i < windows_.size(); ++i) applyVisibility(i);
+    }
+
+protected:
+    bool Present(size_t surface, OverlayRect placement, const SoftCanvas& pixels) override {
+        Window& w = windows_[surface];
+        std::memcpy(w.bits, pixels.Pixels(), static_cast<size_t>(pixels.Width()) * pixels.Height() * sizeof(uint32_t));
+        POINT pos{static_cast<LONG>(placement.left), static_cast<LONG>(placement.top)};
+        SIZE size{pixels.Width(), pixels.Height()};
+        POINT origin{0, 0};
+        BLENDFUNCTION blend{AC_SRC_OVER, 0, 255, AC_SRC_ALPHA};
+        // A failed update keeps the previous content; there is no device to recover
+        UpdateLayeredWindow(w.hwnd, nullptr, &pos, &size, w.dc, &origin, 0, &blend, ULW_ALPHA);
+        return true;
+    }
+
+private:
+    struct Window {
+        HWND hwnd{};
+        HDC dc{};
+        HBITMAP bitmap{};
+        void* bits{nullptr};
+    };
+
+    void applyVisibility(size_t surface) {
+        // Async: the owning thread may be joining the render thread
+        ShowWindowAsync(windows_[surface].hwnd, visible_ && Shown(surface) ? SW_SHOWNA : SW_HIDE);
+    }
+
+    std::vector<Window> windows_; // one per surface
+};
+
+class OverlayNoop : public IOverlayRenderer {
+public:
+    bool Initialize() override { return true; }
+    void ShowPenalty(WordId) override {}
+    void UpdateStatus(int, WordId) override {}
+    void Hide() override {}
+};
+
+// A built-in style as a Direct2D layer and as its software counterpart.
+struct OverlayStyle {
+    std::string_view name;
+    std::unique_ptr<IOverlayLayer> (*gpu)();
+    std::unique_ptr<IOverlayLayer> (*cpu)();
+};
+
+constexpr OverlayStyle kStyles[] = {
+    {"classic", CreateClassicLayer, CreateSoftClassicLayer},
+    {"bar", CreateBarLayer, CreateSoftBarLayer},
+    {"vignette", CreateVignetteLayer, CreateSoftVignetteLayer},
+};
+
+// Compositor on the GPU device, or on the software device when no Direct3D
+// device can be created (or STRAF_OVERLAY_SOFTWARE is set). The choice is
+// made once, in Initialize().
+class FallbackOverlay final : public IOverlayRenderer {
+public:
+    explicit FallbackOverlay(std::vector<const OverlayStyle*> styles) : styles_(std::move(styles)) {}
+
+    bool Initialize() override {
+        if (!IsEnvSetA("STRAF_OVERLAY_SOFTWARE")) {
+            active_ = build(CreateD2DCompositorDevice(), false);
+            if (active_->Initialize()) return true;
+        }
+        active_ = build(std::make_unique<LayeredWindowDevice>(), true);
+        return active_->Initialize();
+    }
+
+    void ShowPenalty(WordId word) override { if (active_) active_->ShowPenalty(word); }
+    void UpdateStatus(int stars, WordId word) override { if (active_) active_->UpdateStatus(stars, word); }
+    void Hide() override { if (active_) active_->Hide(); }
+    OverlayFrameStats GetFrameStats() const override { return active_ ? active_->GetFrameStats() : OverlayFrameStats{}; }
+
+private:
+    std::unique_ptr<OverlayCompositor> build(std::unique_ptr<ICompositorDevice> device, bool software) const {
+        auto overlay = std::make_unique<OverlayCompositor>(std::move(device));
+        for (const OverlayStyle* style : styles_) {
+            overlay->AddLayer(software ? style->cpu() : style->gpu());
+        }
+        return overlay;
+    }
+
+    std::vector<const OverlayStyle*> styles_;
+    std::unique_ptr<OverlayCompositor> active_;
+};
+
+std::unique_ptr<IOverlayRenderer> CreateOverlayClassic(){
+    return std::make_unique<FallbackOverlay>(std::vector<const OverlayStyle*>{&kStyles[0]});
+}
+
+std::unique_ptr<IOverlayRenderer> CreateOverlayBar(){
+    return std::make_unique<FallbackOverlay>(std::vector<const OverlayStyle*>{&kStyles[1]});
+}
+
+std::unique_ptr<IOverlayRenderer> CreateOverlayVignette(){
+    return std::make_unique<FallbackOverlay>(std::vector<const OverlayStyle*>{&kStyles[2]});
+}
+
+std::unique_ptr<IOverlayRenderer> CreateOverlayStub() {
+    if (IsEnvSetA("STRAF_NO_OVERLAY")) {
+        return std::make_unique<OverlayNoop>();
+    }
+    char style[64]{};
+    if (GetEnvironmentVariableA("STRAF_OVERLAY_STYLE", style, (DWORD)sizeof(style)) == 0){
+        return CreateOverlayClassic();
+    }
+    std::string s(style);
+    for (auto& c : s) c = (char)tolower((unsigned char)c);
+    if (s == "headless"){
+        return CreateOverlayHeadless();
+    }
+    // "+"-separated styles stack on one device, first at the bottom
+    std::vector<const OverlayStyle*> styles;
+    std::string_view rest(s);
+    while (!rest.empty()){
+        const size_t plus = rest.find('+');
+        const std::string_view name = rest.substr(0, plus);
+        rest = plus == std::string_view::npos ? std::string_view{} : rest.substr(plus + 1);
+        for (const OverlayStyle& known : kStyles){
+            if (name == known.name) styles.push_back(&known);
+        }
+    }
+    if (styles.empty()){
+        styles.push_back(&kStyles[0]);
+    }
+    return std::make_unique<FallbackOverlay>(std::move(styles));
+}
+
+}
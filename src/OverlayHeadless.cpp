@@ -0,0 +1,96 @@
+// Headless overlay: the real compositor on a device that draws nothing.
+// Portable; used where there is no display and to check that idle overlays
+// render no frames.
+#include "Straf/Overlay.h"
+#include "Straf/OverlayCompositor.h"
+
+namespace Straf {
+
+bool HeadlessCompositorDevice::AddSurface(OverlayRect placement) {
+    std::lock_guard lock(mutex_);
+    surfaces_.push_back(Surface{placement});
+    return true;
+}
+
+bool HeadlessCompositorDevice::BeginDraw(size_t surface) {
+    std::lock_guard lock(mutex_);
+    return surface < surfaces_.size();
+}
+
+bool HeadlessCompositorDevice::EndDraw(size_t surface) {
+    std::lock_guard lock(mutex_);
+    if (lost_) return false;
+    ++surfaces_[surface].draws;
+    return true;
+}
+
+void HeadlessCompositorDevice::ShowSurface(size_t surface, bool shown) {
+    std::lock_guard lock(mutex_);
+    surfaces_[surface].shown = shown;
+}
+
+bool HeadlessCompositorDevice::Commit() {
+    std::lock_guard lock(mutex_);
+    ++commits_;
+    return !lost_;
+}
+
+void HeadlessCompositorDevice::SetVisible(bool visible) {
+    std::lock_guard lock(mutex_);
+    visible_ = visible;
+}
+
+bool HeadlessCompositorDevice::Reset() {
+    std::lock_guard lock(mutex_);
+    lost_ = false;
+    ++resets_;
+    for (auto& s : surfaces_) s.shown = false;
+    return true;
+}
+
+void HeadlessCompositorDevice::LoseDevice() {
+    std::lock_guard lock(mutex_);
+    lost_ = true;
+}
+
+std::vector<HeadlessCompositorDevice::Surface> HeadlessCompositorDevice::Surfaces() const {
+    std::lock_guard lock(mutex_);
+    return surfaces_;
+}
+
+bool HeadlessCompositorDevice::Visible() const {
+    std::lock_guard lock(mutex_);
+    return visible_;
+}
+
+uint64_t HeadlessCompositorDevice::Commits() const {
+    std::lock_guard lock(mutex_);
+    return commits_;
+}
+
+uint64_t HeadlessCompositorDevice::Resets() const {
+    std::lock_guard lock(mutex_);
+    return resets_;
+}
+
+namespace {
+
+// Full-screen layer that draws nothing; visible whenever the scene is.
+class NullLayer final : public IOverlayLayer {
+public:
+    std::string_view Name() const override { return "headless"; }
+    OverlayRect Placement(float screenWidth, float screenHeight) const override { return {0, 0, screenWidth, screenHeight}; }
+    bool CreateResources(IOverlayCanvas&) override { return true; }
+    void ReleaseResources() override {}
+    std::optional<clock::time_point> Draw(IOverlayCanvas&, const OverlayScene&, clock::time_point) override { return std::nullopt; }
+};
+
+}
+
+std::unique_ptr<IOverlayRenderer> CreateOverlayHeadless(){
+    auto overlay = std::make_unique<OverlayCompositor>(std::make_unique<HeadlessCompositorDevice>());
+    overlay->AddLayer(std::make_unique<NullLayer>());
+    return overlay;
+}
+
+}
@@ -0,0 +1,106 @@
+#include "Straf/OverlayRenderLoop.h"
+#include "Straf/Metrics.h"
+#include "Straf/Trace.h"
+#include <algorithm>
+
+namespace Straf {
+
+void OverlayRenderLoop::Start() {
+    if (thread_.joinable()) return;
+    stop_ = false;
+    thread_ = std::thread([this]{ Run(); });
+}
+
+void OverlayRenderLoop::Stop() {
+    if (!thread_.joinable()) return;
+    stop_ = true;
+    wake_.Notify();
+    thread_.join();
+}
+
+void OverlayRenderLoop::ShowPenalty(WordId word) {
+    {
+        std::lock_guard lock(writeMutex_);
+        latest_.word = word;
+        latest_.stars = std::max(latest_.stars, 1); // ensure at least one
+        latest_.visible = true;
+        PublishLocked();
+    }
+    wake_.Notify();
+}
+
+void OverlayRenderLoop::UpdateStatus(int stars, WordId word) {
+    {
+        std::lock_guard lock(writeMutex_);
+        latest_.stars = std::clamp(stars, 0, 5);
+        if (word != kNoWord) latest_.word = word;
+        PublishLocked();
+    }
+    wake_.Notify();
+}
+
+void OverlayRenderLoop::SetVisible(bool visible) {
+    {
+        std::lock_guard lock(writeMutex_);
+        if (latest_.visible == visible) return;
+        latest_.visible = visible;
+        PublishLocked();
+    }
+    wake_.Notify();
+}
+
+// Hands the whole scene to the render thread under a new version.
+void OverlayRenderLoop::PublishLocked() {
+    ++latest_.version;
+    latest_.flow = trace::CurrentFlow();
+    published_.Back() = latest_;
+    published_.Publish();
+    version_.store(latest_.version, std::memory_order_relaxed);
+}
+
+OverlayScene OverlayRenderLoop::Scene() const {
+    std::lock_guard lock(writeMutex_);
+    return latest_;
+}
+
+OverlayFrameStats OverlayRenderLoop::Stats() const {
+    OverlayFrameStats s;
+    s.frames = frames_.load(std::memory_order_relaxed);
+    s.wakeups = wake_.Wakeups();
+    s.updates = version_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void OverlayRenderLoop::Run() {
+    trace::SetThreadName("overlay render");
+    metrics::Histogram& frameTime = metrics::Metrics().AddHistogram(
+        "straf_overlay_frame_seconds", "Time to draw and present one overlay frame.", {1e-5, 1.0});
+    bool shown = false;
+    std::optional<IOverlayBackend::clock::time_point> animation;
+    while (!stop_) {
+        const auto now = IOverlayBackend::clock::now();
+        // Adopts the newest scene if one was published; edits that land while
+        // the frame is drawn are picked up on the next pass.
+        const bool changed = published_.Refresh();
+        if (changed || (animation && now >= *animation)) {
+            const OverlayScene& scene = published_.Front();
+            animation.reset();
+            const bool show = backend_.ShouldShow(scene);
+            if (show) {
+                trace::Span span("overlay", "drawFrame");
+                if (changed) span.Flow(scene.flow); // the first frame of an edit joins its flow
+                animation = backend_.DrawFrame(scene, now);
+                frameTime.Observe(IOverlayBackend::clock::now() - now);
+                frames_.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (show != shown) {
+                backend_.SetVisible(show);
+                shown = show;
+            }
+            continue;
+        }
+        wake_.WaitUntil(animation);
+    }
+}
+
+}
@@ -0,0 +1,241 @@
+// Software overlay: compositor device over SoftCanvas buffers and the built-in
+// layers drawn on the CPU. Portable; the GPU-less fallback on Windows.
+#include "Straf/OverlaySoft.h"
+#include "Straf/WordTable.h"
+
+#include <algorithm>
+#include <string>
+
+namespace Straf {
+
+bool SoftCompositorDevice::AddSurface(OverlayRect placement) {
+    SoftSurface s;
+    s.placement = placement;
+    s.pixels.Resize(static_cast<int>(placement.Width()), static_cast<int>(placement.Height()));
+    surfaces_.push_back(std::move(s));
+    return true;
+}
+
+bool SoftCompositorDevice::BeginDraw(size_t surface) {
+    if (surface >= surfaces_.size()) return false;
+    SoftSurface& s = surfaces_[surface];
+    s.pixels.Clear();
+    canvas_.target = &s.pixels;
+    return true;
+}
+
+bool SoftCompositorDevice::EndDraw(size_t surface) {
+    canvas_.target = nullptr;
+    surfaces_[surface].dirty = true; // presented with the frame in Commit()
+    return true;
+}
+
+void SoftCompositorDevice::ShowSurface(size_t surface, bool shown) {
+    surfaces_[surface].shown = shown;
+}
+
+bool SoftCompositorDevice::Commit() {
+    for (size_t i = 0; i < surfaces_.size(); ++i) {
+        SoftSurface& s = surfaces_[i];
+        if (!s.dirty) continue;
+        s.dirty = false;
+        if (!Present(i, s.placement, s.pixels)) return false;
+    }
+    return true;
+}
+
+bool SoftCompositorDevice::Reset() {
+    for (auto& s : surfaces_) {
+        s.shown = false;
+        s.dirty = false;
+    }
+    return true;
+}
+
+bool SoftCompositorDevice::Present(size_t, OverlayRect, const SoftCanvas&) {
+    return true;
+}
+
+namespace {
+
+constexpr SoftColor kWhite{1.0f, 1.0f, 1.0f, 1.0f};
+
+SoftCanvas& Target(IOverlayCanvas& canvas) {
+    return *static_cast<SoftOverlayCanvas&>(canvas).target;
+}
+
+// "<prefix><separator><word>", or `prefix` alone when the word has no text,
+// vertically centred in the box like the DirectWrite captions. The bitmap
+// font is wider than those, so the size steps down until the caption fits.
+void DrawCaption(SoftCanvas& canvas, std::string& scratch, OverlayRect box, std::string_view prefix,
+                 std::string_view separator, WordId word, float height, SoftColor color) {
+    scratch.assign(prefix);
+    const std::string_view name = Words().Name(word);
+    if (!name.empty()) {
+        scratch.append(separator);
+        scratch.append(name);
+    }
+    while (height > 8.0f && SoftCanvas::MeasureText(scratch, height) > box.Width()) height -= 8.0f;
+    canvas.FillText(box.left, box.top + (box.Height() - SoftCanvas::LineHeight(height)) * 0.5f, scratch, height, color);
+}
+
+// Star outline at the origin and its stroke, rebuilt when the radius changes.
+struct SoftStar {
+    float radius{-1.0f};
+    SoftPath fill;
+    SoftPath stroke;
+
+    void Draw(SoftCanvas& canvas, SoftPoint center, float r, float innerRatio, float strokeWidth,
+              SoftColor color, bool filled) {
+        if (r != radius) {
+            radius = r;
+            fill = SoftPath::Star(r, innerRatio);
+            stroke = fill.Stroke(strokeWidth);
+        }
+        if (filled) canvas.FillPath(fill, color, center);
+        canvas.FillPath(stroke, color, center);
+    }
+};
+
+class SoftClassicLayer final : public IOverlayLayer {
+public:
+    std::string_view Name() const override { return "classic"; }
+    OverlayRect Placement(float, float) const override { return {0.0f, 0.0f, 800.0f, 200.0f}; } // top-left banner
+    bool CreateResources(IOverlayCanvas& canvas) override { return dynamic_cast<SoftOverlayCanvas*>(&canvas) != nullptr; }
+    void ReleaseResources() override { star_ = SoftStar{}; }
+
+    std::optional<clock::time_point> Draw(IOverlayCanvas& canvas, const OverlayScene& scene, clock::time_point) override {
+        SoftCanvas& c = Target(canvas);
+        const float width = static_cast<float>(c.Width());
+        const float bannerHeight = c.Height() * 0.22f;
+        c.FillRect(0.0f, 0.0f, width, bannerHeight, {0.0f, 0.0f, 0.0f, 0.55f});
+
+        const float margin = 16.0f;
+        const float starRadius = bannerHeight * 0.28f;
+        float cx = margin + starRadius;
+        const float cy = bannerHeight * 0.58f;
+        for (int i = 0; i < 5; ++i) {
+            const bool active = i < scene.stars;
+            star_.Draw(c, {cx, cy}, starRadius, 0.5f, 2.0f, active ? kGold : kStarInactive, active);
+            cx += starRadius * 2.2f;
+        }
+
+        const float textLeft = std::max(cx + margin, width * 0.35f);
+        DrawCaption(c, caption_, {textLeft, bannerHeight * 0.15f, width - margin, bannerHeight - margin * 0.5f},
+                    "Gestraf", "  -  ", scene.word, 48.0f, kWhite);
+        return std::nullopt; // static frame
+    }
+
+private:
+    static constexpr SoftColor kGold{1.0f, 0.843f, 0.0f, 1.0f};
+    static constexpr SoftColor kStarInactive{0.4f, 0.4f, 0.4f, 0.7f};
+    SoftStar star_;
+    std::string caption_;
+};
+
+class SoftBarLayer final : public IOverlayLayer {
+public:
+    std::string_view Name() const override { return "bar"; }
+    OverlayRect Placement(float, float screenHeight) const override { return {0.f, screenHeight - 140.f, 800.f, screenHeight - 20.f}; }
+    bool CreateResources(IOverlayCanvas& canvas) override { return dynamic_cast<SoftOverlayCanvas*>(&canvas) != nullptr; }
+    void ReleaseResources() override {}
+
+    std::optional<clock::time_point> Draw(IOverlayCanvas& canvas, const OverlayScene& scene, clock::time_point) override {
+        SoftCanvas& c = Target(canvas);
+        const float w = static_cast<float>(c.Width()), h = static_cast<float>(c.Height());
+        c.FillRect(0, 0, w, h, {0.f, 0.f, 0.f, 0.65f});
+        const float ratio = std::clamp(scene.stars, 0, 5) / 5.0f;
+        c.FillRect(0, 0, w * ratio, h, {0.196f, 0.804f, 0.196f, 1.0f}); // LimeGreen
+        DrawCaption(c, caption_, {16.f, 10.f, w - 16.f, h - 10.f}, "Straf Bar", " - ", scene.word, 40.f, kWhite);
+        return std::nullopt;
+    }
+
+private:
+    std::string caption_;
+};
+
+class SoftVignetteLayer final : public IOverlayLayer {
+public:
+    std::string_view Name() const override { return "vignette"; }
+    OverlayRect Placement(float screenWidth, float screenHeight) const override { return {0.0f, 0.0f, screenWidth, screenHeight}; }
+    bool Visible(const OverlayScene& scene) const override { return scene.visible && scene.stars > 0; }
+    bool CreateResources(IOverlayCanvas& canvas) override { return dynamic_cast<SoftOverlayCanvas*>(&canvas) != nullptr; }
+    void ReleaseResources() override { star_ = SoftStar{}; indicator_.Clear(); border_.Clear(); }
+
+    std::optional<clock::time_point> Draw(IOverlayCanvas& canvas, const OverlayScene& scene, clock::time_point) override {
+        SoftCanvas& c = Target(canvas);
+        if (scene.stars > 0) drawProgressiveVignette(c, scene.stars);
+        drawStatusIndicator(c, scene.stars, scene.word);
+        return std::nullopt; // static frame
+    }
+
+private:
+    // Same rings as the Direct2D vignette: an outer gradient that closes in
+    // with the star count and a darker inner ring from three stars on.
+    static void drawProgressiveVignette(SoftCanvas& c, int stars) {
+        const float w = static_cast<float>(c.Width()), h = static_cast<float>(c.Height());
+        const SoftPoint center{w * 0.5f, h * 0.5f};
+        const float intensity = stars / 5.0f;
+        const float baseRadius = std::min(w, h) * 0.6f;
+        const float vignetteRadius = baseRadius * (1.0f - (intensity * 0.7f));
+        const SoftGradientStop outer[3] = {
+            {0.0f, {0, 0, 0, 0.0f}},
+            {0.7f, {0, 0, 0, 0.0f}},
+            {1.0f, {0.1f, 0.05f, 0.2f, intensity * 0.8f}}};
+        c.FillRadialGradient(center, vignetteRadius, outer, 3);
+        if (stars >= 3) {
+            const float innerIntensity = (stars - 2) / 3.0f;
+            const SoftGradientStop inner[2] = {
+                {0.0f, {0, 0, 0, 0.0f}},
+                {1.0f, {0.2f, 0.1f, 0.3f, innerIntensity * 0.6f}}};
+            c.FillRadialGradient(center, vignetteRadius * 0.8f, inner, 2);
+        }
+    }
+
+    void drawStatusIndicator(SoftCanvas& c, int stars, WordId word) {
+        const float indicatorWidth = 300.0f, indicatorHeight = 80.0f, margin = 20.0f;
+        if (indicator_.Empty()) {
+            indicator_ = SoftPath::RoundedRect(margin, margin, margin + indicatorWidth, margin + indicatorHeight, 10.0f);
+            border_ = indicator_.Stroke(1.5f);
+        }
+        c.FillPath(indicator_, {0.15f, 0.1f, 0.25f, 0.85f});
+        c.FillPath(border_, {0.5f, 0.3f, 0.7f, 0.8f});
+
+        const float starRadius = indicatorHeight * 0.15f;
+        float startX = margin + 15.0f + starRadius;
+        const float starY = margin + indicatorHeight * 0.5f;
+        for (int i = 0; i < 5; ++i) {
+            const bool active = i < stars;
+            star_.Draw(c, {startX, starY}, starRadius, 0.4f, 1.5f,
+                       active ? SoftColor{1.0f, 0.647f, 0.0f, 1.0f} : SoftColor{0.3f, 0.3f, 0.4f, 0.6f}, active);
+            startX += starRadius * 2.1f;
+        }
+
+        // Text with shadow
+        const OverlayRect text{startX + 10.0f, margin + indicatorHeight * 0.2f, margin + indicatorWidth - 10.0f, margin + indicatorHeight - 10.0f};
+        const OverlayRect shadow{text.left + 1.0f, text.top + 1.0f, text.right + 1.0f, text.bottom + 1.0f};
+        DrawCaption(c, caption_, shadow, "Gestraf", " \xE2\x80\xA2 ", word, 16.0f, {0, 0, 0, 0.5f});
+        DrawCaption(c, caption_, text, "Gestraf", " \xE2\x80\xA2 ", word, 16.0f, kWhite);
+    }
+
+    SoftStar star_;
+    SoftPath indicator_;
+    SoftPath border_;
+    std::string caption_;
+};
+
+} // namespace
+
+std::unique_ptr<IOverlayLayer> CreateSoftClassicLayer(){
+    return std::make_unique<SoftClassicLayer>();
+}
+
+std::unique_ptr<IOverlayLayer> CreateSoftBarLayer(){
+    return std::make_unique<SoftBarLayer>();
+}
+
+std::unique_ptr<IOverlayLayer> CreateSoftVignetteLayer(){
+    return std::make_unique<SoftVignetteLayer>();
+}
+
+}
@@ -1,3 +1,3 @@
-// Deprecated: moved to OverlayClassic.cpp.
+// Deprecated: moved to OverlayDComp.cpp.
 // This file is intentionally empty and excluded from CMake targets.
-// Do not add code here; use CreateOverlayClassic/CreateOverlayStub in OverlayClassic.cpp.
+// Do not add code here; use CreateOverlayClassic/CreateOverlayStub in OverlayDComp.cpp.
@@ -0,0 +1,565 @@
+#include "Straf/PatternRules.h"
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+namespace Straf {
+
+namespace {
+
+using ByteSet = std::bitset<256>;
+
+struct Node {
+    enum class Kind { Empty, Set, Concat, Alt, Repeat } kind{Kind::Empty};
+    ByteSet set;
+    std::vector<std::unique_ptr<Node>> children;
+    int min{0};
+    int max{0}; // -1: unbounded
+    size_t states{1}; // NFA states Nfa::Build() creates for this node
+};
+
+// Recursive-descent parser for the bounded regex subset. Tracks how many NFA
+// states each node expands to so nested repeats fail here, before anything
+// is built.
+class Parser {
+public:
+    explicit Parser(std::string_view text) : s_(text) {}
+
+    std::unique_ptr<Node> Parse(std::string& error) {
+        auto node = ParseAlt();
+        if (!error_.empty()) { error = error_; return nullptr; }
+        if (pos_ != s_.size()) { error = "unexpected ')' at " + std::to_string(pos_); return nullptr; }
+        return node;
+    }
+
+private:
+    bool More() const { return pos_ < s_.size(); }
+    char Peek() const { return s_[pos_]; }
+    void Fail(const std::string& what) { if (error_.empty()) error_ = what + " at " + std::to_string(pos_); }
+
+    bool CheckSize(const Node& node) {
+        if (node.states <= PatternSet::kMaxRuleStates) return true;
+        Fail("repeats expand beyond " + std::to_string(PatternSet::kMaxRuleStates) + " states");
+        return false;
+    }
+
+    std::unique_ptr<Node> ParseAlt() {
+        auto first = ParseConcat();
+        if (!More() || Peek() != '|') return first;
+        auto alt = std::make_unique<Node>();
+        alt->kind = Node::Kind::Alt;
+        alt->children.push_back(std::move(first));
+        while (More() && Peek() == '|') {
+            ++pos_;
+            alt->children.push_back(ParseConcat());
+        }
+        alt->states = 2;
+        for (const auto& child : alt->children) alt->states += child->states;
+        CheckSize(*alt);
+        return alt;
+    }
+
+    std::unique_ptr<Node> ParseConcat() {
+        auto cat = std::make_unique<Node>();
+        cat->kind = Node::Kind::Concat;
+        while (More() && Peek() != '|' && Peek() != ')' && error_.empty()) {
+            cat->children.push_back(ParseRepeat());
+        }
+        for (const auto& child : cat->children) cat->states += child->states;
+        CheckSize(*cat);
+        return cat;
+    }
+
+    std::unique_ptr<Node> ParseRepeat() {
+        auto atom = ParseAtom();
+        while (More() && error_.empty()) {
+            int lo = 0, hi = 0;
+            char c = Peek();
+            if (c == '*') { lo = 0; hi = -1; ++pos_; }
+            else if (c == '+') { lo = 1; hi = -1; ++pos_; }
+            else if (c == '?') { lo = 0; hi = 1; ++pos_; }
+            else if (c == '{') {
+                ++pos_;
+                lo = ParseNumber();
+                hi = lo;
+                if (More() && Peek() == ',') { ++pos_; hi = ParseNumber(); }
+                if (!More() || Peek() != '}') { Fail("expected '}'"); break; }
+                ++pos_;
+                if (hi < lo || hi > PatternSet::kMaxRepeat) { Fail("repeat bound out of range"); break; }
+            } else {
+                break;
+            }
+            auto rep = std::make_unique<Node>();
+            rep->kind = Node::Kind::Repeat;
+            rep->min = lo;
+            rep->max = hi;
+            // Build() emits one copy of the body per bound (min + 1 when unbounded)
+            const size_t copies = static_cast<size_t>(hi < 0 ? lo + 1 : hi);
+            rep->states = 2 + copies * atom->states;
+            rep->children.push_back(std::move(atom));
+            atom = std::move(rep);
+            if (!CheckSize(*atom)) break;
+        }
+        return atom;
+    }
+
+    int ParseNumber() {
+        int n = 0, digits = 0;
+        while (More() && std::isdigit(static_cast<unsigned char>(Peek())) && digits < 4) {
+            n = n * 10 + (Peek() - '0');
+            ++pos_;
+            ++digits;
+        }
+        if (digits == 0) Fail("expected number");
+        return n;
+    }
+
+    std::unique_ptr<Node> ParseAtom() {
+        auto node = std::make_unique<Node>();
+        if (!More()) { Fail("unexpected end"); return node; }
+        char c = s_[pos_++];
+        switch (c) {
+            case '(': {
+                node = ParseAlt();
+                if (!More() || Peek() != ')') { Fail("expected ')'"); return node; }
+                ++pos_;
+                return node;
+            }
+            case '[': node->kind = Node::Kind::Set; node->states = 2; node->set = ParseClass(); return node;
+            case '.': node->kind = Node::Kind::Set; node->states = 2; node->set.set(); return node;
+            case '*': case '+': case '?': case '{': Fail("nothing to repeat"); return node;
+            case '\\':
+                if (!More()) { Fail("dangling escape"); return node; }
+                c = s_[pos_++];
+                [[fallthrough]];
+            default:
+                node->kind = Node::Kind::Set;
+                node->states = 2;
+                node->set.set(static_cast<uint8_t>(c));
+                return node;
+        }
+    }
+
+    ByteSet ParseClass() {
+        ByteSet set;
+        bool negate = More() && Peek() == '^';
+        if (negate) ++pos_;
+        bool first = true;
+        while (More() && (Peek() != ']' || first)) {
+            first = false;
+            uint8_t lo = static_cast<uint8_t>(s_[pos_++]);
+            if (lo == '\\' && More()) lo = static_cast<uint8_t>(s_[pos_++]);
+            uint8_t hi = lo;
+            if (pos_ + 1 < s_.size() && Peek() == '-' && s_[pos_ + 1] != ']') {
+                ++pos_;
+                hi = static_cast<uint8_t>(s_[pos_++]);
+                if (hi == '\\' && More()) hi = static_cast<uint8_t>(s_[pos_++]);
+            }
+            if (hi < lo) { Fail("inverted range"); return set; }
+            for (int b = lo; b <= hi; ++b) set.set(static_cast<size_t>(b));
+        }
+        if (!More()) { Fail("unterminated class"); return set; }
+        ++pos_; // ']'
+        return negate ? ~set : set;
+    }
+
+    std::string_view s_;
+    size_t pos_{0};
+    std::string error_;
+};
+
+// Thompson NFA: each state has epsilon edges and at most one byte-set edge.
+struct Nfa {
+    struct State {
+        std::vector<uint32_t> eps;
+        int setIndex{-1};
+        uint32_t target{0};
+        int32_t accept{-1};
+        int32_t rule{-1};       // owning rule, -1 for the shared root
+        bool universal{false};  // accepts its rule on every continuation (e.g. trailing `*`)
+    };
+    std::vector<State> states;
+    std::vector<ByteSet> sets;
+
+    uint32_t Add() { states.emplace_back(); return static_cast<uint32_t>(states.size() - 1); }
+
+    // Builds `node` between fresh states; returns {start, end}.
+    std::pair<uint32_t, uint32_t> Build(const Node& node) {
+        switch (node.kind) {
+            case Node::Kind::Empty: {
+                uint32_t s = Add();
+                return {s, s};
+            }
+            case Node::Kind::Set: {
+                uint32_t s = Add(), e = Add();
+                sets.push_back(node.set);
+                states[s].setIndex = static_cast<int>(sets.size() - 1);
+                states[s].target = e;
+                return {s, e};
+            }
+            case Node::Kind::Concat: {
+                uint32_t s = Add(), cur = s;
+                for (const auto& child : node.children) {
+                    auto [cs, ce] = Build(*child);
+                    states[cur].eps.push_back(cs);
+                    cur = ce;
+                }
+                return {s, cur};
+            }
+            case Node::Kind::Alt: {
+                uint32_t s = Add(), e = Add();
+                for (const auto& child : node.children) {
+                    auto [cs, ce] = Build(*child);
+                    states[s].eps.push_back(cs);
+                    states[ce].eps.push_back(e);
+                }
+                return {s, e};
+            }
+            case Node::Kind::Repeat: {
+                const Node& body = *node.children[0];
+                uint32_t s = Add(), cur = s;
+                for (int i = 0; i < node.min; ++i) {
+                    auto [cs, ce] = Build(body);
+                    states[cur].eps.push_back(cs);
+                    cur = ce;
+                }
+                if (node.max < 0) {
+                    auto [cs, ce] = Build(body);
+                    uint32_t e = Add();
+                    states[cur].eps.push_back(cs);
+                    states[cur].eps.push_back(e);
+                    states[ce].eps.push_back(cs);
+                    states[ce].eps.push_back(e);
+                    return {s, e};
+                }
+                uint32_t e = Add();
+                for (int i = node.min; i < node.max; ++i) {
+                    auto [cs, ce] = Build(body);
+                    states[cur].eps.push_back(e);
+                    states[cur].eps.push_back(cs);
+                    cur = ce;
+                }
+                states[cur].eps.push_back(e);
+                return {s, e};
+            }
+        }
+        return {Add(), Add()};
+    }
+
+    void Closure(std::vector<uint32_t>& set, std::vector<uint8_t>& mark) const {
+        std::vector<uint32_t> stack(set.begin(), set.end());
+        for (uint32_t s : set) mark[s] = 1;
+        while (!stack.empty()) {
+            uint32_t s = stack.back();
+            stack.pop_back();
+            for (uint32_t t : states[s].eps) {
+                if (!mark[t]) { mark[t] = 1; set.push_back(t); stack.push_back(t); }
+            }
+        }
+        for (uint32_t s : set) mark[s] = 0;
+        std::sort(set.begin(), set.end());
+    }
+
+    // A state is universal when its closure accepts and contains a match-any
+    // edge leading straight back into that closure.
+    void MarkUniversal() {
+        std::vector<uint8_t> mark(states.size(), 0);
+        for (uint32_t s = 0; s < states.size(); ++s) {
+            if (states[s].rule < 0) continue;
+            std::vector<uint32_t> closure{s};
+            Closure(closure, mark);
+            bool accepts = false;
+            for (uint32_t t : closure) accepts = accepts || states[t].accept >= 0;
+            if (!accepts) continue;
+            for (uint32_t t : closure) {
+                const auto& st = states[t];
+                if (st.setIndex < 0 || !sets[static_cast<size_t>(st.setIndex)].all()) continue;
+                if (std::binary_search(closure.begin(), closure.end(), st.target)) { states[s].universal = true; break; }
+            }
+        }
+    }
+
+    // Once some rule is certain to accept, the outcome is decided: every
+    // other state is dropped so stems like "fuck*" do not multiply the subset
+    // space of the remaining rules. Returns the deciding rule or -1.
+    int32_t PruneDecided(std::vector<uint32_t>& set) const {
+        int32_t winner = -1;
+        for (uint32_t s : set) {
+            if (states[s].universal && (winner < 0 || states[s].rule < winner)) winner = states[s].rule;
+        }
+        if (winner < 0) return -1;
+        set.erase(std::remove_if(set.begin(), set.end(), [&](uint32_t s) { return states[s].rule != winner; }),
+                  set.end());
+        return winner;
+    }
+};
+
+struct SubsetHash {
+    size_t operator()(const std::vector<uint32_t>& v) const {
+        size_t h = v.size();
+        for (uint32_t x : v) h = (h ^ x) * 0x100000001b3ull;
+        return h;
+    }
+};
+
+std::string GlobToRegex(std::string_view glob) {
+    std::string re;
+    for (char c : glob) {
+        if (c == '*') { re += ".*"; continue; }
+        if (std::string_view("\\.[]()|?+{}^").find(c) != std::string_view::npos) re += '\\';
+        re += c;
+    }
+    return re;
+}
+
+// Bytes a token can contain: the detector splits recognizer text on
+// everything else (spaces, punctuation).
+ByteSet TokenBytes() {
+    ByteSet set;
+    for (int c = 0; c < 256; ++c) set[static_cast<size_t>(c)] = std::isalnum(c) || c >= 0x80;
+    return set;
+}
+
+// What `node` can match when restricted to token bytes: the empty string,
+// and some non-empty string. A rule with no non-empty match can never fire,
+// e.g. one containing a space.
+struct TokenMatch {
+    bool empty{false};
+    bool nonEmpty{false};
+};
+
+TokenMatch MatchesToken(const Node& node, const ByteSet& tokenBytes) {
+    switch (node.kind) {
+        case Node::Kind::Empty: return {true, false};
+        case Node::Kind::Set: return {false, (node.set & tokenBytes).any()};
+        case Node::Kind::Concat: {
+            TokenMatch all{true, false};
+            for (const auto& child : node.children) {
+                const TokenMatch m = MatchesToken(*child, tokenBytes);
+                if (!m.empty && !m.nonEmpty) return {};
+                all.empty = all.empty && m.empty;
+                all.nonEmpty = all.nonEmpty || m.nonEmpty;
+            }
+            return all;
+        }
+        case Node::Kind::Alt: {
+            TokenMatch any;
+            for (const auto& child : node.children) {
+                const TokenMatch m = MatchesToken(*child, tokenBytes);
+                any.empty = any.empty || m.empty;
+                any.nonEmpty = any.nonEmpty || m.nonEmpty;
+            }
+            return any;
+        }
+        case Node::Kind::Repeat: {
+            const TokenMatch m = MatchesToken(*node.children[0], tokenBytes);
+            return {node.min == 0 || m.empty, m.nonEmpty && node.max != 0};
+        }
+    }
+    return {};
+}
+
+} // namespace
+
+bool PatternSet::IsPattern(std::string_view entry) {
+    return entry.rfind("re:", 0) == 0 || entry.find('*') != std::string_view::npos;
+}
+
+bool PatternSet::Compile(const std::vector<std::string>& patterns, std::vector<std::string>* errors) {
+    rules_.clear();
+    table_.clear();
+    accept_.clear();
+    settled_.clear();
+    classCount_ = 0;
+
+    const ByteSet tokenBytes = TokenBytes();
+    Nfa nfa;
+    const uint32_t root = nfa.Add();
+    for (const auto& raw : patterns) {
+        std::string text = raw;
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+        std::string re = text.rfind("re:", 0) == 0 ? text.substr(3) : GlobToRegex(text);
+        std::string error;
+        if (re.size() > kMaxPatternLength) error = "pattern too long";
+        std::unique_ptr<Node> ast;
+        if (error.empty()) ast = Parser(re).Parse(error);
+        if (ast && !MatchesToken(*ast, tokenBytes).nonEmpty) {
+            error = "can never match a single token (tokens contain no spaces or punctuation)";
+            ast.reset();
+        }
+        if (!ast) {
+            if (errors) errors->push_back(raw + ": " + error);
+            continue;
+        }
+        const size_t first = nfa.states.size();
+        auto [s, e] = nfa.Build(*ast);
+        for (size_t i = first; i < nfa.states.size(); ++i) nfa.states[i].rule = static_cast<int32_t>(rules_.size());
+        nfa.states[root].eps.push_back(s);
+        nfa.states[e].accept = static_cast<int32_t>(rules_.size());
+        rules_.push_back(raw);
+    }
+    if (rules_.empty()) return true;
+    nfa.MarkUniversal();
+
+    // Byte equivalence classes: bytes that no set distinguishes share a column.
+    {
+        std::vector<uint32_t> cls(256, 0);
+        uint32_t count = 1;
+        for (const auto& set : nfa.sets) {
+            std::map<std::pair<uint32_t, bool>, uint32_t> split;
+            uint32_t next = 0;
+            for (int b = 0; b < 256; ++b) {
+                auto key = std::make_pair(cls[b], static_cast<bool>(set[static_cast<size_t>(b)]));
+                auto [it, inserted] = split.try_emplace(key, next);
+                if (inserted) ++next;
+                cls[b] = it->second;
+            }
+            count = next;
+        }
+        classCount_ = count;
+        for (int b = 0; b < 256; ++b) byteClass_[b] = static_cast<uint8_t>(cls[b]);
+    }
+    std::vector<uint8_t> classRep(classCount_);
+    for (int b = 255; b >= 0; --b) classRep[byteClass_[b]] = static_cast<uint8_t>(b);
+
+    // Subset construction. State 0 is the dead (empty) set.
+    std::vector<uint8_t> mark(nfa.states.size(), 0);
+    std::unordered_map<std::vector<uint32_t>, uint32_t, SubsetHash> ids;
+    std::vector<std::vector<uint32_t>> subsets;
+    std::vector<uint32_t> table;
+    std::vector<int32_t> accept;
+    auto intern = [&](std::vector<uint32_t> set) -> uint32_t {
+        auto [it, inserted] = ids.try_emplace(set, static_cast<uint32_t>(subsets.size()));
+        if (inserted) {
+            int32_t best = -1;
+            for (uint32_t s : set) {
+                int32_t a = nfa.states[s].accept;
+                if (a >= 0 && (best < 0 || a < best)) best = a;
+            }
+            accept.push_back(best);
+            subsets.push_back(std::move(set));
+        }
+        return it->second;
+    };
+    intern({});
+    std::vector<uint32_t> startSet{root};
+    nfa.Closure(startSet, mark);
+    nfa.PruneDecided(startSet);
+    const uint32_t start = intern(std::move(startSet));
+    for (size_t d = 0; d < subsets.size(); ++d) {
+        if (subsets.size() > kMaxDfaStates) {
+            if (errors) errors->push_back("pattern automaton exceeds state limit");
+            rules_.clear();
+            return false;
+        }
+        table.resize((d + 1) * classCount_);
+        for (uint32_t c = 0; c < classCount_; ++c) {
+            std::vector<uint32_t> moved;
+            for (uint32_t s : subsets[d]) {
+                const auto& st = nfa.states[s];
+                if (st.setIndex >= 0 && nfa.sets[static_cast<size_t>(st.setIndex)][classRep[c]]) moved.push_back(st.target);
+            }
+            std::sort(moved.begin(), moved.end());
+            moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+            nfa.Closure(moved, mark);
+            nfa.PruneDecided(moved);
+            table[d * classCount_ + c] = intern(std::move(moved));
+        }
+    }
+
+    // Hopcroft minimization: start from blocks keyed by accepted rule and split
+    // them by the predecessors of each (block, class) splitter on the worklist.
+    // Block members are kept contiguous in `elems` so a split is a range cut.
+    const size_t n = subsets.size();
+    const uint32_t classes = classCount_;
+    std::vector<uint32_t> block(n);
+    std::vector<uint32_t> elems(n), where(n);
+    std::vector<uint32_t> begin, end, marked;
+    {
+        std::map<int32_t, std::vector<uint32_t>> byAccept;
+        for (uint32_t s = 0; s < n; ++s) byAccept[accept[s]].push_back(s);
+        uint32_t pos = 0;
+        for (const auto& [rule, members] : byAccept) {
+            const uint32_t b = static_cast<uint32_t>(begin.size());
+            begin.push_back(pos);
+            for (uint32_t s : members) { block[s] = b; where[s] = pos; elems[pos++] = s; }
+            end.push_back(pos);
+            marked.push_back(0);
+        }
+    }
+    // Predecessors of each (state, class), flattened: preds[predStart[t * classes + c] ...]
+    std::vector<uint32_t> predStart(n * classes + 1, 0), preds(n * classes);
+    for (size_t i = 0; i < n * classes; ++i) ++predStart[table[i] * classes + i % classes + 1];
+    for (size_t i = 0; i < n * classes; ++i) predStart[i + 1] += predStart[i];
+    {
+        std::vector<uint32_t> fill(predStart.begin(), predStart.end() - 1);
+        for (size_t i = 0; i < n * classes; ++i) preds[fill[table[i] * classes + i % classes]++] = static_cast<uint32_t>(i / classes);
+    }
+
+    std::vector<std::pair<uint32_t, uint32_t>> work;
+    std::vector<uint8_t> pending(n * classes, 0); // (block, class) queued
+    auto push = [&](uint32_t b, uint32_t c) {
+        if (!pending[b * classes + c]) { pending[b * classes + c] = 1; work.emplace_back(b, c); }
+    };
+    for (uint32_t b = 0; b < begin.size(); ++b) {
+        for (uint32_t c = 0; c < classes; ++c) push(b, c);
+    }
+    std::vector<uint32_t> splitter, touched;
+    while (!work.empty()) {
+        const auto [a, c] = work.back();
+        work.pop_back();
+        pending[a * classes + c] = 0;
+        splitter.assign(elems.begin() + begin[a], elems.begin() + end[a]);
+        // Move every state entering the splitter on `c` to the front of its block
+        for (uint32_t t : splitter) {
+            for (uint32_t k = predStart[t * classes + c]; k < predStart[t * classes + c + 1]; ++k) {
+                const uint32_t p = preds[k], b = block[p];
+                const uint32_t front = begin[b] + marked[b];
+                if (where[p] < front) continue;
+                std::swap(elems[where[p]], elems[front]);
+                where[elems[where[p]]] = where[p];
+                where[p] = front;
+                if (marked[b]++ == 0) touched.push_back(b);
+            }
+        }
+        for (uint32_t b : touched) {
+            const uint32_t cut = begin[b] + marked[b];
+            marked[b] = 0;
+            if (cut == end[b]) continue;
+            const uint32_t nb = static_cast<uint32_t>(begin.size());
+            begin.push_back(begin[b]);
+            end.push_back(cut);
+            marked.push_back(0);
+            begin[b] = cut;
+            for (uint32_t i = begin[nb]; i < end[nb]; ++i) block[elems[i]] = nb;
+            for (uint32_t d = 0; d < classes; ++d) {
+                if (pending[b * classes + d]) push(nb, d);
+                else push(end[b] - begin[b] < end[nb] - begin[nb] ? b : nb, d);
+            }
+        }
+        touched.clear();
+    }
+    const size_t blockCount = begin.size();
+
+    table_.assign(blockCount * classCount_, 0);
+    accept_.assign(blockCount, -1);
+    for (size_t s = 0; s < n; ++s) {
+        accept_[block[s]] = accept[s];
+        for (uint32_t c = 0; c < classCount_; ++c) {
+            table_[block[s] * classCount_ + c] = block[table[s * classCount_ + c]];
+        }
+    }
+    start_ = block[start];
+    settled_.assign(blockCount, 1);
+    for (size_t b = 0; b < blockCount; ++b) {
+        for (uint32_t c = 0; c < classCount_; ++c) {
+            if (table_[b * classCount_ + c] != b) { settled_[b] = 0; break; }
+        }
+    }
+    return true;
+}
+
+}
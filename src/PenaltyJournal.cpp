@@ -0,0 +1,443 @@
+#include "Straf/PenaltyJournal.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Straf {
+
+namespace {
+
+constexpr const char* kJournalFile = "penalty.journal";
+constexpr const char* kSnapshotFile = "penalty.snap";
+
+// CRC-32 (IEEE 802.3), table-driven.
+const std::array<uint32_t, 256>& CrcTable() {
+    static const auto table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint32_t RecordCrc(const JournalRecord& r) {
+    const auto& table = CrcTable();
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&r) + sizeof(r.crc);
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < sizeof(JournalRecord) - sizeof(r.crc); ++i) c = table[(c ^ bytes[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+void Seal(JournalRecord& r) { r.crc = RecordCrc(r); }
+
+bool Valid(const JournalRecord& r) {
+    return r.crc == RecordCrc(r) && r.type >= JournalRecordType::Snapshot && r.type <= JournalRecordType::LabelTail;
+}
+
+// Appends the record for one transition, followed by a LabelTail record for
+// every kLabelBytes of label that do not fit inline.
+void Encode(JournalRecordType type, std::string_view label, int64_t atMs, int64_t durationMs, std::vector<JournalRecord>& out) {
+    constexpr size_t kInline = JournalRecord::kLabelBytes;
+    JournalRecord r{};
+    r.type = type;
+    r.labelLength = static_cast<uint16_t>(label.size());
+    std::memcpy(r.label, label.data(), std::min(label.size(), kInline));
+    r.atMs = atMs;
+    r.durationMs = durationMs;
+    out.push_back(r);
+    for (size_t at = kInline; at < label.size(); at += kInline) {
+        JournalRecord tail{};
+        tail.type = JournalRecordType::LabelTail;
+        std::memcpy(tail.label, label.data() + at, std::min(label.size() - at, kInline));
+        out.push_back(tail);
+    }
+}
+
+// Reads the transition starting at records[i] and reassembles its label from
+// the LabelTail records after it; journal records must also carry consecutive
+// sequence numbers. Returns how many records it spans, or 0 when it is
+// corrupt or its tail was torn off.
+size_t Decode(const std::vector<JournalRecord>& records, size_t i, bool sequenced, std::string& label) {
+    const JournalRecord& r = records[i];
+    if (!Valid(r) || r.type == JournalRecordType::LabelTail) return 0;
+    label.assign(r.InlineLabel());
+    size_t n = 1;
+    while (label.size() < r.labelLength) {
+        if (i + n >= records.size()) return 0;
+        const JournalRecord& tail = records[i + n];
+        if (!Valid(tail) || tail.type != JournalRecordType::LabelTail) return 0;
+        if (sequenced && tail.sequence != r.sequence + n) return 0;
+        label.append(tail.label, std::min<size_t>(r.labelLength - label.size(), JournalRecord::kLabelBytes));
+        ++n;
+    }
+    return n;
+}
+
+std::vector<JournalRecord> ReadRecords(const fs::path& path) {
+    std::vector<JournalRecord> records;
+    std::ifstream f(path, std::ios::binary);
+    if (!f.is_open()) return records;
+    JournalRecord r;
+    while (f.read(reinterpret_cast<char*>(&r), sizeof(r))) records.push_back(r);
+    return records; // a trailing partial record is ignored
+}
+
+int64_t WallNowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+// Append-only file with explicit durability points.
+class PenaltyJournal::File {
+public:
+    ~File() { Close(); }
+
+    bool Open(const fs::path& path, bool truncate) {
+#ifdef _WIN32
+        handle_ = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                              truncate ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        return handle_ != INVALID_HANDLE_VALUE;
+#else
+        fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+        return fd_ >= 0;
+#endif
+    }
+
+    bool Write(const void* data, size_t size) {
+#ifdef _WIN32
+        LARGE_INTEGER zero{};
+        if (!SetFilePointerEx(handle_, zero, nullptr, FILE_END)) return false;
+        const auto* p = static_cast<const char*>(data);
+        while (size > 0) {
+            DWORD written = 0;
+            if (!WriteFile(handle_, p, static_cast<DWORD>(std::min<size_t>(size, 1u << 30)), &written, nullptr)) return false;
+            p += written;
+            size -= written;
+        }
+        return true;
+#else
+        const auto* p = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t n = write(fd_, p, size);
+            if (n < 0) return false;
+            p += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+#endif
+    }
+
+    bool Sync() {
+#ifdef _WIN32
+        return FlushFileBuffers(handle_) != 0;
+#elif defined(__APPLE__)
+        return fsync(fd_) == 0;
+#else
+        return fdatasync(fd_) == 0;
+#endif
+    }
+
+    bool Truncate(uint64_t size) {
+#ifdef _WIN32
+        LARGE_INTEGER pos{};
+        pos.QuadPart = static_cast<LONGLONG>(size);
+        return SetFilePointerEx(handle_, pos, nullptr, FILE_BEGIN) && SetEndOfFile(handle_);
+#else
+        return ftruncate(fd_, static_cast<off_t>(size)) == 0;
+#endif
+    }
+
+    void Close() {
+#ifdef _WIN32
+        if (handle_ != INVALID_HANDLE_VALUE) CloseHandle(handle_);
+        handle_ = INVALID_HANDLE_VALUE;
+#else
+        if (fd_ >= 0) close(fd_);
+        fd_ = -1;
+#endif
+    }
+
+    // Atomically replaces `to` with `from` once `from` is durable.
+    static bool Replace(const fs::path& from, const fs::path& to) {
+#ifdef _WIN32
+        return MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        if (rename(from.c_str(), to.c_str()) != 0) return false;
+        int dir = open(to.parent_path().empty() ? "." : to.parent_path().c_str(), O_RDONLY | O_CLOEXEC);
+        if (dir >= 0) {
+            fsync(dir);
+            close(dir);
+        }
+        return true;
+#endif
+    }
+
+private:
+#ifdef _WIN32
+    HANDLE handle_{INVALID_HANDLE_VALUE};
+#else
+    int fd_{-1};
+#endif
+};
+
+// Penalty state as described by the records applied so far, in wall-clock ms.
+struct PenaltyJournal::State {
+    struct Entry {
+        std::string label;
+        int64_t durationMs{0};
+    };
+    std::deque<Entry> queue;
+    std::optional<Entry> current;
+    int64_t currentEndMs{0};
+    int64_t cooldownEndMs{0};
+    int64_t debounceEndMs{0};
+    std::unordered_map<std::string, int64_t> phrases;
+
+    void Apply(JournalRecordType type, std::string_view label, int64_t atMs, int64_t durationMs) {
+        switch (type) {
+            case JournalRecordType::Snapshot: break;
+            case JournalRecordType::Queued:
+                queue.push_back({std::string(label), durationMs});
+                break;
+            case JournalRecordType::Started:
+                if (!queue.empty()) queue.pop_front();
+                current = Entry{std::string(label), durationMs};
+                currentEndMs = atMs;
+                break;
+            case JournalRecordType::Ended:
+                current.reset();
+                cooldownEndMs = atMs;
+                break;
+            case JournalRecordType::Phrase:
+                phrases[std::string(label)] = atMs;
+                break;
+            case JournalRecordType::Debounce:
+                debounceEndMs = atMs;
+                break;
+            case JournalRecordType::LabelTail: break; // folded into the record before it
+        }
+    }
+
+    // Drops expired phrase cooldowns and emits records that rebuild the rest.
+    void Compact(int64_t nowMs, std::vector<JournalRecord>& out) {
+        if (debounceEndMs > nowMs) Encode(JournalRecordType::Debounce, {}, debounceEndMs, 0, out);
+        if (cooldownEndMs > nowMs) Encode(JournalRecordType::Ended, {}, cooldownEndMs, 0, out);
+        for (auto it = phrases.begin(); it != phrases.end();) {
+            if (it->second <= nowMs) {
+                it = phrases.erase(it);
+            } else {
+                Encode(JournalRecordType::Phrase, it->first, it->second, 0, out);
+                ++it;
+            }
+        }
+        if (current) {
+            Encode(JournalRecordType::Queued, current->label, 0, current->durationMs, out);
+            Encode(JournalRecordType::Started, current->label, currentEndMs, current->durationMs, out);
+        }
+        for (const auto& e : queue) Encode(JournalRecordType::Queued, e.label, 0, e.durationMs, out);
+    }
+};
+
+PenaltyJournal::PenaltyJournal(const fs::path& directory, JournalOptions options)
+    : journalPath_(directory / kJournalFile), snapshotPath_(directory / kSnapshotFile), options_(options),
+      mirror_(std::make_unique<State>()), journal_(std::make_unique<File>()) {
+    wallOffset_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()) -
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+std::unique_ptr<PenaltyJournal> PenaltyJournal::Open(const std::string& directory, JournalOptions options) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    std::unique_ptr<PenaltyJournal> journal(new PenaltyJournal(fs::path(directory), options));
+    if (!journal->Recover()) return nullptr;
+    journal->writer_ = std::thread([j = journal.get()] { j->Run(); });
+    return journal;
+}
+
+PenaltyJournal::~PenaltyJournal() {
+    if (writer_.joinable()) {
+        stop_ = true;
+        wake_.Notify();
+        writer_.join();
+    }
+}
+
+bool PenaltyJournal::Recover() {
+    const auto started = std::chrono::steady_clock::now();
+
+    uint64_t covered = 0;
+    std::string label;
+    auto snapshot = ReadRecords(snapshotPath_);
+    if (!snapshot.empty() && Valid(snapshot[0]) && snapshot[0].type == JournalRecordType::Snapshot) {
+        covered = snapshot[0].sequence;
+        for (size_t i = 1, n = 0; i < snapshot.size(); i += n) {
+            if ((n = Decode(snapshot, i, false, label)) == 0) break;
+            mirror_->Apply(snapshot[i].type, label, snapshot[i].atMs, snapshot[i].durationMs);
+            replayedRecords_ += n;
+        }
+    }
+
+    // The journal tail ends at the first torn or corrupt record; anything after
+    // it was never acknowledged as durable. A transition and its label tails
+    // share one batch, so a snapshot covers all of them or none.
+    auto tail = ReadRecords(journalPath_);
+    size_t valid = 0;
+    uint64_t last = covered;
+    for (size_t n = 0; valid < tail.size(); valid += n) {
+        const JournalRecord& r = tail[valid];
+        if (r.type == JournalRecordType::Snapshot || (n = Decode(tail, valid, true, label)) == 0) break;
+        if (r.sequence <= covered) continue; // already folded into the snapshot
+        if (r.sequence <= last) break;
+        mirror_->Apply(r.type, label, r.atMs, r.durationMs);
+        last = r.sequence + n - 1;
+        replayedRecords_ += n;
+    }
+    nextSequence_ = last + 1;
+    sinceSnapshot_ = valid;
+
+    if (!journal_->Open(journalPath_, false) || !journal_->Truncate(valid * sizeof(JournalRecord))) return false;
+
+    // Hand the state over in this process's steady_clock.
+    const int64_t nowMs = WallNowMs();
+    for (const auto& e : mirror_->queue) recovered_.queue.push_back({e.label, std::chrono::milliseconds(e.durationMs)});
+    if (mirror_->current) {
+        recovered_.current = RecoveredPenaltyState::Entry{mirror_->current->label, std::chrono::milliseconds(mirror_->current->durationMs)};
+        recovered_.currentEnd = FromWallMs(mirror_->currentEndMs);
+    }
+    if (mirror_->cooldownEndMs > nowMs) recovered_.cooldownEnd = FromWallMs(mirror_->cooldownEndMs);
+    if (mirror_->debounceEndMs > nowMs) recovered_.debounceEnd = FromWallMs(mirror_->debounceEndMs);
+    for (const auto& [label, until] : mirror_->phrases) {
+        if (until > nowMs) recovered_.phrases.emplace_back(label, FromWallMs(until));
+    }
+
+    replayTime_ = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+    return true;
+}
+
+bool PenaltyJournal::Append(JournalRecordType type, WordId word, std::chrono::steady_clock::time_point at,
+                            std::chrono::milliseconds duration) {
+    const Pending entry{type, word, at == std::chrono::steady_clock::time_point{} ? 0 : ToWallMs(at), duration.count()};
+    if (Words().Name(word).size() > JournalRecord::kMaxLabelBytes || !ring_.TryPush(entry)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    appended_.fetch_add(1, std::memory_order_relaxed);
+    wake_.Notify();
+    return true;
+}
+
+void PenaltyJournal::Flush() {
+    const uint64_t target = appended_.load(std::memory_order_relaxed);
+    flushRequested_.store(target, std::memory_order_relaxed);
+    wake_.Notify();
+    while (writer_.joinable() && flushed_.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+JournalStats PenaltyJournal::GetStats() const {
+    JournalStats s;
+    s.appended = appended_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.syncs = syncs_.load(std::memory_order_relaxed);
+    s.journalBytes = journalBytes_.load(std::memory_order_relaxed);
+    s.snapshotBytes = snapshotBytes_.load(std::memory_order_relaxed);
+    s.snapshots = snapshots_.load(std::memory_order_relaxed);
+    s.replayedRecords = replayedRecords_;
+    s.replayTime = replayTime_;
+    return s;
+}
+
+void PenaltyJournal::Run() {
+    std::vector<Pending> batch;
+    batch.reserve(4096);
+    encoded_.reserve(4096);
+    for (;;) {
+        wake_.WaitUntil(std::nullopt);
+        // Group commit: let a burst accumulate so it shares one fsync.
+        if (!stop_ && flushRequested_.load(std::memory_order_relaxed) <= flushed_.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(options_.flushDelay);
+        }
+        Pending r;
+        while (ring_.TryPop(r)) batch.push_back(r);
+        if (!batch.empty()) WriteBatch(batch);
+        if (stop_) break;
+    }
+    Pending r;
+    while (ring_.TryPop(r)) batch.push_back(r);
+    if (!batch.empty()) WriteBatch(batch);
+}
+
+bool PenaltyJournal::WriteBatch(std::vector<Pending>& batch) {
+    encoded_.clear();
+    for (const Pending& p : batch) {
+        const std::string_view label = Words().Name(p.word);
+        mirror_->Apply(p.type, label, p.atMs, p.durationMs);
+        Encode(p.type, label, p.atMs, p.durationMs, encoded_);
+    }
+    for (auto& r : encoded_) {
+        r.sequence = nextSequence_++;
+        Seal(r);
+    }
+    const size_t bytes = encoded_.size() * sizeof(JournalRecord);
+    bool ok = journal_->Write(encoded_.data(), bytes) && journal_->Sync();
+    journalBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    syncs_.fetch_add(1, std::memory_order_relaxed);
+    sinceSnapshot_ += encoded_.size();
+    flushed_.fetch_add(batch.size(), std::memory_order_release);
+    batch.clear();
+    if (ok && sinceSnapshot_ >= options_.snapshotEvery) ok = WriteSnapshot();
+    return ok;
+}
+
+bool PenaltyJournal::WriteSnapshot() {
+    std::vector<JournalRecord> records;
+    Encode(JournalRecordType::Snapshot, {}, WallNowMs(), 0, records);
+    records[0].sequence = nextSequence_ - 1;
+    mirror_->Compact(WallNowMs(), records);
+    for (auto& r : records) Seal(r);
+
+    fs::path temp = snapshotPath_;
+    temp += ".tmp";
+    File file;
+    const size_t bytes = records.size() * sizeof(JournalRecord);
+    if (!file.Open(temp, true) || !file.Write(records.data(), bytes) || !file.Sync()) return false;
+    file.Close();
+    if (!File::Replace(temp, snapshotPath_)) return false;
+    snapshotBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    snapshots_.fetch_add(1, std::memory_order_relaxed);
+
+    // The snapshot covers every record so far; a crash before this truncation
+    // is harmless because replay skips sequences the snapshot already covers.
+    sinceSnapshot_ = 0;
+    return journal_->Truncate(0) && journal_->Sync();
+}
+
+int64_t PenaltyJournal::ToWallMs(std::chrono::steady_clock::time_point t) const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(t.time_since_epoch() + wallOffset_).count();
+}
+
+std::chrono::steady_clock::time_point PenaltyJournal::FromWallMs(int64_t ms) const {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::milliseconds(ms) - wallOffset_));
+}
+
+}
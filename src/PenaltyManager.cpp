@@ -1,152 +1,433 @@
 #include "Straf/PenaltyManager.h"
+#include "Straf/Metrics.h"
+#include "Straf/MpscQueue.h"
 #include "Straf/Overlay.h"
+#include "Straf/PenaltyJournal.h"
+#include "Straf/TimingWheel.h"
+#include "Straf/Trace.h"
+#include "Straf/TripleBuffer.h"
+#include "Straf/WakeSignal.h"
+#include "Straf/WordStats.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <array>
 #include <memory>
-#include <queue>
-#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Straf {
 
+namespace {
+
+// Fixed-capacity FIFO for queued penalties; never allocates.
+template<size_t Capacity>
+class PenaltyRing {
+public:
+    bool Empty() const { return size_ == 0; }
+    size_t Size() const { return size_; }
+    bool Push(const Penalty& p) {
+        if (size_ == Capacity) return false;
+        slots_[(head_ + size_) % Capacity] = p;
+        ++size_;
+        return true;
+    }
+    const Penalty& Front() const { return slots_[head_]; }
+    void Pop() {
+        head_ = (head_ + 1) % Capacity;
+        --size_;
+    }
+
+private:
+    std::array<Penalty, Capacity> slots_{};
+    size_t head_{0};
+    size_t size_{0};
+};
+
+}
+
 class PenaltyManager : public IPenaltyManager {
 public:
-    explicit PenaltyManager(IOverlayRenderer* overlay) : overlay_(overlay) {}
+    PenaltyManager(IOverlayRenderer* overlay, IClock* clock)
+        : overlay_(overlay), clock_(clock ? clock : &SystemClock()), timers_(std::chrono::milliseconds(1), clock_->Now()) {}
+    ~PenaltyManager() override { Stop(); }
 
     void Configure(int queueLimit, std::chrono::milliseconds defaultDuration, std::chrono::milliseconds defaultCooldown) override {
-        queueLimit_ = queueLimit;
-        defaultDuration_ = defaultDuration;
-        defaultCooldown_ = defaultCooldown;
+        if (queueLimit > static_cast<int>(kMaxQueued)) {
+            SPDLOG_WARN("Penalty queue limit {} exceeds the maximum of {}; using {}", queueLimit, kMaxQueued, kMaxQueued);
+        }
+        std::lock_guard lock(settingsMutex_);
+        latestSettings_.queueLimit = std::clamp(queueLimit, 0, static_cast<int>(kMaxQueued));
+        latestSettings_.defaultDuration = defaultDuration;
+        latestSettings_.defaultCooldown = defaultCooldown;
+        PublishSettingsLocked();
+    }
+
+    void SetPolicy(const PenaltyPolicy& policy) override {
+        std::lock_guard lock(settingsMutex_);
+        latestSettings_.debounce = policy.debounce;
+        latestSettings_.phraseCooldown = policy.phraseCooldown;
+        if (!policy.progressiveDurations.empty()) latestSettings_.progressiveDurations = policy.progressiveDurations;
+        PublishSettingsLocked();
+    }
+
+    void AttachJournal(std::unique_ptr<PenaltyJournal> journal) override {
+        journal_ = std::move(journal);
+        if (journal_) Restore(journal_->Recovered());
+    }
+
+    void AttachStats(WordStats* stats) override { stats_ = stats; }
+
+    void Start() override {
+        if (worker_.joinable()) return;
+        stop_ = false;
+        worker_ = std::thread([this]{ Run(); });
     }
 
-    void Trigger(const std::string& reason) override {
-        using clock = std::chrono::steady_clock;
-        auto now = clock::now();
-        
+    void Stop() override {
+        if (!worker_.joinable()) return;
+        stop_ = true;
+        wake_.Notify();
+        worker_.join();
+    }
+
+    bool Submit(DetectionEvent event) override {
+        event.enqueuedAt = std::chrono::steady_clock::now();
+        if (event.detectedAt == std::chrono::steady_clock::time_point{}) event.detectedAt = event.enqueuedAt;
+        if (!events_.TryPush(std::move(event))) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        submitted_.fetch_add(1, std::memory_order_relaxed);
+        wake_.Notify();
+        return true;
+    }
+
+    void Trigger(WordId word) override {
+        trace::Span span("penalty", "Trigger");
+        span.Flow(trace::CurrentFlow());
+        const Settings& settings = AdoptSettings();
+        auto now = clock_->Now();
+        Expire(now);
+
         // Debounce check - prevent penalties too close together
-        if (lastStraf_ + debounceDuration_ > now) { return; }
-        
+        if (debounceTimer_ != TimingWheel::kNoTimer) { Count(word, WordOutcome::Debounced); return; }
+
         // Check if we've already penalized this exact phrase recently
-        auto phraseIt = recentPhrases_.find(reason);
-        if (phraseIt != recentPhrases_.end() && phraseIt->second + phraseCooldown_ > now) { return; }
-        
-        // Record this phrase and timestamp
-        recentPhrases_[reason] = now;
-        lastStraf_ = now;
-        
+        if (word < phraseTimers_.size() && phraseTimers_[word] != TimingWheel::kNoTimer) { Count(word, WordOutcome::PhraseCooldown); return; }
+
+        // Start this phrase's cooldown and the global debounce; zero turns either off
+        if (settings.phraseCooldown.count() > 0) {
+            StartPhraseCooldown(word, now + settings.phraseCooldown);
+            Journal(JournalRecordType::Phrase, word, now + settings.phraseCooldown);
+        }
+        if (settings.debounce.count() > 0) {
+            debounceTimer_ = timers_.Schedule(now + settings.debounce, TimerTag(TimerKind::Debounce));
+            Journal(JournalRecordType::Debounce, {}, now + settings.debounce);
+        }
+
         // Progressive penalty duration - repeat offenses get longer penalties
-        int currentTotal = GetStarCount();
+        int currentTotal = CountStars();
         auto duration = CalculateProgressiveDuration(currentTotal);
-        
+
         // Queue penalty if space available
-        if ((int)queue_.size() < queueLimit_) {
-            queue_.push(Penalty{reason, duration, defaultCooldown_});
-            std::queue<Penalty> tmpQ = queue_;
-            while (!tmpQ.empty()) {
-                const auto& p = tmpQ.front();
-                tmpQ.pop();
-            }
-            overlay_->UpdateStatus(GetStarCount(), reason);
+        if ((int)queue_.Size() < settings.queueLimit) {
+            queue_.Push(Penalty{word, duration, settings.defaultCooldown, trace::CurrentFlow()});
+            Journal(JournalRecordType::Queued, word, {}, duration);
+            PublishStars();
+            overlay_->UpdateStatus(CountStars(), word);
+            Count(word, WordOutcome::Triggered);
         } else {
-            
+            Count(word, WordOutcome::QueueFull);
         }
     }
 
     void Tick() override {
-        using clock = std::chrono::steady_clock;
-        auto now = clock::now();
-        
-        // Periodically clean up old phrase entries (every 30 seconds)
-        static auto lastCleanup = now;
-        if (now - lastCleanup > std::chrono::seconds{30}) {
-            CleanupOldPhrases();
-            lastCleanup = now;
-        }
-        
-        if (current_) {
-            if (start_ + current_->duration <= now) {
-                lastEnd_ = now;
-                current_.reset();
-                int remainingStars = GetStarCount();
-                if (remainingStars > 0) {
-                    // Still have queued penalties - keep overlay visible but update status
-                    overlay_->UpdateStatus(remainingStars, "");
-                } else {
-                    // No more penalties - hide overlay
-                    overlay_->Hide();
-                    overlay_->UpdateStatus(0, "");
-                }
-            }
-            return;
-        }
+        trace::Span span("penalty", "Tick");
+        AdoptSettings();
+        auto now = clock_->Now();
+        Expire(now);
+
         // Start next if available and cooldown passed
-        if (!queue_.empty() && lastEnd_ + defaultCooldown_ <= now) {
-            current_ = queue_.front();
-            queue_.pop();
-            start_ = now;
-            overlay_->ShowPenalty(current_->label);
-            overlay_->UpdateStatus(GetStarCount(), current_->label);
+        if (!current_ && !queue_.Empty() && cooldownTimer_ == TimingWheel::kNoTimer) {
+            current_ = queue_.Front();
+            queue_.Pop();
+            span.Flow(current_->flow);
+            trace::FlowScope flow(current_->flow);
+            penaltyTimer_ = timers_.Schedule(now + current_->duration, TimerTag(TimerKind::PenaltyEnd));
+            Journal(JournalRecordType::Started, current_->word, now + current_->duration, current_->duration);
+            PublishStars();
+            overlay_->ShowPenalty(current_->word);
+            overlay_->UpdateStatus(CountStars(), current_->word);
         }
     }
 
+    void Pump() override {
+        Drain();
+        Tick();
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> NextDeadline() const override {
+        return timers_.NextExpiry();
+    }
+
     int GetStarCount() const override {
+        return stars_.load(std::memory_order_acquire);
+    }
+
+    PenaltyQueueStats GetQueueStats() const override {
+        PenaltyQueueStats s;
+        s.submitted = submitted_.load(std::memory_order_relaxed);
+        s.dropped = dropped_.load(std::memory_order_relaxed);
+        s.applied = applied_.load(std::memory_order_relaxed);
+        s.lastQueueLatency = std::chrono::nanoseconds(lastQueueLatencyNs_.load(std::memory_order_relaxed));
+        s.maxQueueLatency = std::chrono::nanoseconds(maxQueueLatencyNs_.load(std::memory_order_relaxed));
+        s.lastDetectLatency = std::chrono::nanoseconds(lastDetectLatencyNs_.load(std::memory_order_relaxed));
+        if (s.applied > 0) {
+            s.meanQueueLatency = std::chrono::nanoseconds(totalQueueLatencyNs_.load(std::memory_order_relaxed) / s.applied);
+        }
+        s.wakeups = wake_.Wakeups();
+        s.timerWakeups = wake_.TimerWakeups();
+        for (size_t i = 0; i < s.outcomes.size(); ++i) s.outcomes[i] = outcomes_[i].load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    // Everything Configure() and SetPolicy() set, published as one snapshot.
+    struct Settings {
+        int queueLimit{5};
+        std::chrono::milliseconds defaultDuration{10000};
+        std::chrono::milliseconds defaultCooldown{60000};
+        std::chrono::milliseconds debounce{3000};        // 3s between any penalties
+        std::chrono::milliseconds phraseCooldown{15000}; // 15s before same phrase can be penalized again
+        std::vector<std::chrono::milliseconds> progressiveDurations{PenaltyPolicy{}.progressiveDurations};
+    };
+
+    void PublishSettingsLocked() {
+        settingsBox_.Back() = latestSettings_;
+        settingsBox_.Publish();
+    }
+
+    // Owning thread: switches to the newest settings at the start of every
+    // transition, so a reload applies from the next detection or deadline on.
+    // Timers already running keep the deadline they were scheduled with.
+    const Settings& AdoptSettings() {
+        settingsBox_.Refresh();
+        return settingsBox_.Front();
+    }
+    const Settings& CurrentSettings() const { return settingsBox_.Front(); }
+
+    // Manager thread: the only place state transitions happen after Start().
+    // Sleeps until the next deadline or a submitted detection; idle means no wakeups.
+    void Run() {
+        trace::SetThreadName("penalty");
+        while (!stop_) {
+            Pump();
+            wake_.WaitUntil(NextDeadline());
+        }
+        Drain();
+    }
+
+    void Drain() {
+        DetectionEvent event;
+        while (events_.TryPop(event)) {
+            trace::FlowScope flow(event.flow);
+            Trigger(event.word);
+            RecordLatency(event, std::chrono::steady_clock::now());
+        }
+    }
+
+    void RecordLatency(const DetectionEvent& event, std::chrono::steady_clock::time_point appliedAt) {
+        const auto queued = std::chrono::duration_cast<std::chrono::nanoseconds>(appliedAt - event.enqueuedAt).count();
+        const auto detected = std::chrono::duration_cast<std::chrono::nanoseconds>(appliedAt - event.detectedAt).count();
+        applied_.fetch_add(1, std::memory_order_relaxed);
+        lastQueueLatencyNs_.store(queued, std::memory_order_relaxed);
+        lastDetectLatencyNs_.store(detected, std::memory_order_relaxed);
+        totalQueueLatencyNs_.fetch_add(queued, std::memory_order_relaxed);
+        if (queued > maxQueueLatencyNs_.load(std::memory_order_relaxed)) {
+            maxQueueLatencyNs_.store(queued, std::memory_order_relaxed);
+        }
+    }
+
+    int CountStars() const {
         int active = current_.has_value() ? 1 : 0;
-        int queued = static_cast<int>(queue_.size());
+        int queued = static_cast<int>(queue_.Size());
         int total = active + queued;
         if (total <= 0) return 0;
         if (total > 5) return 5;
         return total;
     }
 
-private:
+    void PublishStars() { stars_.store(CountStars(), std::memory_order_release); }
+
     // Calculate progressive penalty duration - more stars = longer penalties
     std::chrono::milliseconds CalculateProgressiveDuration(int currentStars) {
-        // Base duration increases with current penalty level
-        // 1 star: 5s, 2 stars: 8s, 3 stars: 12s, 4 stars: 18s, 5+ stars: 25s
-        const std::chrono::milliseconds baseDurations[] = {
-            std::chrono::milliseconds{5000},   // 0 stars -> 5s
-            std::chrono::milliseconds{8000},   // 1 star -> 8s  
-            std::chrono::milliseconds{12000},  // 2 stars -> 12s
-            std::chrono::milliseconds{18000},  // 3 stars -> 18s
-            std::chrono::milliseconds{25000}   // 4+ stars -> 25s
-        };
-        
-        int index = std::min(currentStars, 4);
-        return baseDurations[index];
-    }
-    
-    // Clean up old phrase entries to prevent memory bloat
-    void CleanupOldPhrases() {
-        using clock = std::chrono::steady_clock;
-        auto now = clock::now();
-        auto maxAge = phraseCooldown_ * 2; // Keep phrases for double the cooldown period
-        
-        for (auto it = recentPhrases_.begin(); it != recentPhrases_.end();) {
-            if (it->second + maxAge < now) {
-                it = recentPhrases_.erase(it);
+        // Base duration increases with current penalty level; the last entry
+        // applies to every level beyond it
+        const auto& table = CurrentSettings().progressiveDurations;
+        size_t index = std::min(static_cast<size_t>(std::max(currentStars, 0)), table.size() - 1);
+        return table[index];
+    }
+
+    // Every cooldown and expiry runs on one timing wheel; the tag's top byte
+    // says which kind of timer fired, the rest carries its payload.
+    enum class TimerKind : uint64_t { PenaltyEnd, Cooldown, Debounce, Phrase };
+
+    static uint64_t TimerTag(TimerKind kind, uint64_t payload = 0) {
+        return (static_cast<uint64_t>(kind) << 56) | payload;
+    }
+
+    void Expire(std::chrono::steady_clock::time_point now) {
+        timers_.Advance(now, [this, now](uint64_t tag) {
+            switch (static_cast<TimerKind>(tag >> 56)) {
+                case TimerKind::PenaltyEnd: EndPenalty(now); break;
+                case TimerKind::Cooldown: cooldownTimer_ = TimingWheel::kNoTimer; break;
+                case TimerKind::Debounce: debounceTimer_ = TimingWheel::kNoTimer; break;
+                case TimerKind::Phrase: phraseTimers_[static_cast<WordId>(tag)] = TimingWheel::kNoTimer; break;
+            }
+        });
+    }
+
+    void EndPenalty(std::chrono::steady_clock::time_point now) {
+        penaltyTimer_ = TimingWheel::kNoTimer;
+        current_.reset();
+        const auto cooldown = CurrentSettings().defaultCooldown;
+        cooldownTimer_ = timers_.Schedule(now + cooldown, TimerTag(TimerKind::Cooldown));
+        Journal(JournalRecordType::Ended, kNoWord, now + cooldown);
+        PublishStars();
+        int remainingStars = CountStars();
+        if (remainingStars > 0) {
+            // Still have queued penalties - keep overlay visible but update status
+            overlay_->UpdateStatus(remainingStars, kNoWord);
+        } else {
+            // No more penalties - hide overlay
+            overlay_->Hide();
+            overlay_->UpdateStatus(0, kNoWord);
+        }
+    }
+
+    // Never blocks: the journal copies the record into its own ring.
+    void Journal(JournalRecordType type, WordId word, std::chrono::steady_clock::time_point at = {},
+                 std::chrono::milliseconds duration = std::chrono::milliseconds{0}) {
+        if (journal_) journal_->Append(type, word, at, duration);
+    }
+
+    void Count(WordId word, WordOutcome outcome) {
+        outcomes_[static_cast<size_t>(outcome)].fetch_add(1, std::memory_order_relaxed);
+        if (stats_) stats_->Record(word, outcome);
+    }
+
+    // Rebuilds queue, active penalty and timers from a journal replay.
+    void Restore(const RecoveredPenaltyState& state) {
+        const auto cooldown = AdoptSettings().defaultCooldown;
+        auto now = clock_->Now();
+        for (const auto& e : state.queue) queue_.Push(Penalty{Words().Intern(e.label), e.duration, cooldown});
+        if (state.current) {
+            if (state.currentEnd > now) {
+                current_ = Penalty{Words().Intern(state.current->label), state.current->duration, cooldown};
+                penaltyTimer_ = timers_.Schedule(state.currentEnd, TimerTag(TimerKind::PenaltyEnd));
             } else {
-                ++it;
+                // Expired while the agent was down; its cooldown still applies.
+                // Journal the end EndPenalty() never wrote, or every restart
+                // would recover the same stale penalty.
+                Journal(JournalRecordType::Ended, kNoWord, state.currentEnd + cooldown);
+                if (state.currentEnd + cooldown > now) {
+                    cooldownTimer_ = timers_.Schedule(state.currentEnd + cooldown, TimerTag(TimerKind::Cooldown));
+                }
             }
         }
+        if (state.cooldownEnd && cooldownTimer_ == TimingWheel::kNoTimer) {
+            cooldownTimer_ = timers_.Schedule(*state.cooldownEnd, TimerTag(TimerKind::Cooldown));
+        }
+        if (state.debounceEnd) debounceTimer_ = timers_.Schedule(*state.debounceEnd, TimerTag(TimerKind::Debounce));
+        for (const auto& [phrase, until] : state.phrases) {
+            const WordId word = Words().Intern(phrase);
+            if (word != kNoWord && (word >= phraseTimers_.size() || phraseTimers_[word] == TimingWheel::kNoTimer)) {
+                StartPhraseCooldown(word, until);
+            }
+        }
+
+        PublishStars();
+        if (current_) overlay_->ShowPenalty(current_->word);
+        if (CountStars() > 0) overlay_->UpdateStatus(CountStars(), current_ ? current_->word : kNoWord);
+    }
+
+    // Phrase cooldown timers are indexed by word id; the table only grows the
+    // first time a word is seen, so repeat detections allocate nothing.
+    void StartPhraseCooldown(WordId word, std::chrono::steady_clock::time_point until) {
+        if (word >= phraseTimers_.size()) {
+            phraseTimers_.resize(std::max<size_t>(Words().Size(), word + size_t{1}), TimingWheel::kNoTimer);
+        }
+        phraseTimers_[word] = timers_.Schedule(until, TimerTag(TimerKind::Phrase, word));
     }
 
 private:
+    static constexpr size_t kMaxQueued = kMaxQueueLimit;
+
     IOverlayRenderer* overlay_;
-    int queueLimit_{5};
-    std::chrono::milliseconds defaultDuration_{10000};
-    std::chrono::milliseconds defaultCooldown_{60000};
-    std::chrono::milliseconds debounceDuration_{3000};     // 3s between any penalties
-    std::chrono::milliseconds phraseCooldown_{15000};      // 15s before same phrase can be penalized again
+    IClock* clock_;
+
+    // Configure()/SetPolicy() may run on any thread, also while the manager
+    // thread is busy; the owning thread adopts the newest snapshot without
+    // waiting on them.
+    std::mutex settingsMutex_;                 // writers only
+    Settings latestSettings_;                  // guarded by settingsMutex_
+    TripleBuffer<Settings> settingsBox_;       // writers -> owning thread
 
     std::optional<Penalty> current_{};
-    std::queue<Penalty> queue_{};
-    std::chrono::steady_clock::time_point start_{};
-    std::chrono::steady_clock::time_point lastEnd_{};
-    std::chrono::steady_clock::time_point lastStraf_{};
-    
+    PenaltyRing<kMaxQueued> queue_{};
+
+    // Pending timers; kNoTimer when not running
+    TimingWheel timers_;
+    TimingWheel::TimerId penaltyTimer_{TimingWheel::kNoTimer};  // active penalty expiry
+    TimingWheel::TimerId cooldownTimer_{TimingWheel::kNoTimer}; // gap before the next queued penalty
+    TimingWheel::TimerId debounceTimer_{TimingWheel::kNoTimer}; // minimum gap between penalties
+
     // Track recent phrases to prevent repeat penalties
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point> recentPhrases_;
+    std::vector<TimingWheel::TimerId> phraseTimers_; // word id -> cooldown timer, kNoTimer when not cooling
+
+    std::unique_ptr<PenaltyJournal> journal_;
+    WordStats* stats_{nullptr};
+
+    // Detection hand-off from recognizer threads
+    MpscQueue<DetectionEvent, 256> events_;
+    WakeSignal wake_;
+    std::atomic<bool> stop_{false};
+    std::thread worker_;
+
+    // Published for other threads
+    std::atomic<int> stars_{0};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> applied_{0};
+    std::atomic<int64_t> lastQueueLatencyNs_{0};
+    std::atomic<int64_t> maxQueueLatencyNs_{0};
+    std::atomic<int64_t> totalQueueLatencyNs_{0};
+    std::atomic<int64_t> lastDetectLatencyNs_{0};
+    std::array<std::atomic<uint64_t>, kWordOutcomeCount> outcomes_{};
 };
 
-std::unique_ptr<IPenaltyManager> CreatePenaltyManager(IOverlayRenderer* overlay){ 
-    return std::make_unique<PenaltyManager>(overlay); 
+std::unique_ptr<IPenaltyManager> CreatePenaltyManager(IOverlayRenderer* overlay, IClock* clock){
+    return std::make_unique<PenaltyManager>(overlay, clock);
+}
+
+size_t AddPenaltyMetrics(const IPenaltyManager& manager) {
+    static_assert(kWordOutcomeCount == PenaltyQueueStats{}.outcomes.size());
+    return metrics::Metrics().AddCollector([&manager](metrics::Writer& w) {
+        const PenaltyQueueStats s = manager.GetQueueStats();
+        w.WriteCounter("straf_detections_submitted_total", "Detections handed to the penalty manager.", static_cast<double>(s.submitted));
+        w.WriteCounter("straf_detections_dropped_total", "Detections dropped because the detection queue was full.",
+                       static_cast<double>(s.dropped));
+        w.WriteCounter("straf_detections_applied_total", "Detections the penalty manager has evaluated.", static_cast<double>(s.applied));
+        static constexpr const char* kOutcomes[] = {"outcome=\"triggered\"", "outcome=\"debounced\"",
+                                                    "outcome=\"phrase_cooldown\"", "outcome=\"queue_full\""};
+        w.Header("straf_penalty_outcomes_total", "Evaluated detections by result; triggered ones became penalties.", "counter");
+        for (size_t i = 0; i < s.outcomes.size(); ++i) {
+            w.Sample("straf_penalty_outcomes_total", kOutcomes[i], static_cast<double>(s.outcomes[i]));
+        }
+        w.WriteGauge("straf_penalty_stars", "Stars currently shown.", manager.GetStarCount());
+    });
 }
 
 }
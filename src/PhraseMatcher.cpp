@@ -0,0 +1,90 @@
+#include "Straf/PhraseMatcher.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace Straf {
+
+void PhraseMatcher::Build(const std::vector<std::string>& phrases) {
+    tokens_.clear();
+    states_.assign(1, State{});
+    outputs_.clear();
+    phrases_.clear();
+    maxDepth_ = 0;
+
+    // Trie over token ids; State::next holds the goto function for now.
+    std::vector<int32_t> terminal{-1};
+    for (const auto& raw : phrases) {
+        std::string text = raw;
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return (char) std::tolower(c); });
+        std::istringstream iss(text);
+        std::string word, normalized;
+        uint32_t state = 0, length = 0;
+        while (iss >> word) {
+            auto [it, inserted] = tokens_.try_emplace(word, static_cast<uint32_t>(tokens_.size()));
+            (void) inserted;
+            auto& next = states_[state].next;
+            auto edge = next.find(it->second);
+            if (edge == next.end()) {
+                uint32_t created = static_cast<uint32_t>(states_.size());
+                next.emplace(it->second, created);
+                states_.emplace_back();
+                terminal.push_back(-1);
+                state = created;
+            } else {
+                state = edge->second;
+            }
+            if (!normalized.empty()) normalized += ' ';
+            normalized += word;
+            ++length;
+        }
+        if (length == 0 || terminal[state] >= 0) continue;
+        terminal[state] = static_cast<int32_t>(phrases_.size());
+        phrases_.push_back(PhraseEntry{std::move(normalized), length});
+        maxDepth_ = std::max<size_t>(maxDepth_, length);
+    }
+
+    // Breadth-first: compute failure links and fold them into a complete
+    // transition map, then chain outputs along dictionary suffixes. Root's
+    // transitions are not copied into every state (that would make the build
+    // quadratic in the vocabulary size); Next() falls back to them instead.
+    std::vector<uint32_t> fail(states_.size(), 0);
+    std::vector<uint32_t> order{0};
+    for (size_t head = 0; head < order.size(); ++head) {
+        const uint32_t r = order[head];
+        std::vector<std::pair<uint32_t, uint32_t>> children(states_[r].next.begin(), states_[r].next.end());
+        for (const auto& [token, child] : children) {
+            if (r != 0) fail[child] = Step(fail[r], token);
+            order.push_back(child);
+        }
+        if (r != 0) {
+            if (fail[r] != 0) {
+                for (const auto& [token, target] : states_[fail[r]].next) states_[r].next.try_emplace(token, target);
+            }
+            const int32_t inherited = states_[fail[r]].output;
+            if (terminal[r] >= 0) {
+                outputs_.push_back(Output{static_cast<uint32_t>(terminal[r]), inherited});
+                states_[r].output = static_cast<int32_t>(outputs_.size() - 1);
+            } else {
+                states_[r].output = inherited;
+            }
+        }
+    }
+}
+
+uint32_t PhraseMatcher::Step(uint32_t state, uint32_t token) const {
+    const auto& next = states_[state].next;
+    if (auto it = next.find(token); it != next.end()) return it->second;
+    if (state == 0) return 0;
+    const auto& root = states_[0].next;
+    auto it = root.find(token);
+    return it != root.end() ? it->second : 0;
+}
+
+uint32_t PhraseMatcher::Next(uint32_t state, std::string_view token) const {
+    auto id = tokens_.find(token);
+    if (id == tokens_.end()) return 0;
+    return Step(state, id->second);
+}
+
+}
@@ -0,0 +1,137 @@
+#include "Straf/Platform.h"
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <cerrno>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Straf {
+
+namespace {
+
+#ifdef _WIN32
+std::wstring Widen(const char* s) {
+    const int len = MultiByteToWideChar(CP_UTF8, 0, s, -1, nullptr, 0);
+    std::wstring w(len > 0 ? len - 1 : 0, L'\0');
+    if (len > 1) MultiByteToWideChar(CP_UTF8, 0, s, -1, w.data(), len);
+    return w;
+}
+
+std::string Narrow(const wchar_t* w, int size) {
+    const int len = WideCharToMultiByte(CP_UTF8, 0, w, size, nullptr, 0, nullptr, nullptr);
+    std::string s(len > 0 ? len : 0, '\0');
+    if (len > 0) WideCharToMultiByte(CP_UTF8, 0, w, size, s.data(), len, nullptr, nullptr);
+    return s;
+}
+#endif
+
+class ProcessEnvironment final : public IEnvironment {
+public:
+    std::optional<std::string> Get(const char* name) const override {
+#ifdef _WIN32
+        const std::wstring wname = Widen(name);
+        const DWORD need = GetEnvironmentVariableW(wname.c_str(), nullptr, 0);
+        if (need == 0) return std::nullopt;
+        std::wstring value(need, L'\0');
+        const DWORD got = GetEnvironmentVariableW(wname.c_str(), value.data(), need);
+        if (got >= need) return std::nullopt; // changed between the two calls
+        return Narrow(value.data(), static_cast<int>(got));
+#else
+        const char* value = std::getenv(name);
+        if (!value) return std::nullopt;
+        return std::string(value);
+#endif
+    }
+};
+
+} // namespace
+
+IEnvironment& SystemEnvironment() {
+    static ProcessEnvironment instance;
+    return instance;
+}
+
+namespace platform {
+
+uint64_t CurrentThreadId() {
+#ifdef _WIN32
+    return GetCurrentThreadId();
+#else
+    return static_cast<uint64_t>(syscall(SYS_gettid));
+#endif
+}
+
+uint64_t ProcessId() {
+#ifdef _WIN32
+    return GetCurrentProcessId();
+#else
+    return static_cast<uint64_t>(getpid());
+#endif
+}
+
+bool ProcessAlive(uint64_t pid) {
+    if (pid == 0) return false;
+#ifdef _WIN32
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (!process) return GetLastError() == ERROR_ACCESS_DENIED;
+    DWORD code = 0;
+    const bool running = GetExitCodeProcess(process, &code) && code == STILL_ACTIVE;
+    CloseHandle(process);
+    return running;
+#else
+    return kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM;
+#endif
+}
+
+void SetCurrentThreadName(const char* name) {
+    if (!name) return;
+#ifdef _WIN32
+    SetThreadDescription(GetCurrentThread(), Widen(name).c_str());
+#elif defined(__APPLE__)
+    pthread_setname_np(name);
+#else
+    char truncated[16]{};
+    std::string(name).copy(truncated, sizeof truncated - 1);
+    pthread_setname_np(pthread_self(), truncated);
+#endif
+}
+
+std::chrono::nanoseconds ProcessCpuTime() {
+#ifdef _WIN32
+    FILETIME created{}, exited{}, kernel{}, user{};
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return {};
+    auto ticks = [](const FILETIME& t) { return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+    return std::chrono::nanoseconds((ticks(kernel) + ticks(user)) * 100); // 100 ns units
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return {};
+    auto ns = [](const timeval& t) { return std::chrono::seconds(t.tv_sec) + std::chrono::microseconds(t.tv_usec); };
+    return ns(usage.ru_utime) + ns(usage.ru_stime);
+#endif
+}
+
+uint64_t PeakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof pmc)) return 0;
+    return pmc.PeakWorkingSetSize;
+#elif defined(__APPLE__)
+    rusage usage{};
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<uint64_t>(usage.ru_maxrss) : 0; // bytes
+#else
+    rusage usage{};
+    return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<uint64_t>(usage.ru_maxrss) * 1024 : 0; // KiB
+#endif
+}
+
+} // namespace platform
+
+}
@@ -0,0 +1,99 @@
+#include "Straf/STT.h"
+#include "Straf/Metrics.h"
+#include "Straf/Trace.h"
+
+#include <cstdlib>
+#include <fstream>
+
+namespace Straf {
+
+bool LoadTranscript(const std::string& path, std::vector<TranscriptEntry>& transcript) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') continue;
+        char* end = nullptr;
+        const double seconds = std::strtod(line.c_str() + begin, &end);
+        if (end == line.c_str() + begin) continue;
+        std::string text(end);
+        text.erase(0, text.find_first_not_of(" \t"));
+        text.erase(text.find_last_not_of(" \t\r") + 1);
+        TranscriptEntry entry;
+        entry.at = std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000.0 + 0.5));
+        entry.partial = !text.empty() && text[0] == '~';
+        entry.text = entry.partial ? text.substr(1) : text;
+        if (!entry.text.empty()) transcript.push_back(std::move(entry));
+    }
+    return true;
+}
+
+class TranscriberReplay : public ITranscriber {
+public:
+    explicit TranscriberReplay(std::vector<TranscriptEntry> transcript) : transcript_(std::move(transcript)) {}
+    ~TranscriberReplay() override { Stop(); }
+
+    bool Initialize(const std::vector<std::string>&, const std::shared_ptr<spdlog::logger>& logger) override {
+        logger_ = logger;
+        return true;
+    }
+
+    void SetPartialCallback(TokenCallback onPartial) override { partialCb_ = std::move(onPartial); }
+    void SetAudioSource(std::unique_ptr<IAudioSource> source) override { audio_ = std::move(source); }
+
+    void Start(TokenCallback onToken) override {
+        cb_ = std::move(onToken);
+        if (!audio_ || !audio_->Initialize(kRate, 1)) {
+            if (logger_) logger_->warn("Transcript replay has no usable audio source");
+            return;
+        }
+        consumed_ = 0;
+        next_ = 0;
+        audio_->Start([this](const AudioBuffer& buf){ OnAudio(buf); });
+    }
+
+    void Stop() override {
+        if (audio_) audio_->Stop();
+    }
+
+private:
+    static constexpr int kRate = 16000;
+
+    // Audio thread. Emits every entry whose position has been reached.
+    void OnAudio(const AudioBuffer& buf) {
+        STRAF_TRACE_SCOPE("stt", "OnAudio");
+        metrics::AudioScope audioScope(std::chrono::steady_clock::now());
+        consumed_ += buf.size();
+        const std::chrono::milliseconds position(static_cast<int64_t>(consumed_ * 1000 / kRate));
+        while (next_ < transcript_.size() && transcript_[next_].at <= position) {
+            Emit(transcript_[next_++]);
+        }
+    }
+
+    void Emit(const TranscriptEntry& entry) {
+        trace::Span span("stt", "ParseAndEmit");
+        const uint64_t flow = trace::NewFlow();
+        span.Flow(flow, trace::FlowPhase::Begin);
+        trace::FlowScope scope(flow);
+        if (entry.partial) {
+            if (partialCb_) partialCb_(entry.text, 0.6f);
+        } else if (cb_) {
+            cb_(entry.text, 0.8f);
+        }
+    }
+
+    std::vector<TranscriptEntry> transcript_;
+    std::unique_ptr<IAudioSource> audio_;
+    TokenCallback cb_{};
+    TokenCallback partialCb_{};
+    std::shared_ptr<spdlog::logger> logger_;
+    uint64_t consumed_{0}; // samples seen, audio thread only
+    size_t next_{0};
+};
+
+std::unique_ptr<ITranscriber> CreateTranscriberReplay(std::vector<TranscriptEntry> transcript) {
+    return std::make_unique<TranscriberReplay>(std::move(transcript));
+}
+
+}
@@ -1,3 +1,4 @@
+#include "Straf/HotLog.h"
 #include "Straf/STT.h"
 #include <windows.h>
 #include <sapi.h>
@@ -35,12 +36,18 @@ public:
         if (logger_) logger_->debug("Starting SAPI transcriber");
         cb_ = std::move(onToken);
         running_ = true;
+        stopEvent_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
         worker_ = std::thread([this]{ Run(); });
     }
 
     void Stop() override {
         running_ = false;
+        if (stopEvent_) SetEvent(stopEvent_);
         if (worker_.joinable()) worker_.join();
+        if (stopEvent_) {
+            CloseHandle(stopEvent_);
+            stopEvent_ = nullptr;
+        }
         Shutdown();
     }
 
@@ -90,8 +97,17 @@ private:
         if (FAILED(grammar_->LoadDictation(nullptr, SPLO_STATIC))){ return; }
         if (FAILED(grammar_->SetDictationState(SPRS_ACTIVE))){ return; }
 
-        // Loop until stopped; notifications drive recognition callback
-        while (running_) { Sleep(50); }
+        // Pump messages until stopped: SAPI delivers the notifications that drive
+        // the recognition callback as window messages to this STA thread, and
+        // nothing else needs to wake it
+        while (MsgWaitForMultipleObjects(1, &stopEvent_, FALSE, INFINITE, QS_ALLINPUT) == WAIT_OBJECT_0 + 1) {
+            MSG msg;
+            while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+                TranslateMessage(&msg);
+                DispatchMessageW(&msg);
+            }
+        }
+        Shutdown(); // release the COM objects on the apartment that created them
         CoUninitialize();
     }
 
@@ -106,13 +122,14 @@ private:
         if (!vocab_.empty()){
             if (vocab_.find(tok) == vocab_.end()) return;
         }
-        if (logger_) logger_->debug("SAPI emitting token: '{}'", tok);
+        STRAF_HOT_DEBUG("SAPI emitting token: '{}'", tok);
         cb_(tok, 0.9f);
     }
 
     std::unordered_set<std::string> vocab_;
     TokenCallback cb_{};
     std::atomic<bool> running_{false};
+    HANDLE stopEvent_{nullptr}; // manual reset, set by Stop()
     std::thread worker_;
     Microsoft::WRL::ComPtr<ISpRecognizer> recognizer_;
     Microsoft::WRL::ComPtr<ISpRecoContext> recog_;
@@ -1,10 +1,8 @@
 #include "Straf/STT.h"
-#include <thread>
-#include <atomic>
-#include <chrono>
 
 namespace Straf {
 
+// Produces no tokens, so there is nothing to run between Start() and Stop().
 class TranscriberStub : public ITranscriber {
 public:
     bool Initialize(const std::vector<std::string>&, const std::shared_ptr<spdlog::logger>& logger) override { 
@@ -12,23 +10,13 @@ public:
         if (logger_) logger_->debug("TranscriberStub::Initialize");
         return true; 
     }
-    void Start(TokenCallback onToken) override {
+    void Start(TokenCallback) override {
         if (logger_) logger_->debug("TranscriberStub::Start");
-        stop_ = false;
-        worker_ = std::thread([this, onToken]{
-            while(!stop_){
-                std::this_thread::sleep_for(std::chrono::seconds(1));
-                // no actual tokens; this is a stub
-            }
-        });
     }
     void Stop() override {
         if (logger_) logger_->debug("TranscriberStub::Stop");
-        stop_ = true; if (worker_.joinable()) worker_.join();
     }
 private:
-    std::thread worker_;
-    std::atomic<bool> stop_{false};
     std::shared_ptr<spdlog::logger> logger_;
 };
 
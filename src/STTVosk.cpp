@@ -1,5 +1,11 @@
 #include "Straf/Audio.h"
+#include "Straf/AudioDsp.h"
+#include "Straf/Executor.h"
+#include "Straf/HotLog.h"
+#include "Straf/Metrics.h"
+#include "Straf/Platform.h"
 #include "Straf/STT.h"
+#include "Straf/Trace.h"
 
 #include <spdlog/spdlog.h>
 #include <fmt/format.h>
@@ -18,9 +24,7 @@
 #include <mutex>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <vector>
-#include <windows.h>
 
 
 // Vosk headers (assume available via include path when enabled)
@@ -44,14 +48,12 @@ public:
         for (auto &w : vocab_)
             w = ToLower(w);
         // Model path via env STRAF_VOSK_MODEL, or fallback to ./models/vosk
-        wchar_t buf[1024]{};
-        DWORD n = GetEnvironmentVariableW(L"STRAF_VOSK_MODEL", buf, 1024);
-        if (n == 0) {
-            modelPath_ = L"models/vosk";
+        modelPath_ = SystemEnvironment().Get("STRAF_VOSK_MODEL").value_or("");
+        if (modelPath_.empty()) {
+            modelPath_ = "models/vosk";
             if (logger_) logger_->debug("Using default Vosk model path: models/vosk");
         } else {
-            modelPath_ = std::wstring(buf, buf + n);
-            if (logger_) logger_->debug("Using Vosk model path from environment: {}", std::string(modelPath_.begin(), modelPath_.end()));
+            if (logger_) logger_->debug("Using Vosk model path from environment: {}", modelPath_);
         }
         return true;
     }
@@ -64,7 +66,15 @@ public:
         if (logger_) logger_->debug("Starting Vosk transcriber");
         cb_ = std::move(onToken);
         running_ = true;
-        worker_ = std::thread([this] { Run(); });
+        task_ = Tasks().Spawn(Run());
+    }
+
+    void SetPartialCallback(TokenCallback onPartial) override {
+        partialCb_ = std::move(onPartial);
+    }
+
+    void SetAudioSource(std::unique_ptr<IAudioSource> source) override {
+        audioOverride_ = std::move(source);
     }
 
     void Stop() override {
@@ -74,8 +84,13 @@ public:
         }
         if (logger_) logger_->debug("Stopping Vosk transcriber");
         running_ = false;
-        if (worker_.joinable())
-            worker_.join();
+        task_.Stop(); // waits out a model load in progress
+        // Stop the audio first; its callback feeds the recognizer
+        if (audio_) {
+            audio_->Stop();
+            audio_.reset();
+            if (logger_) logger_->debug("Stopped and reset audio source");
+        }
         // Cleanup Vosk
         if (rec_) {
             vosk_recognizer_free(rec_);
@@ -92,29 +107,24 @@ public:
             mod_ = nullptr;
             if (logger_) logger_->debug("Freed Vosk model");
         }
-        if (audio_) {
-            audio_->Stop();
-            audio_.reset();
-            if (logger_) logger_->debug("Stopped and reset audio source");
-        }
     }
 
 private:
-    void Run() {
-        if (logger_) logger_->debug("Starting Vosk transcription thread");
+    // Loads the model and starts the audio source, then ends: from there on the
+    // audio callback drives recognition and nothing has to wait for Stop().
+    Task Run() {
+        if (logger_) logger_->debug("Starting Vosk transcription task");
         vosk_set_log_level(-1);
 
-        // Convert wide string path to narrow string safely
-        int pathLen = WideCharToMultiByte(CP_UTF8, 0, modelPath_.c_str(), -1, nullptr, 0, nullptr, nullptr);
-        std::string mpath(pathLen - 1, '\0');
-        WideCharToMultiByte(CP_UTF8, 0, modelPath_.c_str(), -1, mpath.data(), pathLen, nullptr, nullptr);
-
+        const std::string& mpath = modelPath_;
         if (logger_) logger_->debug("Loading Vosk model from: {}", mpath);
-        mod_ = vosk_model_new(mpath.c_str());
+        // Takes seconds; off the executor's workers so other tasks keep running
+        const bool loaded = co_await Blocking([this, &mpath] { mod_ = vosk_model_new(mpath.c_str()); });
+        if (!loaded) co_return; // Stop() frees the model
         if (!mod_) {
             if (logger_) logger_->debug("Failed to load Vosk model from: {}", mpath);
             running_ = false;
-            return;
+            co_return;
         }
         if (logger_) logger_->debug("Successfully loaded Vosk model");
 
@@ -133,65 +143,102 @@ private:
         if (!rec_) {
             if (logger_) logger_->debug("Failed to create Vosk recognizer");
             running_ = false;
-            return;
+            co_return;
         }
         if (logger_) logger_->debug("Successfully created Vosk recognizer");
 
-        // Create audio source (prefer WASAPI)
-
-        if (logger_) logger_->debug("Creating WASAPI audio source for Vosk");
-        audio_ = CreateAudioWasapi();
+        // Create audio source: the one set with SetAudioSource(), else WASAPI
+        if (audioOverride_) {
+            audio_ = std::move(audioOverride_);
+        } else {
+#ifdef _WIN32
+            if (logger_) logger_->debug("Creating WASAPI audio source for Vosk");
+            audio_ = CreateAudioWasapi();
+#endif
+        }
         if (!audio_ || !audio_->Initialize(16000, 1)) {
             if (logger_) logger_->debug("Failed to create or initialize audio source");
             running_ = false;
-            return;
+            co_return;
         }
         if (logger_) logger_->debug("Audio source initialized successfully");
 
-        // Consume audio and feed recognizer
+        // Stop() while the audio source initialized: leave it unstarted
+        const bool live = co_await Yield();
+        if (!live) co_return;
 
+        // Consume audio and feed recognizer
         if (logger_) logger_->debug("Starting audio capture for Vosk transcription");
         audio_->Start([this](const AudioBuffer &buf) { OnAudio(buf); });
-
-        while (running_) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
-        if (logger_) logger_->debug("Vosk transcription thread ending");
     }
 
     void OnAudio(const AudioBuffer &buf) {
         if (!rec_ || !cb_)
             return;
+        STRAF_TRACE_SCOPE("stt", "OnAudio");
+        static metrics::Histogram& decodeRtf = metrics::Metrics().AddHistogram(
+            "straf_stt_decode_rtf", "Recognizer decode time per packet divided by the packet's audio duration.", {1e-3, 100.0});
+        const auto arrived = std::chrono::steady_clock::now();
+        metrics::AudioScope audioScope(arrived); // detections below measure latency from here
 
         // Log first few audio callbacks to confirm flow
         static int audioCallCount = 0;
         if (audioCallCount < 5) {
             ++audioCallCount;
-            if (logger_) logger_->debug("OnAudio callback #{}, buffer size: {}", audioCallCount, buf.size());
+            STRAF_HOT_DEBUG("OnAudio callback #{}, buffer size: {}", audioCallCount, buf.size());
         } else if (audioCallCount == 5) {
             ++audioCallCount;
-            if (logger_) logger_->debug("OnAudio callback working normally (suppressing further audio callback logs)");
+            STRAF_HOT_DEBUG("OnAudio callback working normally (suppressing further audio callback logs)");
         }
 
         // Convert float [-1,1] to int16 for Vosk
         std::vector<int16_t> pcm(buf.size());
-        for (size_t i = 0; i < buf.size(); ++i) {
-            float s = std::max(-1.0f, std::min(1.0f, buf[i]));
-            pcm[i] = (int16_t) std::lrintf(s * 32767.0f);
+        FloatToPcm16(buf.data(), buf.size(), pcm.data());
+
+        bool final;
+        {
+            STRAF_TRACE_SCOPE("stt", "decode");
+            const auto decodeStart = std::chrono::steady_clock::now();
+            final = vosk_recognizer_accept_waveform(rec_, (const char *) pcm.data(), (int) (pcm.size() * sizeof(int16_t)));
+            const std::chrono::duration<double> decodeTime = std::chrono::steady_clock::now() - decodeStart;
+            if (!pcm.empty()) decodeRtf.Observe(decodeTime.count() * 16000.0 / static_cast<double>(pcm.size()));
         }
-
-        if (vosk_recognizer_accept_waveform(rec_, (const char *) pcm.data(), (int) (pcm.size() * sizeof(int16_t)))) {
+        if (final) {
             const char *j = vosk_recognizer_result(rec_);
+            lastPartial_.clear();
             ParseAndEmit(j);
+        } else if (partialCb_) {
+            ParsePartialAndEmit(vosk_recognizer_partial_result(rec_));
+        }
+    }
+
+    void ParsePartialAndEmit(const char *json) {
+        if (!json) return;
+        trace::Span span("stt", "ParsePartial");
+        // Partial result: {"partial" : "..."}; only emit when it grew or changed
+        const char *field = strstr(json, "\"partial\" : \"");
+        if (!field) return;
+        field += 13; // Skip past "partial" : "
+        const char *endQuote = strchr(field, '"');
+        if (!endQuote || endQuote == field) return;
+        if (lastPartial_.size() == static_cast<size_t>(endQuote - field) &&
+            lastPartial_.compare(0, lastPartial_.size(), field, endQuote - field) == 0) {
+            return;
         }
-        // Skip partial results - we only want final complete phrases
+        lastPartial_.assign(field, endQuote);
+        // Each new hypothesis starts a flow that follows it to any penalty
+        const uint64_t flow = trace::NewFlow();
+        span.Flow(flow, trace::FlowPhase::Begin);
+        trace::FlowScope scope(flow);
+        partialCb_(lastPartial_, 0.6f);
     }
 
     void ParseAndEmit(const char *json) {
         if (!json || !cb_)
             return;
+        trace::Span span("stt", "ParseAndEmit");
 
-        if (logger_) logger_->debug("Vosk recognition result: {}", json);
+        STRAF_HOT_TRACE("Vosk recognition result: {}", json);
         std::string phrase;
 
         // Parse final result: {"text" : "..."}
@@ -206,25 +253,30 @@ private:
 
         // Skip empty results
         if (phrase.empty()) {
-            if (logger_) logger_->debug("Empty recognition result, skipping");
+            STRAF_HOT_TRACE("Empty recognition result, skipping");
             return;
         }
 
-        if (logger_) logger_->debug("Emitting recognized phrase: '{}'", phrase);
+        STRAF_HOT_DEBUG("Emitting recognized phrase: '{}'", phrase);
         // Send the entire phrase to the callback for detector analysis
-
+        const uint64_t flow = trace::NewFlow();
+        span.Flow(flow, trace::FlowPhase::Begin);
+        trace::FlowScope scope(flow);
         cb_(phrase, 0.8f);
     }
 
     std::vector<std::string> vocab_;
-    std::wstring modelPath_;
+    std::string modelPath_; // UTF-8
+    std::unique_ptr<IAudioSource> audioOverride_;
     std::unique_ptr<IAudioSource> audio_;
-    std::thread worker_;
+    TaskHandle task_;
     std::atomic<bool> running_{false};
     VoskModel *mod_{nullptr};
     VoskRecognizer *rec_{nullptr};
     VoskSpkModel *spk_{nullptr};
     TokenCallback cb_{};
+    TokenCallback partialCb_{};
+    std::string lastPartial_;
     std::shared_ptr<spdlog::logger> logger_;
 };
 
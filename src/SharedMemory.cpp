@@ -0,0 +1,197 @@
+#include "Straf/SharedMemory.h"
+
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <ctime>
+#endif
+#endif
+
+namespace Straf::platform {
+
+namespace {
+
+#ifdef _WIN32
+std::wstring Wide(const std::string& s) {
+    return std::wstring(s.begin(), s.end()); // object names are ASCII
+}
+#endif
+
+// Creates the named region, or opens an existing one when `existed` comes
+// back true.
+intptr_t CreateOrOpen(const std::string& objectName, size_t bytes, bool& existed) {
+#ifdef _WIN32
+    HANDLE h = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(uint64_t(bytes) >> 32),
+                                  static_cast<DWORD>(bytes), Wide(objectName).c_str());
+    existed = h && GetLastError() == ERROR_ALREADY_EXISTS;
+    return reinterpret_cast<intptr_t>(h);
+#else
+    int fd = shm_open(objectName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    existed = fd < 0 && errno == EEXIST;
+    if (existed) return shm_open(objectName.c_str(), O_RDWR, 0600);
+    if (fd >= 0 && ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        close(fd);
+        shm_unlink(objectName.c_str());
+        return kNoSharedHandle;
+    }
+    return fd;
+#endif
+}
+
+} // namespace
+
+std::string SharedObjectName(const std::string& name) {
+#ifdef _WIN32
+    return "Local\\" + name;
+#else
+    return "/" + name;
+#endif
+}
+
+intptr_t CreateSharedMemory(const std::string& name, size_t bytes,
+                            const std::function<bool(void* old, size_t oldBytes)>& takeOver) {
+    const std::string objectName = SharedObjectName(name);
+    bool existed = false;
+    intptr_t handle = CreateOrOpen(objectName, bytes, existed);
+    if (handle == kNoSharedHandle || !existed) return handle;
+
+    const size_t oldBytes = SharedMemoryBytes(handle);
+    void* old = oldBytes > 0 ? MapSharedMemory(handle, oldBytes) : nullptr;
+    const bool replace = !old || takeOver(old, oldBytes);
+    if (old) UnmapSharedMemory(old, oldBytes);
+#ifdef _WIN32
+    // A live reader keeps the old mapping; reuse it if it is large enough
+    if (!replace || oldBytes < bytes) {
+        CloseSharedMemory(handle);
+        return kNoSharedHandle;
+    }
+    return handle;
+#else
+    CloseSharedMemory(handle);
+    if (!replace) return kNoSharedHandle;
+    shm_unlink(objectName.c_str());
+    handle = CreateOrOpen(objectName, bytes, existed);
+    if (existed) {
+        CloseSharedMemory(handle);
+        return kNoSharedHandle;
+    }
+    return handle;
+#endif
+}
+
+intptr_t OpenSharedMemory(const std::string& name) {
+#ifdef _WIN32
+    return reinterpret_cast<intptr_t>(OpenFileMappingW(FILE_MAP_READ | FILE_MAP_WRITE, FALSE, Wide(SharedObjectName(name)).c_str()));
+#else
+    return shm_open(SharedObjectName(name).c_str(), O_RDWR, 0600);
+#endif
+}
+
+void CloseSharedMemory(intptr_t handle) {
+#ifdef _WIN32
+    if (handle) CloseHandle(reinterpret_cast<HANDLE>(handle));
+#else
+    if (handle >= 0) close(static_cast<int>(handle));
+#endif
+}
+
+void RemoveSharedMemory(const std::string& name) {
+#ifdef _WIN32
+    (void)name; // goes away with its last handle
+#else
+    shm_unlink(SharedObjectName(name).c_str());
+#endif
+}
+
+size_t SharedMemoryBytes(intptr_t handle) {
+#ifdef _WIN32
+    void* view = MapViewOfFile(reinterpret_cast<HANDLE>(handle), FILE_MAP_READ, 0, 0, 0);
+    if (!view) return 0;
+    MEMORY_BASIC_INFORMATION info{};
+    const size_t bytes = VirtualQuery(view, &info, sizeof info) ? info.RegionSize : 0;
+    UnmapViewOfFile(view);
+    return bytes;
+#else
+    struct stat st{};
+    return fstat(static_cast<int>(handle), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+#endif
+}
+
+void* MapSharedMemory(intptr_t handle, size_t bytes) {
+#ifdef _WIN32
+    return MapViewOfFile(reinterpret_cast<HANDLE>(handle), FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, bytes);
+#else
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, static_cast<int>(handle), 0);
+    return p == MAP_FAILED ? nullptr : p;
+#endif
+}
+
+void UnmapSharedMemory(void* view, size_t bytes) {
+#ifdef _WIN32
+    (void)bytes;
+    UnmapViewOfFile(view);
+#else
+    munmap(view, bytes);
+#endif
+}
+
+intptr_t OpenSharedEvent(const std::string& name) {
+#ifdef _WIN32
+    return reinterpret_cast<intptr_t>(CreateEventW(nullptr, FALSE, FALSE, Wide(SharedObjectName(name)).c_str()));
+#else
+    (void)name;
+    return kNoSharedHandle;
+#endif
+}
+
+void CloseSharedEvent(intptr_t event) {
+#ifdef _WIN32
+    if (event) CloseHandle(reinterpret_cast<HANDLE>(event));
+#else
+    (void)event;
+#endif
+}
+
+void WaitOnWord(std::atomic<uint32_t>& word, uint32_t seen, std::chrono::milliseconds timeout, intptr_t event) {
+#ifdef _WIN32
+    (void)word;
+    (void)seen;
+    WaitForSingleObject(reinterpret_cast<HANDLE>(event), static_cast<DWORD>(timeout.count()));
+#elif defined(__linux__)
+    (void)event;
+    timespec ts{static_cast<time_t>(timeout.count() / 1000), static_cast<long>(timeout.count() % 1000) * 1000000};
+    // Shared futex (no FUTEX_PRIVATE_FLAG): the waker is another process
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, seen, &ts, nullptr, 0);
+#else
+    (void)event;
+    // No cross-process futex here; short naps bound the latency instead
+    const auto until = std::chrono::steady_clock::now() + timeout;
+    while (word.load(std::memory_order_acquire) == seen && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+#endif
+}
+
+void WakeWord(std::atomic<uint32_t>& word, intptr_t event) {
+    word.fetch_add(1, std::memory_order_release);
+#ifdef _WIN32
+    SetEvent(reinterpret_cast<HANDLE>(event));
+#elif defined(__linux__)
+    (void)event;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+    (void)event;
+#endif
+}
+
+} // namespace Straf::platform
@@ -0,0 +1,477 @@
+// CPU rasterizer for the overlay primitives (portable; SSE2 span blending where available)
+#include "Straf/SoftRaster.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STRAF_SOFT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace Straf {
+
+namespace {
+
+constexpr float kPi = 3.14159265f;
+constexpr int kSubScanlines = 4;
+
+uint32_t To8(float v) {
+    return static_cast<uint32_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+uint32_t Pack(uint32_t b, uint32_t g, uint32_t r, uint32_t a) {
+    return b | (g << 8) | (r << 16) | (a << 24);
+}
+
+uint32_t Premultiply(SoftColor c) {
+    const float a = std::clamp(c.a, 0.0f, 1.0f);
+    return Pack(To8(c.b * a), To8(c.g * a), To8(c.r * a), To8(a));
+}
+
+// Each channel times k / 255, rounded; two channels per multiply.
+uint32_t Scale(uint32_t px, uint32_t k) {
+    uint32_t rb = (px & 0x00FF00FFu) * k + 0x00800080u;
+    uint32_t ag = ((px >> 8) & 0x00FF00FFu) * k + 0x00800080u;
+    rb = ((rb + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    ag = ((ag + ((ag >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    return rb | (ag << 8);
+}
+
+// Premultiplied source-over
+uint32_t Over(uint32_t src, uint32_t dst) {
+    return src + Scale(dst, 255 - (src >> 24));
+}
+
+#if STRAF_SOFT_SSE2
+// x / 255 rounded, for 16-bit lanes holding products of two bytes
+inline __m128i Div255(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Four destination pixels times per-channel 16-bit factors (lo: pixels 0-1, hi: 2-3)
+inline __m128i Scale4(__m128i dst, __m128i invLo, __m128i invHi) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = Div255(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), invLo));
+    __m128i hi = Div255(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), invHi));
+    return _mm_packus_epi16(lo, hi);
+}
+
+// Source-over for four pixels with four different sources
+inline __m128i Over4(__m128i src, __m128i dst) {
+    __m128i alpha = _mm_srli_epi32(src, 24);
+    alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));    // a in both halves of each pixel
+    const __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    return _mm_adds_epu8(src, Scale4(dst, _mm_unpacklo_epi32(inv, inv), _mm_unpackhi_epi32(inv, inv)));
+}
+#endif
+
+// 8x8 bitmap font for U+0020..U+007E; bit 0 is the leftmost pixel.
+constexpr uint8_t kFont[95][8] = {
+    {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00}, {0x18,0x3C,0x3C,0x18,0x18,0x00,0x18,0x00}, // ' ' !
+    {0x36,0x36,0x00,0x00,0x00,0x00,0x00,0x00}, {0x36,0x36,0x7F,0x36,0x7F,0x36,0x36,0x00}, // " #
+    {0x0C,0x3E,0x03,0x1E,0x30,0x1F,0x0C,0x00}, {0x00,0x63,0x33,0x18,0x0C,0x66,0x63,0x00}, // $ %
+    {0x1C,0x36,0x1C,0x6E,0x3B,0x33,0x6E,0x00}, {0x06,0x06,0x03,0x00,0x00,0x00,0x00,0x00}, // & '
+    {0x18,0x0C,0x06,0x06,0x06,0x0C,0x18,0x00}, {0x06,0x0C,0x18,0x18,0x18,0x0C,0x06,0x00}, // ( )
+    {0x00,0x66,0x3C,0xFF,0x3C,0x66,0x00,0x00}, {0x00,0x0C,0x0C,0x3F,0x0C,0x0C,0x00,0x00}, // * +
+    {0x00,0x00,0x00,0x00,0x00,0x0C,0x0C,0x06}, {0x00,0x00,0x00,0x3F,0x00,0x00,0x00,0x00}, // , -
+    {0x00,0x00,0x00,0x00,0x00,0x0C,0x0C,0x00}, {0x60,0x30,0x18,0x0C,0x06,0x03,0x01,0x00}, // . /
+    {0x3E,0x63,0x73,0x7B,0x6F,0x67,0x3E,0x00}, {0x0C,0x0E,0x0C,0x0C,0x0C,0x0C,0x3F,0x00}, // 0 1
+    {0x1E,0x33,0x30,0x1C,0x06,0x33,0x3F,0x00}, {0x1E,0x33,0x30,0x1C,0x30,0x33,0x1E,0x00}, // 2 3
+    {0x38,0x3C,0x36,0x33,0x7F,0x30,0x78,0x00}, {0x3F,0x03,0x1F,0x30,0x30,0x33,0x1E,0x00}, // 4 5
+    {0x1C,0x06,0x03,0x1F,0x33,0x33,0x1E,0x00}, {0x3F,0x33,0x30,0x18,0x0C,0x0C,0x0C,0x00}, // 6 7
+    {0x1E,0x33,0x33,0x1E,0x33,0x33,0x1E,0x00}, {0x1E,0x33,0x33,0x3E,0x30,0x18,0x0E,0x00}, // 8 9
+    {0x00,0x0C,0x0C,0x00,0x00,0x0C,0x0C,0x00}, {0x00,0x0C,0x0C,0x00,0x00,0x0C,0x0C,0x06}, // : ;
+    {0x18,0x0C,0x06,0x03,0x06,0x0C,0x18,0x00}, {0x00,0x00,0x3F,0x00,0x00,0x3F,0x00,0x00}, // < =
+    {0x06,0x0C,0x18,0x30,0x18,0x0C,0x06,0x00}, {0x1E,0x33,0x30,0x18,0x0C,0x00,0x0C,0x00}, // > ?
+    {0x3E,0x63,0x7B,0x7B,0x7B,0x03,0x1E,0x00}, {0x0C,0x1E,0x33,0x33,0x3F,0x33,0x33,0x00}, // @ A
+    {0x3F,0x66,0x66,0x3E,0x66,0x66,0x3F,0x00}, {0x3C,0x66,0x03,0x03,0x03,0x66,0x3C,0x00}, // B C
+    {0x1F,0x36,0x66,0x66,0x66,0x36,0x1F,0x00}, {0x7F,0x46,0x16,0x1E,0x16,0x46,0x7F,0x00}, // D E
+    {0x7F,0x46,0x16,0x1E,0x16,0x06,0x0F,0x00}, {0x3C,0x66,0x03,0x03,0x73,0x66,0x7C,0x00}, // F G
+    {0x33,0x33,0x33,0x3F,0x33,0x33,0x33,0x00}, {0x1E,0x0C,0x0C,0x0C,0x0C,0x0C,0x1E,0x00}, // H I
+    {0x78,0x30,0x30,0x30,0x33,0x33,0x1E,0x00}, {0x67,0x66,0x36,0x1E,0x36,0x66,0x67,0x00}, // J K
+    {0x0F,0x06,0x06,0x06,0x46,0x66,0x7F,0x00}, {0x63,0x77,0x7F,0x7F,0x6B,0x63,0x63,0x00}, // L M
+    {0x63,0x67,0x6F,0x7B,0x73,0x63,0x63,0x00}, {0x1C,0x36,0x63,0x63,0x63,0x36,0x1C,0x00}, // N O
+    {0x3F,0x66,0x66,0x3E,0x06,0x06,0x0F,0x00}, {0x1E,0x33,0x33,0x33,0x3B,0x1E,0x38,0x00}, // P Q
+    {0x3F,0x66,0x66,0x3E,0x36,0x66,0x67,0x00}, {0x1E,0x33,0x07,0x0E,0x38,0x33,0x1E,0x00}, // R S
+    {0x3F,0x2D,0x0C,0x0C,0x0C,0x0C,0x1E,0x00}, {0x33,0x33,0x33,0x33,0x33,0x33,0x3F,0x00}, // T U
+    {0x33,0x33,0x33,0x33,0x33,0x1E,0x0C,0x00}, {0x63,0x63,0x63,0x6B,0x7F,0x77,0x63,0x00}, // V W
+    {0x63,0x63,0x36,0x1C,0x1C,0x36,0x63,0x00}, {0x33,0x33,0x33,0x1E,0x0C,0x0C,0x1E,0x00}, // X Y
+    {0x7F,0x63,0x31,0x18,0x4C,0x66,0x7F,0x00}, {0x1E,0x06,0x06,0x06,0x06,0x06,0x1E,0x00}, // Z [
+    {0x03,0x06,0x0C,0x18,0x30,0x60,0x40,0x00}, {0x1E,0x18,0x18,0x18,0x18,0x18,0x1E,0x00}, // \ ]
+    {0x08,0x1C,0x36,0x63,0x00,0x00,0x00,0x00}, {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF}, // ^ _
+    {0x0C,0x0C,0x18,0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x1E,0x30,0x3E,0x33,0x6E,0x00}, // ` a
+    {0x07,0x06,0x06,0x3E,0x66,0x66,0x3B,0x00}, {0x00,0x00,0x1E,0x33,0x03,0x33,0x1E,0x00}, // b c
+    {0x38,0x30,0x30,0x3E,0x33,0x33,0x6E,0x00}, {0x00,0x00,0x1E,0x33,0x3F,0x03,0x1E,0x00}, // d e
+    {0x1C,0x36,0x06,0x0F,0x06,0x06,0x0F,0x00}, {0x00,0x00,0x6E,0x33,0x33,0x3E,0x30,0x1F}, // f g
+    {0x07,0x06,0x36,0x6E,0x66,0x66,0x67,0x00}, {0x0C,0x00,0x0E,0x0C,0x0C,0x0C,0x1E,0x00}, // h i
+    {0x30,0x00,0x30,0x30,0x30,0x33,0x33,0x1E}, {0x07,0x06,0x66,0x36,0x1E,0x36,0x67,0x00}, // j k
+    {0x0E,0x0C,0x0C,0x0C,0x0C,0x0C,0x1E,0x00}, {0x00,0x00,0x33,0x7F,0x7F,0x6B,0x63,0x00}, // l m
+    {0x00,0x00,0x1F,0x33,0x33,0x33,0x33,0x00}, {0x00,0x00,0x1E,0x33,0x33,0x33,0x1E,0x00}, // n o
+    {0x00,0x00,0x3B,0x66,0x66,0x3E,0x06,0x0F}, {0x00,0x00,0x6E,0x33,0x33,0x3E,0x30,0x78}, // p q
+    {0x00,0x00,0x3B,0x6E,0x66,0x06,0x0F,0x00}, {0x00,0x00,0x3E,0x03,0x1E,0x30,0x1F,0x00}, // r s
+    {0x08,0x0C,0x3E,0x0C,0x0C,0x2C,0x18,0x00}, {0x00,0x00,0x33,0x33,0x33,0x33,0x6E,0x00}, // t u
+    {0x00,0x00,0x33,0x33,0x33,0x1E,0x0C,0x00}, {0x00,0x00,0x63,0x6B,0x7F,0x7F,0x36,0x00}, // v w
+    {0x00,0x00,0x63,0x36,0x1C,0x36,0x63,0x00}, {0x00,0x00,0x33,0x33,0x33,0x3E,0x30,0x1F}, // x y
+    {0x00,0x00,0x3F,0x19,0x0C,0x26,0x3F,0x00}, {0x38,0x0C,0x0C,0x07,0x0C,0x0C,0x38,0x00}, // z {
+    {0x18,0x18,0x18,0x00,0x18,0x18,0x18,0x00}, {0x07,0x0C,0x0C,0x38,0x0C,0x0C,0x07,0x00}, // | }
+    {0x6E,0x3B,0x00,0x00,0x00,0x00,0x00,0x00},                                             // ~
+};
+constexpr uint8_t kBullet[8] = {0x00,0x00,0x0C,0x1E,0x1E,0x0C,0x00,0x00}; // U+2022, U+00B7
+
+// Next code point of UTF-8 `s` at `i`; malformed bytes decode as U+FFFD one at a time.
+char32_t NextCodePoint(std::string_view s, size_t& i) {
+    const auto b0 = static_cast<unsigned char>(s[i++]);
+    if (b0 < 0x80) return b0;
+    int extra = b0 >= 0xF0 ? 3 : b0 >= 0xE0 ? 2 : b0 >= 0xC0 ? 1 : -1;
+    if (extra < 0 || i + extra > s.size()) return 0xFFFD;
+    char32_t cp = b0 & (0x3F >> extra);
+    for (int k = 0; k < extra; ++k) {
+        const auto b = static_cast<unsigned char>(s[i]);
+        if ((b & 0xC0) != 0x80) return 0xFFFD;
+        cp = (cp << 6) | (b & 0x3F);
+        ++i;
+    }
+    return cp;
+}
+
+const uint8_t* Glyph(char32_t cp) {
+    if (cp >= 0x20 && cp <= 0x7E) return kFont[cp - 0x20];
+    if (cp == 0x2022 || cp == 0xB7) return kBullet;
+    return kFont['?' - 0x20];
+}
+
+int FontScale(float height) {
+    return std::max(1, static_cast<int>(height / 8.0f + 0.5f));
+}
+
+} // namespace
+
+void SoftPath::MoveTo(SoftPoint p) {
+    starts_.push_back(points_.size());
+    points_.push_back(p);
+}
+
+void SoftPath::LineTo(SoftPoint p) {
+    if (starts_.empty()) starts_.push_back(0);
+    points_.push_back(p);
+}
+
+SoftPath SoftPath::Stroke(float width) const {
+    SoftPath out;
+    const float half = width * 0.5f;
+    for (size_t c = 0; c < starts_.size(); ++c) {
+        const size_t begin = starts_[c];
+        const size_t end = c + 1 < starts_.size() ? starts_[c + 1] : points_.size();
+        for (size_t i = begin; i < end; ++i) {
+            const SoftPoint p = points_[i];
+            const SoftPoint q = points_[i + 1 < end ? i + 1 : begin];
+            const float dx = q.x - p.x, dy = q.y - p.y;
+            const float len = std::sqrt(dx * dx + dy * dy);
+            if (len > 0.0f) {
+                // All quads share one orientation, so the nonzero fill is their union
+                const float nx = -dy / len * half, ny = dx / len * half;
+                out.MoveTo({p.x + nx, p.y + ny});
+                out.LineTo({q.x + nx, q.y + ny});
+                out.LineTo({q.x - nx, q.y - ny});
+                out.LineTo({p.x - nx, p.y - ny});
+            }
+            // Round join: octagon wound like the quads
+            out.MoveTo({p.x + half, p.y});
+            for (int k = 1; k < 8; ++k) {
+                const float a = -k * kPi / 4.0f;
+                out.LineTo({p.x + half * std::cos(a), p.y + half * std::sin(a)});
+            }
+        }
+    }
+    return out;
+}
+
+SoftPath SoftPath::Star(float r, float innerRatio) {
+    // Same outline as the Direct2D layers' star
+    SoftPath star;
+    const float step = kPi * 2.0f / 5.0f;
+    const float start = -kPi / 2.0f;
+    const float inner = r * innerRatio;
+    for (int i = 0; i < 5; ++i) {
+        const float a0 = start + i * step;
+        const float a1 = a0 + step / 2.0f;
+        const SoftPoint tip{r * std::cos(a0), r * std::sin(a0)};
+        if (i == 0) star.MoveTo(tip);
+        else star.LineTo(tip);
+        star.LineTo({inner * std::cos(a1), inner * std::sin(a1)});
+    }
+    return star;
+}
+
+SoftPath SoftPath::RoundedRect(float left, float top, float right, float bottom, float radius) {
+    SoftPath rr;
+    radius = std::min({radius, (right - left) * 0.5f, (bottom - top) * 0.5f});
+    const SoftPoint centers[4] = {
+        {right - radius, top + radius}, {right - radius, bottom - radius},
+        {left + radius, bottom - radius}, {left + radius, top + radius}};
+    constexpr int kSegments = 6; // per quarter circle
+    for (int c = 0; c < 4; ++c) {
+        for (int k = 0; k <= kSegments; ++k) {
+            const float a = -kPi / 2.0f + (c + static_cast<float>(k) / kSegments) * kPi / 2.0f;
+            const SoftPoint p{centers[c].x + radius * std::cos(a), centers[c].y + radius * std::sin(a)};
+            if (c == 0 && k == 0) rr.MoveTo(p);
+            else rr.LineTo(p);
+        }
+    }
+    return rr;
+}
+
+void SoftCanvas::Resize(int width, int height) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    pixels_.assign(static_cast<size_t>(width_) * height_, 0);
+    coverage_.assign(static_cast<size_t>(width_) + 1, 0.0f);
+}
+
+void SoftCanvas::Clear(SoftColor color) {
+    std::fill(pixels_.begin(), pixels_.end(), Premultiply(color));
+}
+
+void SoftCanvas::BlendSpan(uint32_t* dst, int count, uint32_t src) {
+    const uint32_t alpha = src >> 24;
+    if (alpha == 255) {
+        std::fill(dst, dst + count, src);
+        return;
+    }
+    if (src == 0) return;
+    int i = 0;
+#if STRAF_SOFT_SSE2
+    const __m128i src4 = _mm_set1_epi32(static_cast<int>(src));
+    const __m128i inv = _mm_set1_epi16(static_cast<short>(255 - alpha));
+    for (; i + 4 <= count; i += 4) {
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epu8(src4, Scale4(d, inv, inv)));
+    }
+#endif
+    for (; i < count; ++i) dst[i] = Over(src, dst[i]);
+}
+
+void SoftCanvas::FillRect(float left, float top, float right, float bottom, SoftColor color) {
+    // Snapped to pixel centres
+    const int x0 = std::max(0, static_cast<int>(std::ceil(left - 0.5f)));
+    const int x1 = std::min(width_, static_cast<int>(std::ceil(right - 0.5f)));
+    const int y0 = std::max(0, static_cast<int>(std::ceil(top - 0.5f)));
+    const int y1 = std::min(height_, static_cast<int>(std::ceil(bottom - 0.5f)));
+    if (x0 >= x1 || y0 >= y1) return;
+    const uint32_t src = Premultiply(color);
+    for (int y = y0; y < y1; ++y) BlendSpan(&pixels_[static_cast<size_t>(y) * width_ + x0], x1 - x0, src);
+}
+
+void SoftCanvas::FillRadialGradient(SoftPoint center, float radius, const SoftGradientStop* stops, size_t count) {
+    if (count == 0 || radius <= 0.0f || pixels_.empty()) return;
+
+    // Premultiplied colour per 1/255 of the radius, interpolated in premultiplied space
+    uint32_t lut[256];
+    for (int i = 0; i < 256; ++i) {
+        const float t = i / 255.0f;
+        size_t hi = 0;
+        while (hi < count && stops[hi].position < t) ++hi;
+        const SoftColor& a = stops[hi == 0 ? 0 : hi - 1].color;
+        const SoftColor& b = stops[hi == count ? count - 1 : hi].color;
+        float f = 0.0f;
+        if (hi > 0 && hi < count && stops[hi].position > stops[hi - 1].position)
+            f = (t - stops[hi - 1].position) / (stops[hi].position - stops[hi - 1].position);
+        const float pa = a.a + (b.a - a.a) * f;
+        lut[i] = Pack(To8(a.b * a.a + (b.b * b.a - a.b * a.a) * f), To8(a.g * a.a + (b.g * b.a - a.g * a.a) * f),
+                      To8(a.r * a.a + (b.r * b.a - a.r * a.a) * f), To8(pa));
+    }
+    // Pixels nearer than `core` map to transparent entries and are skipped
+    int clear = -1;
+    while (clear < 255 && lut[clear + 1] == 0) ++clear;
+    const float core = clear < 0 ? 0.0f : radius * (clear + 0.5f) / 255.0f;
+    const uint32_t outside = lut[255];
+    const float scale = 255.0f / radius;
+
+    auto shade = [&](uint32_t* row, int x0, int x1, float dy2) {
+        int x = x0;
+#if STRAF_SOFT_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        const __m128 vcx = _mm_set1_ps(center.x), half = _mm_set1_ps(0.5f);
+        const __m128 vdy2 = _mm_set1_ps(dy2), vscale = _mm_set1_ps(scale), vmax = _mm_set1_ps(255.0f);
+        alignas(16) int idx[4];
+        for (; x + 4 <= x1; x += 4) {
+            const __m128 dx = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane), vcx), half);
+            const __m128 d = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), vdy2));
+            const __m128 t = _mm_add_ps(_mm_min_ps(_mm_mul_ps(d, vscale), vmax), half);
+            _mm_store_si128(reinterpret_cast<__m128i*>(idx), _mm_cvttps_epi32(t));
+            const __m128i src = _mm_set_epi32(static_cast<int>(lut[idx[3]]), static_cast<int>(lut[idx[2]]),
+                                              static_cast<int>(lut[idx[1]]), static_cast<int>(lut[idx[0]]));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(src, zero)) == 0xFFFF) continue;
+            __m128i* p = reinterpret_cast<__m128i*>(row + x);
+            _mm_storeu_si128(p, Over4(src, _mm_loadu_si128(p)));
+        }
+#endif
+        for (; x < x1; ++x) {
+            const float dx = (static_cast<float>(x) - center.x) + 0.5f; // rounded like the vector lanes
+            const float t = std::min(std::sqrt(dx * dx + dy2) * scale, 255.0f);
+            const uint32_t src = lut[static_cast<int>(t + 0.5f)];
+            if (src) row[x] = Over(src, row[x]);
+        }
+    };
+
+    for (int y = 0; y < height_; ++y) {
+        uint32_t* row = &pixels_[static_cast<size_t>(y) * width_];
+        const float dy = y + 0.5f - center.y;
+        const float dy2 = dy * dy;
+        // Columns possibly inside the circle; outside it the colour is constant
+        int in0 = width_, in1 = width_;
+        if (dy2 < radius * radius) {
+            const float h = std::sqrt(radius * radius - dy2);
+            in0 = std::clamp(static_cast<int>(std::floor(center.x - h - 0.5f)), 0, width_);
+            in1 = std::clamp(static_cast<int>(std::ceil(center.x + h - 0.5f)) + 1, in0, width_);
+        }
+        BlendSpan(row, in0, outside);
+        BlendSpan(row + in1, width_ - in1, outside);
+        // Columns strictly inside the transparent core
+        int core0 = in1, core1 = in1;
+        if (dy2 < core * core) {
+            const float h = std::sqrt(core * core - dy2);
+            core0 = std::clamp(static_cast<int>(std::floor(center.x - h - 0.5f)) + 1, in0, in1);
+            core1 = std::clamp(static_cast<int>(std::ceil(center.x + h - 0.5f)), core0, in1);
+        }
+        shade(row, in0, core0, dy2);
+        shade(row, core1, in1, dy2);
+    }
+}
+
+void SoftCanvas::FillPath(const SoftPath& path, SoftColor color, SoftPoint offset) {
+    if (path.Empty() || pixels_.empty()) return;
+    edges_.clear();
+    float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+    for (size_t c = 0; c < path.starts_.size(); ++c) {
+        const size_t begin = path.starts_[c];
+        const size_t end = c + 1 < path.starts_.size() ? path.starts_[c + 1] : path.points_.size();
+        for (size_t i = begin; i < end; ++i) {
+            SoftPoint p = path.points_[i];
+            SoftPoint q = path.points_[i + 1 < end ? i + 1 : begin];
+            p.x += offset.x; p.y += offset.y; q.x += offset.x; q.y += offset.y;
+            minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+            minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+            if (p.y == q.y) continue;
+            const int dir = p.y < q.y ? 1 : -1;
+            if (dir < 0) std::swap(p, q);
+            edges_.push_back({p.x, p.y, q.y, (q.x - p.x) / (q.y - p.y), dir});
+        }
+    }
+    const int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+    const int y1 = std::min(height_ - 1, static_cast<int>(std::floor(maxY)));
+    const int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+    const int x1 = std::min(width_ - 1, static_cast<int>(std::floor(maxX)));
+    if (x0 > x1 || y0 > y1) return;
+
+    constexpr float weight = 1.0f / kSubScanlines;
+    auto addSpan = [&](float a, float b) {
+        a = std::max(a, 0.0f);
+        b = std::min(b, static_cast<float>(width_));
+        if (a >= b) return;
+        const int ia = static_cast<int>(a), ib = static_cast<int>(b);
+        if (ia == ib) { coverage_[ia] += (b - a) * weight; return; }
+        coverage_[ia] += (ia + 1 - a) * weight;
+        for (int i = ia + 1; i < ib; ++i) coverage_[i] += weight;
+        coverage_[ib] += (b - ib) * weight; // coverage_ has one spare slot for ib == width_
+    };
+
+    const uint32_t src = Premultiply(color);
+    for (int y = y0; y <= y1; ++y) {
+        for (int s = 0; s < kSubScanlines; ++s) {
+            const float sy = y + (s + 0.5f) * weight;
+            crossings_.clear();
+            for (const Edge& e : edges_) {
+                if (sy < e.y0 || sy >= e.y1) continue;
+                crossings_.emplace_back(e.x0 + (sy - e.y0) * e.dxdy, e.dir);
+            }
+            std::sort(crossings_.begin(), crossings_.end());
+            int winding = 0;
+            float start = 0.0f;
+            for (const auto& [x, dir] : crossings_) {
+                const int before = winding;
+                winding += dir;
+                if (before == 0 && winding != 0) start = x;
+                else if (before != 0 && winding == 0) addSpan(start, x);
+            }
+        }
+        BlendCoverageRow(y, x0, std::min(x1 + 1, width_ - 1), src);
+    }
+    coverage_[width_] = 0.0f;
+}
+
+void SoftCanvas::BlendCoverageRow(int y, int x0, int x1, uint32_t src) {
+    uint32_t* row = &pixels_[static_cast<size_t>(y) * width_];
+    for (int x = x0; x <= x1; ++x) {
+        const float c = coverage_[x];
+        if (c >= 0.999f) {
+            // Run of full coverage: one vector span
+            int end = x;
+            while (end <= x1 && coverage_[end] >= 0.999f) coverage_[end++] = 0.0f;
+            BlendSpan(row + x, end - x, src);
+            x = end - 1;
+            continue;
+        }
+        coverage_[x] = 0.0f;
+        const uint32_t k = To8(c);
+        if (k) row[x] = Over(Scale(src, k), row[x]);
+    }
+}
+
+float SoftCanvas::MeasureText(std::string_view text, float height) {
+    size_t glyphs = 0;
+    for (size_t i = 0; i < text.size();) {
+        NextCodePoint(text, i);
+        ++glyphs;
+    }
+    return static_cast<float>(glyphs * 8 * FontScale(height));
+}
+
+float SoftCanvas::LineHeight(float height) {
+    return static_cast<float>(8 * FontScale(height));
+}
+
+float SoftCanvas::FillText(float x, float y, std::string_view text, float height, SoftColor color) {
+    const int scale = FontScale(height);
+    const uint32_t src = Premultiply(color);
+    int penX = static_cast<int>(std::lround(x));
+    const int top = static_cast<int>(std::lround(y));
+    for (size_t i = 0; i < text.size();) {
+        const uint8_t* glyph = Glyph(NextCodePoint(text, i));
+        for (int gy = 0; gy < 8; ++gy) {
+            const uint8_t bits = glyph[gy];
+            for (int gx = 0; gx < 8;) {
+                if (!(bits & (1u << gx))) { ++gx; continue; }
+                int run = gx;
+                while (run < 8 && (bits & (1u << run))) ++run;
+                // One span per run of set bits, `scale` rows high
+                const int sx0 = std::max(0, penX + gx * scale);
+                const int sx1 = std::min(width_, penX + run * scale);
+                for (int r = 0; r < scale && sx0 < sx1; ++r) {
+                    const int sy = top + gy * scale + r;
+                    if (sy < 0 || sy >= height_) continue;
+                    BlendSpan(&pixels_[static_cast<size_t>(sy) * width_ + sx0], sx1 - sx0, src);
+                }
+                gx = run;
+            }
+        }
+        penX += 8 * scale;
+    }
+    return static_cast<float>(penX) - x;
+}
+
+uint64_t SoftCanvas::Hash() const {
+    uint64_t h = 14695981039346656037ull;
+    for (uint32_t px : pixels_) {
+        for (int b = 0; b < 4; ++b) {
+            h ^= (px >> (8 * b)) & 0xFF;
+            h *= 1099511628211ull;
+        }
+    }
+    return h;
+}
+
+}
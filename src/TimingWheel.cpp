@@ -0,0 +1,163 @@
+#include "Straf/TimingWheel.h"
+#include <algorithm>
+#include <bit>
+
+namespace Straf {
+
+TimingWheel::TimingWheel(clock::duration tick, clock::time_point origin)
+    : tick_(tick.count() > 0 ? tick : clock::duration{1}), origin_(origin) {
+    std::fill(std::begin(heads_), std::end(heads_), kNil);
+}
+
+uint64_t TimingWheel::FloorTick(clock::time_point t) const {
+    if (t <= origin_) return 0;
+    return static_cast<uint64_t>((t - origin_) / tick_);
+}
+
+uint64_t TimingWheel::CeilTick(clock::time_point t) const {
+    if (t <= origin_) return 0;
+    const auto elapsed = t - origin_;
+    auto ticks = static_cast<uint64_t>(elapsed / tick_);
+    if (elapsed % tick_ != clock::duration::zero()) ++ticks;
+    return ticks;
+}
+
+TimingWheel::TimerId TimingWheel::Schedule(clock::time_point when, uint64_t tag) {
+    uint32_t index;
+    if (freeHead_ != kNil) {
+        index = freeHead_;
+        freeHead_ = nodes_[index].next;
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    Node& node = nodes_[index];
+    node.expires = std::max(CeilTick(when), current_ + 1);
+    node.tag = tag;
+    File(index);
+    ++size_;
+    return (static_cast<uint64_t>(node.generation) << 32) | index;
+}
+
+bool TimingWheel::Pending(TimerId id) const {
+    const auto index = static_cast<uint32_t>(id);
+    if (id == kNoTimer || index >= nodes_.size()) return false;
+    const Node& node = nodes_[index];
+    return node.generation == static_cast<uint32_t>(id >> 32) && node.slot != kFree;
+}
+
+bool TimingWheel::Cancel(TimerId id) {
+    if (!Pending(id)) return false;
+    const auto index = static_cast<uint32_t>(id);
+    Unlink(index);
+    Release(index);
+    return true;
+}
+
+std::optional<uint64_t> TimingWheel::NextTick() const {
+    if (size_ == 0) return std::nullopt;
+    for (int level = 0; level < kLevels; ++level) {
+        const int shift = level * kLevelBits;
+        const uint64_t index = (current_ >> shift) & kSlotMask;
+        // Only slots after the current one can be occupied at any level.
+        const uint64_t later = occupied_[level] & ~((uint64_t{2} << index) - 1);
+        if (later) {
+            const uint64_t base = current_ & ~((uint64_t{1} << (shift + kLevelBits)) - 1);
+            return base | (static_cast<uint64_t>(std::countr_zero(later)) << shift);
+        }
+    }
+    // Only overflow timers remain; they are re-filed at the next top-level revolution.
+    constexpr uint64_t span = (uint64_t{1} << (kLevels * kLevelBits)) - 1;
+    return (current_ | span) + 1;
+}
+
+std::optional<TimingWheel::clock::time_point> TimingWheel::NextExpiry() const {
+    auto tick = NextTick();
+    if (!tick) return std::nullopt;
+    return origin_ + tick_ * static_cast<clock::rep>(*tick);
+}
+
+bool TimingWheel::StepToward(uint64_t target) {
+    auto next = NextTick();
+    if (!next || *next > target) {
+        // Nothing due or to cascade before target: jump straight there.
+        current_ = target;
+        return false;
+    }
+    current_ = *next;
+    if ((current_ & kSlotMask) == 0) {
+        int top = 0;
+        while (top + 1 < kLevels && (current_ & ((uint64_t{1} << ((top + 1) * kLevelBits)) - 1)) == 0) ++top;
+        if (top == kLevels - 1 && (current_ & ((uint64_t{1} << (kLevels * kLevelBits)) - 1)) == 0) {
+            Cascade(kOverflow);
+        }
+        for (int level = top; level >= 1; --level) {
+            Cascade(static_cast<uint32_t>(level * kSlots + ((current_ >> (level * kLevelBits)) & kSlotMask)));
+        }
+    }
+    return true;
+}
+
+bool TimingWheel::PopDue(uint64_t& tag) {
+    const uint32_t index = heads_[current_ & kSlotMask];
+    if (index == kNil) return false;
+    tag = nodes_[index].tag;
+    Unlink(index);
+    Release(index);
+    return true;
+}
+
+void TimingWheel::File(uint32_t index) {
+    const uint64_t diff = nodes_[index].expires ^ current_;
+    for (int level = 0; level < kLevels; ++level) {
+        if ((diff >> ((level + 1) * kLevelBits)) == 0) {
+            const uint64_t slot = (nodes_[index].expires >> (level * kLevelBits)) & kSlotMask;
+            Link(index, static_cast<uint32_t>(level * kSlots + slot));
+            return;
+        }
+    }
+    Link(index, kOverflow);
+}
+
+void TimingWheel::Link(uint32_t index, uint32_t slot) {
+    Node& node = nodes_[index];
+    node.slot = slot;
+    node.prev = kNil;
+    node.next = heads_[slot];
+    if (node.next != kNil) nodes_[node.next].prev = index;
+    heads_[slot] = index;
+    if (slot < kOverflow) occupied_[slot / kSlots] |= uint64_t{1} << (slot % kSlots);
+}
+
+void TimingWheel::Unlink(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.prev != kNil) nodes_[node.prev].next = node.next;
+    else heads_[node.slot] = node.next;
+    if (node.next != kNil) nodes_[node.next].prev = node.prev;
+    if (heads_[node.slot] == kNil && node.slot < kOverflow) {
+        occupied_[node.slot / kSlots] &= ~(uint64_t{1} << (node.slot % kSlots));
+    }
+}
+
+void TimingWheel::Release(uint32_t index) {
+    Node& node = nodes_[index];
+    node.slot = kFree;
+    ++node.generation;
+    if (node.generation == 0) node.generation = 1; // keep ids non-zero
+    node.next = freeHead_;
+    freeHead_ = index;
+    --size_;
+}
+
+void TimingWheel::Cascade(uint32_t slot) {
+    uint32_t index = heads_[slot];
+    heads_[slot] = kNil;
+    if (slot < kOverflow) occupied_[slot / kSlots] &= ~(uint64_t{1} << (slot % kSlots));
+    while (index != kNil) {
+        const uint32_t next = nodes_[index].next;
+        File(index);
+        index = next;
+    }
+}
+
+}
@@ -0,0 +1,325 @@
+#include "Straf/Trace.h"
+#include "Straf/Platform.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Straf::trace {
+
+namespace {
+
+size_t RoundUpPow2(size_t n) {
+    size_t p = 64;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// One thread's latest spans. The owning thread overwrites the oldest slot
+// without waiting; WriteChromeJson() reads concurrently. Each slot is a
+// seqlock over atomic words: odd while being written, 2n+2 once span n is
+// complete, so a reader drops slots that changed under it instead of
+// reporting a torn span.
+//
+// When the thread exits the ring is closed, and the next thread to record
+// takes it over instead of allocating another; the exited thread's spans are
+// dropped then. So the rings never outnumber the threads alive at once.
+class Ring {
+public:
+    Ring(size_t capacity, uint64_t threadId)
+        : capacity_(RoundUpPow2(capacity)), mask_(capacity_ - 1), threadId_(threadId),
+          slots_(std::make_unique<Slot[]>(capacity_)) {}
+
+    // Owning thread only.
+    void Push(const detail::Event& e) {
+        const uint64_t n = next_.load(std::memory_order_relaxed);
+        Slot& s = slots_[n & mask_];
+        s.seq.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.category.store(e.category, std::memory_order_relaxed);
+        s.name.store(e.name, std::memory_order_relaxed);
+        s.startNs.store(e.startNs, std::memory_order_relaxed);
+        s.durationNs.store(e.durationNs, std::memory_order_relaxed);
+        s.flow.store(e.flow, std::memory_order_relaxed);
+        s.phase.store(e.phase, std::memory_order_relaxed);
+        s.seq.store(2 * n + 2, std::memory_order_release);
+        next_.store(n + 1, std::memory_order_release);
+    }
+
+    // Any thread. Calls fn(event) for every retained span, oldest first.
+    template <typename Fn>
+    void ForEach(Fn&& fn) const {
+        const uint64_t end = next_.load(std::memory_order_acquire);
+        for (uint64_t n = end > capacity_ ? end - capacity_ : 0; n < end; ++n) {
+            const Slot& s = slots_[n & mask_];
+            const uint64_t seq = s.seq.load(std::memory_order_acquire);
+            if (seq != 2 * n + 2) continue; // overwritten since `end` was read
+            const detail::Event e{s.category.load(std::memory_order_relaxed), s.name.load(std::memory_order_relaxed),
+                                  s.startNs.load(std::memory_order_relaxed), s.durationNs.load(std::memory_order_relaxed),
+                                  s.flow.load(std::memory_order_relaxed), s.phase.load(std::memory_order_relaxed)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) != seq) continue;
+            fn(e);
+        }
+    }
+
+    uint64_t Recorded() const { return next_.load(std::memory_order_relaxed); }
+    uint64_t Overwritten() const {
+        const uint64_t n = Recorded();
+        return n > capacity_ ? n - capacity_ : 0;
+    }
+    uint64_t ThreadId() const { return threadId_; }
+    size_t Capacity() const { return capacity_; }
+
+    void Close() { closed_.store(true, std::memory_order_release); }
+    bool Closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // Hands a closed ring to a new thread. Under the registry mutex, so no
+    // reader is walking it; the stale slots lie past `next_` and their
+    // sequence numbers belong to the old spans, so they are never reported.
+    void Reopen(uint64_t threadId) {
+        threadId_ = threadId;
+        next_.store(0, std::memory_order_release);
+        closed_.store(false, std::memory_order_release);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<const char*> category{nullptr};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<int64_t> startNs{0};
+        std::atomic<int64_t> durationNs{0};
+        std::atomic<uint64_t> flow{0};
+        std::atomic<FlowPhase> phase{FlowPhase::None};
+    };
+
+    const size_t capacity_;
+    const uint64_t mask_;
+    uint64_t threadId_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> next_{0}; // spans pushed so far
+    std::atomic<bool> closed_{false}; // owning thread has exited
+};
+
+struct ThreadEntry {
+    std::unique_ptr<Ring> ring;
+    std::string name;
+};
+
+// Rings of the threads that have recorded, exited ones included until their
+// ring is taken over. The mutex is taken when a thread records for the first
+// time, names itself, or a trace is written; never per span.
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadEntry> threads;
+    Options options;
+    uint64_t retiredRecorded{0};    // counters of rings taken over by another thread
+    uint64_t retiredOverwritten{0};
+    uint64_t attached{0};           // threads that have recorded
+    std::atomic<uint64_t> nextFlow{0};
+};
+
+Registry& Reg() {
+    static Registry* registry = new Registry; // rings outlive the threads that filled them
+    return *registry;
+}
+
+thread_local Ring* t_ring = nullptr;
+thread_local std::string t_name; // set before this thread's ring exists
+
+// Closes the ring when its thread exits so another thread can take it over.
+struct ThreadRingOwner {
+    Ring* ring{nullptr};
+    ~ThreadRingOwner() {
+        t_ring = nullptr;
+        t_exiting = true;
+        if (ring) ring->Close();
+    }
+    static inline thread_local bool t_exiting = false;
+};
+thread_local ThreadRingOwner t_owner;
+
+Ring* AttachThisThread() {
+    if (ThreadRingOwner::t_exiting) return nullptr;
+    Registry& reg = Reg();
+    std::lock_guard lock(reg.mutex);
+    ++reg.attached;
+    const uint64_t threadId = platform::CurrentThreadId();
+    const size_t capacity = RoundUpPow2(reg.options.eventsPerThread);
+    ThreadEntry* entry = nullptr;
+    for (auto& t : reg.threads) {
+        if (!t.ring->Closed()) continue;
+        if (t.ring->Capacity() == capacity) {
+            if (!entry) entry = &t;
+            continue;
+        }
+        // Sized by earlier options: no new thread would take it over
+        reg.retiredRecorded += t.ring->Recorded();
+        reg.retiredOverwritten += t.ring->Overwritten();
+        t.ring.reset();
+    }
+    if (entry) {
+        reg.retiredRecorded += entry->ring->Recorded();
+        reg.retiredOverwritten += entry->ring->Overwritten();
+        entry->ring->Reopen(threadId);
+        entry->name = t_name;
+        t_ring = entry->ring.get();
+    }
+    std::erase_if(reg.threads, [](const ThreadEntry& t) { return !t.ring; });
+    if (!t_ring) {
+        reg.threads.push_back(ThreadEntry{std::make_unique<Ring>(capacity, threadId), t_name});
+        t_ring = reg.threads.back().ring.get();
+    }
+    t_owner.ring = t_ring;
+    return t_ring;
+}
+
+void AppendEscaped(std::string& out, const char* s) {
+    for (; s && *s; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof buf, "\\u%04x", c);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+}
+
+} // namespace
+
+namespace detail {
+
+void Record(const Event& event) {
+    Ring* ring = t_ring ? t_ring : AttachThisThread();
+    if (ring) ring->Push(event); // nullptr: recorded while the thread exits
+}
+
+} // namespace detail
+
+void Enable(Options options) {
+    Registry& reg = Reg();
+    {
+        std::lock_guard lock(reg.mutex);
+        reg.options = options;
+    }
+    detail::g_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Disable() {
+    detail::g_enabled.store(false, std::memory_order_relaxed);
+}
+
+Stats GetStats() {
+    Registry& reg = Reg();
+    std::lock_guard lock(reg.mutex);
+    Stats s;
+    s.recorded = reg.retiredRecorded;
+    s.overwritten = reg.retiredOverwritten;
+    s.threads = reg.attached;
+    s.rings = reg.threads.size();
+    for (const auto& t : reg.threads) {
+        s.recorded += t.ring->Recorded();
+        s.overwritten += t.ring->Overwritten();
+    }
+    return s;
+}
+
+void SetThreadName(const char* name) {
+    platform::SetCurrentThreadName(name);
+    t_name = name ? name : "";
+    if (!t_ring) return;
+    Registry& reg = Reg();
+    std::lock_guard lock(reg.mutex);
+    for (auto& t : reg.threads) {
+        if (t.ring.get() == t_ring) t.name = t_name;
+    }
+}
+
+uint64_t NewFlow() {
+    if (!Enabled()) return 0;
+    return Reg().nextFlow.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+uint64_t CurrentFlow() {
+    return detail::t_flow;
+}
+
+bool WriteChromeJson(const std::filesystem::path& path) {
+    struct Source {
+        uint64_t threadId;
+        std::string name;
+        std::vector<detail::Event> events;
+    };
+    std::vector<Source> sources;
+    {
+        Registry& reg = Reg();
+        std::lock_guard lock(reg.mutex);
+        for (const auto& t : reg.threads) sources.push_back(Source{t.ring->ThreadId(), t.name, {}});
+        // Copied under the lock only so the list stays stable; recording threads never take it
+        for (size_t i = 0; i < sources.size(); ++i) {
+            reg.threads[i].ring->ForEach([&](const detail::Event& e) { sources[i].events.push_back(e); });
+        }
+    }
+
+    // Timestamps in microseconds from the earliest retained span
+    int64_t originNs = INT64_MAX;
+    for (const auto& src : sources) {
+        for (const auto& e : src.events) originNs = std::min(originNs, e.startNs);
+    }
+
+    const uint64_t pid = platform::ProcessId();
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    char buf[256];
+    auto separator = [&] {
+        if (!first) out += ",\n";
+        first = false;
+    };
+    for (const auto& src : sources) {
+        const uint64_t tid = src.threadId;
+        if (!src.name.empty()) {
+            separator();
+            std::snprintf(buf, sizeof buf, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%" PRIu64 ",\"tid\":%" PRIu64 ",\"args\":{\"name\":\"", pid, tid);
+            out += buf;
+            AppendEscaped(out, src.name.c_str());
+            out += "\"}}";
+        }
+        for (const detail::Event& e : src.events) {
+            const double ts = static_cast<double>(e.startNs - originNs) / 1000.0;
+            separator();
+            out += "{\"name\":\"";
+            AppendEscaped(out, e.name);
+            out += "\",\"cat\":\"";
+            AppendEscaped(out, e.category);
+            std::snprintf(buf, sizeof buf, "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%" PRIu64 ",\"tid\":%" PRIu64 "}",
+                          ts, static_cast<double>(e.durationNs) / 1000.0, pid, tid);
+            out += buf;
+            if (e.phase == FlowPhase::None) continue;
+            // Flow events bind to the slice that encloses their timestamp
+            separator();
+            std::snprintf(buf, sizeof buf,
+                          "{\"name\":\"utterance\",\"cat\":\"flow\",\"ph\":\"%s\",\"id\":%" PRIu64 ",\"ts\":%.3f,\"pid\":%" PRIu64
+                          ",\"tid\":%" PRIu64 ",\"bp\":\"e\"}",
+                          e.phase == FlowPhase::Begin ? "s" : "t", e.flow, ts, pid, tid);
+            out += buf;
+        }
+    }
+    out += "\n]}\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+} // namespace Straf::trace
@@ -4,6 +4,7 @@
 #include <windows.h>
 #include <shellapi.h>
 #include <thread>
+#include <vector>
 
 namespace Straf {
 
@@ -14,6 +15,11 @@ public:
         Stop();
     }
     
+    void AddMenuItem(std::wstring label, std::function<void()> onClick) override {
+        if (running_) return;
+        items_.push_back(MenuItem{std::move(label), std::move(onClick)});
+    }
+
     void Run(std::function<void()> onExit) override {
         if (running_) return;
         running_ = true;
@@ -39,10 +45,18 @@ public:
     }
     
 private:
+    struct MenuItem {
+        std::wstring label;
+        std::function<void()> onClick;
+    };
+    static constexpr UINT kExitCommand = 1;
+    static constexpr UINT kFirstItemCommand = 100;
+
     NOTIFYICONDATA nid_{};
     HWND hwnd_{};
     std::thread worker_;
     std::function<void()> onExit_;
+    std::vector<MenuItem> items_; // fixed once running
     std::atomic<bool> running_{false};
     UINT WM_TRAY_{RegisterWindowMessageW(L"StrafTrayMsg")};
     
@@ -93,14 +107,22 @@ private:
     void ShowMenu() {
         POINT pt; GetCursorPos(&pt);
         HMENU menu = CreatePopupMenu();
-        AppendMenuW(menu, MF_STRING, 1, L"Exit");
+        for (size_t i = 0; i < items_.size(); ++i) {
+            AppendMenuW(menu, MF_STRING, kFirstItemCommand + i, items_[i].label.c_str());
+        }
+        if (!items_.empty()) AppendMenuW(menu, MF_SEPARATOR, 0, nullptr);
+        AppendMenuW(menu, MF_STRING, kExitCommand, L"Exit");
         SetForegroundWindow(hwnd_);
         
         
         int cmd = TrackPopupMenu(menu, TPM_RETURNCMD | TPM_RIGHTBUTTON, pt.x, pt.y, 0, hwnd_, nullptr);
         DestroyMenu(menu);
         
-        if (cmd == 1) { if (onExit_) { onExit_(); } }
+        if (cmd == static_cast<int>(kExitCommand)) { if (onExit_) { onExit_(); } }
+        if (cmd >= static_cast<int>(kFirstItemCommand) && cmd < static_cast<int>(kFirstItemCommand + items_.size())) {
+            const auto& item = items_[cmd - kFirstItemCommand];
+            if (item.onClick) item.onClick();
+        }
     }
     static LRESULT CALLBACK WndProcThunk(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam) {
         TrayWin* self = reinterpret_cast<TrayWin*>(GetWindowLongPtrW(hWnd, GWLP_USERDATA));
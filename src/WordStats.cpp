@@ -0,0 +1,327 @@
+#include "Straf/WordStats.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <optional>
+
+namespace fs = std::filesystem;
+
+namespace Straf {
+
+namespace {
+
+constexpr const char* kStatsFile = "word-stats.bin";
+constexpr char kMagic[4] = {'S', 'W', 'S', '1'};
+constexpr uint32_t kLevelMinutes[] = {1, 60, 1440};
+
+enum RecordType : uint8_t { kWordRecord = 1, kBucketRecord = 2 };
+constexpr uint8_t kRollUp = 1; // live minute record: also counts toward its hour and day
+
+// File layout: FileHeader, then records. A word record names the next file
+// word index; bucket records refer to words by that index.
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+};
+
+struct WordRecord {
+    uint8_t type;
+    uint8_t length; // followed by `length` bytes of UTF-8
+};
+
+struct BucketRecord {
+    uint8_t type;
+    uint8_t level;
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t minute; // bucket start, minutes since the Unix epoch
+    uint32_t word;   // file word index
+    uint32_t counts[kWordOutcomeCount];
+};
+static_assert(sizeof(BucketRecord) == 28, "bucket records are fixed 28-byte entries");
+
+uint32_t ToMinute(std::chrono::system_clock::time_point t) {
+    const auto m = std::chrono::floor<std::chrono::minutes>(t.time_since_epoch()).count();
+    return static_cast<uint32_t>(std::clamp<int64_t>(m, 0, UINT32_MAX));
+}
+
+uint32_t NowMinute() { return ToMinute(std::chrono::system_clock::now()); }
+
+std::chrono::system_clock::time_point FromMinute(uint64_t minute) {
+    return std::chrono::system_clock::time_point(std::chrono::minutes(minute));
+}
+
+uint32_t BucketStart(int level, uint32_t minute) { return minute - minute % kLevelMinutes[level]; }
+
+void AppendWord(std::string& out, const std::string& word) {
+    WordRecord r{kWordRecord, static_cast<uint8_t>(std::min<size_t>(word.size(), 255))};
+    out.append(reinterpret_cast<const char*>(&r), sizeof(r));
+    out.append(word.data(), r.length);
+}
+
+void AppendBucket(std::string& out, uint8_t level, uint8_t flags, uint32_t minute, uint32_t word, const WordOutcomeCounts& counts) {
+    BucketRecord r{kBucketRecord, level, flags, 0, minute, word, {}};
+    for (size_t i = 0; i < kWordOutcomeCount; ++i) r.counts[i] = static_cast<uint32_t>(std::min<uint64_t>(counts[i], UINT32_MAX));
+    out.append(reinterpret_cast<const char*>(&r), sizeof(r));
+}
+
+} // namespace
+
+WordStats::WordStats(const fs::path& directory, WordStatsOptions options)
+    : path_(directory / kStatsFile), options_(options), shards_(std::make_unique<Shard[]>(kShards)) {}
+
+std::unique_ptr<WordStats> WordStats::Open(const std::string& directory, WordStatsOptions options) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    std::unique_ptr<WordStats> stats(new WordStats(directory, options));
+    {
+        std::lock_guard<std::mutex> lock(stats->mutex_);
+        stats->Load();
+        stats->Prune(NowMinute());
+        if (!stats->Compact()) return nullptr;
+    }
+    stats->roller_ = std::thread([s = stats.get()] { s->Run(); });
+    return stats;
+}
+
+WordStats::~WordStats() {
+    if (roller_.joinable()) {
+        stop_ = true;
+        wake_.Notify();
+        roller_.join();
+        Flush();
+    }
+    for (size_t s = 0; s < kShards; ++s) {
+        for (auto& block : shards_[s].blocks) delete block.load(std::memory_order_relaxed);
+    }
+}
+
+WordStats::Block* WordStats::AllocateBlock(size_t shard, size_t index) {
+    auto fresh = std::make_unique<Block>();
+    Block* expected = nullptr;
+    if (shards_[shard].blocks[index].compare_exchange_strong(expected, fresh.get(), std::memory_order_acq_rel)) {
+        return fresh.release();
+    }
+    return expected; // another thread sharing this shard won
+}
+
+// Roller thread. Opens a minute when the first count arrives and rolls it
+// once the minute is over; with nothing recorded it waits without a deadline.
+void WordStats::Run() {
+    std::optional<uint32_t> open;
+    while (!stop_) {
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        if (open) {
+            deadline = std::chrono::steady_clock::now() +
+                       std::chrono::duration_cast<std::chrono::steady_clock::duration>(FromMinute(*open + 1ull) - std::chrono::system_clock::now());
+        }
+        wake_.WaitUntil(deadline);
+        if (stop_) break;
+        const uint32_t now = NowMinute();
+        if (!open) {
+            if (dirty_.load(std::memory_order_acquire)) open = now;
+            continue;
+        }
+        if (now > *open) {
+            // Clear first: counts that race with the roll set it again and
+            // open the next minute.
+            dirty_.store(false, std::memory_order_release);
+            std::lock_guard<std::mutex> lock(mutex_);
+            Roll(*open);
+            open.reset();
+            if (dirty_.load(std::memory_order_acquire)) open = now;
+        }
+    }
+}
+
+void WordStats::Flush() {
+    dirty_.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Roll(NowMinute());
+}
+
+void WordStats::Roll(uint32_t minute) {
+    const size_t words = Words().Size();
+    if (rolled_.size() < words) rolled_.resize(words);
+
+    std::vector<std::pair<std::string, WordOutcomeCounts>> rows;
+    std::vector<WordOutcomeCounts> sums(kBlockWords);
+    for (size_t b = 0; b * kBlockWords < words; ++b) {
+        bool any = false;
+        std::fill(sums.begin(), sums.end(), WordOutcomeCounts{});
+        for (size_t s = 0; s < kShards; ++s) {
+            const Block* block = shards_[s].blocks[b].load(std::memory_order_acquire);
+            if (!block) continue;
+            any = true;
+            for (size_t w = 0; w < kBlockWords; ++w) {
+                for (size_t o = 0; o < kWordOutcomeCount; ++o) sums[w][o] += block->counts[w][o].load(std::memory_order_relaxed);
+            }
+        }
+        if (!any) continue;
+        for (size_t w = 0; w < kBlockWords && b * kBlockWords + w < words; ++w) {
+            const WordId id = static_cast<WordId>(b * kBlockWords + w);
+            WordOutcomeCounts delta{};
+            bool changed = false;
+            for (size_t o = 0; o < kWordOutcomeCount; ++o) {
+                delta[o] = sums[w][o] - rolled_[id][o];
+                changed = changed || delta[o] != 0;
+            }
+            if (!changed) continue;
+            rolled_[id] = sums[w];
+            const std::string_view name = Words().Name(id);
+            if (name.empty()) continue;
+            rows.emplace_back(std::string(name), delta);
+        }
+    }
+
+    for (const auto& [word, delta] : rows) {
+        for (int level = Minute; level < kLevels; ++level) Add(static_cast<Level>(level), minute, word, delta);
+    }
+    if (!rows.empty()) AppendMinute(minute, rows);
+    Prune(minute);
+    if (appended_ >= options_.compactEvery) Compact();
+}
+
+void WordStats::Add(Level level, uint32_t minute, const std::string& word, const WordOutcomeCounts& counts) {
+    auto& total = buckets_[level][BucketStart(level, minute)][word];
+    for (size_t o = 0; o < kWordOutcomeCount; ++o) total[o] += counts[o];
+}
+
+void WordStats::Prune(uint32_t nowMinute) {
+    const auto cutoff = [nowMinute](std::chrono::hours retention) {
+        const auto keep = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::minutes>(retention).count());
+        return nowMinute > keep ? nowMinute - keep : 0u;
+    };
+    buckets_[Minute].erase(buckets_[Minute].begin(), buckets_[Minute].lower_bound(cutoff(options_.minuteRetention)));
+    buckets_[Hour].erase(buckets_[Hour].begin(), buckets_[Hour].lower_bound(cutoff(options_.hourRetention)));
+}
+
+bool WordStats::Load() {
+    std::ifstream f(path_, std::ios::binary);
+    if (!f.is_open()) return false;
+    const std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    FileHeader header{};
+    if (data.size() < sizeof(header)) return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != 1) return false;
+
+    std::vector<std::string> names;
+    size_t pos = sizeof(header);
+    while (pos < data.size()) {
+        // Stops at the first torn or unknown record
+        const auto type = static_cast<uint8_t>(data[pos]);
+        if (type == kWordRecord) {
+            WordRecord r{};
+            if (pos + sizeof(r) > data.size()) break;
+            std::memcpy(&r, data.data() + pos, sizeof(r));
+            if (pos + sizeof(r) + r.length > data.size()) break;
+            names.emplace_back(data.data() + pos + sizeof(r), r.length);
+            pos += sizeof(r) + r.length;
+        } else if (type == kBucketRecord) {
+            BucketRecord r{};
+            if (pos + sizeof(r) > data.size()) break;
+            std::memcpy(&r, data.data() + pos, sizeof(r));
+            if (r.level >= kLevels || r.word >= names.size()) break;
+            WordOutcomeCounts counts{};
+            for (size_t o = 0; o < kWordOutcomeCount; ++o) counts[o] = r.counts[o];
+            if (r.flags & kRollUp) {
+                for (int level = Minute; level < kLevels; ++level) Add(static_cast<Level>(level), r.minute, names[r.word], counts);
+            } else {
+                Add(static_cast<Level>(r.level), r.minute, names[r.word], counts);
+            }
+            pos += sizeof(r);
+        } else {
+            break;
+        }
+    }
+    return true;
+}
+
+// Rewrites the file from the in-memory buckets: each level's buckets stand
+// alone, so expired minutes survive only inside their hour and day.
+bool WordStats::Compact() {
+    std::string out;
+    const FileHeader header{{kMagic[0], kMagic[1], kMagic[2], kMagic[3]}, 1};
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    fileWords_.clear();
+    for (int level = Minute; level < kLevels; ++level) {
+        for (const auto& [start, words] : buckets_[level]) {
+            for (const auto& [word, counts] : words) {
+                auto [it, inserted] = fileWords_.emplace(word, static_cast<uint32_t>(fileWords_.size()));
+                if (inserted) AppendWord(out, word);
+                AppendBucket(out, static_cast<uint8_t>(level), 0, start, it->second, counts);
+            }
+        }
+    }
+
+    const fs::path temp = path_.string() + ".tmp";
+    {
+        std::ofstream f(temp, std::ios::binary | std::ios::trunc);
+        if (!f.write(out.data(), static_cast<std::streamsize>(out.size())) || !f.flush()) return false;
+    }
+    std::error_code ec;
+    fs::rename(temp, path_, ec);
+    if (ec) return false;
+    appended_ = 0;
+    return true;
+}
+
+bool WordStats::AppendMinute(uint32_t minute, const std::vector<std::pair<std::string, WordOutcomeCounts>>& rows) {
+    std::string out;
+    for (const auto& [word, counts] : rows) {
+        auto [it, inserted] = fileWords_.emplace(word, static_cast<uint32_t>(fileWords_.size()));
+        if (inserted) AppendWord(out, word);
+        AppendBucket(out, Minute, kRollUp, minute, it->second, counts);
+    }
+    appended_ += rows.size();
+    std::ofstream f(path_, std::ios::binary | std::ios::app);
+    return f.write(out.data(), static_cast<std::streamsize>(out.size())) && f.flush();
+}
+
+WordStatsRange WordStats::Query(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to,
+                                WordOutcome by, size_t topN) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint32_t now = NowMinute();
+    const uint32_t first = ToMinute(from);
+    const auto retained = [&](std::chrono::hours retention) {
+        return static_cast<uint64_t>(first) + static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::minutes>(retention).count()) >= now;
+    };
+    const Level level = retained(options_.minuteRetention) ? Minute : retained(options_.hourRetention) ? Hour : Day;
+    const uint32_t size = kLevelMinutes[level];
+    const uint32_t start = BucketStart(level, first);
+    const uint64_t last = ToMinute(to - std::chrono::nanoseconds(1));
+    const uint64_t end = (last / size + 1) * size;
+
+    WordStatsRange range;
+    range.from = FromMinute(start);
+    range.to = FromMinute(end);
+    range.resolution = std::chrono::minutes(size);
+    if (to <= from) {
+        range.to = range.from;
+        return range;
+    }
+
+    std::unordered_map<std::string_view, WordOutcomeCounts> byWord;
+    const Buckets& buckets = buckets_[level];
+    for (auto it = buckets.lower_bound(start); it != buckets.end() && it->first < end; ++it) {
+        for (const auto& [word, counts] : it->second) {
+            auto& sum = byWord[word];
+            for (size_t o = 0; o < kWordOutcomeCount; ++o) {
+                sum[o] += counts[o];
+                range.totals[o] += counts[o];
+            }
+        }
+    }
+
+    const auto rank = static_cast<size_t>(by);
+    std::vector<std::pair<std::string_view, WordOutcomeCounts>> rows(byWord.begin(), byWord.end());
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [rank](const auto& r) { return r.second[rank] == 0; }), rows.end());
+    const size_t n = std::min(topN, rows.size());
+    std::partial_sort(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(n), rows.end(), [rank](const auto& a, const auto& b) {
+        return a.second[rank] != b.second[rank] ? a.second[rank] > b.second[rank] : a.first < b.first;
+    });
+    for (size_t i = 0; i < n; ++i) range.top.push_back({std::string(rows[i].first), rows[i].second});
+    return range;
+}
+
+}
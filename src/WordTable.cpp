@@ -0,0 +1,102 @@
+#include "Straf/WordTable.h"
+#include <functional>
+
+namespace Straf {
+
+namespace {
+
+// UTF-8 to wchar_t (UTF-16 on Windows, UTF-32 elsewhere). Malformed bytes
+// become U+FFFD.
+std::wstring Widen(std::string_view s) {
+    std::wstring out;
+    out.reserve(s.size());
+    size_t i = 0;
+    while (i < s.size()) {
+        const auto c = static_cast<unsigned char>(s[i]);
+        uint32_t cp = 0xFFFD;
+        size_t len = 1;
+        if (c < 0x80) { cp = c; }
+        else if ((c >> 5) == 0x6) { len = 2; cp = c & 0x1F; }
+        else if ((c >> 4) == 0xE) { len = 3; cp = c & 0x0F; }
+        else if ((c >> 3) == 0x1E) { len = 4; cp = c & 0x07; }
+        if (len > 1) {
+            if (i + len > s.size()) { cp = 0xFFFD; len = 1; }
+            else {
+                for (size_t k = 1; k < len; ++k) {
+                    const auto cc = static_cast<unsigned char>(s[i + k]);
+                    if ((cc >> 6) != 0x2) { cp = 0xFFFD; len = k; break; }
+                    cp = (cp << 6) | (cc & 0x3F);
+                }
+            }
+        }
+        i += len;
+        if constexpr (sizeof(wchar_t) == 2) {
+            if (cp >= 0x10000) {
+                cp -= 0x10000;
+                out.push_back(static_cast<wchar_t>(0xD800 + (cp >> 10)));
+                out.push_back(static_cast<wchar_t>(0xDC00 + (cp & 0x3FF)));
+                continue;
+            }
+        }
+        out.push_back(static_cast<wchar_t>(cp));
+    }
+    return out;
+}
+
+} // namespace
+
+WordTable::WordTable() : index_(std::make_unique<std::atomic<WordId>[]>(kIndexSlots)) {
+    chunks_[0] = std::make_unique<Entry[]>(kChunkSize);
+    count_.store(1, std::memory_order_release); // id 0 = kNoWord, empty
+}
+
+WordId WordTable::Intern(std::string_view word) {
+    if (word.empty()) return kNoWord;
+    if (WordId known = Find(word); known != kNoWord) return known;
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    size_t slot = std::hash<std::string_view>{}(word) & (kIndexSlots - 1);
+    for (WordId id; (id = index_[slot].load(std::memory_order_relaxed)) != kNoWord; slot = (slot + 1) & (kIndexSlots - 1)) {
+        if (Name(id) == word) return id; // added since Find()
+    }
+
+    const size_t id = count_.load(std::memory_order_relaxed);
+    if (id >= kCapacity) return kNoWord;
+    auto& chunk = chunks_[id >> kChunkBits];
+    if (!chunk) chunk = std::make_unique<Entry[]>(kChunkSize);
+    Entry& entry = chunk[id & (kChunkSize - 1)];
+    entry.name.assign(word);
+    entry.wide = Widen(word);
+    count_.store(id + 1, std::memory_order_release); // publish after the entry is complete
+    index_[slot].store(static_cast<WordId>(id), std::memory_order_release); // then make it findable
+    return static_cast<WordId>(id);
+}
+
+WordId WordTable::Find(std::string_view word) const {
+    if (word.empty()) return kNoWord;
+    for (size_t slot = std::hash<std::string_view>{}(word) & (kIndexSlots - 1);; slot = (slot + 1) & (kIndexSlots - 1)) {
+        const WordId id = index_[slot].load(std::memory_order_acquire);
+        if (id == kNoWord || Name(id) == word) return id;
+    }
+}
+
+const WordTable::Entry* WordTable::Get(WordId id) const {
+    if (id >= count_.load(std::memory_order_acquire)) return nullptr;
+    return &chunks_[id >> kChunkBits][id & (kChunkSize - 1)];
+}
+
+std::string_view WordTable::Name(WordId id) const {
+    const Entry* e = Get(id);
+    return e ? std::string_view(e->name) : std::string_view();
+}
+
+std::wstring_view WordTable::WideName(WordId id) const {
+    const Entry* e = Get(id);
+    return e ? std::wstring_view(e->wide) : std::wstring_view();
+}
+
+WordTable& Words() {
+    static WordTable table;
+    return table;
+}
+
+}
@@ -1,5 +1,6 @@
 // src/logging.cpp
 #include "Straf/logging.h"
+#include "Straf/HotLog.h"
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/async.h>                 // async logger
@@ -7,7 +8,39 @@
 
 namespace logsys {
 
+namespace {
+
+bool g_verbose = false;
+
+spdlog::level::level_enum ToSpdlog(Straf::hotlog::Level level) {
+  switch (level) {
+    case Straf::hotlog::Level::Trace: return spdlog::level::trace;
+    case Straf::hotlog::Level::Debug: return spdlog::level::debug;
+    case Straf::hotlog::Level::Info: return spdlog::level::info;
+    case Straf::hotlog::Level::Warn: return spdlog::level::warn;
+    case Straf::hotlog::Level::Error: return spdlog::level::err;
+    case Straf::hotlog::Level::Off: break;
+  }
+  return spdlog::level::off;
+}
+
+// Hot-path records are already queued and formatted off the caller's thread,
+// so they go straight to the sinks, keeping the caller's time and thread id.
+void WriteHotRecord(const Straf::hotlog::Message& m) {
+  auto* logger = spdlog::default_logger_raw();
+  spdlog::details::log_msg msg(spdlog::source_loc{m.file, m.line, ""}, logger->name(), ToSpdlog(m.level),
+                               spdlog::string_view_t(m.text.data(), m.text.size()));
+  msg.time = m.time;
+  msg.thread_id = static_cast<size_t>(m.threadId);
+  for (auto& sink : logger->sinks()) {
+    if (sink->should_log(msg.level)) sink->log(msg);
+  }
+}
+
+} // namespace
+
 void init(bool verbose) {
+  g_verbose = verbose;
   // Pattern. Time, level, thread, source file and line
   spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [tid %t] [%s:%#] %v");
 
@@ -18,20 +51,40 @@ void init(bool verbose) {
 
   std::vector<spdlog::sink_ptr> sinks {console, rotating};
 
-  // Async logger for throughput
+  // Async logger for throughput; a full queue overwrites its oldest message
+  // instead of stalling the audio and recognizer threads
   spdlog::init_thread_pool(8192, 1); // q size, threads
   auto logger = std::make_shared<spdlog::async_logger>(
       "app", sinks.begin(), sinks.end(),
       spdlog::thread_pool(),
-      spdlog::async_overflow_policy::block);
+      spdlog::async_overflow_policy::overrun_oldest);
 
   spdlog::set_default_logger(logger);
-  // spdlog::set_level(verbose ? spdlog::level::debug : spdlog::level::info);
-  spdlog::set_level(spdlog::level::trace);
+  set_level(verbose ? "debug" : "info");
   spdlog::flush_every(std::chrono::seconds(1));
   spdlog::enable_backtrace(32);               // record last 32 messages
+
+  Straf::hotlog::Start(WriteHotRecord);
 }
 
 std::shared_ptr<spdlog::logger> get() { return spdlog::default_logger(); }
 
+bool set_level(std::string_view name) {
+  Straf::hotlog::Level level;
+  if (!Straf::hotlog::ParseLevel(name, level)) return false;
+  if (g_verbose && level > Straf::hotlog::Level::Debug) level = Straf::hotlog::Level::Debug;
+  Straf::hotlog::SetLevel(level);
+  spdlog::set_level(ToSpdlog(level));
+  return true;
+}
+
+void shutdown() {
+  Straf::hotlog::Stop();
+  const auto hot = Straf::hotlog::GetStats();
+  const auto overrun = spdlog::thread_pool() ? spdlog::thread_pool()->overrun_counter() : 0;
+  SPDLOG_INFO("Logging: {} hot-path records from {} threads, {} dropped; {} async messages overwritten",
+              hot.written, hot.threads, hot.dropped, overrun);
+  spdlog::shutdown();
+}
+
 } // namespace logsys
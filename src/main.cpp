@@ -1,10 +1,19 @@
 #include "Straf/Config.h"
+#include "Straf/ConfigWatcher.h"
 #include "Straf/Detector.h"
 #include "Straf/Audio.h"
 #include "Straf/Overlay.h"
 #include "Straf/PenaltyManager.h"
 #include "Straf/Tray.h"
 #include "Straf/STT.h"
+#include "Straf/Blocklist.h"
+#include "Straf/PenaltyJournal.h"
+#include "Straf/WordStats.h"
+#include "Straf/Trace.h"
+#include "Straf/Metrics.h"
+#include "Straf/EventFeed.h"
+#include "Straf/AudioRing.h"
+#include "Straf/Platform.h"
 #include <windows.h>
 #include <shlobj.h>
 #include <filesystem>
@@ -20,22 +29,39 @@ namespace fs = std::filesystem;
 namespace Straf {
 // Global shutdown flag for inter-thread communication
 static std::atomic<bool> g_shouldExit{false};
+// Signalled together with g_shouldExit so the main thread wakes without polling
+static HANDLE g_exitEvent = nullptr;
+
+static void RequestExit() {
+    g_shouldExit = true;
+    if (g_exitEvent) SetEvent(g_exitEvent);
+}
 // Forward declarations for factory functions
 std::unique_ptr<IAudioSource> CreateAudioSilent();
 std::unique_ptr<IOverlayRenderer> CreateOverlayStub();
-std::unique_ptr<IPenaltyManager> CreatePenaltyManager(IOverlayRenderer* overlay);
 std::optional<AppConfig> LoadConfig(const std::string& path);
 
 struct AppComponents {
     std::unique_ptr<ITray> tray;
+    std::unique_ptr<feed::FeedWriter> feed; // config `feed.name`; outlives the overlay that publishes to it
     std::unique_ptr<IOverlayRenderer> overlay;
+    std::unique_ptr<WordStats> stats; // outlives penalties
     std::unique_ptr<IPenaltyManager> penalties;
     std::unique_ptr<IAudioSource> audio;
     std::unique_ptr<ITranscriber> stt;
     std::unique_ptr<ITextDetector> detector;
-    AppConfig config;
+    AppConfig config;           // config watcher thread only once running
+    fs::path configPath;
+    std::unique_ptr<ConfigWatcher> configWatcher; // stopped before the components it reconfigures
+    fs::path tracePath;         // STRAF_TRACE; empty when tracing is off
+    std::unique_ptr<metrics::MetricsServer> metricsServer; // config `metrics.port`; read at startup only
+    std::unique_ptr<feed::FeedServer> feedServer;
+    size_t penaltyCollector{0};
 };
 
+// Value of an environment variable as a path; empty when unset
+fs::path GetEnvironmentPath(const wchar_t* name);
+
 // Get configuration file path with environment variable overrides
 fs::path GetConfigurationPath();
 
@@ -48,6 +74,9 @@ std::unique_ptr<IAudioSource> CreateConfiguredAudioSource();
 // Create and configure STT transcriber based on environment  
 std::unique_ptr<ITranscriber> CreateConfiguredTranscriber(const std::vector<std::string>& vocabulary);
 
+// Re-reads the configuration and applies it to the running components
+bool ApplyConfigChange(AppComponents& components);
+
 // Main application loop
 void RunMainLoop(AppComponents& components);
 }
@@ -90,11 +119,20 @@ int WINAPI wWinMain(HINSTANCE, HINSTANCE, PWSTR, int){
     }
     
     RunMainLoop(*components);
+    logsys::shutdown();
     return 0;
 }
 
 namespace Straf {
 
+fs::path GetEnvironmentPath(const wchar_t* name) {
+    DWORD need = GetEnvironmentVariableW(name, nullptr, 0);
+    if (need == 0) return {};
+    std::wstring w; w.resize(need - 1);
+    if (GetEnvironmentVariableW(name, w.data(), need) != need - 1) return {};
+    return fs::path(w);
+}
+
 fs::path GetConfigurationPath() {
     // STRAF_CONFIG_PATH (absolute path override)
     DWORD configPathEnv = GetEnvironmentVariableW(L"STRAF_CONFIG_PATH", nullptr, 0);
@@ -183,27 +221,76 @@ std::unique_ptr<ITranscriber> CreateConfiguredTranscriber(const std::vector<std:
         stt = CreateTranscriberStub();
         stt->Initialize(sttVocab, logger);
     }
+
+    // STRAF_AUDIO_FILE: recognize a WAV recording instead of the microphone
+    fs::path audioFile = GetEnvironmentPath(L"STRAF_AUDIO_FILE");
+    if (!audioFile.empty()) {
+        SPDLOG_INFO("Recognizing audio from {}", audioFile.string());
+        stt->SetAudioSource(CreateAudioFile(audioFile.string()));
+    } else if (const auto ring = SystemEnvironment().Get("STRAF_AUDIO_RING"); ring && !ring->empty()) {
+        // STRAF_AUDIO_RING: recognize what straf_capture writes into this
+        // shared-memory ring, so restarting the agent never stops capture
+        SPDLOG_INFO("Recognizing audio from ring '{}'", *ring);
+        stt->SetAudioSource(CreateAudioRing(*ring));
+    }
     
     return stt;
 }
 
+static PhraseStreamOptions PhraseOptionsFrom(const DetectorConfig& detector) {
+    PhraseStreamOptions options;
+    options.window = std::chrono::milliseconds(detector.phraseWindowMs);
+    options.silenceReset = std::chrono::milliseconds(detector.silenceResetMs);
+    return options;
+}
+
 std::unique_ptr<AppComponents> InitializeComponents() {
     auto components = std::make_unique<AppComponents>();
     
+    g_exitEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (!g_exitEvent) return nullptr;
+    
+    // STRAF_TRACE: record pipeline spans; "Save trace" in the tray menu and
+    // exit write them to this file
+    components->tracePath = GetEnvironmentPath(L"STRAF_TRACE");
+    if (!components->tracePath.empty()) trace::Enable();
+
     // Initialize tray first
     components->tray = CreateTray();
-    components->tray->Run([]{ g_shouldExit = true; });
+    if (!components->tracePath.empty()) {
+        components->tray->AddMenuItem(L"Save trace", [path = components->tracePath]{
+            if (trace::WriteChromeJson(path)) SPDLOG_INFO("Trace written to {}", path.string());
+            else SPDLOG_WARN("Failed to write trace to {}", path.string());
+        });
+    }
+    components->tray->Run([]{ RequestExit(); });
     
     // Load configuration
     fs::path cfgPath = GetConfigurationPath();
     auto cfg = LoadConfig(cfgPath.string());
     if (!cfg) return nullptr;
     components->config = std::move(*cfg);
+    components->configPath = cfgPath;
+    if (!logsys::set_level(components->config.logging.level)) {
+        SPDLOG_WARN("Unknown logging level '{}'", components->config.logging.level);
+    }
     
     // Logging removed
     // Initialize overlay (no logger needed)
     components->overlay = CreateOverlayStub();
     if (!components->overlay->Initialize()) { return nullptr; }
+    // Shared-memory feed of detections and overlay changes for other processes
+    if (const auto& name = components->config.feed.name; !name.empty()) {
+        components->feed = feed::FeedWriter::Create(name);
+        if (components->feed) {
+            components->feedServer = feed::StartFeedServer(*components->feed);
+            components->overlay = feed::PublishingOverlay(std::move(components->overlay), *components->feed);
+            SPDLOG_INFO("Event feed '{}' on {}", name, feed::ControlAddress(name));
+            if (!components->feedServer) SPDLOG_WARN("Failed to open the event feed control channel {}", feed::ControlAddress(name));
+        } else {
+            SPDLOG_WARN("Failed to create event feed '{}'; is another agent running?", name);
+        }
+    }
     
     // Initialize penalty manager
     components->penalties = CreatePenaltyManager(components->overlay.get());
@@ -212,26 +299,113 @@ std::unique_ptr<AppComponents> InitializeComponents() {
         std::chrono::seconds(components->config.penalty.durationSeconds),
         std::chrono::seconds(components->config.penalty.cooldownSeconds)
     );
+    // Resume penalty state from the journal next to the config so restarting
+    // the agent does not clear queued penalties or cooldowns
+    auto journal = PenaltyJournal::Open(cfgPath.parent_path().string());
+    if (journal) {
+        auto stats = journal->GetStats();
+        SPDLOG_INFO("Penalty journal: replayed {} records in {} us", stats.replayedRecords, stats.replayTime.count());
+        components->penalties->AttachJournal(std::move(journal));
+    } else {
+        SPDLOG_WARN("Failed to open penalty journal in {}", cfgPath.parent_path().string());
+    }
+    components->stats = WordStats::Open(cfgPath.parent_path().string());
+    if (components->stats) {
+        components->penalties->AttachStats(components->stats.get());
+    } else {
+        SPDLOG_WARN("Failed to open word statistics in {}", cfgPath.parent_path().string());
+    }
     
     // Initialize detector for vocabulary filtering
-    components->detector = CreateTextAnalysisDetector();
+    components->detector = CreateTextAnalysisDetector(PhraseOptionsFrom(components->config.detector));
     if (!components->detector->Initialize(components->config.words)) { return nullptr; }
+    if (!components->config.blocklist.empty()) {
+        auto blocklist = OpenBlocklist(components->config.blocklist);
+        if (blocklist) {
+            SPDLOG_INFO("Mapped blocklist {} ({} entries)", components->config.blocklist, blocklist->Size());
+            components->detector->AttachBlocklist(std::move(blocklist));
+        } else {
+            SPDLOG_WARN("Failed to map blocklist {}", components->config.blocklist);
+        }
+    }
     
     // Initialize audio and STT (no vocabulary filtering in STT - detector will handle it)
     components->audio = CreateConfiguredAudioSource();
     components->stt = CreateConfiguredTranscriber({}); // Empty vocabulary - let STT recognize everything
+
+    // Local Prometheus endpoint; the collectors read counters the components already keep
+    components->penaltyCollector = AddPenaltyMetrics(*components->penalties);
+    metrics::AddProcessCollector();
+    if (const int port = components->config.metrics.port; port > 0 && port <= 65535) {
+        components->metricsServer = metrics::StartMetricsServer(static_cast<uint16_t>(port));
+        if (components->metricsServer) SPDLOG_INFO("Metrics at http://127.0.0.1:{}/metrics", port);
+        else SPDLOG_WARN("Failed to serve metrics on 127.0.0.1:{}", port);
+    }
     
     return components;
 }
 
+// Runs on the config watcher thread, so compiling the new vocabulary never
+// stalls recognition: the detector swaps it in atomically and the penalty
+// manager adopts the new settings on its next transition. Audio settings and
+// the recognizer model are left as they are; they only change on restart.
+bool ApplyConfigChange(AppComponents& components) {
+    const auto start = std::chrono::steady_clock::now();
+    auto cfg = LoadConfig(components.configPath.string());
+    if (!cfg) {
+        SPDLOG_WARN("Config reload: {} is unreadable or invalid, keeping the previous configuration", components.configPath.string());
+        return false;
+    }
+    const AppConfig& previous = components.config;
+    components.detector->Reload(cfg->words, PhraseOptionsFrom(cfg->detector));
+    if (cfg->blocklist != previous.blocklist) {
+        auto blocklist = cfg->blocklist.empty() ? nullptr : OpenBlocklist(cfg->blocklist);
+        if (!cfg->blocklist.empty() && !blocklist) SPDLOG_WARN("Failed to map blocklist {}", cfg->blocklist);
+        components.detector->AttachBlocklist(std::move(blocklist));
+    }
+    components.penalties->Configure(
+        cfg->penalty.queueLimit,
+        std::chrono::seconds(cfg->penalty.durationSeconds),
+        std::chrono::seconds(cfg->penalty.cooldownSeconds)
+    );
+    if (cfg->logging.level != previous.logging.level && !logsys::set_level(cfg->logging.level)) {
+        SPDLOG_WARN("Unknown logging level '{}'", cfg->logging.level);
+    }
+    if (cfg->audio.sampleRate != previous.audio.sampleRate || cfg->audio.channels != previous.audio.channels) {
+        SPDLOG_INFO("Config reload: audio settings take effect after a restart");
+    }
+    components.config = std::move(*cfg);
+    SPDLOG_INFO("Config reloaded in {} us ({} vocabulary entries)",
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(),
+        components.config.words.size());
+    return true;
+}
+
 void RunMainLoop(AppComponents& components) {
-    // Set up detection callback - detector will call this for vocabulary matches
-    DetectionCallback onDetect = [&components](const DetectionResult& r){ components.penalties->Trigger(r.word); };
+    // Set up detection callback - detector will call this for vocabulary matches on
+    // recognizer threads; the penalty manager applies them on its own thread.
+    DetectionCallback onDetect = [&components](const DetectionResult& r){
+        DetectionEvent event;
+        event.word = r.word;
+        event.source = r.source;
+        event.confidence = r.confidence;
+        event.detectedAt = std::chrono::steady_clock::now();
+        event.flow = trace::CurrentFlow();
+        if (components.feed) components.feed->PublishDetection(r.word, r.confidence, r.source);
+        if (!components.penalties->Submit(std::move(event))) {
+            SPDLOG_WARN("Detection queue full, dropped '{}'", Words().Name(r.word));
+        }
+    };
+    components.penalties->Start();
     
     // Start detector with detection callback
     components.detector->Start(onDetect);
     
-    // Start STT with detector pipeline - STT passes recognized text to detector for analysis
+    // Start STT with detector pipeline - STT passes recognized text to detector for analysis.
+    // Partials let phrases be matched before the recognizer finalizes the utterance.
+    components.stt->SetPartialCallback([&components](const std::string& partialText, float conf){
+        if (!partialText.empty()) { components.detector->AnalyzePartial(partialText, conf); }
+    });
     components.stt->Start([&components](const std::string& recognizedText, float conf){
         if (!recognizedText.empty()) { components.detector->AnalyzeText(recognizedText, conf); }
     });
@@ -240,39 +414,104 @@ void RunMainLoop(AppComponents& components) {
     components.audio->Start([](const AudioBuffer&){ /* intentionally no-op */ });
     
     // Initialize overlay status
-    components.overlay->UpdateStatus(components.penalties->GetStarCount(), "");
+    components.overlay->UpdateStatus(components.penalties->GetStarCount(), kNoWord);
+
+    // Pick up edits to config.json without restarting (and reloading the model)
+    components.configWatcher = ConfigWatcher::Start(components.configPath, [&components]{ return ApplyConfigChange(components); });
+    if (!components.configWatcher) SPDLOG_WARN("Cannot watch {}; config changes need a restart", components.configPath.string());
     
     // // Test mode: Add initial penalties to demonstrate vignette effect progression
     // LogInfo("Starting vignette test: Adding progressive penalties to demonstrate effect");
     // for (int i = 0; i < 10; i++) {
     //     LogInfo("Adding penalty %d/3 for vignette demonstration", i + 1);
-    //     components.penalties->Trigger("test_word");
+    //     components.penalties->Trigger(Words().Intern("test_word"));
     //     std::this_thread::sleep_for(std::chrono::milliseconds(500));
     // }
     
-    // Main message loop
+    // Main message loop. Penalty deadlines are scheduled on the penalty manager's
+    // thread, so this thread only wakes for window messages or the exit event.
     MSG msg{};
-    auto lastTick = std::chrono::steady_clock::now();
-    while (!g_shouldExit){
+    uint64_t wakeups = 0;
+    const auto loopStart = std::chrono::steady_clock::now();
+    bool quit = false;
+    while (!quit && !g_shouldExit){
+        DWORD r = MsgWaitForMultipleObjectsEx(1, &g_exitEvent, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        ++wakeups;
+        if (r == WAIT_OBJECT_0) break;
+        if (r == WAIT_FAILED) {
+            SPDLOG_ERROR("MsgWaitForMultipleObjectsEx failed: {}", GetLastError());
+            break;
+        }
         while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)){
-            if (msg.message == WM_QUIT) break;
+            if (msg.message == WM_QUIT) { quit = true; break; }
             TranslateMessage(&msg);
             DispatchMessage(&msg);
         }
-        if (msg.message == WM_QUIT) break;
-        
-        auto now = std::chrono::steady_clock::now();
-        if (now - lastTick > std::chrono::milliseconds(50)){
-            components.penalties->Tick();
-            lastTick = now;
-        }
-        Sleep(5);
     }
+    const auto uptime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - loopStart);
     
     // Cleanup
+    if (components.configWatcher) {
+        auto reloads = components.configWatcher->Stats();
+        components.configWatcher.reset();
+        SPDLOG_INFO("Config reloads: {} applied, {} rejected; latency mean {} us, max {} us",
+            reloads.reloads, reloads.failures,
+            std::chrono::duration_cast<std::chrono::microseconds>(reloads.meanLatency).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(reloads.maxLatency).count());
+    }
     if (components.stt) components.stt->Stop();
     if (components.audio) components.audio->Stop();
     if (components.detector) components.detector->Stop();
+    if (components.penalties) {
+        components.penalties->Stop();
+        auto stats = components.penalties->GetQueueStats();
+        SPDLOG_INFO("Detections: {} submitted, {} dropped, {} applied; queue latency mean {} us, max {} us",
+            stats.submitted, stats.dropped, stats.applied,
+            std::chrono::duration_cast<std::chrono::microseconds>(stats.meanQueueLatency).count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(stats.maxQueueLatency).count());
+        SPDLOG_INFO("Wakeups over {} s: main loop {}, penalty thread {} ({} on deadlines)",
+            uptime.count(), wakeups, stats.wakeups, stats.timerWakeups);
+    }
+    if (components.overlay) {
+        auto frames = components.overlay->GetFrameStats();
+        SPDLOG_INFO("Overlay: {} frames for {} scene updates, {} render wakeups", frames.frames, frames.updates, frames.wakeups);
+        if (frames.frames > 0) {
+            SPDLOG_INFO("Overlay draw CPU: mean {} us, max {} us per frame",
+                std::chrono::duration_cast<std::chrono::microseconds>(frames.drawTime).count() / static_cast<int64_t>(frames.frames),
+                std::chrono::duration_cast<std::chrono::microseconds>(frames.maxDrawTime).count());
+        }
+    }
+    if (components.stats) {
+        components.stats->Flush();
+        const auto now = std::chrono::system_clock::now();
+        const auto day = components.stats->Query(now - std::chrono::hours(24), now);
+        SPDLOG_INFO("Last 24 h: {} triggered, {} debounced, {} in phrase cooldown, {} dropped on full queue",
+            day.totals[0], day.totals[1], day.totals[2], day.totals[3]);
+        for (const auto& row : day.top) {
+            SPDLOG_INFO("  {}: {} triggered ({:.2f}/h)", row.word, row.counts[0], day.PerHour(row.counts[0]));
+        }
+    }
+    if (!components.tracePath.empty()) {
+        const auto spans = trace::GetStats();
+        if (trace::WriteChromeJson(components.tracePath)) {
+            SPDLOG_INFO("Trace: {} spans on {} threads ({} overwritten), written to {}",
+                spans.recorded, spans.threads, spans.overwritten, components.tracePath.string());
+        } else {
+            SPDLOG_WARN("Failed to write trace to {}", components.tracePath.string());
+        }
+    }
+    if (components.metricsServer) {
+        SPDLOG_INFO("Metrics: served {} scrapes", components.metricsServer->Scrapes());
+        components.metricsServer.reset();
+    }
+    if (components.feed) {
+        const auto published = components.feed->GetStats();
+        SPDLOG_INFO("Event feed: {} records published, {} reader wakeups, {} control requests", published.published,
+            published.wakeups, components.feedServer ? components.feedServer->Requests() : 0);
+        components.feedServer.reset();
+    }
+    if (components.penaltyCollector) metrics::Metrics().RemoveCollector(components.penaltyCollector);
+    if (g_exitEvent) { CloseHandle(g_exitEvent); g_exitEvent = nullptr; }
 }
 
 }
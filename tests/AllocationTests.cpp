@@ -0,0 +1,128 @@
+#include "Straf/Clock.h"
+#include "Straf/Detector.h"
+#include "Straf/Overlay.h"
+#include "Straf/PenaltyManager.h"
+#include "Straf/WordStats.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+// Counts heap allocations made by the calling thread while a test arms the
+// counter. Other threads (the overlay's render thread, gtest) are not counted.
+namespace {
+thread_local bool tCounting = false;
+thread_local size_t tAllocations = 0;
+
+void* CountedAlloc(std::size_t size) {
+    if (tCounting) ++tAllocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+}
+
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+class AllocationCounter {
+public:
+    AllocationCounter() { tAllocations = 0; tCounting = true; }
+    ~AllocationCounter() { tCounting = false; }
+    size_t Count() const { return tAllocations; }
+};
+
+// The production path: recognizer text -> detector -> Submit() -> the
+// manager's drain and tick -> overlay scene. Pump() runs the manager thread's
+// loop body on this thread, driven by a virtual clock.
+class SteadyStateAllocationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        overlay = CreateOverlayHeadless();
+        ASSERT_TRUE(overlay->Initialize());
+        manager = CreatePenaltyManager(overlay.get(), &clock);
+        manager->Configure(5, 2s, 1s);
+        PenaltyPolicy policy;
+        policy.debounce = 100ms;
+        policy.phraseCooldown = 500ms;
+        policy.progressiveDurations = {1s};
+        manager->SetPolicy(policy);
+
+        detector = CreateTextAnalysisDetector();
+        ASSERT_TRUE(detector->Initialize({"alloc darn", "alloc heck", "you muppet"}));
+        // As RunMainLoop() hands detections over
+        detector->Start([this](const DetectionResult& r) {
+            ++detections;
+            DetectionEvent event;
+            event.word = r.word;
+            event.source = r.source;
+            event.confidence = r.confidence;
+            event.detectedAt = std::chrono::steady_clock::now();
+            if (!manager->Submit(std::move(event))) ++rejected;
+        });
+    }
+
+    // One utterance with a penalty, run to the end of the penalty and its cooldown.
+    void Cycle(const std::string& utterance) {
+        detector->AnalyzePartial("well");
+        detector->AnalyzePartial("well you");
+        detector->AnalyzePartial("well you muppet");
+        detector->AnalyzeText(utterance);
+        manager->Pump();
+        for (int i = 0; i < 40; ++i) {
+            clock.Advance(100ms);
+            manager->Pump();
+        }
+    }
+
+    VirtualClock clock;
+    std::unique_ptr<IOverlayRenderer> overlay;
+    std::unique_ptr<IPenaltyManager> manager;
+    std::unique_ptr<ITextDetector> detector;
+    size_t detections{0};
+    size_t rejected{0}; // Submit() found the queue full
+};
+
+} // namespace
+
+TEST_F(SteadyStateAllocationTest, DetectionToOverlayAllocatesNothingOnceWarm) {
+    const std::string utterance = "well you muppet alloc darn";
+    // Warm-up: first sightings intern words and grow buffers to their working size
+    for (int i = 0; i < 3; ++i) Cycle(utterance);
+    const size_t perCycle = detections / 3;
+    ASSERT_GT(perCycle, 0u);
+    const auto before = manager->GetQueueStats();
+
+    AllocationCounter counter;
+    for (int i = 0; i < 20; ++i) Cycle(utterance);
+    const size_t allocations = counter.Count();
+
+    const auto after = manager->GetQueueStats();
+    EXPECT_EQ(detections, perCycle * 23);
+    EXPECT_EQ(rejected, 0u);
+    EXPECT_EQ(after.submitted - before.submitted, perCycle * 20);
+    EXPECT_EQ(after.applied - before.applied, perCycle * 20);
+    EXPECT_EQ(after.outcomes[static_cast<size_t>(WordOutcome::Triggered)],
+              before.outcomes[static_cast<size_t>(WordOutcome::Triggered)] + 20);
+    EXPECT_EQ(allocations, 0u);
+}
+
+TEST(AllocationCounterTest, CountsThisThread) {
+    AllocationCounter counter;
+    static int* volatile sink;
+    sink = new int(1); // escapes, so the allocation cannot be elided
+    delete sink;
+    EXPECT_EQ(counter.Count(), 1u);
+}
@@ -0,0 +1,59 @@
+#include "Straf/AudioDsp.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+using namespace Straf;
+
+TEST(DownmixAndResample, EmptyInputClearsOutput) {
+    std::vector<float> out{1.0f, 2.0f};
+    DownmixAndResample(nullptr, 0, 2, 48000, out, 16000);
+    EXPECT_TRUE(out.empty());
+}
+
+TEST(DownmixAndResample, MonoAtTargetRateIsCopied) {
+    const std::vector<float> in{0.1f, -0.2f, 0.3f};
+    std::vector<float> out;
+    DownmixAndResample(in.data(), in.size(), 1, 16000, out, 16000);
+    EXPECT_EQ(out, in);
+}
+
+TEST(DownmixAndResample, StereoIsAveraged) {
+    const std::vector<float> in{1.0f, 0.0f, 0.5f, -0.5f, -1.0f, -0.5f};
+    std::vector<float> out;
+    DownmixAndResample(in.data(), 3, 2, 16000, out, 16000);
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_FLOAT_EQ(out[0], 0.5f);
+    EXPECT_FLOAT_EQ(out[1], 0.0f);
+    EXPECT_FLOAT_EQ(out[2], -0.75f);
+}
+
+TEST(DownmixAndResample, DownsamplesByRateRatio) {
+    // 10 ms at 48 kHz, six channels of a ramp
+    std::vector<float> in(480 * 6);
+    for (size_t i = 0; i < 480; ++i) {
+        for (size_t ch = 0; ch < 6; ++ch) in[i * 6 + ch] = static_cast<float>(i);
+    }
+    std::vector<float> out;
+    DownmixAndResample(in.data(), 480, 6, 48000, out, 16000);
+    ASSERT_EQ(out.size(), 160u);
+    for (size_t i = 0; i < out.size(); ++i) EXPECT_FLOAT_EQ(out[i], static_cast<float>(i * 3)) << i;
+}
+
+TEST(DownmixAndResample, UpsamplingInterpolatesLinearly) {
+    const std::vector<float> in{0.0f, 1.0f, 0.0f};
+    std::vector<float> out;
+    DownmixAndResample(in.data(), in.size(), 1, 8000, out, 16000);
+    ASSERT_EQ(out.size(), 6u);
+    const std::vector<float> expected{0.0f, 0.5f, 1.0f, 0.5f, 0.0f, 0.0f};
+    for (size_t i = 0; i < out.size(); ++i) EXPECT_FLOAT_EQ(out[i], expected[i]) << i;
+}
+
+TEST(FloatToPcm16, ScalesAndClips) {
+    const std::vector<float> in{0.0f, 1.0f, -1.0f, 0.5f, 2.0f, -3.0f};
+    std::vector<int16_t> out(in.size());
+    FloatToPcm16(in.data(), in.size(), out.data());
+    EXPECT_EQ(out, (std::vector<int16_t>{0, 32767, -32767, 16384, 32767, -32767}));
+}
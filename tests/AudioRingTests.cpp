@@ -0,0 +1,324 @@
+// Two-process tests for the shared-memory audio ring (AudioRing.h). Linux
+#include "Straf/Executor.h"
+// only: consumers are forked processes.
+//
+// The producer writes 320-sample packets (20 ms at 16 kHz) whose samples are
+// their own stream position, so a consumer can check every sample it reads in
+// place. A consumer reports what it saw through a pipe.
+#include "Straf/AudioRing.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kPacket = 320;
+
+struct ConsumerResult {
+    uint64_t start{0};    // position at attach
+    uint64_t read{0};     // samples
+    uint64_t packets{0};
+    uint64_t overruns{0};
+    uint64_t wrong{0};    // samples that were not their position
+    uint64_t gaps{0};     // packets not contiguous with the one before, past overruns
+    uint64_t restarts{0}; // streams that started over at position 0
+    double p99Us{0};      // capture to read
+};
+
+struct Child {
+    pid_t pid{-1};
+    int fd{-1}; // reads the child's ConsumerResult
+};
+
+float SampleAt(uint64_t position) { return static_cast<float>(position & 0xFFFFFF); }
+
+uint64_t CheckPiece(const float* samples, size_t count, uint64_t position) {
+    uint64_t wrong = 0;
+    for (size_t i = 0; i < count; ++i) wrong += samples[i] != SampleAt(position + i);
+    return wrong;
+}
+
+void Report(int fd, const ConsumerResult& result) {
+    if (write(fd, &result, sizeof result) != static_cast<ssize_t>(sizeof result)) _exit(1);
+}
+
+// Forks a consumer that attaches, says so through the pipe, then reads in
+// place until it has accounted for `samples` (or sleeps `stall` first). With
+// `killAfter` it kills itself after that many packets, leaving its consumer
+// slot behind.
+Child ForkConsumer(const std::string& name, uint64_t samples, std::chrono::milliseconds stall = {}, uint64_t killAfter = 0) {
+    int fds[2];
+    if (pipe(fds) != 0) return {};
+    const pid_t pid = fork();
+    if (pid != 0) {
+        close(fds[1]);
+        char ready = 0;
+        if (read(fds[0], &ready, 1) != 1 || ready != 1) {
+            close(fds[0]);
+            waitpid(pid, nullptr, 0);
+            return {};
+        }
+        return {pid, fds[0]};
+    }
+    close(fds[0]);
+    auto reader = AudioRingReader::Open(name);
+    const char ok = reader ? 1 : 0;
+    if (write(fds[1], &ok, 1) != 1 || !reader) _exit(1);
+    if (stall.count() > 0) std::this_thread::sleep_for(stall);
+    ConsumerResult result;
+    result.start = reader->Position();
+    std::vector<double> latencies;
+    latencies.reserve(1 << 16);
+    uint64_t expected = result.start;
+    AudioRingPacket packet;
+    while (result.read + reader->Overruns() < samples && !reader->Closed()) {
+        if (!reader->Next(packet)) {
+            reader->Wait(1000ms);
+            continue;
+        }
+        const auto now = clock_type::now();
+        uint64_t wrong = CheckPiece(packet.first, packet.firstCount, packet.position) +
+                         CheckPiece(packet.second, packet.secondCount, packet.position + packet.firstCount);
+        if (!reader->Intact(packet)) continue; // lapped while checking; Next() counts it from here
+        result.wrong += wrong;
+        result.gaps += packet.position != expected && packet.position - expected != reader->Overruns() - result.overruns;
+        result.overruns = reader->Overruns();
+        expected = packet.position + packet.Count();
+        result.read += packet.Count();
+        ++result.packets;
+        if (latencies.size() < latencies.capacity()) latencies.push_back(std::chrono::duration<double, std::micro>(now - packet.captured).count());
+        if (killAfter != 0 && result.packets == killAfter) raise(SIGKILL);
+    }
+    result.overruns = reader->Overruns();
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result.p99Us = latencies[latencies.size() * 99 / 100];
+    }
+    Report(fds[1], result);
+    _exit(0);
+}
+
+ConsumerResult Collect(Child& child) {
+    ConsumerResult result;
+    if (read(child.fd, &result, sizeof result) != static_cast<ssize_t>(sizeof result)) result = {};
+    close(child.fd);
+    waitpid(child.pid, nullptr, 0);
+    return result;
+}
+
+// Writes `packets` packets continuing the ramp from `position`, `gap` apart
+// (back to back when zero). Mean ns per packet.
+double Produce(AudioRingWriter& writer, uint64_t& position, uint64_t packets, std::chrono::microseconds gap = {}) {
+    std::vector<float> packet(kPacket);
+    const auto start = clock_type::now();
+    auto next = start;
+    for (uint64_t i = 0; i < packets; ++i) {
+        if (gap.count() > 0) {
+            next += gap;
+            std::this_thread::sleep_until(next);
+        }
+        for (size_t s = 0; s < kPacket; ++s) packet[s] = SampleAt(position + s);
+        writer.Write(packet.data(), packet.size(), clock_type::now());
+        position += kPacket;
+    }
+    return std::chrono::duration<double, std::nano>(clock_type::now() - start).count() / static_cast<double>(packets);
+}
+
+class AudioRingTest : public ::testing::Test {
+protected:
+    std::string name = "straf-test-" + std::to_string(getpid()) + "-" +
+                       ::testing::UnitTest::GetInstance()->current_test_info()->name();
+};
+
+} // namespace
+
+TEST_F(AudioRingTest, FloodReadInPlaceAccountsForEverySample) {
+    auto writer = AudioRingWriter::Create(name, 16000, 1);
+    ASSERT_TRUE(writer);
+    const uint64_t packets = 20000;
+    Child child = ForkConsumer(name, packets * kPacket);
+    ASSERT_GT(child.pid, 0);
+    uint64_t position = 0;
+    Produce(*writer, position, packets);
+    const ConsumerResult r = Collect(child);
+
+    EXPECT_EQ(r.read + r.overruns, position);
+    EXPECT_EQ(r.wrong, 0u);
+    EXPECT_EQ(r.gaps, 0u);
+}
+
+TEST_F(AudioRingTest, SleepingConsumerIsWokenForPacedPackets) {
+    auto writer = AudioRingWriter::Create(name, 16000, 1);
+    ASSERT_TRUE(writer);
+    Child child = ForkConsumer(name, 1000 * kPacket);
+    ASSERT_GT(child.pid, 0);
+    uint64_t position = 0;
+    Produce(*writer, position, 1000, 1000us);
+    const ConsumerResult r = Collect(child);
+    RecordProperty("p99_us", static_cast<int>(r.p99Us));
+
+    EXPECT_EQ(r.read, position); // paced: nothing is lapped
+    EXPECT_EQ(r.overruns, 0u);
+    EXPECT_EQ(r.wrong, 0u);
+    EXPECT_EQ(r.gaps, 0u);
+    EXPECT_GT(writer->GetStats().wakeups, 0u);
+    EXPECT_LE(writer->GetStats().wakeups, 1000u); // at most once per packet
+}
+
+TEST_F(AudioRingTest, KilledConsumerIsReplacedAtTheLiveEdge) {
+    auto writer = AudioRingWriter::Create(name, 16000, 1);
+    ASSERT_TRUE(writer);
+    Child first = ForkConsumer(name, 3000 * kPacket, {}, 500);
+    ASSERT_GT(first.pid, 0);
+    EXPECT_FALSE(AudioRingReader::Open(name)); // one consumer at a time
+    uint64_t position = 0;
+    Produce(*writer, position, 1000, 500us);
+    int status = 0;
+    waitpid(first.pid, &status, 0);
+    close(first.fd);
+    EXPECT_TRUE(WIFSIGNALED(status));
+
+    const uint64_t resumeAt = position;
+    Child second = ForkConsumer(name, 1000 * kPacket);
+    ASSERT_GT(second.pid, 0);
+    Produce(*writer, position, 1000, 500us);
+    const ConsumerResult r = Collect(second);
+
+    EXPECT_GE(r.start, resumeAt);
+    EXPECT_EQ(r.read + r.overruns, position - r.start);
+    EXPECT_EQ(r.wrong, 0u);
+    EXPECT_EQ(r.gaps, 0u);
+    EXPECT_EQ(writer->GetStats().attaches, 2u);
+}
+
+TEST_F(AudioRingTest, StalledConsumerCountsWhatItLost) {
+    auto writer = AudioRingWriter::Create(name, 16000, 1);
+    ASSERT_TRUE(writer);
+    const uint64_t lapPackets = writer->Capacity() / kPacket;
+    uint64_t position = 0;
+    Produce(*writer, position, lapPackets);
+    const uint64_t start = position;
+    Child child = ForkConsumer(name, 3 * lapPackets * kPacket + 100 * kPacket, 500ms);
+    ASSERT_GT(child.pid, 0);
+    Produce(*writer, position, 3 * lapPackets); // never waits for the consumer
+    std::this_thread::sleep_for(700ms);          // consumer wakes and finds itself lapped
+    Produce(*writer, position, 100, 1000us);
+    const ConsumerResult r = Collect(child);
+
+    EXPECT_EQ(r.read + r.overruns, position - start);
+    EXPECT_GT(r.overruns, 0u);
+    EXPECT_EQ(r.wrong, 0u);
+}
+
+TEST_F(AudioRingTest, SourceReattachesWhenTheProducerRestarts) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        // Consumer: the IAudioSource the recognizer would use
+        std::atomic<uint64_t> samples{0}, wrong{0}, restarts{0};
+        uint64_t expected = 0;
+        Executor executor(1); // Tasks() may have lost its workers in the fork
+        auto source = CreateAudioRing(name, executor);
+        source->Initialize(16000, 1);
+        source->Start([&](const AudioBuffer& buf) {
+            if (buf.empty()) return;
+            const auto position = static_cast<uint64_t>(buf[0]);
+            if (position != expected) restarts.fetch_add(position == 0);
+            wrong.fetch_add(CheckPiece(buf.data(), buf.size(), position));
+            expected = position + buf.size();
+            samples.fetch_add(buf.size());
+        });
+        const auto until = clock_type::now() + 20s;
+        while (samples.load() < 2 * 300 * kPacket && clock_type::now() < until) std::this_thread::sleep_for(5ms);
+        source->Stop();
+        ConsumerResult result;
+        result.read = samples.load();
+        result.wrong = wrong.load();
+        result.restarts = restarts.load();
+        Report(fds[1], result);
+        _exit(0);
+    }
+    close(fds[1]);
+    for (int run = 0; run < 2; ++run) {
+        auto writer = AudioRingWriter::Create(name, 16000, 1);
+        ASSERT_TRUE(writer);
+        const auto until = clock_type::now() + 5s;
+        while (writer->GetStats().consumerPid == 0 && clock_type::now() < until) std::this_thread::sleep_for(5ms);
+        uint64_t position = 0;
+        Produce(*writer, position, 300, 1000us);
+        std::this_thread::sleep_for(50ms);
+    }
+    Child child{pid, fds[0]};
+    const ConsumerResult r = Collect(child);
+
+    EXPECT_EQ(r.read, 2 * 300 * kPacket);
+    EXPECT_EQ(r.wrong, 0u);
+    EXPECT_EQ(r.restarts, 1u);
+}
+
+TEST_F(AudioRingTest, IdleSourceSleepsUntilAProducerStarts) {
+    Executor executor(1);
+    std::atomic<uint64_t> samples{0};
+    auto source = CreateAudioRing(name, executor);
+    ASSERT_TRUE(source->Initialize(16000, 1));
+    source->Start([&](const AudioBuffer& buf) { samples.fetch_add(buf.size()); });
+    std::this_thread::sleep_for(100ms);
+    // No producer: the task waits on the doorbell and is not resumed meanwhile
+    const uint64_t resumes = executor.GetStats().resumes;
+    std::this_thread::sleep_for(600ms);
+    EXPECT_EQ(executor.GetStats().resumes, resumes);
+
+    for (int run = 0; run < 2; ++run) {
+        // Each producer is picked up at once, well inside the bell's timeout
+        auto writer = AudioRingWriter::Create(name, 16000, 1);
+        ASSERT_TRUE(writer);
+        const auto created = clock_type::now();
+        while (writer->GetStats().consumerPid == 0 && clock_type::now() < created + 5s) std::this_thread::sleep_for(1ms);
+        EXPECT_LT(clock_type::now() - created, 1s) << "run " << run;
+        const uint64_t before = samples.load();
+        uint64_t position = 0;
+        Produce(*writer, position, 10, 1000us);
+        const auto until = clock_type::now() + 5s;
+        while (samples.load() - before < 10 * kPacket && clock_type::now() < until) std::this_thread::sleep_for(1ms);
+        EXPECT_EQ(samples.load() - before, 10 * kPacket) << "run " << run;
+    }
+    source->Stop();
+}
+
+TEST_F(AudioRingTest, ReplacedProducerLeavesItsSuccessorsRingAlone) {
+    auto first = AudioRingWriter::Create(name, 16000, 1);
+    ASSERT_TRUE(first);
+    auto second = AudioRingWriter::Create(name, 16000, 1); // same process: takes the name over
+    ASSERT_TRUE(second);
+    first.reset();
+
+    auto reader = AudioRingReader::Open(name);
+    ASSERT_TRUE(reader);
+    EXPECT_FALSE(reader->Closed());
+    uint64_t position = 0;
+    Produce(*second, position, 4);
+    AudioBuffer buffer;
+    clock_type::time_point captured;
+    ASSERT_TRUE(reader->Read(buffer, captured));
+    EXPECT_EQ(CheckPiece(buffer.data(), buffer.size(), 0), 0u);
+
+    reader.reset();
+    second.reset();
+    EXPECT_FALSE(AudioRingReader::Open(name));
+}
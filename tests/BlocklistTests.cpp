@@ -0,0 +1,118 @@
+#include "Straf/Blocklist.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace Straf;
+
+namespace {
+
+class BlocklistTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = (std::filesystem::temp_directory_path() / "straf_blocklist_test.sfst").string();
+        ASSERT_TRUE(CompileBlocklist({"Alpha", "alps", "beta", "bet", "", "beta"}, path, &stats));
+        std::ifstream f(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(f), {});
+    }
+
+    // Rewrites the file with `bytes` and opens it again.
+    std::unique_ptr<IBlocklist> Reopen() {
+        std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        return OpenBlocklist(path);
+    }
+
+    BlocklistHeader Header() const {
+        BlocklistHeader h;
+        std::memcpy(&h, bytes.data(), sizeof h);
+        return h;
+    }
+    BlocklistState* State(size_t i) {
+        return reinterpret_cast<BlocklistState*>(bytes.data() + sizeof(BlocklistHeader) + i * sizeof(BlocklistState));
+    }
+    BlocklistArc* Arc(size_t i) {
+        return reinterpret_cast<BlocklistArc*>(bytes.data() + sizeof(BlocklistHeader) +
+                                               Header().stateCount * sizeof(BlocklistState) + i * sizeof(BlocklistArc));
+    }
+
+    std::string path;
+    BlocklistStats stats;
+    std::vector<char> bytes;
+};
+
+} // namespace
+
+TEST_F(BlocklistTest, CompiledListMatchesExactWords) {
+    EXPECT_EQ(stats.words, 4u);
+    EXPECT_EQ(stats.fileBytes, bytes.size());
+    auto list = OpenBlocklist(path);
+    ASSERT_TRUE(list);
+    EXPECT_EQ(list->Size(), 4u);
+    for (const char* w : {"alpha", "alps", "beta", "bet"}) EXPECT_TRUE(list->Contains(w)) << w;
+    for (const char* w : {"", "alp", "be", "betas", "gamma", "Alpha"}) EXPECT_FALSE(list->Contains(w)) << w;
+}
+
+TEST_F(BlocklistTest, MissingOrEmptyFileIsRejected) {
+    EXPECT_FALSE(OpenBlocklist(path + ".missing"));
+    bytes.clear();
+    EXPECT_FALSE(Reopen());
+}
+
+TEST_F(BlocklistTest, TruncatedFileIsRejected) {
+    bytes.resize(bytes.size() - 1);
+    EXPECT_FALSE(Reopen());
+}
+
+TEST_F(BlocklistTest, WrongMagicOrVersionIsRejected) {
+    bytes[0] = 'X';
+    EXPECT_FALSE(Reopen());
+    SetUp();
+    bytes[4] = 9;
+    EXPECT_FALSE(Reopen());
+}
+
+TEST_F(BlocklistTest, StateArcsPastTheEndAreRejected) {
+    ASSERT_TRUE(Reopen());
+    State(Header().rootState)->firstArc = Header().arcCount - 1;
+    State(Header().rootState)->arcCount = 2;
+    EXPECT_FALSE(Reopen());
+}
+
+TEST_F(BlocklistTest, ArcTargetOutOfRangeIsRejected) {
+    Arc(0)->target = Header().stateCount;
+    EXPECT_FALSE(Reopen());
+}
+
+TEST_F(BlocklistTest, UnsortedArcsAreRejected) {
+    const BlocklistState root = *State(Header().rootState);
+    ASSERT_GE(root.arcCount, 2); // 'a' and 'b'
+    std::swap(*Arc(root.firstArc), *Arc(root.firstArc + 1));
+    EXPECT_FALSE(Reopen());
+}
+
+TEST_F(BlocklistTest, ForEachWordVisitsWordsInByteOrder) {
+    auto list = OpenBlocklist(path);
+    ASSERT_TRUE(list);
+    std::vector<std::string> words;
+    list->ForEachWord([&](std::string_view w) { words.emplace_back(w); return true; });
+    EXPECT_EQ(words, (std::vector<std::string>{"alpha", "alps", "bet", "beta"}));
+    words.clear();
+    list->ForEachWord([&](std::string_view w) { words.emplace_back(w); return words.size() < 2; });
+    EXPECT_EQ(words.size(), 2u);
+}
+
+TEST_F(BlocklistTest, WalkOfCyclicFileStops) {
+    // Valid indices, but the root's first arc loops back to the root
+    Arc(State(Header().rootState)->firstArc)->target = Header().rootState;
+    auto list = Reopen();
+    ASSERT_TRUE(list);
+    size_t visited = 0;
+    list->ForEachWord([&](std::string_view) { ++visited; return true; });
+    EXPECT_LE(visited, 5u * 256);
+}
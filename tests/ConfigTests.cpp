@@ -0,0 +1,84 @@
+#include "Straf/Config.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace Straf;
+
+namespace {
+
+// Writes `text` to a fresh file under the test temp directory.
+std::string WriteConfig(const std::string& name, const std::string& text) {
+    const auto path = std::filesystem::temp_directory_path() / ("straf_config_test_" + name + ".json");
+    std::ofstream(path, std::ios::binary) << text;
+    return path.string();
+}
+
+} // namespace
+
+TEST(Config, MissingFileIsNullopt) {
+    EXPECT_FALSE(LoadConfig((std::filesystem::temp_directory_path() / "straf_no_such_config.json").string()));
+}
+
+TEST(Config, MalformedJsonIsNullopt) {
+    EXPECT_FALSE(LoadConfig(WriteConfig("malformed", "{\"words\": [")));
+}
+
+TEST(Config, EmptyObjectKeepsDefaults) {
+    const auto cfg = LoadConfig(WriteConfig("empty", "{}"));
+    ASSERT_TRUE(cfg);
+    const AppConfig defaults;
+    EXPECT_TRUE(cfg->words.empty());
+    EXPECT_EQ(cfg->penalty.durationSeconds, defaults.penalty.durationSeconds);
+    EXPECT_EQ(cfg->penalty.cooldownSeconds, defaults.penalty.cooldownSeconds);
+    EXPECT_EQ(cfg->penalty.queueLimit, defaults.penalty.queueLimit);
+    EXPECT_EQ(cfg->audio.sampleRate, 16000);
+    EXPECT_EQ(cfg->detector.phraseWindowMs, defaults.detector.phraseWindowMs);
+    EXPECT_EQ(cfg->logging.level, "info");
+    EXPECT_EQ(cfg->metrics.port, 0);
+    EXPECT_TRUE(cfg->feed.name.empty());
+}
+
+TEST(Config, ReadsEverySection) {
+    const auto cfg = LoadConfig(WriteConfig("full", R"({
+        "words": ["alpha", "bad word", 7, "re:x+"],
+        "penalty": {"durationSeconds": 3, "cooldownSeconds": 4, "queueLimit": 9},
+        "audio": {"sampleRate": 48000, "channels": 2},
+        "detector": {"phraseWindowMs": 1500, "silenceResetMs": 700},
+        "logging": {"level": "debug"},
+        "metrics": {"port": 9464},
+        "feed": {"name": "straf-test"}
+    })"));
+    ASSERT_TRUE(cfg);
+    // Non-string entries are dropped, order is kept
+    EXPECT_EQ(cfg->words, (std::vector<std::string>{"alpha", "bad word", "re:x+"}));
+    EXPECT_EQ(cfg->penalty.durationSeconds, 3);
+    EXPECT_EQ(cfg->penalty.cooldownSeconds, 4);
+    EXPECT_EQ(cfg->penalty.queueLimit, 9);
+    EXPECT_EQ(cfg->audio.sampleRate, 48000);
+    EXPECT_EQ(cfg->audio.channels, 2);
+    EXPECT_EQ(cfg->detector.phraseWindowMs, 1500);
+    EXPECT_EQ(cfg->detector.silenceResetMs, 700);
+    EXPECT_EQ(cfg->logging.level, "debug");
+    EXPECT_EQ(cfg->metrics.port, 9464);
+    EXPECT_EQ(cfg->feed.name, "straf-test");
+}
+
+TEST(Config, RelativeBlocklistResolvesAgainstConfigDirectory) {
+    const std::string path = WriteConfig("blocklist", R"({"blocklist": "lists/words.sfst"})");
+    const auto cfg = LoadConfig(path);
+    ASSERT_TRUE(cfg);
+    EXPECT_EQ(std::filesystem::path(cfg->blocklist), std::filesystem::path(path).parent_path() / "lists/words.sfst");
+}
+
+TEST(Config, WrongTypesFallBackToDefaults) {
+    const auto cfg = LoadConfig(WriteConfig("types", R"({"words": "alpha", "penalty": 5, "audio": {"channels": 2}})"));
+    ASSERT_TRUE(cfg);
+    EXPECT_TRUE(cfg->words.empty());
+    EXPECT_EQ(cfg->penalty.queueLimit, PenaltyConfig{}.queueLimit);
+    EXPECT_EQ(cfg->audio.sampleRate, 16000);
+    EXPECT_EQ(cfg->audio.channels, 2);
+}
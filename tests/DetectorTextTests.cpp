@@ -0,0 +1,107 @@
+#include "Straf/Detector.h"
+#include "Straf/Blocklist.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace Straf;
+
+namespace {
+
+class DetectorTextTest : public ::testing::Test {
+protected:
+    void Start(const std::vector<std::string>& vocabulary) {
+        detector = CreateTextAnalysisDetector();
+        ASSERT_TRUE(detector->Initialize(vocabulary));
+        detector->Start([this](const DetectionResult& r) { detected.emplace_back(Words().Name(r.word)); });
+    }
+
+    std::unique_ptr<ITextDetector> detector;
+    std::vector<std::string> detected;
+};
+
+using Found = std::vector<std::string>;
+
+} // namespace
+
+TEST_F(DetectorTextTest, GrowingPartialsReportEachMatchOnce) {
+    Start({"bad word", "jerk"});
+    detector->AnalyzePartial("you");
+    detector->AnalyzePartial("you bad");
+    detector->AnalyzePartial("You bad word,");
+    detector->AnalyzePartial("you bad word jerk");
+    detector->AnalyzeText("you bad word jerk");
+    EXPECT_EQ(detected, (Found{"bad word", "jerk"}));
+}
+
+TEST_F(DetectorTextTest, RevisedPartialWordIsMatched) {
+    Start({"fun"});
+    detector->AnalyzePartial("this is fine");
+    detector->AnalyzePartial("this is fun");
+    EXPECT_EQ(detected, (Found{"fun"}));
+}
+
+TEST_F(DetectorTextTest, FinalThatDiffersFromPartialsIsMatched) {
+    Start({"nice"});
+    detector->AnalyzePartial("you are an ass");
+    detector->AnalyzeText("you are a nice person");
+    EXPECT_EQ(detected, (Found{"nice"}));
+}
+
+TEST_F(DetectorTextTest, FinalShorterThanPartialsEndsUtterance) {
+    Start({"go away"});
+    detector->AnalyzePartial("please go");
+    detector->AnalyzeText("please"); // "go" was never said
+    detector->AnalyzeText("away");
+    EXPECT_TRUE(detected.empty());
+}
+
+TEST_F(DetectorTextTest, RevisedWordsDropTheirPhraseState) {
+    Start({"bad word"});
+    detector->AnalyzePartial("bad");
+    detector->AnalyzePartial("good word");
+    EXPECT_TRUE(detected.empty());
+}
+
+TEST_F(DetectorTextTest, RevisionDoesNotReportUnchangedWordsAgain) {
+    Start({"jerk", "stu*"});
+    detector->AnalyzePartial("jerk stuff");
+    detector->AnalyzePartial("jerk stuf");
+    detector->AnalyzePartial("jerk stuff");
+    detector->AnalyzeText("jerk stuff");
+    EXPECT_EQ(detected, (Found{"jerk", "stuff", "stuf"}));
+}
+
+TEST_F(DetectorTextTest, NextUtteranceReportsAgain) {
+    Start({"jerk"});
+    detector->AnalyzePartial("jerk");
+    detector->AnalyzeText("jerk");
+    detector->AnalyzePartial("jerk");
+    detector->AnalyzeText("jerk");
+    EXPECT_EQ(detected, (Found{"jerk", "jerk"}));
+}
+
+TEST_F(DetectorTextTest, PhraseSpansUtterances) {
+    Start({"shut up now"});
+    detector->AnalyzeText("shut up");
+    detector->AnalyzePartial("now");
+    detector->AnalyzeText("now");
+    EXPECT_EQ(detected, (Found{"shut up now"}));
+}
+
+TEST_F(DetectorTextTest, BlocklistWordsAreInternedWhenAttached) {
+    const std::string path = (std::filesystem::temp_directory_path() / "straf_detector_blocklist.sfst").string();
+    ASSERT_TRUE(CompileBlocklist({"zzlisted", "zzother"}, path));
+    Start({"jerk"});
+    EXPECT_EQ(Words().Find("zzlisted"), kNoWord);
+    detector->AttachBlocklist(OpenBlocklist(path));
+    const WordId listed = Words().Find("zzlisted");
+    EXPECT_NE(listed, kNoWord);
+    EXPECT_NE(Words().Find("zzother"), kNoWord);
+    detector->AnalyzeText("you zzlisted jerk");
+    EXPECT_EQ(detected, (Found{"zzlisted", "jerk"}));
+    EXPECT_EQ(Words().Find("zzlisted"), listed);
+}
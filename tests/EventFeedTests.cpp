@@ -0,0 +1,316 @@
+#include "Straf/EventFeed.h"
+#include "Straf/Platform.h"
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Remembers what the feed overlay forwarded.
+class RecordingOverlay : public IOverlayRenderer {
+public:
+    bool Initialize() override { return true; }
+    void ShowPenalty(WordId) override { ++shown; }
+    void UpdateStatus(int s, WordId) override { stars = s; }
+    void Hide() override { ++hides; }
+
+    int shown{0};
+    int stars{0};
+    int hides{0};
+};
+
+class EventFeedTest : public ::testing::Test {
+protected:
+    std::unique_ptr<feed::FeedWriter> Create(size_t capacity = 64) { return feed::FeedWriter::Create(name, capacity); }
+
+    std::string name = "straf-test-" + std::to_string(platform::ProcessId()) + "-" +
+                       ::testing::UnitTest::GetInstance()->current_test_info()->name();
+};
+
+} // namespace
+
+TEST_F(EventFeedTest, ReaderGetsRecordsInOrderWithTheirFields) {
+    auto writer = Create();
+    ASSERT_TRUE(writer);
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+
+    feed::Record record;
+    EXPECT_FALSE(reader->Next(record));
+    writer->PublishDetection(Words().Intern("feed-first"), 0.75f, DetectionSource::Partial);
+    writer->PublishState(feed::Kind::Penalty, Words().Intern("feed-second"), 2);
+
+    ASSERT_TRUE(reader->Next(record));
+    EXPECT_EQ(record.seq, 0u);
+    EXPECT_EQ(record.kind, feed::Kind::Detection);
+    EXPECT_EQ(record.source, DetectionSource::Partial);
+    EXPECT_FLOAT_EQ(record.confidence, 0.75f);
+    EXPECT_STREQ(record.word, "feed-first");
+    EXPECT_GT(record.unixNanos, 0);
+
+    ASSERT_TRUE(reader->Next(record));
+    EXPECT_EQ(record.seq, 1u);
+    EXPECT_EQ(record.kind, feed::Kind::Penalty);
+    EXPECT_EQ(record.stars, 2);
+    EXPECT_STREQ(record.word, "feed-second");
+    EXPECT_FALSE(reader->Next(record));
+    EXPECT_EQ(reader->Overruns(), 0u);
+}
+
+TEST_F(EventFeedTest, LongWordsAreCutAtACharacterBoundary) {
+    auto writer = Create();
+    ASSERT_TRUE(writer);
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    std::string word(feed::kWordBytes - 2, 'a');
+    word += "\xC3\xA9\xC3\xA9"; // é straddles the cut
+    writer->PublishDetection(Words().Intern(word), 1.0f, DetectionSource::Chat);
+
+    feed::Record record;
+    ASSERT_TRUE(reader->Next(record));
+    EXPECT_EQ(std::strlen(record.word), feed::kWordBytes - 2);
+    EXPECT_EQ(std::string(record.word), word.substr(0, feed::kWordBytes - 2));
+}
+
+TEST_F(EventFeedTest, ReaderStartsAtTheNewestOrOldestRecord) {
+    auto writer = Create(64);
+    ASSERT_TRUE(writer);
+    for (int i = 0; i < 100; ++i) writer->PublishDetection(kNoWord, 1.0f, DetectionSource::Chat);
+
+    auto live = feed::FeedReader::Open(name);
+    ASSERT_TRUE(live);
+    EXPECT_EQ(live->Position(), 100u);
+    auto oldest = feed::FeedReader::Open(name, true);
+    ASSERT_TRUE(oldest);
+    EXPECT_EQ(oldest->Position(), 100u - writer->Capacity());
+    feed::Record record;
+    ASSERT_TRUE(oldest->Next(record));
+    EXPECT_EQ(record.seq, 100u - writer->Capacity());
+}
+
+TEST_F(EventFeedTest, LappedReaderSkipsToTheOldestRecordAndCountsOverruns) {
+    auto writer = Create(64);
+    ASSERT_TRUE(writer);
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    const uint64_t published = 3 * writer->Capacity() + 10;
+    for (uint64_t i = 0; i < published; ++i) writer->PublishDetection(kNoWord, 1.0f, DetectionSource::Chat);
+
+    feed::Record record;
+    uint64_t received = 0;
+    uint64_t expected = published - writer->Capacity();
+    while (reader->Next(record)) {
+        EXPECT_EQ(record.seq, expected++);
+        ++received;
+    }
+    EXPECT_EQ(received, writer->Capacity());
+    EXPECT_EQ(reader->Overruns(), published - writer->Capacity());
+    EXPECT_EQ(received + reader->Overruns(), published);
+    ASSERT_EQ(writer->Readers().size(), 1u);
+    EXPECT_EQ(writer->Readers()[0].overruns, reader->Overruns());
+    EXPECT_EQ(writer->Readers()[0].position, published);
+}
+
+// Several writer threads publish while a reader drains; every record must be
+// whole (its word and confidence encode the same number) and every record
+// accounted for, read or overrun.
+TEST_F(EventFeedTest, ConcurrentPublishersNeverProduceTornRecords) {
+    auto writer = Create(256);
+    ASSERT_TRUE(writer);
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    std::vector<WordId> words;
+    for (int i = 0; i < 16; ++i) words.push_back(Words().Intern("feed-torn-" + std::to_string(i)));
+
+    constexpr int kWriters = 3;
+    constexpr int kEach = 20000;
+    std::atomic<int> running{kWriters};
+    std::vector<std::thread> writers;
+    for (int w = 0; w < kWriters; ++w) {
+        writers.emplace_back([&, w] {
+            for (int i = 0; i < kEach; ++i) {
+                const int k = (i + w) % 16;
+                writer->PublishDetection(words[k], static_cast<float>(k), DetectionSource::Chat);
+            }
+            running.fetch_sub(1);
+        });
+    }
+
+    uint64_t received = 0, torn = 0, backwards = 0, last = 0;
+    feed::Record record;
+    auto drain = [&] {
+        while (reader->Next(record)) {
+            const int k = static_cast<int>(record.confidence);
+            if (record.kind != feed::Kind::Detection || std::string(record.word) != "feed-torn-" + std::to_string(k)) ++torn;
+            if (received > 0 && record.seq <= last) ++backwards;
+            last = record.seq;
+            ++received;
+        }
+    };
+    while (running.load() > 0) {
+        drain();
+        reader->Wait(1ms);
+    }
+    for (auto& t : writers) t.join();
+    drain();
+
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(backwards, 0u);
+    EXPECT_EQ(received + reader->Overruns(), uint64_t{kWriters} * kEach);
+    EXPECT_EQ(writer->GetStats().published, uint64_t{kWriters} * kEach);
+}
+
+TEST_F(EventFeedTest, WaitingReaderIsWokenByAPublish) {
+    auto writer = Create();
+    ASSERT_TRUE(writer);
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    EXPECT_FALSE(reader->Wait(10ms));
+
+    std::thread publisher([&] {
+        std::this_thread::sleep_for(50ms);
+        writer->PublishDetection(kNoWord, 1.0f, DetectionSource::Chat);
+    });
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(reader->Wait(5000ms));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 4000ms);
+    publisher.join();
+    EXPECT_EQ(writer->GetStats().wakeups, 1u);
+}
+
+TEST_F(EventFeedTest, StateSurvivesLeavingTheRing) {
+    auto writer = Create(64);
+    ASSERT_TRUE(writer);
+    writer->PublishState(feed::Kind::Penalty, Words().Intern("feed-state"), 3);
+    for (int i = 0; i < 200; ++i) writer->PublishDetection(kNoWord, 1.0f, DetectionSource::Chat);
+
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    const auto state = reader->State();
+    ASSERT_TRUE(state);
+    EXPECT_EQ(state->kind, feed::Kind::Penalty);
+    EXPECT_EQ(state->stars, 3);
+    EXPECT_STREQ(state->word, "feed-state");
+    EXPECT_EQ(writer->GetStats().stars, 3);
+}
+
+TEST_F(EventFeedTest, PublishingOverlayForwardsAndPublishes) {
+    auto writer = Create();
+    ASSERT_TRUE(writer);
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    auto inner = std::make_unique<RecordingOverlay>();
+    RecordingOverlay* recording = inner.get();
+    auto overlay = feed::PublishingOverlay(std::move(inner), *writer);
+
+    const WordId word = Words().Intern("feed-overlay");
+    overlay->UpdateStatus(2, word);
+    overlay->ShowPenalty(word);
+    overlay->Hide();
+    EXPECT_EQ(recording->stars, 2);
+    EXPECT_EQ(recording->shown, 1);
+    EXPECT_EQ(recording->hides, 1);
+
+    feed::Record record;
+    ASSERT_TRUE(reader->Next(record));
+    EXPECT_EQ(record.kind, feed::Kind::Status);
+    EXPECT_EQ(record.stars, 2);
+    ASSERT_TRUE(reader->Next(record));
+    EXPECT_EQ(record.kind, feed::Kind::Penalty);
+    EXPECT_STREQ(record.word, "feed-overlay");
+    ASSERT_TRUE(reader->Next(record));
+    EXPECT_EQ(record.kind, feed::Kind::Hidden);
+    EXPECT_EQ(reader->State()->kind, feed::Kind::Hidden);
+}
+
+TEST_F(EventFeedTest, ReaderSlotsRunOut) {
+    auto writer = Create();
+    ASSERT_TRUE(writer);
+    std::vector<std::unique_ptr<feed::FeedReader>> readers;
+    for (size_t i = 0; i < feed::kMaxReaders; ++i) {
+        readers.push_back(feed::FeedReader::Open(name));
+        ASSERT_TRUE(readers.back());
+    }
+    EXPECT_FALSE(feed::FeedReader::Open(name));
+    EXPECT_EQ(writer->Readers().size(), feed::kMaxReaders);
+    readers.pop_back(); // frees its slot
+    EXPECT_TRUE(feed::FeedReader::Open(name));
+}
+
+TEST_F(EventFeedTest, ReaderSeesTheWriterGo) {
+    auto writer = Create();
+    ASSERT_TRUE(writer);
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    EXPECT_FALSE(reader->Closed());
+    writer.reset();
+    EXPECT_TRUE(reader->Closed());
+    EXPECT_FALSE(reader->Wait(1000ms));
+    EXPECT_FALSE(feed::FeedReader::Open(name));
+}
+
+TEST_F(EventFeedTest, ReplacedWriterLeavesItsSuccessorsFeedAlone) {
+    auto first = Create();
+    ASSERT_TRUE(first);
+    auto old = feed::FeedReader::Open(name);
+    ASSERT_TRUE(old);
+    auto second = Create(); // same process: takes the name over
+    ASSERT_TRUE(second);
+    EXPECT_TRUE(old->Closed());
+    first.reset();
+
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    EXPECT_FALSE(reader->Closed());
+    second->PublishDetection(kNoWord, 1.0f, DetectionSource::Chat);
+    feed::Record record;
+    EXPECT_TRUE(reader->Next(record));
+}
+
+TEST_F(EventFeedTest, ControlChannelAnswersSubscribeAndStatus) {
+    auto writer = Create(128);
+    ASSERT_TRUE(writer);
+    auto server = feed::StartFeedServer(*writer);
+    ASSERT_TRUE(server);
+    auto reader = feed::FeedReader::Open(name);
+    ASSERT_TRUE(reader);
+    writer->PublishState(feed::Kind::Status, kNoWord, 4);
+
+    const auto subscribe = feed::QueryFeed(name, "subscribe");
+    ASSERT_TRUE(subscribe);
+    const auto sub = nlohmann::json::parse(*subscribe);
+    EXPECT_EQ(sub["shm"], feed::SharedMemoryName(name));
+    EXPECT_EQ(sub["version"], feed::kLayoutVersion);
+    EXPECT_EQ(sub["recordSize"], 64);
+    EXPECT_EQ(sub["capacity"], 128);
+    EXPECT_EQ(sub["head"], 1);
+    EXPECT_EQ(sub["stars"], 4);
+
+    const auto status = feed::QueryFeed(name, "status");
+    ASSERT_TRUE(status);
+    const auto st = nlohmann::json::parse(*status);
+    EXPECT_EQ(st["pid"], platform::ProcessId());
+    EXPECT_EQ(st["published"], 1);
+    ASSERT_EQ(st["readers"].size(), 1u);
+    EXPECT_EQ(st["readers"][0]["position"], 0);
+    EXPECT_EQ(st["readers"][0]["lag"], 1);
+
+    const auto unknown = feed::QueryFeed(name, "frobnicate");
+    ASSERT_TRUE(unknown);
+    EXPECT_TRUE(nlohmann::json::parse(*unknown).contains("error"));
+    EXPECT_EQ(server->Requests(), 3u);
+}
+
+TEST_F(EventFeedTest, QueryWithoutAnAgentTimesOut) {
+    EXPECT_FALSE(feed::QueryFeed(name, "status", 200ms));
+}
@@ -0,0 +1,171 @@
+#include "Straf/Executor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+Task SetFlag(std::atomic<bool>& flag) {
+    flag = true;
+    co_return;
+}
+
+Task Sleeper(std::chrono::milliseconds duration, std::optional<bool>& result) {
+    const bool slept = co_await SleepFor(duration);
+    result = slept;
+}
+
+Task Waiter(Event& event, std::optional<Executor::clock::time_point> deadline, std::optional<bool>& result) {
+    const bool set = co_await event.Wait(deadline);
+    result = set;
+}
+
+Task Receiver(Channel<int>& channel, std::vector<int>& got) {
+    for (;;) {
+        const std::optional<int> value = co_await channel.Receive();
+        if (!value) break;
+        got.push_back(*value);
+    }
+}
+
+Task BlockingCall(std::chrono::milliseconds duration, std::atomic<bool>& returned, std::optional<bool>& result) {
+    const bool live = co_await Blocking([&] {
+        std::this_thread::sleep_for(duration);
+        returned = true;
+    });
+    result = live;
+}
+
+Task BlockingCalls(int calls, int& made) {
+    for (int i = 0; i < calls; ++i) {
+        const bool live = co_await Blocking([&made] { ++made; });
+        if (!live) break;
+    }
+}
+
+} // namespace
+
+TEST(ExecutorTest, SpawnedTaskRunsAndJoins) {
+    Executor executor(1);
+    std::atomic<bool> ran{false};
+    TaskHandle task = executor.Spawn(SetFlag(ran));
+    task.Join();
+    EXPECT_TRUE(ran);
+    EXPECT_FALSE(task.Joinable());
+    EXPECT_EQ(executor.GetStats().tasks, 0u);
+}
+
+TEST(ExecutorTest, SleepEndsAtItsDeadline) {
+    Executor executor(1);
+    std::optional<bool> result;
+    const auto start = std::chrono::steady_clock::now();
+    executor.Spawn(Sleeper(50ms, result)).Join();
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+    EXPECT_EQ(result, true);
+    EXPECT_EQ(executor.GetStats().timersFired, 1u);
+}
+
+TEST(ExecutorTest, StopEndsASleepAtOnce) {
+    Executor executor(1);
+    std::optional<bool> result;
+    TaskHandle task = executor.Spawn(Sleeper(10s, result));
+    std::this_thread::sleep_for(20ms);
+    const auto start = std::chrono::steady_clock::now();
+    task.Stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+    EXPECT_EQ(result, false);
+}
+
+TEST(ExecutorTest, EventWakesWaiterOrTimesOut) {
+    Executor executor(1);
+    Event event(executor);
+    std::optional<bool> set, timedOut;
+
+    TaskHandle waiter = executor.Spawn(Waiter(event, std::nullopt, set));
+    std::this_thread::sleep_for(20ms);
+    EXPECT_FALSE(set.has_value());
+    event.Set();
+    waiter.Join();
+    EXPECT_EQ(set, true);
+
+    executor.Spawn(Waiter(event, Executor::clock::now() + 20ms, timedOut)).Join();
+    EXPECT_EQ(timedOut, false);
+
+    // A Set() with nobody waiting is kept for the next Wait()
+    event.Set();
+    set.reset();
+    executor.Spawn(Waiter(event, Executor::clock::now() + 1s, set)).Join();
+    EXPECT_EQ(set, true);
+}
+
+TEST(ExecutorTest, ChannelDeliversInOrderAndDrainsOnClose) {
+    Executor executor(2);
+    Channel<int> channel(4, executor);
+    std::vector<int> got;
+    EXPECT_TRUE(channel.Send(1));
+    EXPECT_TRUE(channel.Send(2));
+    TaskHandle receiver = executor.Spawn(Receiver(channel, got));
+    for (int i = 3; i <= 10; ++i) {
+        while (!channel.Send(i)) std::this_thread::yield(); // full: the receiver catches up
+    }
+    channel.Close();
+    receiver.Join();
+    EXPECT_FALSE(channel.Send(11));
+    ASSERT_EQ(got.size(), 10u);
+    for (int i = 0; i < 10; ++i) EXPECT_EQ(got[i], i + 1);
+}
+
+TEST(ExecutorTest, IdleExecutorDoesNotWake) {
+    Executor executor(2);
+    std::this_thread::sleep_for(20ms);
+    const uint64_t before = executor.GetStats().wakeups;
+    std::this_thread::sleep_for(200ms);
+    EXPECT_EQ(executor.GetStats().wakeups, before);
+}
+
+// A blocking call (like the Vosk model load) must not hold the only worker.
+TEST(ExecutorTest, BlockingCallHoldsNoWorker) {
+    Executor executor(1);
+    std::atomic<bool> returned{false};
+    std::optional<bool> result;
+    TaskHandle slow = executor.Spawn(BlockingCall(300ms, returned, result));
+    std::this_thread::sleep_for(20ms);
+
+    std::atomic<bool> ran{false};
+    executor.Spawn(SetFlag(ran)).Join();
+    EXPECT_TRUE(ran);
+    EXPECT_FALSE(returned); // the other task ran while the call was still blocked
+
+    slow.Join();
+    EXPECT_TRUE(returned);
+    EXPECT_EQ(result, true);
+}
+
+TEST(ExecutorTest, StoppedTaskWaitsOutItsBlockingCall) {
+    Executor executor(1);
+    std::atomic<bool> returned{false};
+    std::optional<bool> result;
+    TaskHandle task = executor.Spawn(BlockingCall(100ms, returned, result));
+    std::this_thread::sleep_for(20ms);
+    task.Stop();
+    EXPECT_TRUE(returned);
+    EXPECT_EQ(result, false);
+}
+
+// A task that blocks once per packet must not start a thread per packet.
+TEST(ExecutorTest, BlockingThreadsAreReused) {
+    Executor executor(1);
+    int made = 0;
+    executor.Spawn(BlockingCalls(200, made)).Join();
+    EXPECT_EQ(made, 200);
+    EXPECT_EQ(executor.GetStats().blockingThreads, 1u);
+    // The parked thread is released when the executor goes
+}
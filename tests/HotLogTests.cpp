@@ -0,0 +1,189 @@
+// Trace is compiled out in this file; debug and up stay
+#define STRAF_HOTLOG_MIN_LEVEL 1
+#include "Straf/HotLog.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Straf;
+using namespace Straf::hotlog;
+
+namespace {
+
+// Appends a bare record carrying `value` in the line field; Drain() only
+// needs the size and level. Returns false when the ring is full.
+bool Put(detail::Ring& ring, uint32_t value, size_t bytes, bool* wake = nullptr) {
+    std::byte* out = ring.Reserve(bytes);
+    if (!out) return false;
+    const detail::RecordHeader header{static_cast<uint32_t>(bytes), Level::Info, value, nullptr, nullptr, nullptr, 0};
+    std::memcpy(out, &header, sizeof header);
+    const bool woke = ring.Commit();
+    if (wake) *wake = woke;
+    return true;
+}
+
+std::vector<uint32_t> DrainValues(detail::Ring& ring) {
+    std::vector<uint32_t> values;
+    ring.Drain([&](const detail::RecordHeader& h, const std::byte*) { values.push_back(h.line); });
+    return values;
+}
+
+// Collects what the writer thread formats. Each test starts its own writer
+// and logs from fresh threads, so the rings use the options given here.
+class HotLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Stop();
+        SetLevel(Level::Trace);
+    }
+    void TearDown() override {
+        Stop();
+        SetLevel(Level::Info);
+    }
+
+    void StartWriter(size_t ringBytes = 64 * 1024) {
+        Options options;
+        options.ringBytes = ringBytes;
+        hotlog::Start([this](const Message& m) {
+            std::lock_guard lock(mutex);
+            texts.emplace_back(m.text);
+            levels.push_back(m.level);
+        }, options);
+    }
+
+    std::vector<std::string> Texts() {
+        std::lock_guard lock(mutex);
+        return texts;
+    }
+
+    std::mutex mutex;
+    std::vector<std::string> texts;
+    std::vector<Level> levels;
+};
+
+} // namespace
+
+TEST(HotLogRing, RecordsWrapAroundInOrder) {
+    detail::Ring ring(256, 1);
+    uint32_t next = 0, expected = 0;
+    size_t refused = 0;
+    for (int round = 0; round < 200; ++round) {
+        // Mixed sizes leave the tail at offsets where a record does not fit
+        // before the end and padding has to be skipped
+        while (Put(ring, next, round % 3 == 0 ? 48 : 72)) ++next;
+        ++refused;
+        for (uint32_t v : DrainValues(ring)) EXPECT_EQ(v, expected++);
+        EXPECT_TRUE(ring.Empty());
+    }
+    EXPECT_EQ(expected, next);
+    EXPECT_EQ(ring.Written(), next);
+    EXPECT_EQ(ring.Dropped(), refused);
+}
+
+TEST(HotLogRing, OnlyARecordIntoAnEmptyRingWakesTheWriter) {
+    detail::Ring ring(1024, 1);
+    bool wake = false;
+    ASSERT_TRUE(Put(ring, 0, 48, &wake));
+    EXPECT_TRUE(wake);
+    ASSERT_TRUE(Put(ring, 1, 48, &wake));
+    EXPECT_FALSE(wake);
+    ASSERT_TRUE(Put(ring, 2, 48, &wake));
+    EXPECT_FALSE(wake);
+    EXPECT_EQ(DrainValues(ring).size(), 3u);
+    ASSERT_TRUE(Put(ring, 3, 48, &wake));
+    EXPECT_TRUE(wake);
+}
+
+TEST_F(HotLogTest, FullRingDropsAndCounts) {
+    // No writer yet: records wait in the ring until it is full
+    const Stats before = GetStats();
+    StartWriter(256);
+    Stop();
+    std::thread([] {
+        for (int i = 0; i < 20; ++i) STRAF_HOT_INFO("record {}", i);
+    }).join();
+    const Stats after = GetStats();
+    EXPECT_EQ(after.threads - before.threads, 1u);
+    EXPECT_GT(after.dropped - before.dropped, 0u);
+    EXPECT_EQ((after.written - before.written) + (after.dropped - before.dropped), 20u);
+
+    StartWriter();
+    Stop();
+    const auto texts = Texts();
+    ASSERT_EQ(texts.size(), after.written - before.written);
+    for (size_t i = 0; i < texts.size(); ++i) EXPECT_EQ(texts[i], "record " + std::to_string(i));
+}
+
+TEST_F(HotLogTest, RecordsOfAnExitedThreadAreStillWritten) {
+    StartWriter();
+    Stop();
+    const Stats before = GetStats();
+    std::thread([] {
+        STRAF_HOT_WARN("from {} with {:.1f}", std::string("worker"), 2.5);
+        STRAF_HOT_ERROR("second {}", 2);
+    }).join();
+    StartWriter();
+    Stop();
+    EXPECT_EQ(Texts(), (std::vector<std::string>{"from worker with 2.5", "second 2"}));
+    // The ring was freed once drained; its counters move to the totals
+    const Stats after = GetStats();
+    EXPECT_EQ(after.written - before.written, 2u);
+}
+
+TEST_F(HotLogTest, RunningWriterKeepsUpWithSeveralThreads) {
+    StartWriter();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < 500; ++i) STRAF_HOT_DEBUG("thread {} record {}", t, i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    Stop();
+    EXPECT_EQ(Texts().size(), 2000u);
+}
+
+TEST_F(HotLogTest, RuntimeLevelSkipsArguments) {
+    StartWriter();
+    int evaluated = 0;
+    auto count = [&evaluated] { return ++evaluated; };
+    std::thread([&] {
+        SetLevel(Level::Warn);
+        STRAF_HOT_INFO("hidden {}", count());
+        STRAF_HOT_WARN("shown {}", count());
+        SetLevel(Level::Off);
+        STRAF_HOT_ERROR("hidden {}", count());
+    }).join();
+    Stop();
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(Texts(), (std::vector<std::string>{"shown 1"}));
+    EXPECT_EQ(levels, (std::vector<Level>{Level::Warn}));
+}
+
+TEST_F(HotLogTest, LevelsBelowTheBuildMinimumAreCompiledOut) {
+    StartWriter();
+    int evaluated = 0;
+    auto count = [&evaluated] { return ++evaluated; };
+    std::thread([&] {
+        STRAF_HOT_TRACE("stripped {}", count());
+        STRAF_HOT_DEBUG("kept {}", count());
+    }).join();
+    Stop();
+    EXPECT_EQ(evaluated, 1);
+    EXPECT_EQ(Texts(), (std::vector<std::string>{"kept 1"}));
+}
+
+TEST(HotLogLevels, ParseLevelNames) {
+    Level level = Level::Off;
+    EXPECT_TRUE(ParseLevel("warning", level));
+    EXPECT_EQ(level, Level::Warn);
+    EXPECT_TRUE(ParseLevel("trace", level));
+    EXPECT_EQ(level, Level::Trace);
+    EXPECT_FALSE(ParseLevel("Info", level));
+    EXPECT_EQ(level, Level::Trace);
+}
@@ -0,0 +1,52 @@
+#include "Straf/Metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+
+using namespace Straf::metrics;
+
+namespace {
+
+// Sends `request` to the server on loopback and returns the whole response.
+std::string Exchange(uint16_t port, const std::string& request) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    std::string response;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) == 0 &&
+        send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size())) {
+        char buf[4096];
+        for (ssize_t got; (got = recv(fd, buf, sizeof buf, 0)) > 0;) response.append(buf, static_cast<size_t>(got));
+    }
+    close(fd);
+    return response;
+}
+
+} // namespace
+
+TEST(MetricsServer, ServesTheRegistryOverHttp) {
+    Registry registry;
+    registry.AddCounter("served_total", "Served.").Inc(5);
+    auto server = StartMetricsServer(0, registry);
+    ASSERT_TRUE(server);
+    ASSERT_NE(server->Port(), 0);
+
+    const std::string response = Exchange(server->Port(), "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    ASSERT_EQ(response.compare(0, 15, "HTTP/1.0 200 OK"), 0) << response;
+    EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+    const std::string body = registry.Render();
+    EXPECT_NE(response.find("Content-Length: " + std::to_string(body.size()) + "\r\n"), std::string::npos);
+    EXPECT_EQ(response.substr(response.find("\r\n\r\n") + 4), body);
+    EXPECT_EQ(server->Scrapes(), 1u);
+
+    EXPECT_EQ(Exchange(server->Port(), "POST / HTTP/1.1\r\n\r\n").compare(0, 12, "HTTP/1.0 405"), 0);
+    EXPECT_EQ(server->Scrapes(), 1u);
+}
@@ -0,0 +1,188 @@
+#include "Straf/Metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Straf::metrics;
+
+namespace {
+
+// Count of the bucket whose upper bound is `bound`, or of +Inf for INFINITY.
+uint64_t CountAt(const Histogram::Snapshot& s, double bound) {
+    if (std::isinf(bound)) return s.counts.back();
+    for (size_t i = 0; i < s.bounds.size(); ++i) {
+        if (s.bounds[i] == bound) return s.counts[i];
+    }
+    ADD_FAILURE() << "no bucket with bound " << bound;
+    return 0;
+}
+
+bool Contains(const std::string& text, const std::string& line) {
+    return text.find(line) != std::string::npos;
+}
+
+// Value of the sample line starting with `prefix` (name and labels).
+double SampleValue(const std::string& text, const std::string& prefix) {
+    std::istringstream in(text);
+    for (std::string line; std::getline(in, line);) {
+        if (line.compare(0, prefix.size() + 1, prefix + " ") == 0) return std::stod(line.substr(prefix.size() + 1));
+    }
+    ADD_FAILURE() << "no sample " << prefix;
+    return -1;
+}
+
+} // namespace
+
+TEST(Histogram, BucketsSplitEachPowerOfTwoInFour) {
+    // One unit is lowest / 4 = 0.25, exact in binary
+    Histogram h({1.0, 8.0});
+    const auto s = h.Read();
+    ASSERT_GE(s.bounds.size(), 16u);
+    const std::vector<double> first{0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 1.75, 2.0, 2.5, 3.0, 3.5, 4.0, 5.0, 6.0, 7.0, 8.0};
+    EXPECT_EQ(std::vector<double>(s.bounds.begin(), s.bounds.begin() + 16), first);
+    for (size_t i = 4; i < s.bounds.size(); ++i) EXPECT_LE(s.bounds[i] - s.bounds[i - 1], 0.25 * s.bounds[i - 1]);
+    EXPECT_GE(s.bounds.back(), 8.0);
+    EXPECT_EQ(s.counts.size(), s.bounds.size() + 1);
+}
+
+TEST(Histogram, ValueOnABoundLandsInThatBucket) {
+    Histogram h({1.0, 8.0});
+    for (double v : {0.25, 1.0, 2.5, 8.0}) h.Observe(v);
+    h.Observe(0.26);
+    h.Observe(1.01);
+    h.Observe(-3.0);
+    h.Observe(std::nan(""));
+    h.Observe(1e30);
+    const auto s = h.Read();
+    EXPECT_EQ(CountAt(s, 0.25), 3u); // 0.25, and negative and NaN as zero
+    EXPECT_EQ(CountAt(s, 0.5), 1u);
+    EXPECT_EQ(CountAt(s, 1.0), 1u);
+    EXPECT_EQ(CountAt(s, 1.25), 1u);
+    EXPECT_EQ(CountAt(s, 2.5), 1u);
+    EXPECT_EQ(CountAt(s, 8.0), 1u);
+    EXPECT_EQ(CountAt(s, INFINITY), 1u);
+    EXPECT_EQ(s.count, 9u);
+    EXPECT_DOUBLE_EQ(s.sum, 0.25 + 1.0 + 2.5 + 8.0 + 0.26 + 1.01 + 1e30);
+}
+
+TEST(Histogram, QuantileIsTheBoundOfTheRankedBucket) {
+    Histogram h({1.0, 64.0});
+    EXPECT_EQ(h.Read().Quantile(0.5), 0.0);
+    for (int i = 1; i <= 100; ++i) h.Observe(i * 0.25); // 0.25 .. 25
+    const auto s = h.Read();
+    EXPECT_EQ(s.Quantile(0.0), 0.25);
+    EXPECT_EQ(s.Quantile(0.01), 0.25);
+    EXPECT_EQ(s.Quantile(0.5), 14.0);  // 50th value, 12.5, in (12, 14]
+    EXPECT_EQ(s.Quantile(0.95), 24.0); // 95th value, 23.75, in (20, 24]
+    EXPECT_EQ(s.Quantile(1.0), 28.0);  // 25 in (24, 28]
+    EXPECT_EQ(s.Quantile(7.0), 28.0);  // clamped
+    h.Observe(1000.0);
+    EXPECT_EQ(h.Read().Quantile(1.0), h.Read().bounds.back()); // +Inf reports the last bound
+}
+
+TEST(CounterFamily, CountsByIdAndIgnoresIdsPastTheLastChunk) {
+    CounterFamily family([](uint32_t id) { return "w" + std::to_string(id); });
+    family.Inc(3);
+    family.Inc(3, 4);
+    family.Inc(2000);
+    family.Inc(CounterFamily::kChunkSize * CounterFamily::kMaxChunks);
+    std::vector<std::pair<std::string, uint64_t>> seen;
+    family.ForEach([&](const std::string& label, uint64_t v) { seen.emplace_back(label, v); });
+    EXPECT_EQ(seen, (std::vector<std::pair<std::string, uint64_t>>{{"w3", 5}, {"w2000", 1}}));
+}
+
+TEST(Registry, RendersPrometheusTextFormat) {
+    Registry registry;
+    registry.AddCounter("c_total", "Counts \\ things\nover lines").Inc(3);
+    registry.AddGauge("g", "A gauge.").Set(-1.5);
+    registry.AddCounterFamily("f_total", "By word.", "word", [](uint32_t id) {
+        return id == 1 ? std::string("say \"hi\"\\\n") : std::string("plain");
+    }).Inc(1);
+    registry.AddHistogram("h_seconds", "Latency.", {1.0, 2.0}).Observe(0.75);
+    registry.AddCollector([](Writer& w) { w.WriteGauge("collected", "From a collector.", 7); });
+
+    const std::string text = registry.Render();
+    EXPECT_TRUE(Contains(text, "# HELP c_total Counts \\\\ things\\nover lines\n# TYPE c_total counter\nc_total 3\n")) << text;
+    EXPECT_TRUE(Contains(text, "# HELP g A gauge.\n# TYPE g gauge\ng -1.5\n")) << text;
+    EXPECT_TRUE(Contains(text, "# TYPE f_total counter\nf_total{word=\"say \\\"hi\\\"\\\\\\n\"} 1\n")) << text;
+    EXPECT_TRUE(Contains(text, "# TYPE h_seconds histogram\nh_seconds_bucket{le=\"0.25\"} 0\n")) << text;
+    EXPECT_TRUE(Contains(text, "h_seconds_bucket{le=\"0.75\"} 1\nh_seconds_bucket{le=\"1\"} 1\n")) << text;
+    EXPECT_TRUE(Contains(text, "h_seconds_bucket{le=\"+Inf\"} 1\nh_seconds_sum 0.75\nh_seconds_count 1\n")) << text;
+    EXPECT_TRUE(Contains(text, "# TYPE collected gauge\ncollected 7\n")) << text;
+    EXPECT_EQ(text.back(), '\n');
+}
+
+TEST(Registry, SameNameReturnsTheSameMetric) {
+    Registry registry;
+    Counter& a = registry.AddCounter("x_total", "X.");
+    Counter& b = registry.AddCounter("x_total", "Other help.");
+    EXPECT_EQ(&a, &b);
+}
+
+TEST(Registry, NameRegisteredAsAnotherKindIsRejected) {
+    Registry registry;
+    registry.AddCounter("dup", "First.").Inc(2);
+    Gauge& gauge = registry.AddGauge("dup", "Second.");
+    gauge.Set(9); // usable, but not exported
+    Histogram& histogram = registry.AddHistogram("dup", "Third.", {});
+    histogram.Observe(1.0);
+    const std::string text = registry.Render();
+    EXPECT_TRUE(Contains(text, "# TYPE dup counter\ndup 2\n")) << text;
+    EXPECT_FALSE(Contains(text, "gauge")) << text;
+    EXPECT_FALSE(Contains(text, "dup_bucket")) << text;
+}
+
+TEST(Registry, RemovedCollectorIsNotRendered) {
+    Registry registry;
+    const size_t id = registry.AddCollector([](Writer& w) { w.WriteCounter("gone_total", "Removed.", 1); });
+    EXPECT_TRUE(Contains(registry.Render(), "gone_total 1"));
+    registry.RemoveCollector(id);
+    EXPECT_FALSE(Contains(registry.Render(), "gone_total"));
+}
+
+TEST(Registry, ConcurrentRecordingAndRendering) {
+    Registry registry;
+    Counter& counter = registry.AddCounter("stress_total", "Stress.");
+    Histogram& histogram = registry.AddHistogram("stress_seconds", "Stress.", {1e-3, 1.0});
+    CounterFamily& family = registry.AddCounterFamily("stress_by_id_total", "Stress.", "id",
+                                                      [](uint32_t id) { return std::to_string(id); });
+    constexpr int kThreads = 4, kPerThread = 20000;
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistent{0};
+    std::thread scraper([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            const std::string text = registry.Render();
+            // +Inf and _count come from the same read
+            if (SampleValue(text, "stress_seconds_bucket{le=\"+Inf\"}") != SampleValue(text, "stress_seconds_count")) {
+                inconsistent.fetch_add(1);
+            }
+        }
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                counter.Inc();
+                histogram.Observe((i % 1000) * 1e-3);
+                // Every thread races to allocate the same fresh chunks
+                family.Inc(static_cast<uint32_t>((i * 7 + t) % 5000));
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    done.store(true, std::memory_order_release);
+    scraper.join();
+
+    EXPECT_EQ(inconsistent.load(), 0);
+    EXPECT_EQ(counter.Value(), uint64_t{kThreads} * kPerThread);
+    EXPECT_EQ(histogram.Read().count, uint64_t{kThreads} * kPerThread);
+    uint64_t total = 0;
+    family.ForEach([&](const std::string&, uint64_t v) { total += v; });
+    EXPECT_EQ(total, uint64_t{kThreads} * kPerThread);
+}
@@ -0,0 +1,80 @@
+#include "Straf/OverlayCache.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+using namespace Straf;
+
+namespace {
+
+using Cache = OverlayResourceCache<std::shared_ptr<int>>;
+
+// What a layer does per resource: look up, build on a miss.
+int Get(Cache& cache, const OverlayCacheKey& key, int made) {
+    if (auto* hit = cache.Find(key)) return **hit;
+    cache.Insert(key, std::make_shared<int>(made));
+    return made;
+}
+
+} // namespace
+
+TEST(OverlayCacheTest, BuildsOnceAndReuses) {
+    Cache cache;
+    const OverlayCacheKey key{"classic", -1, kNoWord, 1920, 1080, 1};
+    EXPECT_EQ(cache.Find(key), nullptr);
+    EXPECT_EQ(Get(cache, key, 7), 7);
+    EXPECT_EQ(Get(cache, key, 8), 7);
+    EXPECT_EQ(cache.Misses(), 1u);
+    EXPECT_EQ(cache.Size(), 1u);
+}
+
+TEST(OverlayCacheTest, EveryFieldIsPartOfTheKey) {
+    Cache cache;
+    const OverlayCacheKey base{"classic", 3, 5, 1920, 1080, 1};
+    Get(cache, base, 0);
+    Get(cache, {"bar", 3, 5, 1920, 1080, 1}, 1);
+    Get(cache, {"classic", 4, 5, 1920, 1080, 1}, 2);
+    Get(cache, {"classic", 3, 6, 1920, 1080, 1}, 3);
+    Get(cache, {"classic", 3, 5, 1920, 1080, 2}, 4);
+    EXPECT_EQ(cache.Misses(), 5u);
+    EXPECT_EQ(Get(cache, base, 9), 0);
+}
+
+TEST(OverlayCacheTest, ResizeDropsOnlyThatStyle) {
+    Cache cache;
+    Get(cache, {"classic", -1, kNoWord, 1920, 1080, 1}, 1);
+    Get(cache, {"classic", -1, kNoWord, 1920, 1080, 2}, 2);
+    Get(cache, {"bar", -1, kNoWord, 1920, 1080, 1}, 3);
+    ASSERT_EQ(cache.Size(), 3u);
+
+    EXPECT_EQ(Get(cache, {"classic", -1, kNoWord, 2560, 1440, 1}, 4), 4);
+    EXPECT_EQ(cache.Size(), 2u);
+    EXPECT_EQ(Get(cache, {"bar", -1, kNoWord, 1920, 1080, 1}, 5), 3);
+    // Back to the old size: rebuilt, the 1440p entry goes in turn
+    EXPECT_EQ(Get(cache, {"classic", -1, kNoWord, 1920, 1080, 2}, 6), 6);
+    EXPECT_EQ(cache.Size(), 2u);
+}
+
+TEST(OverlayCacheTest, TrimClearsOnlyPastTheLimit) {
+    Cache cache;
+    for (WordId w = 1; w <= Cache::kMaxEntries; ++w) Get(cache, {"bar", -1, w, 1920, 1080, 1}, 0);
+    cache.Trim();
+    EXPECT_EQ(cache.Size(), Cache::kMaxEntries);
+
+    Get(cache, {"bar", -1, 0xffff, 1920, 1080, 1}, 0);
+    cache.Trim();
+    EXPECT_EQ(cache.Size(), 0u);
+    EXPECT_EQ(cache.Misses(), Cache::kMaxEntries + 1);
+}
+
+TEST(OverlayCacheTest, ClearReleasesResources) {
+    Cache cache;
+    auto resource = std::make_shared<int>(1);
+    const OverlayCacheKey key{"vignette", 2, kNoWord, 1920, 1080, 1};
+    cache.Insert(key, resource);
+    EXPECT_EQ(resource.use_count(), 2);
+    cache.Clear();
+    EXPECT_EQ(resource.use_count(), 1);
+    EXPECT_EQ(cache.Find(key), nullptr);
+}
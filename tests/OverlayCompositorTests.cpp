@@ -0,0 +1,225 @@
+#include "Straf/Overlay.h"
+#include "Straf/OverlayCompositor.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Long enough for a busy or polling render thread to show up in the stats.
+constexpr auto kIdle = 300ms;
+
+bool WaitFor(const std::function<bool()>& done, std::chrono::milliseconds timeout = 2000ms) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+// Counts its draws; animates at `period` while the scene shows 5 stars.
+class CountingLayer final : public IOverlayLayer {
+public:
+    explicit CountingLayer(std::atomic<int>& draws, clock::duration period = 20ms) : draws_(draws), period_(period) {}
+    std::string_view Name() const override { return "counting"; }
+    OverlayRect Placement(float w, float h) const override { return {0, 0, w, h}; }
+    bool CreateResources(IOverlayCanvas&) override { return true; }
+    void ReleaseResources() override {}
+    std::optional<clock::time_point> Draw(IOverlayCanvas&, const OverlayScene& scene, clock::time_point now) override {
+        ++draws_;
+        if (scene.stars == 5) return now + period_;
+        return std::nullopt;
+    }
+
+private:
+    std::atomic<int>& draws_;
+    clock::duration period_;
+};
+
+// Takes `cost` per draw; shown from `minStars` stars on.
+class SlowLayer final : public IOverlayLayer {
+public:
+    explicit SlowLayer(clock::duration cost, int minStars = 0) : cost_(cost), minStars_(minStars) {}
+    std::string_view Name() const override { return "slow"; }
+    bool Visible(const OverlayScene& scene) const override { return scene.visible && scene.stars >= minStars_; }
+    OverlayRect Placement(float w, float h) const override { return {0, 0, w, h}; }
+    bool CreateResources(IOverlayCanvas&) override { return true; }
+    void ReleaseResources() override {}
+    std::optional<clock::time_point> Draw(IOverlayCanvas&, const OverlayScene&, clock::time_point) override {
+        std::this_thread::sleep_for(cost_);
+        return std::nullopt;
+    }
+
+private:
+    clock::duration cost_;
+    int minStars_;
+};
+
+// Can't draw on any device: CreateResources() fails, so Draw() must not run.
+class BrokenLayer final : public IOverlayLayer {
+public:
+    explicit BrokenLayer(std::atomic<int>& draws) : draws_(draws) {}
+    std::string_view Name() const override { return "broken"; }
+    OverlayRect Placement(float w, float h) const override { return {0, 0, w, h}; }
+    bool CreateResources(IOverlayCanvas&) override { return false; }
+    void ReleaseResources() override {}
+    std::optional<clock::time_point> Draw(IOverlayCanvas&, const OverlayScene&, clock::time_point) override {
+        ++draws_;
+        return std::nullopt;
+    }
+
+private:
+    std::atomic<int>& draws_;
+};
+
+} // namespace
+
+TEST(HeadlessOverlayTest, IdleOverlayRendersNothingAndNeverWakes) {
+    auto overlay = CreateOverlayHeadless();
+    ASSERT_TRUE(overlay->Initialize());
+    std::this_thread::sleep_for(kIdle);
+
+    const OverlayFrameStats stats = overlay->GetFrameStats();
+    EXPECT_EQ(stats.frames, 0u);
+    EXPECT_EQ(stats.wakeups, 0u);
+    EXPECT_EQ(stats.updates, 0u);
+}
+
+TEST(HeadlessOverlayTest, StaticPenaltyDrawsOnceThenIdles) {
+    auto overlay = CreateOverlayHeadless();
+    ASSERT_TRUE(overlay->Initialize());
+    overlay->ShowPenalty(Words().Intern("overlay-static"));
+    overlay->UpdateStatus(2, kNoWord);
+    ASSERT_TRUE(WaitFor([&] { return overlay->GetFrameStats().frames >= 1; }));
+    std::this_thread::sleep_for(50ms); // let a frame for the second edit land, if it was separate
+    const OverlayFrameStats shown = overlay->GetFrameStats();
+    EXPECT_LE(shown.frames, 2u);
+    EXPECT_EQ(shown.updates, 2u);
+
+    std::this_thread::sleep_for(kIdle);
+    const OverlayFrameStats idle = overlay->GetFrameStats();
+    EXPECT_EQ(idle.frames, shown.frames);
+    EXPECT_EQ(idle.wakeups, shown.wakeups);
+}
+
+TEST(HeadlessOverlayTest, HiddenOverlayStopsDrawing) {
+    auto overlay = CreateOverlayHeadless();
+    ASSERT_TRUE(overlay->Initialize());
+    overlay->ShowPenalty(Words().Intern("overlay-hidden"));
+    ASSERT_TRUE(WaitFor([&] { return overlay->GetFrameStats().frames >= 1; }));
+    overlay->Hide();
+    overlay->UpdateStatus(0, kNoWord);
+    ASSERT_TRUE(WaitFor([&] { return overlay->GetFrameStats().updates == 3; }));
+    std::this_thread::sleep_for(50ms);
+    const OverlayFrameStats hidden = overlay->GetFrameStats();
+
+    std::this_thread::sleep_for(kIdle);
+    const OverlayFrameStats idle = overlay->GetFrameStats();
+    EXPECT_EQ(idle.frames, hidden.frames);
+    EXPECT_EQ(idle.wakeups, hidden.wakeups);
+}
+
+TEST(OverlayCompositorTest, ShowsWindowWithFirstFrameAndHidesItWithScene) {
+    auto device = std::make_unique<HeadlessCompositorDevice>();
+    HeadlessCompositorDevice* dev = device.get();
+    std::atomic<int> draws{0};
+    OverlayCompositor compositor(std::move(device));
+    compositor.AddLayer(std::make_unique<CountingLayer>(draws));
+    ASSERT_TRUE(compositor.Initialize());
+    EXPECT_FALSE(dev->Visible());
+
+    compositor.ShowPenalty(Words().Intern("overlay-window"));
+    ASSERT_TRUE(WaitFor([&] { return dev->Visible(); }));
+    EXPECT_GE(draws.load(), 1);
+    ASSERT_EQ(dev->Surfaces().size(), 1u);
+    EXPECT_TRUE(dev->Surfaces()[0].shown);
+
+    compositor.Hide();
+    EXPECT_TRUE(WaitFor([&] { return !dev->Visible(); }));
+}
+
+TEST(OverlayCompositorTest, AnimatesOnlyWhileTheLayerAsks) {
+    auto device = std::make_unique<HeadlessCompositorDevice>();
+    std::atomic<int> draws{0};
+    OverlayCompositor compositor(std::move(device));
+    compositor.AddLayer(std::make_unique<CountingLayer>(draws, 10ms));
+    ASSERT_TRUE(compositor.Initialize());
+
+    compositor.ShowPenalty(Words().Intern("overlay-animated"));
+    compositor.UpdateStatus(5, kNoWord);
+    ASSERT_TRUE(WaitFor([&] { return draws.load() >= 5; })); // animation frames keep coming
+
+    compositor.UpdateStatus(1, kNoWord);
+    std::this_thread::sleep_for(50ms);
+    const int settled = draws.load();
+    std::this_thread::sleep_for(kIdle);
+    EXPECT_EQ(draws.load(), settled);
+}
+
+TEST(OverlayCompositorTest, RedrawsEveryLayerAfterDeviceLoss) {
+    auto device = std::make_unique<HeadlessCompositorDevice>();
+    HeadlessCompositorDevice* dev = device.get();
+    std::atomic<int> bottom{0};
+    std::atomic<int> top{0};
+    OverlayCompositor compositor(std::move(device));
+    compositor.AddLayer(std::make_unique<CountingLayer>(bottom));
+    compositor.AddLayer(std::make_unique<CountingLayer>(top));
+    ASSERT_TRUE(compositor.Initialize());
+
+    compositor.ShowPenalty(Words().Intern("overlay-lost"));
+    ASSERT_TRUE(WaitFor([&] { return bottom.load() >= 1 && top.load() >= 1 && dev->Visible(); }));
+
+    dev->LoseDevice();
+    compositor.UpdateStatus(3, kNoWord);
+    ASSERT_TRUE(WaitFor([&] { return dev->Resets() == 1; }));
+    ASSERT_TRUE(WaitFor([&] {
+        const auto surfaces = dev->Surfaces();
+        return surfaces[0].shown && surfaces[1].shown;
+    }));
+    EXPECT_GE(bottom.load(), 2);
+    EXPECT_GE(top.load(), 2);
+}
+
+TEST(OverlayCompositorTest, DrawTimeAddsUpEveryFrame) {
+    OverlayCompositor compositor(std::make_unique<HeadlessCompositorDevice>());
+    compositor.AddLayer(std::make_unique<SlowLayer>(20ms));
+    ASSERT_TRUE(compositor.Initialize());
+
+    compositor.ShowPenalty(Words().Intern("overlay-slow"));
+    ASSERT_TRUE(WaitFor([&] { return compositor.GetFrameStats().frames >= 1; }));
+    const OverlayFrameStats first = compositor.GetFrameStats();
+    EXPECT_GE(first.drawTime, 20ms);
+    EXPECT_EQ(first.maxDrawTime, first.drawTime);
+
+    compositor.UpdateStatus(2, kNoWord);
+    ASSERT_TRUE(WaitFor([&] { return compositor.GetFrameStats().frames > first.frames; }));
+    const OverlayFrameStats second = compositor.GetFrameStats();
+    EXPECT_GE(second.drawTime, first.drawTime + 20ms);
+    EXPECT_GE(second.maxDrawTime, 20ms);
+    EXPECT_LT(second.maxDrawTime, second.drawTime);
+}
+
+TEST(OverlayCompositorTest, LayersThatDoNotDrawAddNoDrawTime) {
+    std::atomic<int> broken{0};
+    OverlayCompositor compositor(std::make_unique<HeadlessCompositorDevice>());
+    compositor.AddLayer(std::make_unique<BrokenLayer>(broken));
+    compositor.AddLayer(std::make_unique<SlowLayer>(20ms, 3));
+    ASSERT_TRUE(compositor.Initialize());
+
+    // Neither layer draws: the slow one is hidden below 3 stars
+    compositor.ShowPenalty(Words().Intern("overlay-undrawn"));
+    ASSERT_TRUE(WaitFor([&] { return compositor.GetFrameStats().frames >= 1; }));
+    EXPECT_EQ(compositor.GetFrameStats().drawTime.count(), 0);
+
+    compositor.UpdateStatus(3, kNoWord);
+    ASSERT_TRUE(WaitFor([&] { return compositor.GetFrameStats().drawTime >= 20ms; }));
+    EXPECT_EQ(broken.load(), 0);
+}
@@ -0,0 +1,118 @@
+// Windows overlay devices on the desktop the tests run on. Every test draws
+// through a real device at least once; the Direct2D tests skip where no
+// Direct3D 11 device can be created, the software fallback runs everywhere.
+#include "Straf/Overlay.h"
+#include "Straf/OverlayCompositor.h"
+#include "Straf/OverlayD2D.h"
+#include "Straf/WordTable.h"
+
+#include <gtest/gtest.h>
+
+#include <windows.h>
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+bool WaitFor(const std::function<bool()>& done, std::chrono::milliseconds timeout = 5000ms) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+// Draw time only accrues for layers that created their resources and drew,
+// so it tells a drawn frame from one where every layer stayed hidden.
+bool DrewALayer(const IOverlayRenderer& overlay) {
+    return WaitFor([&] { return overlay.GetFrameStats().drawTime.count() > 0; });
+}
+
+// Sets an environment variable for one test, restoring what was there.
+class ScopedEnv {
+public:
+    ScopedEnv(const char* name, const char* value) : name_(name) {
+        char old[256]{};
+        const DWORD got = GetEnvironmentVariableA(name, old, static_cast<DWORD>(sizeof old));
+        if (got > 0 && got < sizeof old) old_ = old;
+        SetEnvironmentVariableA(name, value);
+    }
+    ~ScopedEnv() { SetEnvironmentVariableA(name_, old_ ? old_->c_str() : nullptr); }
+
+    ScopedEnv(const ScopedEnv&) = delete;
+    ScopedEnv& operator=(const ScopedEnv&) = delete;
+
+private:
+    const char* name_;
+    std::optional<std::string> old_;
+};
+
+} // namespace
+
+// Also starts one device after another in the same process.
+TEST(D2DOverlayTest, EveryStyleDrawsOnTheGpuDevice) {
+    const WordId word = Words().Intern("scheisse");
+    for (auto make : {CreateClassicLayer, CreateBarLayer, CreateVignetteLayer}) {
+        OverlayCompositor overlay(CreateD2DCompositorDevice());
+        overlay.AddLayer(make());
+        if (!overlay.Initialize()) GTEST_SKIP() << "no Direct3D 11 device";
+        overlay.UpdateStatus(3, word);
+        overlay.ShowPenalty(word);
+        EXPECT_TRUE(DrewALayer(overlay));
+        EXPECT_GE(overlay.GetFrameStats().frames, 1u);
+    }
+}
+
+TEST(D2DOverlayTest, StackedStylesShareOneDevice) {
+    const WordId word = Words().Intern("scheisse");
+    OverlayCompositor overlay(CreateD2DCompositorDevice());
+    overlay.AddLayer(CreateClassicLayer());
+    overlay.AddLayer(CreateBarLayer());
+    overlay.AddLayer(CreateVignetteLayer());
+    if (!overlay.Initialize()) GTEST_SKIP() << "no Direct3D 11 device";
+    overlay.ShowPenalty(word);
+    ASSERT_TRUE(DrewALayer(overlay));
+
+    // A new word and star level redraw; hiding stops drawing
+    const uint64_t before = overlay.GetFrameStats().frames;
+    overlay.UpdateStatus(5, Words().Intern("verdammt"));
+    EXPECT_TRUE(WaitFor([&] { return overlay.GetFrameStats().frames > before; }));
+    overlay.Hide();
+    std::this_thread::sleep_for(100ms);
+    const uint64_t hidden = overlay.GetFrameStats().frames;
+    std::this_thread::sleep_for(200ms);
+    EXPECT_EQ(overlay.GetFrameStats().frames, hidden);
+}
+
+// The layered-window device the overlay falls back to without Direct3D.
+TEST(D2DOverlayTest, SoftwareFallbackDrawsStackedStyles) {
+    ScopedEnv software("STRAF_OVERLAY_SOFTWARE", "1");
+    ScopedEnv style("STRAF_OVERLAY_STYLE", "classic+bar+vignette");
+    const WordId word = Words().Intern("scheisse");
+    auto overlay = CreateOverlayStub();
+    ASSERT_TRUE(overlay->Initialize());
+    overlay->ShowPenalty(word);
+    ASSERT_TRUE(DrewALayer(*overlay));
+
+    const uint64_t before = overlay->GetFrameStats().frames;
+    overlay->UpdateStatus(4, Words().Intern("verdammt"));
+    EXPECT_TRUE(WaitFor([&] { return overlay->GetFrameStats().frames > before; }));
+    overlay->Hide();
+}
+
+// Either device must come up: the GPU one, or the fallback when it can't.
+TEST(D2DOverlayTest, OverlayDrawsWithOrWithoutAGpu) {
+    auto overlay = CreateOverlayClassic();
+    ASSERT_TRUE(overlay->Initialize());
+    overlay->UpdateStatus(2, kNoWord);
+    overlay->ShowPenalty(Words().Intern("scheisse"));
+    EXPECT_TRUE(DrewALayer(*overlay));
+}
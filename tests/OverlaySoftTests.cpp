@@ -0,0 +1,164 @@
+// Golden-image tests for the software overlay layers (OverlaySoft.h).
+//
+// Every built-in style is drawn at each star level into a canvas sized to its
+// placement on three screens, and the frame's hash is compared with a
+// reference. The references are the hashes `straf_overlay_bench` prints; the
+// SSE2 and scalar paths produce identical pixels. After an intended change to
+// the drawing, check the frames it dumps and paste its new hashes here.
+#include "Straf/OverlaySoft.h"
+#include "Straf/WordTable.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+using namespace Straf;
+
+namespace {
+
+struct Screen {
+    const char* name;
+    float width, height;
+};
+
+struct Golden {
+    const char* screen;
+    const char* style;
+    int stars;
+    uint64_t hash;
+};
+
+constexpr Screen kScreens[] = {{"1080p", 1920, 1080}, {"1440p", 2560, 1440}, {"4K", 3840, 2160}};
+
+// Scene word "scheisse", version 1
+constexpr Golden kGolden[] = {
+    {"1080p", "classic", 1, 0x5a3080fc0843aaccull},
+    {"1080p", "classic", 2, 0x42565cc5681a865eull},
+    {"1080p", "classic", 3, 0x24547ab23e8528f9ull},
+    {"1080p", "classic", 4, 0x05462ffcd4e48a67ull},
+    {"1080p", "classic", 5, 0x0fa64dab6e6e6137ull},
+    {"1080p", "bar", 1, 0x6146f5158c496525ull},
+    {"1080p", "bar", 2, 0x3aac20032f8dc325ull},
+    {"1080p", "bar", 3, 0x3697d7f7c30cd0a5ull},
+    {"1080p", "bar", 4, 0x9d13491587804c25ull},
+    {"1080p", "bar", 5, 0xd7983c793fa9d125ull},
+    {"1080p", "vignette", 1, 0x457ba3d62ca3d84full},
+    {"1080p", "vignette", 2, 0xf072a849f90b35d4ull},
+    {"1080p", "vignette", 3, 0x68e076e39476fe77ull},
+    {"1080p", "vignette", 4, 0xf1e803c814e06232ull},
+    {"1080p", "vignette", 5, 0x6930d850b8aacb94ull},
+    {"1440p", "classic", 1, 0x5a3080fc0843aaccull},
+    {"1440p", "classic", 2, 0x42565cc5681a865eull},
+    {"1440p", "classic", 3, 0x24547ab23e8528f9ull},
+    {"1440p", "classic", 4, 0x05462ffcd4e48a67ull},
+    {"1440p", "classic", 5, 0x0fa64dab6e6e6137ull},
+    {"1440p", "bar", 1, 0x6146f5158c496525ull},
+    {"1440p", "bar", 2, 0x3aac20032f8dc325ull},
+    {"1440p", "bar", 3, 0x3697d7f7c30cd0a5ull},
+    {"1440p", "bar", 4, 0x9d13491587804c25ull},
+    {"1440p", "bar", 5, 0xd7983c793fa9d125ull},
+    {"1440p", "vignette", 1, 0xa0e9bf3fd22e3a67ull},
+    {"1440p", "vignette", 2, 0xf12c85289a213fb4ull},
+    {"1440p", "vignette", 3, 0xdec3fe380d491427ull},
+    {"1440p", "vignette", 4, 0x4df4096da869469aull},
+    {"1440p", "vignette", 5, 0x6e4e23e33572c58cull},
+    {"4K", "classic", 1, 0x5a3080fc0843aaccull},
+    {"4K", "classic", 2, 0x42565cc5681a865eull},
+    {"4K", "classic", 3, 0x24547ab23e8528f9ull},
+    {"4K", "classic", 4, 0x05462ffcd4e48a67ull},
+    {"4K", "classic", 5, 0x0fa64dab6e6e6137ull},
+    {"4K", "bar", 1, 0x6146f5158c496525ull},
+    {"4K", "bar", 2, 0x3aac20032f8dc325ull},
+    {"4K", "bar", 3, 0x3697d7f7c30cd0a5ull},
+    {"4K", "bar", 4, 0x9d13491587804c25ull},
+    {"4K", "bar", 5, 0xd7983c793fa9d125ull},
+    {"4K", "vignette", 1, 0x951c74830aa4034full},
+    {"4K", "vignette", 2, 0xddef4212e42888d4ull},
+    {"4K", "vignette", 3, 0xbd650b3270822a3full},
+    {"4K", "vignette", 4, 0xe16dd2b7c6d69ceaull},
+    {"4K", "vignette", 5, 0x71612ab0e62df984ull},
+};
+
+using Factory = std::unique_ptr<IOverlayLayer> (*)();
+
+Factory StyleFactory(std::string_view style) {
+    if (style == "classic") return CreateSoftClassicLayer;
+    if (style == "bar") return CreateSoftBarLayer;
+    if (style == "vignette") return CreateSoftVignetteLayer;
+    return nullptr;
+}
+
+const Screen* FindScreen(std::string_view name) {
+    for (const Screen& screen : kScreens) {
+        if (name == screen.name) return &screen;
+    }
+    return nullptr;
+}
+
+// Draws one frame of `layer` the way the soft device does: cleared surface
+// sized to the layer's placement.
+class LayerFrame {
+public:
+    LayerFrame(IOverlayLayer& layer, const Screen& screen) : layer_(layer) {
+        const OverlayRect place = layer.Placement(screen.width, screen.height);
+        pixels_.Resize(static_cast<int>(place.Width()), static_cast<int>(place.Height()));
+        canvas_.target = &pixels_;
+        ready_ = layer.CreateResources(canvas_);
+    }
+    ~LayerFrame() { layer_.ReleaseResources(); }
+
+    bool Ready() const { return ready_; }
+    uint64_t Draw(const OverlayScene& scene) {
+        pixels_.Clear();
+        layer_.Draw(canvas_, scene, std::chrono::steady_clock::now());
+        return pixels_.Hash();
+    }
+
+private:
+    IOverlayLayer& layer_;
+    SoftCanvas pixels_;
+    SoftOverlayCanvas canvas_;
+    bool ready_{false};
+};
+
+std::string Hex(uint64_t hash) {
+    char text[17];
+    std::snprintf(text, sizeof text, "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+} // namespace
+
+TEST(OverlaySoftTest, LayersMatchTheirReferenceFrames) {
+    const WordId word = Words().Intern("scheisse");
+    for (const Golden& golden : kGolden) {
+        SCOPED_TRACE(std::string(golden.screen) + " " + golden.style + " " + std::to_string(golden.stars) + " stars");
+        const Screen* screen = FindScreen(golden.screen);
+        const Factory make = StyleFactory(golden.style);
+        ASSERT_TRUE(screen && make);
+        auto layer = make();
+        ASSERT_EQ(layer->Name(), golden.style);
+        LayerFrame frame(*layer, *screen);
+        ASSERT_TRUE(frame.Ready());
+        EXPECT_EQ(Hex(frame.Draw(OverlayScene{true, golden.stars, word, 1})), Hex(golden.hash));
+    }
+}
+
+TEST(OverlaySoftTest, RedrawingASceneGivesTheSameFrame) {
+    const WordId word = Words().Intern("scheisse");
+    for (Factory make : {CreateSoftClassicLayer, CreateSoftBarLayer, CreateSoftVignetteLayer}) {
+        auto layer = make();
+        SCOPED_TRACE(std::string(layer->Name()));
+        LayerFrame frame(*layer, kScreens[0]);
+        ASSERT_TRUE(frame.Ready());
+        const uint64_t three = frame.Draw(OverlayScene{true, 3, word, 1});
+        const uint64_t five = frame.Draw(OverlayScene{true, 5, word, 2});
+        EXPECT_NE(three, five);
+        EXPECT_EQ(frame.Draw(OverlayScene{true, 3, word, 3}), three); // nothing left over from the last frame
+    }
+}
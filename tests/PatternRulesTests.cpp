@@ -0,0 +1,112 @@
+#include "Straf/PatternRules.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace Straf;
+
+TEST(PatternSet, IsPattern) {
+    EXPECT_TRUE(PatternSet::IsPattern("fu*"));
+    EXPECT_TRUE(PatternSet::IsPattern("re:ab+"));
+    EXPECT_FALSE(PatternSet::IsPattern("plain"));
+    EXPECT_FALSE(PatternSet::IsPattern(""));
+}
+
+TEST(PatternSet, Wildcards) {
+    PatternSet set;
+    ASSERT_TRUE(set.Compile({"fuck*", "*hole", "f*ck"}));
+    EXPECT_EQ(set.RuleCount(), 3u);
+    EXPECT_EQ(set.Match("fuck"), 0);
+    EXPECT_EQ(set.Match("fucking"), 0);
+    EXPECT_EQ(set.Match("pothole"), 1);
+    EXPECT_EQ(set.Match("hole"), 1);
+    EXPECT_EQ(set.Match("frack"), 2);
+    EXPECT_EQ(set.Match("fck"), 2);
+    EXPECT_EQ(set.Match("holes"), -1);
+    EXPECT_EQ(set.Match(""), -1);
+}
+
+TEST(PatternSet, BoundedRegex) {
+    PatternSet set;
+    ASSERT_TRUE(set.Compile({"re:sh[i1]t+", "re:(da|d)mn?", "re:x{2,3}"}));
+    EXPECT_EQ(set.Match("shit"), 0);
+    EXPECT_EQ(set.Match("sh1ttt"), 0);
+    EXPECT_EQ(set.Match("shi"), -1);
+    EXPECT_EQ(set.Match("damn"), 1);
+    EXPECT_EQ(set.Match("dam"), 1);
+    EXPECT_EQ(set.Match("dmn"), 1);
+    EXPECT_EQ(set.Match("x"), -1);
+    EXPECT_EQ(set.Match("xx"), 2);
+    EXPECT_EQ(set.Match("xxx"), 2);
+    EXPECT_EQ(set.Match("xxxx"), -1);
+}
+
+TEST(PatternSet, FirstListedRuleWins) {
+    PatternSet set;
+    ASSERT_TRUE(set.Compile({"re:ab", "re:a."}));
+    EXPECT_EQ(set.Match("ab"), 0);
+    EXPECT_EQ(set.Match("ac"), 1);
+}
+
+TEST(PatternSet, StemThatBecomesCertainDecidesEarly) {
+    PatternSet set;
+    ASSERT_TRUE(set.Compile({"re:ab", "a*"}));
+    EXPECT_EQ(set.Match("ab"), 1);
+    EXPECT_EQ(set.Match("abc"), 1);
+}
+
+TEST(PatternSet, MalformedRulesAreSkippedWithErrors) {
+    PatternSet set;
+    std::vector<std::string> errors;
+    ASSERT_TRUE(set.Compile({"re:(ab", "ok*", "re:a{1,99}"}, &errors));
+    EXPECT_EQ(errors.size(), 2u);
+    ASSERT_EQ(set.RuleCount(), 1u);
+    EXPECT_EQ(set.Rule(0), "ok*");
+    EXPECT_EQ(set.Match("okay"), 0);
+}
+
+TEST(PatternSet, StatesDoNotGrowWithRepeatedRules) {
+    PatternSet one;
+    ASSERT_TRUE(one.Compile({"bad*"}));
+    PatternSet many;
+    ASSERT_TRUE(many.Compile({"bad*", "bad*", "bad*", "bad*"}));
+    EXPECT_EQ(one.StateCount(), many.StateCount());
+}
+
+TEST(PatternSet, RulesThatNeedSpacesOrPunctuationAreRejected) {
+    PatternSet set;
+    std::vector<std::string> errors;
+    ASSERT_TRUE(set.Compile({"bad *", "re:you suck", "re:a-b", "re:(x y|xy)", "re:[-_.]+", "re:a?", "re: *"}, &errors));
+    EXPECT_EQ(errors.size(), 5u);
+    ASSERT_EQ(set.RuleCount(), 2u);
+    EXPECT_EQ(set.Rule(0), "re:(x y|xy)");
+    EXPECT_EQ(set.Rule(1), "re:a?");
+    EXPECT_EQ(set.Match("xy"), 0);
+    EXPECT_EQ(set.Match("a"), 1);
+}
+
+TEST(PatternSet, NestedRepeatsBeyondStateLimitAreRejected) {
+    PatternSet set;
+    std::vector<std::string> errors;
+    ASSERT_TRUE(set.Compile({"re:((a{32}){32}){32}", "re:((ab){32}){32}", "re:(ab{2,4}){8}"}, &errors));
+    ASSERT_EQ(errors.size(), 2u);
+    EXPECT_NE(errors[0].find("states"), std::string::npos);
+    ASSERT_EQ(set.RuleCount(), 1u);
+    EXPECT_EQ(set.Match("abbabbbbabbbabbabbabbabbbabb"), 0);
+    EXPECT_EQ(set.Match("abbabbbbabbbabbabbabbabbbab"), -1);
+}
+
+TEST(PatternSet, EquivalentRulesMinimizeToTheSameStates) {
+    // Lengths 2 to 5: start, one state per count, the dead state
+    PatternSet counted;
+    ASSERT_TRUE(counted.Compile({"re:a{2,5}"}));
+    EXPECT_EQ(counted.StateCount(), 7u);
+    PatternSet spelled;
+    ASSERT_TRUE(spelled.Compile({"re:(a|aa)(a|aa)a?"}));
+    EXPECT_EQ(spelled.StateCount(), 7u);
+    EXPECT_EQ(spelled.Match("a"), -1);
+    EXPECT_EQ(spelled.Match("aaaaa"), 0);
+    EXPECT_EQ(spelled.Match("aaaaaa"), -1);
+}
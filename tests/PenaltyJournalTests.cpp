@@ -0,0 +1,159 @@
+#include "Straf/PenaltyJournal.h"
+#include "Straf/Overlay.h"
+#include "Straf/PenaltyManager.h"
+#include "Straf/WordStats.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+class NullOverlay : public IOverlayRenderer {
+public:
+    bool Initialize() override { return true; }
+    void ShowPenalty(WordId) override {}
+    void UpdateStatus(int, WordId) override {}
+    void Hide() override {}
+};
+
+class PenaltyJournalTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() /
+              ("straf_journal_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(dir);
+    }
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    std::unique_ptr<PenaltyJournal> Open(size_t snapshotEvery = 4096) {
+        JournalOptions options;
+        options.snapshotEvery = snapshotEvery;
+        options.flushDelay = 0ms;
+        return PenaltyJournal::Open(dir.string(), options);
+    }
+
+    std::filesystem::path dir;
+    const std::string shortLabel = "jerk";
+    const std::string longLabel = "you absolute walking disaster of a teammate"; // 44 bytes: one tail
+    const std::string longerLabel = std::string(100, 'x') + " and then some";    // four tails
+};
+
+} // namespace
+
+TEST_F(PenaltyJournalTest, LongLabelsRestoreInFull) {
+    const auto at = std::chrono::steady_clock::now() + 1h;
+    {
+        auto journal = Open();
+        ASSERT_TRUE(journal);
+        journal->Append(JournalRecordType::Phrase, Words().Intern(longLabel), at);
+        journal->Append(JournalRecordType::Phrase, Words().Intern(longerLabel), at);
+        journal->Append(JournalRecordType::Queued, Words().Intern(shortLabel), {}, 5s);
+        journal->Append(JournalRecordType::Queued, Words().Intern(longerLabel), {}, 8s);
+        journal->Append(JournalRecordType::Started, Words().Intern(shortLabel), at, 5s);
+        journal->Flush();
+    }
+    auto journal = Open();
+    ASSERT_TRUE(journal);
+    const RecoveredPenaltyState& state = journal->Recovered();
+    ASSERT_EQ(state.phrases.size(), 2u);
+    for (const auto& [label, until] : state.phrases) {
+        EXPECT_TRUE(label == longLabel || label == longerLabel) << label;
+        EXPECT_GT(until, std::chrono::steady_clock::now());
+    }
+    ASSERT_TRUE(state.current);
+    EXPECT_EQ(state.current->label, shortLabel);
+    ASSERT_EQ(state.queue.size(), 1u);
+    EXPECT_EQ(state.queue[0].label, longerLabel);
+    EXPECT_EQ(state.queue[0].duration, 8s);
+}
+
+TEST_F(PenaltyJournalTest, LongLabelsSurviveSnapshots) {
+    const auto at = std::chrono::steady_clock::now() + 1h;
+    {
+        auto journal = Open(4);
+        for (int i = 0; i < 10; ++i) journal->Append(JournalRecordType::Phrase, Words().Intern(longerLabel + std::to_string(i)), at);
+    }
+    EXPECT_TRUE(std::filesystem::exists(dir / "penalty.snap"));
+    auto journal = Open(4);
+    EXPECT_EQ(journal->Recovered().phrases.size(), 10u);
+}
+
+TEST_F(PenaltyJournalTest, TornLabelTailDropsOnlyThatRecord) {
+    const auto at = std::chrono::steady_clock::now() + 1h;
+    {
+        auto journal = Open();
+        journal->Append(JournalRecordType::Phrase, Words().Intern(shortLabel), at);
+        journal->Append(JournalRecordType::Phrase, Words().Intern(longerLabel), at);
+        journal->Flush();
+    }
+    const auto path = dir / "penalty.journal";
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - sizeof(JournalRecord));
+    auto journal = Open();
+    ASSERT_EQ(journal->Recovered().phrases.size(), 1u);
+    EXPECT_EQ(journal->Recovered().phrases[0].first, shortLabel);
+    EXPECT_EQ(std::filesystem::file_size(path), sizeof(JournalRecord)); // the torn record is cut off
+}
+
+TEST_F(PenaltyJournalTest, OverlongLabelIsDroppedNotTruncated) {
+    auto journal = Open();
+    EXPECT_FALSE(journal->Append(JournalRecordType::Queued, Words().Intern(std::string(JournalRecord::kMaxLabelBytes + 1, 'y'))));
+    EXPECT_EQ(journal->GetStats().dropped, 1u);
+}
+
+// A penalty that expired while the agent was down is ended in the journal
+// too, not recovered again on every restart.
+TEST_F(PenaltyJournalTest, PenaltyExpiredWhileDownIsJournaledAsEnded) {
+    const WordId word = Words().Intern(shortLabel);
+    const auto expiredAt = std::chrono::steady_clock::now() - 1s;
+    {
+        auto journal = Open();
+        ASSERT_TRUE(journal);
+        journal->Append(JournalRecordType::Queued, word, {}, 5s);
+        journal->Append(JournalRecordType::Started, word, expiredAt, 5s);
+        journal->Flush();
+    }
+    NullOverlay overlay;
+    {
+        auto journal = Open();
+        ASSERT_TRUE(journal);
+        ASSERT_TRUE(journal->Recovered().current);
+        auto manager = CreatePenaltyManager(&overlay);
+        manager->Configure(5, 5s, 60s);
+        manager->AttachJournal(std::move(journal));
+        EXPECT_EQ(manager->GetStarCount(), 0);
+    }
+    auto journal = Open();
+    ASSERT_TRUE(journal);
+    const RecoveredPenaltyState& state = journal->Recovered();
+    EXPECT_FALSE(state.current);
+    ASSERT_TRUE(state.cooldownEnd);
+    // Wall-clock milliseconds round-trip through the journal
+    EXPECT_NEAR(std::chrono::duration<double>(*state.cooldownEnd - (expiredAt + 60s)).count(), 0.0, 0.05);
+}
+
+// A long phrase's cooldown must outlive a restart: the restored label has to
+// intern to the same id the detector reports.
+TEST_F(PenaltyJournalTest, PhraseCooldownOfLongPhraseSurvivesRestart) {
+    const WordId phrase = Words().Intern(longLabel);
+    NullOverlay overlay;
+    PenaltyPolicy policy;
+    policy.debounce = 0ms; // only the phrase cooldown can reject the repeat
+    {
+        auto manager = CreatePenaltyManager(&overlay);
+        manager->SetPolicy(policy);
+        manager->AttachJournal(Open());
+        manager->Trigger(phrase);
+        EXPECT_EQ(manager->GetQueueStats().outcomes[static_cast<size_t>(WordOutcome::Triggered)], 1u);
+    }
+    auto manager = CreatePenaltyManager(&overlay);
+    manager->SetPolicy(policy);
+    manager->AttachJournal(Open());
+    manager->Trigger(phrase);
+    EXPECT_EQ(manager->GetQueueStats().outcomes[static_cast<size_t>(WordOutcome::PhraseCooldown)], 1u);
+}
@@ -0,0 +1,168 @@
+#include "Straf/PenaltyManager.h"
+#include "Straf/Overlay.h"
+#include "Straf/WordStats.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Remembers what the manager asked the overlay to show.
+class RecordingOverlay : public IOverlayRenderer {
+public:
+    bool Initialize() override { return true; }
+    void ShowPenalty(WordId word) override { shown.push_back(word); }
+    void UpdateStatus(int s, WordId) override { stars = s; }
+    void Hide() override { ++hides; }
+
+    std::vector<WordId> shown;
+    int stars{0};
+    int hides{0};
+};
+
+// Drives a manager synchronously on a virtual clock; no manager thread.
+class PenaltyManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        manager = CreatePenaltyManager(&overlay, &clock);
+        manager->Configure(5, 10s, 1s);
+    }
+
+    // Advances the clock and lets the manager act on it.
+    void Advance(std::chrono::milliseconds d) {
+        clock.Advance(d);
+        manager->Tick();
+    }
+
+    uint64_t Outcome(WordOutcome outcome) const {
+        return manager->GetQueueStats().outcomes[static_cast<size_t>(outcome)];
+    }
+
+    RecordingOverlay overlay;
+    VirtualClock clock;
+    std::unique_ptr<IPenaltyManager> manager;
+    WordId alpha = Words().Intern("pm-alpha");
+    WordId beta = Words().Intern("pm-beta");
+    WordId gamma = Words().Intern("pm-gamma");
+};
+
+} // namespace
+
+TEST_F(PenaltyManagerTest, PenaltyRunsForItsDurationThenHides) {
+    manager->Trigger(alpha);
+    EXPECT_EQ(manager->GetStarCount(), 1);
+    EXPECT_EQ(Outcome(WordOutcome::Triggered), 1u);
+    EXPECT_TRUE(overlay.shown.empty());
+
+    manager->Tick();
+    ASSERT_EQ(overlay.shown, std::vector<WordId>{alpha});
+    EXPECT_EQ(overlay.stars, 1);
+    ASSERT_TRUE(manager->NextDeadline());
+
+    // First offence: 5 s from the default progressive table
+    Advance(4999ms);
+    EXPECT_EQ(manager->GetStarCount(), 1);
+    EXPECT_EQ(overlay.hides, 0);
+    Advance(1ms);
+    EXPECT_EQ(manager->GetStarCount(), 0);
+    EXPECT_EQ(overlay.hides, 1);
+    EXPECT_EQ(overlay.stars, 0);
+}
+
+TEST_F(PenaltyManagerTest, DebounceRejectsBurstsThenAllowsAgain) {
+    manager->Trigger(alpha);
+    Advance(1s);
+    manager->Trigger(beta);
+    EXPECT_EQ(Outcome(WordOutcome::Debounced), 1u);
+    Advance(2s);
+    manager->Trigger(beta);
+    EXPECT_EQ(Outcome(WordOutcome::Triggered), 2u);
+    EXPECT_EQ(manager->GetStarCount(), 2);
+}
+
+TEST_F(PenaltyManagerTest, PhraseCooldownAppliesPerWord) {
+    manager->Trigger(alpha);
+    Advance(4s);
+    manager->Trigger(alpha);
+    EXPECT_EQ(Outcome(WordOutcome::PhraseCooldown), 1u);
+    manager->Trigger(beta);
+    EXPECT_EQ(Outcome(WordOutcome::Triggered), 2u);
+    Advance(11s);
+    Advance(3s); // past beta's debounce too
+    manager->Trigger(alpha);
+    EXPECT_EQ(Outcome(WordOutcome::Triggered), 3u);
+}
+
+TEST_F(PenaltyManagerTest, QueueLimitAndProgressiveDurations) {
+    PenaltyPolicy policy;
+    policy.debounce = 0ms;
+    policy.phraseCooldown = 0ms;
+    policy.progressiveDurations = {1000ms, 2000ms};
+    manager->SetPolicy(policy);
+    manager->Configure(2, 10s, 500ms);
+
+    manager->Trigger(alpha); // queued at 0 stars: 1 s
+    manager->Trigger(beta);  // queued at 1 star: 2 s
+    manager->Trigger(gamma);
+    EXPECT_EQ(Outcome(WordOutcome::QueueFull), 1u);
+    EXPECT_EQ(manager->GetStarCount(), 2);
+
+    manager->Tick();
+    Advance(1s); // alpha ends, cooldown holds beta back
+    EXPECT_EQ(overlay.shown, std::vector<WordId>{alpha});
+    EXPECT_EQ(manager->GetStarCount(), 1);
+    EXPECT_EQ(overlay.hides, 0);
+    Advance(500ms);
+    EXPECT_EQ(overlay.shown, (std::vector<WordId>{alpha, beta}));
+    Advance(1999ms);
+    EXPECT_EQ(manager->GetStarCount(), 1);
+    Advance(1ms);
+    EXPECT_EQ(manager->GetStarCount(), 0);
+    EXPECT_EQ(overlay.hides, 1);
+}
+
+TEST_F(PenaltyManagerTest, IdleManagerHasNoDeadline) {
+    EXPECT_FALSE(manager->NextDeadline());
+    manager->Trigger(alpha);
+    manager->Tick();
+    Advance(5s);  // penalty over
+    Advance(15s); // cooldown, debounce and phrase cooldown over
+    EXPECT_FALSE(manager->NextDeadline());
+}
+
+TEST_F(PenaltyManagerTest, PumpAppliesSubmittedDetectionsThenTicks) {
+    ASSERT_TRUE(manager->Submit(DetectionEvent{alpha}));
+    ASSERT_TRUE(manager->Submit(DetectionEvent{beta}));
+    EXPECT_EQ(manager->GetStarCount(), 0);
+    manager->Pump();
+    const PenaltyQueueStats stats = manager->GetQueueStats();
+    EXPECT_EQ(stats.submitted, 2u);
+    EXPECT_EQ(stats.applied, 2u);
+    EXPECT_EQ(Outcome(WordOutcome::Triggered), 1u);
+    EXPECT_EQ(Outcome(WordOutcome::Debounced), 1u);
+    // The tick in the same pass started the queued penalty
+    EXPECT_EQ(overlay.shown, (std::vector<WordId>{alpha}));
+}
+
+TEST(PenaltyManagerThread, SubmittedDetectionsAreApplied) {
+    RecordingOverlay overlay;
+    auto manager = CreatePenaltyManager(&overlay);
+    manager->Start();
+    ASSERT_TRUE(manager->Submit(DetectionEvent{Words().Intern("pm-thread")}));
+    const auto until = std::chrono::steady_clock::now() + 5s;
+    while (manager->GetQueueStats().applied == 0 && std::chrono::steady_clock::now() < until) {
+        std::this_thread::sleep_for(1ms);
+    }
+    manager->Stop();
+    const PenaltyQueueStats stats = manager->GetQueueStats();
+    EXPECT_EQ(stats.submitted, 1u);
+    EXPECT_EQ(stats.applied, 1u);
+    EXPECT_EQ(stats.outcomes[static_cast<size_t>(WordOutcome::Triggered)], 1u);
+    EXPECT_EQ(manager->GetStarCount(), 1);
+}
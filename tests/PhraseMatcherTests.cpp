@@ -0,0 +1,86 @@
+#include "Straf/PhraseMatcher.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+class PhraseMatcherTest : public ::testing::Test {
+protected:
+    using clock = PhraseMatcher::clock;
+
+    // Feeds each whitespace-separated token of `text` at `now` and returns the
+    // matched phrases in match order.
+    std::vector<std::string> Feed(const std::string& text, clock::time_point now) {
+        std::vector<std::string> matched;
+        std::istringstream in(text);
+        for (std::string token; in >> token;) {
+            matcher.Feed(cursor, token, now, window, silence, [&](size_t i) { matched.push_back(matcher.Phrase(i)); });
+        }
+        return matched;
+    }
+
+    PhraseMatcher matcher;
+    PhraseMatcher::Cursor cursor;
+    clock::duration window = 4s;
+    clock::duration silence = 2s;
+    clock::time_point t0 = clock::time_point{} + 1h;
+};
+
+} // namespace
+
+TEST_F(PhraseMatcherTest, SingleWordsAndPhrases) {
+    matcher.Build({"bad", "Very Bad Word", "word"});
+    EXPECT_EQ(matcher.PhraseCount(), 3u);
+    EXPECT_EQ(matcher.MaxDepth(), 3u);
+    EXPECT_EQ(matcher.Phrase(1), "very bad word");
+    EXPECT_EQ(Feed("a very bad word here", t0), (std::vector<std::string>{"bad", "very bad word", "word"}));
+}
+
+TEST_F(PhraseMatcherTest, EmptyEntriesIgnored) {
+    matcher.Build({"", "ok"});
+    EXPECT_EQ(matcher.PhraseCount(), 1u);
+    EXPECT_EQ(Feed("ok", t0), (std::vector<std::string>{"ok"}));
+}
+
+TEST_F(PhraseMatcherTest, OverlappingPhrasesFollowFailureLinks) {
+    matcher.Build({"a b c", "b c d", "c"});
+    EXPECT_EQ(Feed("a b c d", t0), (std::vector<std::string>{"a b c", "c", "b c d"}));
+}
+
+TEST_F(PhraseMatcherTest, PhraseSpansCallsWithinWindow) {
+    matcher.Build({"shut up now"});
+    EXPECT_TRUE(Feed("shut", t0).empty());
+    EXPECT_TRUE(Feed("up", t0 + 1s).empty());
+    EXPECT_EQ(Feed("now", t0 + 2s), (std::vector<std::string>{"shut up now"}));
+}
+
+TEST_F(PhraseMatcherTest, PhraseLongerThanWindowDoesNotMatch) {
+    matcher.Build({"shut up now"});
+    window = 1s;
+    EXPECT_TRUE(Feed("shut", t0).empty());
+    EXPECT_TRUE(Feed("up", t0 + 500ms).empty());
+    EXPECT_TRUE(Feed("now", t0 + 1500ms).empty());
+    EXPECT_EQ(Feed("shut up now", t0 + 2s), (std::vector<std::string>{"shut up now"}));
+}
+
+TEST_F(PhraseMatcherTest, SilenceResetsState) {
+    matcher.Build({"go away"});
+    Feed("go", t0);
+    EXPECT_TRUE(Feed("away", t0 + 2500ms).empty());
+    EXPECT_EQ(Feed("go away", t0 + 3s), (std::vector<std::string>{"go away"}));
+}
+
+TEST_F(PhraseMatcherTest, CursorResetForgetsPrefix) {
+    matcher.Build({"go away"});
+    Feed("go", t0);
+    cursor.Reset();
+    EXPECT_TRUE(Feed("away", t0).empty());
+}
@@ -0,0 +1,135 @@
+// Hot-reload stress test for the detector and the penalty manager.
+//
+// Each analyzer thread owns a text detector and feeds it utterances that
+// contain words of two vocabularies, A and B; the test thread swaps every
+// detector between A and B (each padded so compiling costs something) and
+// reconfigures a running PenaltyManager that the detections are submitted to,
+// as fast as it can. Every AnalyzeText call matches against one vocabulary,
+// so its detections must all come from the same set; a mix means analysis saw
+// a torn or half-built vocabulary.
+#include "Straf/Detector.h"
+#include "Straf/Overlay.h"
+#include "Straf/PenaltyManager.h"
+#include "Straf/WordTable.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr int kAnalyzers = 3;
+constexpr size_t kEntries = 500;
+constexpr auto kDuration = 1s;
+
+class NullOverlay : public IOverlayRenderer {
+public:
+    bool Initialize() override { return true; }
+    void ShowPenalty(WordId) override {}
+    void UpdateStatus(int, WordId) override {}
+    void Hide() override {}
+};
+
+std::vector<std::string> Vocabulary(const char* word, const char* phrase, const char* pattern, size_t entries) {
+    std::vector<std::string> v{word, phrase, pattern};
+    for (size_t i = v.size(); i < entries; ++i) v.push_back(std::string(word) + std::to_string(i));
+    return v;
+}
+
+std::unordered_set<WordId> RuleIds(const std::vector<std::string>& vocabulary) {
+    std::unordered_set<WordId> ids;
+    for (const auto& entry : vocabulary) ids.insert(Words().Intern(entry));
+    return ids;
+}
+
+struct AnalyzerResult {
+    uint64_t calls{0};
+    uint64_t detections{0};
+    uint64_t mixed{0};
+};
+
+} // namespace
+
+TEST(ReloadStressTest, AnalysisNeverSeesTwoVocabulariesAtOnce) {
+    const auto vocabA = Vocabulary("rsalpha", "red apple", "ap*le", kEntries);
+    const auto vocabB = Vocabulary("rsbeta", "blue berry", "be*ry", kEntries);
+    const auto idsA = RuleIds(vocabA);
+    const auto idsB = RuleIds(vocabB);
+    const std::string utterance = "rsalpha rsbeta red apple blue berry apple berry rsalpha7 rsbeta9";
+
+    NullOverlay overlay;
+    auto penalties = CreatePenaltyManager(&overlay);
+    penalties->Start();
+
+    std::vector<std::unique_ptr<ITextDetector>> detectors;
+    for (int i = 0; i < kAnalyzers; ++i) {
+        detectors.push_back(CreateTextAnalysisDetector());
+        ASSERT_TRUE(detectors.back()->Initialize(vocabA));
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<AnalyzerResult> results(kAnalyzers);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kAnalyzers; ++i) {
+        threads.emplace_back([&, i] {
+            AnalyzerResult& r = results[i];
+            bool sawA = false, sawB = false;
+            detectors[i]->Start([&](const DetectionResult& d) {
+                ++r.detections;
+                sawA = sawA || idsA.count(d.rule) > 0;
+                sawB = sawB || idsB.count(d.rule) > 0;
+                penalties->Submit(DetectionEvent{d.word, d.source, d.confidence});
+            });
+            while (!stop.load(std::memory_order_relaxed)) {
+                sawA = sawB = false;
+                detectors[i]->AnalyzePartial(utterance);
+                detectors[i]->AnalyzeText(utterance);
+                if (sawA && sawB) ++r.mixed;
+                ++r.calls;
+            }
+            detectors[i]->Stop();
+        });
+    }
+
+    // Alternate vocabularies and penalty settings back to back
+    uint64_t reloads = 0;
+    const auto deadline = std::chrono::steady_clock::now() + kDuration;
+    for (; std::chrono::steady_clock::now() < deadline; ++reloads) {
+        const bool useB = reloads % 2 == 0;
+        for (auto& detector : detectors) detector->Reload(useB ? vocabB : vocabA, PhraseStreamOptions{});
+        penalties->Configure(useB ? 3 : 5, 10s, useB ? 50ms : 100ms);
+        PenaltyPolicy policy;
+        policy.debounce = useB ? 1ms : 2ms;
+        policy.phraseCooldown = useB ? 5ms : 10ms;
+        penalties->SetPolicy(policy);
+    }
+    stop = true;
+    for (auto& t : threads) t.join();
+    penalties->Stop();
+
+    AnalyzerResult total;
+    for (const auto& r : results) {
+        total.calls += r.calls;
+        total.detections += r.detections;
+        total.mixed += r.mixed;
+    }
+    const auto queue = penalties->GetQueueStats();
+    RecordProperty("reloads", static_cast<int>(reloads));
+    RecordProperty("calls", static_cast<int>(total.calls));
+
+    EXPECT_GT(reloads, 1u);
+    EXPECT_GT(total.calls, 0u);
+    EXPECT_GT(total.detections, 0u);
+    EXPECT_EQ(total.mixed, 0u);
+    EXPECT_EQ(queue.applied, queue.submitted);
+}
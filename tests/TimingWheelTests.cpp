@@ -0,0 +1,213 @@
+#include "Straf/TimingWheel.h"
+#include "Straf/Clock.h"
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Drives a 1 ms wheel from a VirtualClock and records what fired and when.
+class TimingWheelTest : public ::testing::Test {
+protected:
+    TimingWheel::clock::time_point At(TimingWheel::clock::duration d) const { return start + d; }
+
+    size_t AdvanceTo(TimingWheel::clock::duration d) {
+        clock.Set(At(d));
+        return wheel.Advance(clock.Now(), [this](uint64_t tag) { fired.push_back({tag, clock.Now() - start}); });
+    }
+
+    struct Fired {
+        uint64_t tag;
+        TimingWheel::clock::duration at;
+        bool operator==(const Fired&) const = default;
+    };
+
+    VirtualClock clock;
+    const TimingWheel::clock::time_point start = clock.Now();
+    TimingWheel wheel{1ms, start};
+    std::vector<Fired> fired;
+};
+
+} // namespace
+
+TEST_F(TimingWheelTest, TimersCascadeDownToTheirExactTick) {
+    // One timer per level: 64, 64^2 and 64^3 ticks are the level boundaries
+    wheel.Schedule(At(40ms), 0);
+    wheel.Schedule(At(100ms), 1);
+    wheel.Schedule(At(5000ms), 2);
+    wheel.Schedule(At(300000ms), 3);
+    EXPECT_EQ(wheel.Size(), 4u);
+
+    // Stepping one tick at a time through each deadline fires it there and not before
+    for (auto [tag, due] : {std::pair{0, 40ms}, {1, 100ms}, {2, 5000ms}, {3, 300000ms}}) {
+        EXPECT_EQ(AdvanceTo(due - 2ms), 0u);
+        EXPECT_EQ(AdvanceTo(due - 1ms), 0u);
+        EXPECT_EQ(AdvanceTo(due), 1u);
+        EXPECT_EQ(fired.back(), (Fired{static_cast<uint64_t>(tag), due}));
+    }
+    EXPECT_TRUE(wheel.Empty());
+}
+
+TEST_F(TimingWheelTest, OneAdvanceFiresInDeadlineOrder) {
+    wheel.Schedule(At(300000ms), 3);
+    wheel.Schedule(At(4097ms), 2);
+    wheel.Schedule(At(65ms), 1);
+    wheel.Schedule(At(2ms), 0);
+    wheel.Schedule(At(-5ms), 9); // already due: fires on the next tick
+    std::vector<uint64_t> order;
+    clock.Set(At(1h));
+    EXPECT_EQ(wheel.Advance(clock.Now(), [&](uint64_t tag) { order.push_back(tag); }), 5u);
+    EXPECT_EQ(order, (std::vector<uint64_t>{9, 0, 1, 2, 3}));
+}
+
+TEST_F(TimingWheelTest, DeadlinesRoundUpToTheNextTick) {
+    wheel.Schedule(At(10ms + 1us), 7);
+    EXPECT_EQ(AdvanceTo(10ms), 0u);
+    EXPECT_EQ(AdvanceTo(11ms), 1u);
+}
+
+TEST_F(TimingWheelTest, CancelledTimersNeverFire) {
+    const auto near = wheel.Schedule(At(20ms), 1);
+    const auto cascaded = wheel.Schedule(At(5000ms), 2);
+    const auto kept = wheel.Schedule(At(5001ms), 3);
+    EXPECT_TRUE(wheel.Pending(near));
+    EXPECT_TRUE(wheel.Cancel(near));
+    EXPECT_FALSE(wheel.Pending(near));
+    EXPECT_FALSE(wheel.Cancel(near));
+
+    // Cancel after the timer was cascaded from level 2 into level 0
+    EXPECT_EQ(AdvanceTo(4990ms), 0u);
+    EXPECT_TRUE(wheel.Cancel(cascaded));
+    EXPECT_EQ(AdvanceTo(5000ms), 0u);
+    EXPECT_EQ(AdvanceTo(5001ms), 1u);
+    EXPECT_EQ(fired, (std::vector<Fired>{{3, 5001ms}}));
+    EXPECT_FALSE(wheel.Pending(kept));
+    EXPECT_FALSE(wheel.Cancel(kept));
+    EXPECT_FALSE(wheel.Cancel(TimingWheel::kNoTimer));
+
+    // A recycled node gets a new id; the old one stays dead
+    const auto reused = wheel.Schedule(At(7000ms), 4);
+    EXPECT_NE(reused, kept);
+    EXPECT_FALSE(wheel.Cancel(kept));
+    EXPECT_TRUE(wheel.Pending(reused));
+}
+
+TEST_F(TimingWheelTest, CallbacksMayScheduleAndCancel) {
+    TimingWheel::TimerId victim = wheel.Schedule(At(30ms), 99);
+    wheel.Schedule(At(10ms), 1);
+    std::vector<uint64_t> order;
+    clock.Set(At(100ms));
+    wheel.Advance(clock.Now(), [&](uint64_t tag) {
+        order.push_back(tag);
+        if (tag == 1) {
+            wheel.Cancel(victim);
+            wheel.Schedule(At(20ms), 2);
+            wheel.Schedule(At(500ms), 3); // beyond this Advance
+        }
+    });
+    EXPECT_EQ(order, (std::vector<uint64_t>{1, 2}));
+    EXPECT_EQ(wheel.Size(), 1u);
+}
+
+TEST_F(TimingWheelTest, NextExpiryIsExactNearbyAndALowerBoundFarAway) {
+    EXPECT_FALSE(wheel.NextExpiry());
+    wheel.Schedule(At(50ms), 1);
+    EXPECT_EQ(wheel.NextExpiry(), At(50ms));
+
+    wheel.Cancel(wheel.Schedule(At(20ms), 2));
+    EXPECT_EQ(wheel.NextExpiry(), At(50ms));
+    AdvanceTo(50ms);
+    EXPECT_FALSE(wheel.NextExpiry());
+
+    // Far timers report the slot to cascade, never later than the deadline
+    wheel.Schedule(At(200000ms), 3);
+    const auto bound = wheel.NextExpiry();
+    ASSERT_TRUE(bound);
+    EXPECT_LE(*bound, At(200000ms));
+    EXPECT_GT(*bound, At(50ms));
+
+    // Sleeping until each reported expiry reaches the timer without missing it
+    int wakeups = 0;
+    while (fired.size() < 2 && wakeups < 16) {
+        const auto next = wheel.NextExpiry();
+        ASSERT_TRUE(next);
+        clock.Set(*next);
+        wheel.Advance(clock.Now(), [this](uint64_t tag) { fired.push_back({tag, clock.Now() - start}); });
+        ++wakeups;
+    }
+    EXPECT_EQ(fired.back(), (Fired{3, 200000ms}));
+    EXPECT_LE(wakeups, 4);
+}
+
+TEST_F(TimingWheelTest, DeadlinesPastTheTopLevelWaitInOverflow) {
+    // 64^4 ms is about 4.66 hours
+    wheel.Schedule(At(10h), 1);
+    wheel.Schedule(At(30h + 7ms), 2);
+    wheel.Schedule(At(2h), 0);
+    const auto next = wheel.NextExpiry();
+    ASSERT_TRUE(next);
+    EXPECT_LE(*next, At(2h));
+
+    EXPECT_EQ(AdvanceTo(2h), 1u);
+    EXPECT_EQ(AdvanceTo(10h - 1ms), 0u);
+    EXPECT_EQ(AdvanceTo(10h), 1u);
+    EXPECT_EQ(AdvanceTo(30h + 6ms), 0u);
+    EXPECT_EQ(AdvanceTo(30h + 7ms), 1u);
+    EXPECT_EQ(fired, (std::vector<Fired>{{0, 2h}, {1, 10h}, {2, 30h + 7ms}}));
+
+    // Only an overflow timer left: the bound is the next top-level revolution
+    wheel.Schedule(At(60h), 3);
+    EXPECT_LE(*wheel.NextExpiry(), At(60h));
+    EXPECT_GT(*wheel.NextExpiry(), At(30h + 7ms));
+}
+
+TEST_F(TimingWheelTest, MatchesASortedReference) {
+    std::mt19937_64 rng(31);
+    std::multimap<std::chrono::milliseconds, uint64_t> reference;
+    std::map<uint64_t, TimingWheel::TimerId> ids;
+    auto now = 0ms;
+    uint64_t nextTag = 0;
+    for (int round = 0; round < 2000; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            // Mostly near deadlines, some across every level and past the top
+            const int bits = static_cast<int>(rng() % 27);
+            const auto due = now + std::chrono::milliseconds(1 + rng() % (uint64_t{1} << bits));
+            ids[nextTag] = wheel.Schedule(At(due), nextTag);
+            reference.emplace(due, nextTag++);
+        }
+        if (rng() % 3 == 0 && !ids.empty()) {
+            auto it = ids.begin();
+            std::advance(it, rng() % ids.size());
+            EXPECT_TRUE(wheel.Cancel(it->second));
+            std::erase_if(reference, [&](const auto& e) { return e.second == it->first; });
+            ids.erase(it);
+        }
+        now += std::chrono::milliseconds(rng() % (round % 50 == 0 ? 20000000 : 5000));
+        fired.clear();
+        AdvanceTo(now);
+        std::map<uint64_t, std::chrono::milliseconds> expected;
+        while (!reference.empty() && reference.begin()->first <= now) {
+            expected.emplace(reference.begin()->second, reference.begin()->first);
+            reference.erase(reference.begin());
+        }
+        // Exactly the due timers, in deadline order
+        ASSERT_EQ(fired.size(), expected.size()) << "round " << round;
+        auto last = 0ms;
+        for (const auto& f : fired) {
+            const auto it = expected.find(f.tag);
+            ASSERT_NE(it, expected.end()) << "round " << round;
+            EXPECT_LE(last, it->second);
+            last = it->second;
+            EXPECT_FALSE(wheel.Pending(ids[f.tag]));
+            ids.erase(f.tag);
+        }
+        EXPECT_EQ(wheel.Size(), reference.size());
+    }
+}
@@ -0,0 +1,202 @@
+#include "Straf/Trace.h"
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Straf;
+using nlohmann::json;
+
+namespace {
+
+class TraceTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        trace::Disable();
+        std::filesystem::remove(path);
+    }
+
+    json Export() {
+        EXPECT_TRUE(trace::WriteChromeJson(path));
+        std::ifstream in(path);
+        return json::parse(in);
+    }
+
+    // Events of the exported trace with the given phase ("X", "M", "s", "t").
+    static std::vector<json> Phase(const json& trace, const char* ph) {
+        std::vector<json> events;
+        for (const auto& e : trace["traceEvents"]) {
+            if (e["ph"] == ph) events.push_back(e);
+        }
+        return events;
+    }
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() /
+        ("straf_trace_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + ".json");
+};
+
+} // namespace
+
+TEST_F(TraceTest, DisabledTracingRecordsNothing) {
+    trace::Disable();
+    const auto before = trace::GetStats();
+    std::thread([] {
+        trace::Span span("test", "off");
+        span.Flow(trace::NewFlow());
+    }).join();
+    EXPECT_EQ(trace::GetStats().recorded, before.recorded);
+    EXPECT_EQ(trace::NewFlow(), 0u);
+}
+
+TEST_F(TraceTest, SpansAndFlowsOnTwoThreadsExportAsChromeJson) {
+    trace::Enable();
+    // The producer stays alive until the export: an exited thread's ring
+    // would be handed to the consumer
+    std::promise<uint64_t> handoff;
+    std::promise<void> exported;
+    std::thread producer([&] {
+        trace::SetThreadName("trace producer");
+        {
+            const uint64_t flow = trace::NewFlow();
+            trace::Span span("stt", "emit");
+            span.Flow(flow, trace::FlowPhase::Begin);
+            trace::FlowScope scope(flow);
+            EXPECT_EQ(trace::CurrentFlow(), flow);
+            handoff.set_value(trace::CurrentFlow());
+        }
+        EXPECT_EQ(trace::CurrentFlow(), 0u);
+        exported.get_future().wait();
+    });
+    const uint64_t flow = handoff.get_future().get();
+    ASSERT_NE(flow, 0u);
+    std::thread([flow] {
+        trace::SetThreadName("trace consumer");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1)); // after the producer's span
+        trace::Span span("detect", "match");
+        span.Flow(flow);
+    }).join();
+
+    const json trace = Export();
+    exported.set_value();
+    producer.join();
+    EXPECT_EQ(trace["displayTimeUnit"], "ms");
+    uint64_t producerTid = 0, consumerTid = 0;
+    for (const auto& m : Phase(trace, "M")) {
+        if (m["args"]["name"] == "trace producer") producerTid = m["tid"];
+        if (m["args"]["name"] == "trace consumer") consumerTid = m["tid"];
+    }
+    ASSERT_NE(producerTid, 0u);
+    ASSERT_NE(consumerTid, 0u);
+
+    double emitTs = -1, matchTs = -1;
+    for (const auto& x : Phase(trace, "X")) {
+        EXPECT_GE(x["dur"].get<double>(), 0.0);
+        if (x["name"] == "emit" && x["tid"] == producerTid) {
+            EXPECT_EQ(x["cat"], "stt");
+            emitTs = x["ts"];
+        }
+        if (x["name"] == "match" && x["tid"] == consumerTid) {
+            EXPECT_EQ(x["cat"], "detect");
+            matchTs = x["ts"];
+        }
+    }
+    ASSERT_GE(emitTs, 0.0);
+    ASSERT_GE(matchTs, emitTs);
+
+    // The arrow starts at the producerTid's span and ends at the consumerTid's
+    std::vector<json> begins, steps;
+    for (const auto& s : Phase(trace, "s")) if (s["id"] == flow) begins.push_back(s);
+    for (const auto& t : Phase(trace, "t")) if (t["id"] == flow) steps.push_back(t);
+    ASSERT_EQ(begins.size(), 1u);
+    ASSERT_EQ(steps.size(), 1u);
+    EXPECT_EQ(begins[0]["tid"], producerTid);
+    EXPECT_EQ(begins[0]["ts"], emitTs);
+    EXPECT_EQ(steps[0]["tid"], consumerTid);
+    EXPECT_EQ(steps[0]["ts"], matchTs);
+    EXPECT_EQ(steps[0]["bp"], "e");
+}
+
+TEST_F(TraceTest, RingKeepsTheLatestSpans) {
+    trace::Enable({64});
+    const auto before = trace::GetStats();
+    constexpr uint64_t kBase = 1u << 30; // flow ids tag the spans
+    std::thread([] {
+        for (uint64_t i = 0; i < 100; ++i) {
+            trace::Span span("test", "wrap");
+            span.Flow(kBase + i);
+        }
+    }).join();
+    const auto after = trace::GetStats();
+    EXPECT_EQ(after.recorded - before.recorded, 100u);
+    EXPECT_EQ(after.overwritten - before.overwritten, 36u);
+
+    std::vector<uint64_t> ids;
+    for (const auto& t : Phase(Export(), "t")) {
+        const uint64_t id = t["id"];
+        if (id >= kBase && id < kBase + 100) ids.push_back(id - kBase);
+    }
+    ASSERT_EQ(ids.size(), 64u);
+    for (size_t i = 0; i < ids.size(); ++i) EXPECT_EQ(ids[i], 36 + i);
+}
+
+TEST_F(TraceTest, ExportWhileRecordingSkipsTornSpans) {
+    trace::Enable({256});
+    std::atomic<bool> stop{false};
+    std::thread recorder([&] {
+        // Category and name always change together; a torn slot would mix them
+        for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+            if (i % 2) {
+                trace::Span span("odd", "odd span");
+                span.Flow(i);
+            } else {
+                trace::Span span("even", "even span");
+                span.Flow(i);
+            }
+        }
+    });
+    size_t seen = 0;
+    for (int round = 0; round < 20; ++round) {
+        const json trace = Export();
+        for (const auto& x : Phase(trace, "X")) {
+            if (x["cat"] == "odd") {
+                EXPECT_EQ(x["name"], "odd span");
+            } else if (x["cat"] == "even") {
+                EXPECT_EQ(x["name"], "even span");
+            }
+            seen += x["cat"] == "odd" || x["cat"] == "even";
+        }
+        for (const auto& t : Phase(trace, "t")) EXPECT_GT(t["id"].get<uint64_t>(), 0u);
+    }
+    stop.store(true);
+    recorder.join();
+    EXPECT_GT(seen, 0u);
+}
+
+TEST_F(TraceTest, ExitedThreadsHandTheirRingOn) {
+    trace::Enable({128});
+    const auto before = trace::GetStats();
+    auto record = [] {
+        std::thread([] { trace::Span span("test", "short-lived"); }).join();
+    };
+    record();
+    const uint64_t rings = trace::GetStats().rings;
+    EXPECT_LE(rings, before.rings + 1);
+    for (int i = 0; i < 16; ++i) record();
+    const auto after = trace::GetStats();
+    EXPECT_EQ(after.rings, rings);
+    EXPECT_EQ(after.threads - before.threads, 17u);
+    EXPECT_EQ(after.recorded - before.recorded, 17u);
+
+    // Only the latest owner's span is left in the reused ring
+    size_t spans = 0;
+    for (const auto& x : Phase(Export(), "X")) spans += x["name"] == "short-lived";
+    EXPECT_EQ(spans, 1u);
+}
@@ -0,0 +1,92 @@
+#include "Straf/TripleBuffer.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Large enough that copying it is not atomic; every word carries the same
+// sequence number, so a value mixed from two publishes is easy to spot.
+struct Snapshot {
+    std::array<uint64_t, 32> words{};
+
+    void Fill(uint64_t seq) { words.fill(seq); }
+    bool Whole() const {
+        for (uint64_t w : words) {
+            if (w != words[0]) return false;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+TEST(TripleBufferTest, RefreshReportsOnlyNewValues) {
+    TripleBuffer<int> buffer(7);
+    EXPECT_FALSE(buffer.Refresh());
+    EXPECT_EQ(buffer.Front(), 7);
+
+    buffer.Back() = 1;
+    buffer.Publish();
+    EXPECT_TRUE(buffer.Refresh());
+    EXPECT_EQ(buffer.Front(), 1);
+    EXPECT_FALSE(buffer.Refresh());
+    EXPECT_EQ(buffer.Front(), 1);
+}
+
+TEST(TripleBufferTest, ReaderSkipsToTheNewestValue) {
+    TripleBuffer<int> buffer;
+    for (int i = 1; i <= 5; ++i) {
+        buffer.Back() = i;
+        buffer.Publish();
+    }
+    EXPECT_TRUE(buffer.Refresh());
+    EXPECT_EQ(buffer.Front(), 5);
+    EXPECT_FALSE(buffer.Refresh());
+}
+
+// Writer and reader hammer the buffer concurrently; the reader must only ever
+// see whole snapshots, in publish order, and finally the last one.
+TEST(TripleBufferTest, ConcurrentReaderNeverSeesTornSnapshots) {
+    TripleBuffer<Snapshot> buffer;
+    std::atomic<bool> done{false};
+    uint64_t published = 0;
+
+    std::thread writer([&] {
+        const auto until = std::chrono::steady_clock::now() + 500ms;
+        while (std::chrono::steady_clock::now() < until) {
+            for (int i = 0; i < 256; ++i) {
+                buffer.Back().Fill(++published);
+                buffer.Publish();
+            }
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t torn = 0, backwards = 0, adopted = 0, last = 0;
+    auto check = [&] {
+        const Snapshot& s = buffer.Front();
+        if (!s.Whole()) ++torn;
+        if (s.words[0] < last) ++backwards;
+        last = s.words[0];
+        ++adopted;
+    };
+    while (!done.load(std::memory_order_acquire)) {
+        if (buffer.Refresh()) check();
+    }
+    writer.join();
+    if (buffer.Refresh()) check();
+
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(backwards, 0u);
+    EXPECT_GT(adopted, 0u);
+    EXPECT_EQ(last, published);
+}
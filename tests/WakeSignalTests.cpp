@@ -0,0 +1,66 @@
+#include "Straf/WakeSignal.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+
+namespace {
+using clock = WakeSignal::clock;
+}
+
+TEST(WakeSignal, DeadlinePassesWithoutNotify) {
+    WakeSignal signal;
+    EXPECT_FALSE(signal.WaitUntil(clock::now() + 1ms));
+    EXPECT_EQ(signal.Wakeups(), 1u);
+    EXPECT_EQ(signal.TimerWakeups(), 1u);
+}
+
+TEST(WakeSignal, NotificationsCollapseIntoOneWakeup) {
+    WakeSignal signal;
+    signal.Notify();
+    signal.Notify();
+    signal.Notify();
+    EXPECT_TRUE(signal.WaitUntil(std::nullopt));
+    EXPECT_FALSE(signal.WaitUntil(clock::now() + 1ms));
+    EXPECT_EQ(signal.Wakeups(), 2u);
+    EXPECT_EQ(signal.TimerWakeups(), 1u);
+}
+
+TEST(WakeSignal, NotifyFromAnotherThreadWakesWaiter) {
+    WakeSignal signal;
+    std::thread notifier([&] {
+        std::this_thread::sleep_for(5ms);
+        signal.Notify();
+    });
+    EXPECT_TRUE(signal.WaitUntil(clock::now() + 10s));
+    notifier.join();
+}
+
+// Notify() racing a timeout must not leave the semaphore holding a release
+// nobody accounts for: the next Notify() would then release it past its
+// maximum, and a later wait would wake without a notification.
+TEST(WakeSignal, NotifyRacingTimeoutLeavesNoStrayRelease) {
+    WakeSignal signal;
+    std::atomic<bool> done{false};
+    std::thread notifier([&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            signal.Notify();
+            std::this_thread::yield();
+        }
+    });
+    const auto until = clock::now() + 500ms;
+    while (clock::now() < until) signal.WaitUntil(clock::now() + 2us);
+    done = true;
+    notifier.join();
+
+    signal.WaitUntil(clock::now()); // takes the last notification, if any
+    EXPECT_FALSE(signal.WaitUntil(clock::now() + 20ms));
+    signal.Notify();
+    EXPECT_TRUE(signal.WaitUntil(clock::now()));
+    EXPECT_FALSE(signal.WaitUntil(clock::now() + 1ms));
+}
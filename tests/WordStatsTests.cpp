@@ -0,0 +1,195 @@
+#include "Straf/WordStats.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Straf;
+using namespace std::chrono_literals;
+using sys_clock = std::chrono::system_clock;
+
+namespace {
+
+class WordStatsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() /
+              ("straf_wordstats_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(dir);
+    }
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    std::unique_ptr<WordStats> Open(WordStatsOptions options = {}) { return WordStats::Open(dir.string(), options); }
+
+    static void Record(WordStats& stats, const char* word, WordOutcome outcome, int times) {
+        const WordId id = Words().Intern(word);
+        for (int i = 0; i < times; ++i) stats.Record(id, outcome);
+    }
+
+    // Wide enough that a minute boundary between Record() and Flush() does not matter.
+    static WordStatsRange Recent(const WordStats& stats, WordOutcome by = WordOutcome::Triggered, size_t topN = 10) {
+        return stats.Query(sys_clock::now() - 10min, sys_clock::now() + 1min, by, topN);
+    }
+
+    uintmax_t FileSize() const { return std::filesystem::file_size(dir / "word-stats.bin"); }
+
+    std::filesystem::path dir;
+};
+
+using Rows = std::vector<std::pair<std::string, uint64_t>>;
+
+Rows Ranked(const WordStatsRange& range, WordOutcome by) {
+    Rows rows;
+    for (const auto& r : range.top) rows.emplace_back(r.word, r.counts[static_cast<size_t>(by)]);
+    return rows;
+}
+
+constexpr size_t kHeaderBytes = 8, kBucketBytes = 28;
+
+} // namespace
+
+TEST_F(WordStatsTest, FlushRollsIntoMinuteHourAndDayBuckets) {
+    auto stats = Open();
+    ASSERT_TRUE(stats);
+    Record(*stats, "ws-rollup", WordOutcome::Triggered, 3);
+    Record(*stats, "ws-rollup", WordOutcome::QueueFull, 2);
+    stats->Flush();
+
+    const auto minutes = Recent(*stats);
+    EXPECT_EQ(minutes.resolution, 1min);
+    EXPECT_EQ(minutes.totals, (WordOutcomeCounts{3, 0, 0, 2}));
+
+    // Past the minute retention the hour buckets answer; past the hour retention, the days
+    const auto hours = stats->Query(sys_clock::now() - 72h, sys_clock::now() + 1min);
+    EXPECT_EQ(hours.resolution, 60min);
+    EXPECT_EQ(hours.totals, (WordOutcomeCounts{3, 0, 0, 2}));
+    const auto days = stats->Query(sys_clock::now() - 24h * 100, sys_clock::now() + 1min);
+    EXPECT_EQ(days.resolution, 24h);
+    EXPECT_EQ(days.totals, (WordOutcomeCounts{3, 0, 0, 2}));
+    EXPECT_GE(days.PerHour(3), 0.0);
+
+    // Counts are rolled once: a second flush adds only what is new
+    Record(*stats, "ws-rollup", WordOutcome::Triggered, 1);
+    stats->Flush();
+    EXPECT_EQ(Recent(*stats).totals, (WordOutcomeCounts{4, 0, 0, 2}));
+}
+
+TEST_F(WordStatsTest, QueryRanksByTheChosenOutcome) {
+    auto stats = Open();
+    ASSERT_TRUE(stats);
+    Record(*stats, "ws-rank-a", WordOutcome::Triggered, 3);
+    Record(*stats, "ws-rank-b", WordOutcome::Triggered, 5);
+    Record(*stats, "ws-rank-c", WordOutcome::Triggered, 3);
+    Record(*stats, "ws-rank-d", WordOutcome::Debounced, 2);
+    stats->Flush();
+
+    // Highest first, ties by word; words without the outcome are left out
+    EXPECT_EQ(Ranked(Recent(*stats), WordOutcome::Triggered),
+              (Rows{{"ws-rank-b", 5}, {"ws-rank-a", 3}, {"ws-rank-c", 3}}));
+    EXPECT_EQ(Ranked(Recent(*stats, WordOutcome::Triggered, 2), WordOutcome::Triggered),
+              (Rows{{"ws-rank-b", 5}, {"ws-rank-a", 3}}));
+    EXPECT_EQ(Ranked(Recent(*stats, WordOutcome::Debounced), WordOutcome::Debounced), (Rows{{"ws-rank-d", 2}}));
+    EXPECT_EQ(Recent(*stats).totals, (WordOutcomeCounts{11, 2, 0, 0}));
+
+    const auto empty = stats->Query(sys_clock::now(), sys_clock::now() - 1h);
+    EXPECT_TRUE(empty.top.empty());
+    EXPECT_EQ(empty.from, empty.to);
+}
+
+TEST_F(WordStatsTest, CountsSurviveARestart) {
+    {
+        auto stats = Open();
+        ASSERT_TRUE(stats);
+        Record(*stats, "ws-restart", WordOutcome::Triggered, 2);
+        Record(*stats, "ws-restart", WordOutcome::PhraseCooldown, 1);
+    } // the destructor flushes
+    auto stats = Open();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(Recent(*stats).totals, (WordOutcomeCounts{2, 0, 1, 0}));
+    EXPECT_EQ(stats->Query(sys_clock::now() - 24h * 100, sys_clock::now() + 1min).totals, (WordOutcomeCounts{2, 0, 1, 0}));
+
+    // What this process counted was rolled by the first instance already
+    Record(*stats, "ws-restart", WordOutcome::Triggered, 1);
+    stats->Flush();
+    EXPECT_EQ(Recent(*stats).totals, (WordOutcomeCounts{3, 0, 1, 0}));
+}
+
+TEST_F(WordStatsTest, AppendedMinutesAreCompactedIntoPerLevelBuckets) {
+    WordStatsOptions options;
+    options.compactEvery = 2;
+    const std::string word = "ws-compact";
+    {
+        auto stats = Open(options);
+        ASSERT_TRUE(stats);
+        Record(*stats, word.c_str(), WordOutcome::Triggered, 1);
+        stats->Flush();
+        // One word record and one minute record that rolls up on load
+        EXPECT_EQ(FileSize(), kHeaderBytes + 2 + word.size() + kBucketBytes);
+        Record(*stats, word.c_str(), WordOutcome::Triggered, 1);
+        stats->Flush();
+        // Two appended records reach compactEvery: the rewrite stores each
+        // level's buckets on their own, one or two minutes, one hour, one day
+        const uintmax_t size = FileSize();
+        EXPECT_GE(size, kHeaderBytes + 2 + word.size() + 3 * kBucketBytes);
+        EXPECT_LE(size, kHeaderBytes + 2 + word.size() + 4 * kBucketBytes);
+    }
+    auto stats = Open(options);
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(Recent(*stats).totals, (WordOutcomeCounts{2, 0, 0, 0}));
+    EXPECT_EQ(stats->Query(sys_clock::now() - 72h, sys_clock::now() + 1min).totals, (WordOutcomeCounts{2, 0, 0, 0}));
+}
+
+TEST_F(WordStatsTest, ExpiredMinutesSurviveOnlyInTheirHourAndDay) {
+    // A file as an earlier run left it: one live minute record from three days ago
+    std::filesystem::create_directories(dir);
+    const std::string word = "ws-expired";
+    const auto old = sys_clock::now() - 72h;
+    const auto minute = static_cast<uint32_t>(std::chrono::floor<std::chrono::minutes>(old.time_since_epoch()).count());
+    {
+        std::ofstream f(dir / "word-stats.bin", std::ios::binary);
+        const char header[kHeaderBytes] = {'S', 'W', 'S', '1', 1, 0, 0, 0};
+        f.write(header, sizeof header);
+        const char wordRecord[2] = {1, static_cast<char>(word.size())};
+        f.write(wordRecord, 2);
+        f.write(word.data(), static_cast<std::streamsize>(word.size()));
+        char bucket[kBucketBytes] = {2, 0, 1, 0}; // bucket record, minute level, rolls up
+        const uint32_t fields[] = {minute, 0, 4, 0, 0, 1};
+        std::memcpy(bucket + 4, fields, sizeof fields);
+        f.write(bucket, sizeof bucket);
+    }
+
+    auto stats = Open();
+    ASSERT_TRUE(stats);
+    // Opening pruned the minute and rewrote the file with the hour and day only
+    EXPECT_EQ(FileSize(), kHeaderBytes + 2 + word.size() + 2 * kBucketBytes);
+    const auto hours = stats->Query(old - 1h, old + 1h);
+    EXPECT_EQ(hours.resolution, 60min);
+    EXPECT_EQ(hours.totals, (WordOutcomeCounts{4, 0, 0, 1}));
+    EXPECT_EQ(Ranked(hours, WordOutcome::Triggered), (Rows{{word, 4}}));
+
+    stats.reset();
+    stats = Open();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(stats->Query(old - 1h, old + 1h).totals, (WordOutcomeCounts{4, 0, 0, 1}));
+}
+
+TEST_F(WordStatsTest, TornTailIsIgnored) {
+    {
+        auto stats = Open();
+        ASSERT_TRUE(stats);
+        Record(*stats, "ws-torn", WordOutcome::Triggered, 2);
+    }
+    {
+        std::ofstream f(dir / "word-stats.bin", std::ios::binary | std::ios::app);
+        const char partial[5] = {2, 0, 1, 0, 9}; // a bucket record cut short
+        f.write(partial, sizeof partial);
+    }
+    auto stats = Open();
+    ASSERT_TRUE(stats);
+    EXPECT_EQ(Recent(*stats).totals, (WordOutcomeCounts{2, 0, 0, 0}));
+}
@@ -0,0 +1,56 @@
+#include "Straf/WordTable.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace Straf;
+
+TEST(WordTable, InternIsStableAndFindIsExact) {
+    auto table = std::make_unique<WordTable>();
+    EXPECT_EQ(table->Intern(""), kNoWord);
+    const WordId a = table->Intern("alpha");
+    EXPECT_NE(a, kNoWord);
+    EXPECT_EQ(table->Intern("alpha"), a);
+    EXPECT_EQ(table->Find("alpha"), a);
+    EXPECT_EQ(table->Find("alph"), kNoWord);
+    EXPECT_EQ(table->Find(""), kNoWord);
+    EXPECT_EQ(table->Name(a), "alpha");
+    EXPECT_EQ(table->WideName(a), L"alpha");
+    EXPECT_EQ(table->Size(), 2u); // with kNoWord
+}
+
+TEST(WordTable, FullTableReturnsNoWordButKeepsExistingIds) {
+    auto table = std::make_unique<WordTable>();
+    const WordId first = table->Intern("w0");
+    for (size_t i = 1; !table->Full(); ++i) ASSERT_NE(table->Intern("w" + std::to_string(i)), kNoWord);
+    EXPECT_EQ(table->Size(), WordTable::kCapacity);
+    EXPECT_EQ(table->Intern("one-too-many"), kNoWord);
+    EXPECT_EQ(table->Find("one-too-many"), kNoWord);
+    EXPECT_EQ(table->Intern("w0"), first);
+    EXPECT_EQ(table->Find("w" + std::to_string(WordTable::kCapacity - 2)), WordTable::kCapacity - 1);
+}
+
+TEST(WordTable, LockFreeFindSeesCompleteEntries) {
+    auto table = std::make_unique<WordTable>();
+    constexpr int kWords = 20000;
+    std::atomic<bool> done{false};
+    std::atomic<int> mismatches{0};
+    std::thread reader([&] {
+        while (!done.load(std::memory_order_acquire)) {
+            for (int i = 0; i < kWords; i += 97) {
+                const std::string word = "word" + std::to_string(i);
+                const WordId id = table->Find(word);
+                if (id != kNoWord && table->Name(id) != word) mismatches.fetch_add(1);
+            }
+        }
+    });
+    for (int i = 0; i < kWords; ++i) table->Intern("word" + std::to_string(i));
+    done.store(true, std::memory_order_release);
+    reader.join();
+    EXPECT_EQ(mismatches.load(), 0);
+    for (int i = 0; i < kWords; ++i) EXPECT_NE(table->Find("word" + std::to_string(i)), kNoWord);
+}
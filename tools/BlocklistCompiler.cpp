@@ -0,0 +1,166 @@
+// straf_blocklistc: compiles word lists into a memory-mappable .sfst blocklist.
+//
+//   straf_blocklistc [--report] <out.sfst> <input>...
+//
+// Inputs ending in .json are read like config.json (the "words" array); any
+// other file is one entry per line, '#' starts a comment. With --report the
+// tool compares startup time and resident memory of the JSON + std::set path
+// that LoadConfig/TextAnalysisDetector use against mapping the compiled file.
+#include "Straf/Blocklist.h"
+#include "Straf/Config.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace Straf;
+
+static size_t ResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return pmc.WorkingSetSize;
+    return 0;
+#else
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+static bool EndsWith(const std::string& s, const char* suffix) {
+    const std::string x(suffix);
+    return s.size() >= x.size() && s.compare(s.size() - x.size(), x.size(), x) == 0;
+}
+
+static bool ReadInput(const std::string& path, std::vector<std::string>& words) {
+    if (EndsWith(path, ".json")) {
+        auto cfg = LoadConfig(path);
+        if (!cfg) return false;
+        words.insert(words.end(), cfg->words.begin(), cfg->words.end());
+        return true;
+    }
+    std::ifstream f(path);
+    if (!f.is_open()) return false;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (auto hash = line.find('#'); hash != std::string::npos) line.resize(hash);
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.pop_back();
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos) continue;
+        words.push_back(line.substr(start));
+    }
+    return true;
+}
+
+struct JsonPathResult {
+    double startupMs{0};
+    size_t residentBytes{0};
+    std::set<std::string> vocabulary;
+};
+
+// Mirrors the startup work of the JSON path: LoadConfig plus the detector's
+// lowercased std::set. Runs before compiling so the builder's freed heap
+// cannot absorb the set's allocations.
+static JsonPathResult MeasureJsonPath(const std::vector<std::string>& words, const std::string& outPath) {
+    const std::string jsonPath = outPath + ".report.json";
+    {
+        std::ofstream j(jsonPath, std::ios::binary | std::ios::trunc);
+        j << "{\"words\":[";
+        for (size_t i = 0; i < words.size(); ++i) {
+            if (i) j << ',';
+            j << '"';
+            for (char c : words[i]) {
+                if (c == '"' || c == '\\') j << '\\';
+                j << c;
+            }
+            j << '"';
+        }
+        j << "]}";
+    }
+
+    JsonPathResult r;
+    size_t rssBefore = ResidentBytes();
+    auto t0 = std::chrono::steady_clock::now();
+    auto cfg = LoadConfig(jsonPath);
+    if (cfg) {
+        for (auto& w : cfg->words) {
+            for (auto& c : w) c = (char) std::tolower((unsigned char) c);
+            r.vocabulary.insert(std::move(w));
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    r.startupMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    r.residentBytes = ResidentBytes() - rssBefore;
+    std::remove(jsonPath.c_str());
+    return r;
+}
+
+static void ReportMapped(const JsonPathResult& json, const std::string& outPath) {
+    size_t rssBefore = ResidentBytes();
+    auto t0 = std::chrono::steady_clock::now();
+    auto mapped = OpenBlocklist(outPath);
+    auto t1 = std::chrono::steady_clock::now();
+    // Touch every entry once so all pages a worst-case workload would fault
+    // in are counted.
+    size_t hits = 0;
+    if (mapped) {
+        for (const auto& w : json.vocabulary) hits += mapped->Contains(w) ? 1 : 0;
+    }
+    size_t rssMapped = ResidentBytes() - rssBefore;
+
+    std::printf("json+set : %zu entries, startup %.2f ms, resident +%.1f KiB\n", json.vocabulary.size(),
+                json.startupMs, json.residentBytes / 1024.0);
+    std::printf("mmap sfst: %zu entries, startup %.3f ms, resident +%.1f KiB after touching all entries (%zu hits)\n",
+                mapped ? mapped->Size() : 0, std::chrono::duration<double, std::milli>(t1 - t0).count(),
+                rssMapped / 1024.0, hits);
+}
+
+int main(int argc, char** argv) {
+    bool report = false;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--report") report = true;
+        else args.push_back(a);
+    }
+    if (args.size() < 2) {
+        std::fprintf(stderr, "usage: %s [--report] <out.sfst> <words.txt|config.json>...\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> words;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (!ReadInput(args[i], words)) {
+            std::fprintf(stderr, "failed to read %s\n", args[i].c_str());
+            return 1;
+        }
+    }
+
+    JsonPathResult json;
+    if (report) json = MeasureJsonPath(words, args[0]);
+
+    auto t0 = std::chrono::steady_clock::now();
+    BlocklistStats stats;
+    if (!CompileBlocklist(words, args[0], &stats)) {
+        std::fprintf(stderr, "failed to write %s\n", args[0].c_str());
+        return 1;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    std::printf("%s: %zu words, %zu states, %zu arcs, %zu bytes (v%u) in %.1f ms\n", args[0].c_str(), stats.words,
+                stats.states, stats.arcs, stats.fileBytes, kBlocklistVersion,
+                std::chrono::duration<double, std::milli>(t1 - t0).count());
+
+    if (report) ReportMapped(json, args[0]);
+    return 0;
+}
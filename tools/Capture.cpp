@@ -0,0 +1,127 @@
+// straf_capture: always-on capture process for running the recognizer
+// apart from the microphone. Writes captured audio into a shared-memory
+// audio ring (AudioRing.h) that the agent reads with STRAF_AUDIO_RING=NAME,
+// so the agent can crash, restart or swap its model without the stream
+// stopping.
+//
+//   straf_capture [options]
+//
+// Options:  --name NAME     ring name (default straf)
+//           --file WAV      capture a recording in real time instead of the
+//                           microphone
+//           --loop          with --file, start over at the end
+//           --seconds N     audio the ring holds (default 8)
+//
+// Without --file it captures the default microphone with WASAPI, on
+// Windows only. Every 10 s and on exit it prints what was written and where
+// the recognizer is: position, lag and samples it skipped.
+#include "Straf/Audio.h"
+#include "Straf/AudioRing.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace Straf;
+
+namespace {
+
+constexpr int kSampleRate = 16000;
+
+std::atomic<bool> g_stop{false};
+std::atomic<bool> g_ended{false};
+
+void OnSignal(int) { g_stop = true; }
+
+std::unique_ptr<IAudioSource> OpenSource(const std::string& file, AudioRingWriter& ring) {
+    std::unique_ptr<IAudioSource> source;
+    if (!file.empty()) {
+        AudioFileOptions options;
+        options.onEnd = [] { g_ended = true; };
+        source = CreateAudioFile(file, std::move(options));
+    } else {
+#ifdef _WIN32
+        source = CreateAudioWasapi();
+#else
+        std::fprintf(stderr, "no microphone capture on this platform; use --file\n");
+        return nullptr;
+#endif
+    }
+    source = PublishingAudioSource(std::move(source), ring);
+    if (!source->Initialize(kSampleRate, 1)) {
+        std::fprintf(stderr, "cannot open %s\n", file.empty() ? "the microphone" : file.c_str());
+        return nullptr;
+    }
+    source->Start(nullptr);
+    return source;
+}
+
+void PrintStats(const AudioRingWriter& ring) {
+    const AudioRingStats s = ring.GetStats();
+    std::printf("%.1f s written in %llu packets", static_cast<double>(s.samples) / kSampleRate,
+                static_cast<unsigned long long>(s.packets));
+    if (s.consumerPid != 0) {
+        std::printf("; recognizer %llu at %.1f s, %.0f ms behind, %.1f s skipped", static_cast<unsigned long long>(s.consumerPid),
+                    static_cast<double>(s.consumerPosition) / kSampleRate,
+                    static_cast<double>(s.samples - s.consumerPosition) * 1000.0 / kSampleRate,
+                    static_cast<double>(s.consumerOverruns) / kSampleRate);
+    } else {
+        std::printf("; no recognizer attached");
+    }
+    std::printf(" (%llu attaches)\n", static_cast<unsigned long long>(s.attaches));
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string name = "straf";
+    std::string file;
+    bool loop = false;
+    long long seconds = 8;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) name = argv[++i];
+        else if (std::strcmp(argv[i], "--file") == 0 && i + 1 < argc) file = argv[++i];
+        else if (std::strcmp(argv[i], "--loop") == 0) loop = true;
+        else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) seconds = std::atoll(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: straf_capture [--name NAME] [--file WAV [--loop]] [--seconds N]\n");
+            return 2;
+        }
+    }
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    auto ring = AudioRingWriter::Create(name, kSampleRate, 1, std::chrono::seconds(seconds));
+    if (!ring) {
+        std::fprintf(stderr, "cannot create audio ring '%s'; is another capture process running?\n", name.c_str());
+        return 1;
+    }
+    auto source = OpenSource(file, *ring);
+    if (!source) return 1;
+    std::printf("capturing into %s (%zu samples)\n", AudioRingObjectName(name).c_str(), ring->Capacity());
+    std::fflush(stdout);
+
+    auto nextReport = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(250)); // bounded so Ctrl+C is noticed
+        if (g_ended.exchange(false)) {
+            source->Stop();
+            source = loop ? OpenSource(file, *ring) : nullptr;
+            if (!source) break;
+        }
+        if (std::chrono::steady_clock::now() >= nextReport) {
+            PrintStats(*ring);
+            nextReport += std::chrono::seconds(10);
+        }
+    }
+    if (source) source->Stop();
+    PrintStats(*ring);
+    return 0;
+}
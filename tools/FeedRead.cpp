@@ -0,0 +1,137 @@
+// straf_feed_read: reference reader for the agent's event feed (EventFeed.h),
+// and a starting point for widgets and bots that react to penalties.
+//
+//   straf_feed_read [options]
+//
+// Options:  --name NAME   feed name, as `feed.name` in config.json (default straf)
+//           --status      print the agent's status reply and exit
+//           --oldest      start at the oldest record still in the ring
+//                         instead of the newest
+//           --count N     exit after N records
+//
+// Asks the control channel to subscribe, maps the ring and prints one JSON
+// line per record: {"seq", "time", "kind", "word", "stars", "confidence",
+// "source"}. The current penalty state is printed first. Between records it
+// sleeps on the feed's futex or event; it never polls. Records lost because
+// this reader fell a whole ring behind are reported on stderr, and when the
+// agent exits or restarts it reattaches once the feed is back.
+#include "Straf/EventFeed.h"
+
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace Straf;
+
+namespace {
+
+std::atomic<bool> g_stop{false};
+
+void OnSignal(int) { g_stop = true; }
+
+const char* KindName(feed::Kind kind) {
+    switch (kind) {
+    case feed::Kind::Detection: return "detection";
+    case feed::Kind::Penalty: return "penalty";
+    case feed::Kind::Status: return "status";
+    case feed::Kind::Hidden: return "hidden";
+    }
+    return "unknown";
+}
+
+const char* SourceName(DetectionSource source) {
+    switch (source) {
+    case DetectionSource::Microphone: return "microphone";
+    case DetectionSource::Partial: return "partial";
+    case DetectionSource::Chat: return "chat";
+    }
+    return "unknown";
+}
+
+void Print(const feed::Record& r, bool state) {
+    nlohmann::json line;
+    if (!state) line["seq"] = r.seq;
+    line["time"] = r.unixNanos / 1000000; // ms since the Unix epoch
+    line["kind"] = state ? "state" : KindName(r.kind);
+    line["word"] = std::string(r.word, strnlen(r.word, sizeof r.word));
+    line["stars"] = r.stars;
+    if (r.kind == feed::Kind::Detection) {
+        line["confidence"] = r.confidence;
+        line["source"] = SourceName(r.source);
+    }
+    std::printf("%s\n", line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace).c_str());
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string name = "straf";
+    bool status = false;
+    bool oldest = false;
+    long long count = -1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) name = argv[++i];
+        else if (std::strcmp(argv[i], "--status") == 0) status = true;
+        else if (std::strcmp(argv[i], "--oldest") == 0) oldest = true;
+        else if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = std::atoll(argv[++i]);
+        else {
+            std::fprintf(stderr, "usage: straf_feed_read [--name NAME] [--status] [--oldest] [--count N]\n");
+            return 2;
+        }
+    }
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    if (status) {
+        const auto reply = feed::QueryFeed(name, "status");
+        if (!reply) {
+            std::fprintf(stderr, "no agent answers on %s\n", feed::ControlAddress(name).c_str());
+            return 1;
+        }
+        std::printf("%s\n", reply->c_str());
+        return 0;
+    }
+
+    long long printed = 0;
+    bool waiting = false;
+    while (!g_stop && printed != count) {
+        const auto subscribed = feed::QueryFeed(name, "subscribe");
+        auto reader = subscribed ? feed::FeedReader::Open(name, oldest) : nullptr;
+        if (!reader) {
+            if (!waiting) std::fprintf(stderr, "waiting for feed '%s' on %s\n", name.c_str(), feed::ControlAddress(name).c_str());
+            waiting = true;
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+        waiting = false;
+        std::fprintf(stderr, "subscribed: %s\n", subscribed->c_str());
+        if (const auto state = reader->State()) Print(*state, true);
+
+        uint64_t overruns = 0;
+        feed::Record record;
+        while (!g_stop && printed != count) {
+            if (!reader->Next(record)) {
+                if (reader->Closed()) break;
+                reader->Wait(std::chrono::milliseconds(500)); // bounded so Ctrl+C is noticed
+                continue;
+            }
+            if (reader->Overruns() != overruns) {
+                std::fprintf(stderr, "fell behind: %llu records lost\n", static_cast<unsigned long long>(reader->Overruns() - overruns));
+                overruns = reader->Overruns();
+            }
+            Print(record, false);
+            ++printed;
+        }
+        if (reader->Closed()) std::fprintf(stderr, "feed closed by the agent\n");
+        oldest = true; // after a restart, everything in the new ring is unseen
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+// straf_metrics_scrape: fetches the agent's Prometheus endpoint the way a
+// Prometheus server would, for checking it on a machine without one.
+//
+//   straf_metrics_scrape [options] [port]     (default port 9464)
+//
+// Options:  --every SECONDS  --count N   scrape repeatedly (default once)
+//           --raw                        print the exposition text as served
+//
+// Without --raw each scrape is parsed and summarized: counters and gauges
+// with their values, histograms as count and p50/p95/p99 estimated from the
+// buckets like histogram_quantile() does. Parse errors, buckets that are not
+// cumulative and +Inf buckets that disagree with _count are reported, and
+// make the exit status non-zero. Connects to 127.0.0.1 only.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using Socket = SOCKET;
+constexpr Socket kNoSocket = INVALID_SOCKET;
+void CloseSocket(Socket s) { closesocket(s); }
+#else
+using Socket = int;
+constexpr Socket kNoSocket = -1;
+void CloseSocket(Socket s) { close(s); }
+#endif
+
+// Returns the response body, or false on a connection or HTTP error.
+bool Fetch(uint16_t port, std::string& body, double& millis) {
+    const auto start = std::chrono::steady_clock::now();
+    const Socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == kNoSocket) return false;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(s, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        CloseSocket(s);
+        return false;
+    }
+    const std::string request = "GET /metrics HTTP/1.0\r\nHost: 127.0.0.1\r\nAccept: text/plain\r\n\r\n";
+    send(s, request.data(), static_cast<int>(request.size()), 0);
+    std::string response;
+    char buf[4096];
+    for (;;) {
+        const auto got = recv(s, buf, sizeof buf, 0);
+        if (got <= 0) break;
+        response.append(buf, static_cast<size_t>(got));
+    }
+    CloseSocket(s);
+    millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const size_t head = response.find("\r\n\r\n");
+    if (head == std::string::npos || response.compare(0, 12, "HTTP/1.0 200") != 0) return false;
+    body = response.substr(head + 4);
+    return true;
+}
+
+struct Series {
+    std::string name;
+    std::string labels;
+    double value;
+};
+
+// "name{labels} value" or "name value"; label values may hold escaped quotes and spaces.
+bool ParseLine(const std::string& line, Series& out) {
+    size_t i = line.find_first_of("{ ");
+    if (i == std::string::npos || i == 0) return false;
+    out.name = line.substr(0, i);
+    out.labels.clear();
+    if (line[i] == '{') {
+        bool quoted = false;
+        size_t j = i + 1;
+        for (; j < line.size(); ++j) {
+            if (line[j] == '\\' && quoted) { ++j; continue; }
+            if (line[j] == '"') quoted = !quoted;
+            else if (line[j] == '}' && !quoted) break;
+        }
+        if (j >= line.size()) return false;
+        out.labels = line.substr(i + 1, j - i - 1);
+        i = j + 1;
+    }
+    const std::string value = line.substr(i);
+    if (value == " +Inf") out.value = INFINITY;
+    else if (value == " -Inf") out.value = -INFINITY;
+    else {
+        char* end = nullptr;
+        out.value = std::strtod(value.c_str(), &end);
+        if (end == value.c_str() || *end != '\0') return false;
+    }
+    return true;
+}
+
+double BucketBound(const std::string& labels) {
+    const size_t at = labels.find("le=\"");
+    if (at == std::string::npos) return NAN;
+    const std::string v = labels.substr(at + 4, labels.find('"', at + 4) - at - 4);
+    return v == "+Inf" ? INFINITY : std::strtod(v.c_str(), nullptr);
+}
+
+struct HistogramData {
+    std::vector<std::pair<double, double>> buckets; // (le, cumulative count)
+    double sum{0}, count{0};
+};
+
+// Linear interpolation inside the bucket holding the rank, as histogram_quantile() does.
+double Quantile(const HistogramData& h, double q) {
+    if (h.count <= 0 || h.buckets.empty()) return NAN;
+    const double rank = q * h.count;
+    double lower = 0, below = 0;
+    for (const auto& [le, cumulative] : h.buckets) {
+        if (cumulative >= rank) {
+            if (std::isinf(le)) return lower;
+            const double inBucket = cumulative - below;
+            return inBucket > 0 ? lower + (le - lower) * (rank - below) / inBucket : le;
+        }
+        lower = le;
+        below = cumulative;
+    }
+    return lower;
+}
+
+int Summarize(const std::string& body) {
+    std::map<std::string, std::string> types;
+    std::map<std::string, HistogramData> histograms;
+    std::vector<Series> plain;
+    int errors = 0;
+    std::istringstream in(body);
+    std::string line;
+    size_t lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        if (line.empty()) continue;
+        if (line.rfind("# TYPE ", 0) == 0) {
+            std::istringstream t(line.substr(7));
+            std::string name, type;
+            t >> name >> type;
+            if (types.count(name)) {
+                std::printf("line %zu: %s declared twice\n", lineNo, name.c_str());
+                ++errors;
+            }
+            types[name] = type;
+            continue;
+        }
+        if (line[0] == '#') continue;
+        Series s;
+        if (!ParseLine(line, s)) {
+            std::printf("line %zu: cannot parse: %s\n", lineNo, line.c_str());
+            ++errors;
+            continue;
+        }
+        auto base = [&](const char* suffix) {
+            const size_t n = std::strlen(suffix);
+            return s.name.size() > n && s.name.compare(s.name.size() - n, n, suffix) == 0 ? s.name.substr(0, s.name.size() - n)
+                                                                                            : std::string();
+        };
+        if (const auto b = base("_bucket"); !b.empty() && types[b] == "histogram") {
+            histograms[b].buckets.emplace_back(BucketBound(s.labels), s.value);
+        } else if (const auto b = base("_sum"); !b.empty() && types[b] == "histogram") {
+            histograms[b].sum = s.value;
+        } else if (const auto b = base("_count"); !b.empty() && types[b] == "histogram") {
+            histograms[b].count = s.value;
+        } else {
+            if (!types.count(s.name)) {
+                std::printf("line %zu: %s has no TYPE\n", lineNo, s.name.c_str());
+                ++errors;
+            }
+            plain.push_back(s);
+        }
+    }
+    for (const auto& s : plain) {
+        std::printf("  %-44s %-28s %.6g\n", s.name.c_str(), s.labels.c_str(), s.value);
+    }
+    for (const auto& [name, h] : histograms) {
+        bool ok = !h.buckets.empty() && std::isinf(h.buckets.back().first) && h.buckets.back().second == h.count;
+        for (size_t i = 1; i < h.buckets.size(); ++i) {
+            ok = ok && h.buckets[i].first > h.buckets[i - 1].first && h.buckets[i].second >= h.buckets[i - 1].second;
+        }
+        if (!ok) {
+            std::printf("  %s: buckets not cumulative or +Inf != _count\n", name.c_str());
+            ++errors;
+        }
+        std::printf("  %-44s n=%-8.0f p50=%-10.4g p95=%-10.4g p99=%-10.4g mean=%.4g\n", name.c_str(), h.count,
+                    Quantile(h, 0.50), Quantile(h, 0.95), Quantile(h, 0.99), h.count > 0 ? h.sum / h.count : 0.0);
+    }
+    return errors;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint16_t port = 9464;
+    double every = 0;
+    int count = 1;
+    bool raw = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--every") == 0 && i + 1 < argc) every = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) count = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--raw") == 0) raw = true;
+        else if (argv[i][0] != '-') port = static_cast<uint16_t>(std::atoi(argv[i]));
+        else {
+            std::fprintf(stderr, "usage: straf_metrics_scrape [--every SECONDS] [--count N] [--raw] [port]\n");
+            return 2;
+        }
+    }
+#ifdef _WIN32
+    WSADATA wsa{};
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) return 1;
+#endif
+    int errors = 0;
+    for (int n = 0; n < count; ++n) {
+        if (n > 0) std::this_thread::sleep_for(std::chrono::duration<double>(every));
+        std::string body;
+        double millis = 0;
+        if (!Fetch(port, body, millis)) {
+            std::fprintf(stderr, "scrape of 127.0.0.1:%u failed\n", port);
+            return 1;
+        }
+        if (raw) {
+            std::fwrite(body.data(), 1, body.size(), stdout);
+            continue;
+        }
+        std::printf("scrape %d: %zu bytes in %.2f ms\n", n + 1, body.size(), millis);
+        errors += Summarize(body);
+    }
+    return errors == 0 ? 0 : 1;
+}
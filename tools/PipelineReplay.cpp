@@ -0,0 +1,448 @@
+// straf_pipeline_replay: replays labelled recordings through the detection
+// pipeline and reports how fast a spoken word becomes a penalty.
+//
+//   straf_pipeline_replay [options] <fixture.wav>...
+//   straf_pipeline_replay [options] --synthetic SECONDS
+//
+// Options:  --config PATH    vocabulary (default ./config.sample.json)
+//           --stt replay|vosk  recognizer; replay reads <fixture>.txt
+//                            (default: replay, or vosk when built with it and
+//                            the transcript is missing)
+//           --fast           feed audio back to back instead of in real time
+//           --json PATH      also write the summary as JSON
+//           --feed NAME      publish detections and penalties to the event
+//                            feed NAME while replaying, for straf_feed_read
+//           --queue-limit N  penalty queue limit (default: the manager's
+//                            maximum, 64; the agent uses penalty.queueLimit)
+//
+// A fixture is <name>.wav plus <name>.labels: one "<seconds> <text>" line per
+// vocabulary hit, at the time the word ends in the recording, with the text
+// the detector reports (the phrase or token, not the rule). <name>.txt holds
+// recorded recognizer output in straf_trace_run --transcript format.
+// --synthetic writes a noise recording with a hit every 2.5 s and a
+// transcript that lags each word end by 300 ms, for machines without fixtures.
+//
+// The pipeline is the agent's - file audio, resampling, recognizer,
+// TextAnalysisDetector, PenaltyManager - with an overlay that only records
+// when each penalty was triggered. Debounce and phrase cooldown are off, so
+// every detection reaches Trigger(), which queues it unless --queue-limit
+// penalties are already waiting. Penalties run for their configured duration
+// in real time, so a long --fast replay can fill the queue. Reported:
+//   rtf          time in the recognizer callback (decode + detection) per audio second
+//   cpu          process CPU time per audio second, all threads
+//   peak rss     largest resident set of the process
+//   latency      word end to Trigger(): from the delivery of the audio packet
+//                that holds the word end to the overlay seeing the trigger,
+//                p50/p95/p99
+//   missed       labels the detector never reported (the exit status is 1
+//                when there are any)
+//   full         labels detected but dropped because the penalty queue was full
+//   extra        triggers without a label
+#include "Straf/Audio.h"
+#include "Straf/Config.h"
+#include "Straf/Detector.h"
+#include "Straf/EventFeed.h"
+#include "Straf/Overlay.h"
+#include "Straf/PenaltyManager.h"
+#include "Straf/Platform.h"
+#include "Straf/STT.h"
+#include "Straf/WordTable.h"
+
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Straf;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+
+int Usage() {
+    std::fprintf(stderr, "usage: straf_pipeline_replay [--config PATH] [--stt replay|vosk] [--fast] [--json PATH]\n"
+                         "                             [--feed NAME] [--queue-limit N] <fixture.wav>... | --synthetic SECONDS\n");
+    return 2;
+}
+
+// Records when Trigger() queued each penalty. Trigger() reports a queued
+// penalty as UpdateStatus(stars, word); a penalty that starts reports
+// ShowPenalty(word) first, and that UpdateStatus is skipped.
+class RecordingOverlay final : public IOverlayRenderer {
+public:
+    struct Hit {
+        WordId word;
+        clock_type::time_point at;
+    };
+
+    bool Initialize() override { return true; }
+    void ShowPenalty(WordId) override { afterShow_ = true; }
+    void UpdateStatus(int, WordId word) override {
+        const auto now = clock_type::now();
+        if (std::exchange(afterShow_, false) || word == kNoWord) return;
+        std::lock_guard lock(mutex_);
+        hits_.push_back({word, now});
+    }
+    void Hide() override {}
+
+    std::vector<Hit> Take() {
+        std::lock_guard lock(mutex_);
+        return std::exchange(hits_, {});
+    }
+
+private:
+    bool afterShow_{false}; // manager thread only
+    std::mutex mutex_;
+    std::vector<Hit> hits_;
+};
+
+// Passes packets through, noting when each one was delivered and how long
+// the recognizer spent on it. Written on the audio thread; read after Stop().
+class TimedAudioSource final : public IAudioSource {
+public:
+    struct Delivery {
+        uint64_t endSample; // samples delivered including this packet
+        clock_type::time_point at;
+    };
+
+    explicit TimedAudioSource(std::unique_ptr<IAudioSource> inner) : inner_(std::move(inner)) {}
+
+    bool Initialize(int sampleRate, int channels) override {
+        rate_ = sampleRate;
+        return inner_->Initialize(sampleRate, channels);
+    }
+    void Start(AudioCallback onAudio) override {
+        inner_->Start([this, onAudio = std::move(onAudio)](const AudioBuffer& buf) {
+            const auto start = clock_type::now();
+            samples_ += buf.size();
+            deliveries_.push_back({samples_, start});
+            onAudio(buf);
+            busy_ += clock_type::now() - start;
+        });
+    }
+    void Stop() override { inner_->Stop(); }
+
+    double Seconds() const { return rate_ > 0 ? static_cast<double>(samples_) / rate_ : 0.0; }
+    std::chrono::duration<double> Busy() const { return busy_; }
+    // Delivery time of the packet holding `seconds`, or of the last packet.
+    clock_type::time_point DeliveredAt(double seconds) const {
+        const auto sample = static_cast<uint64_t>(std::max(0.0, seconds) * rate_);
+        const auto it = std::lower_bound(deliveries_.begin(), deliveries_.end(), sample,
+                                         [](const Delivery& d, uint64_t s) { return d.endSample <= s; });
+        return it != deliveries_.end() ? it->at : deliveries_.empty() ? clock_type::time_point{} : deliveries_.back().at;
+    }
+
+private:
+    std::unique_ptr<IAudioSource> inner_;
+    int rate_{0};
+    uint64_t samples_{0};
+    std::vector<Delivery> deliveries_;
+    clock_type::duration busy_{0};
+};
+
+struct FixtureResult {
+    std::string name;
+    double audioSeconds{0};
+    double wallSeconds{0};
+    double busySeconds{0};
+    size_t labels{0};
+    size_t missed{0}; // never detected
+    size_t full{0};   // detected, dropped with the penalty queue full
+    size_t extra{0};
+    std::vector<double> latencies; // seconds
+};
+
+std::filesystem::path WithExtension(std::filesystem::path path, const char* extension) {
+    return path.replace_extension(extension);
+}
+
+// Pairs labels with triggers of the same word in order of time. A label
+// without a trigger was dropped by a full queue if its word was detected
+// more often than triggered, and missed by the detector otherwise.
+void Match(const std::vector<TranscriptEntry>& labels, std::vector<RecordingOverlay::Hit> hits,
+           std::vector<WordId> detected, const TimedAudioSource& audio, FixtureResult& result) {
+    std::vector<bool> used(hits.size(), false);
+    for (const auto& hit : hits) {
+        if (auto it = std::find(detected.begin(), detected.end(), hit.word); it != detected.end()) detected.erase(it);
+    }
+    for (const auto& label : labels) {
+        const WordId word = Words().Intern(label.text);
+        const auto spoken = audio.DeliveredAt(std::chrono::duration<double>(label.at).count());
+        size_t i = 0;
+        while (i < hits.size() && (used[i] || hits[i].word != word)) ++i;
+        if (i == hits.size()) {
+            if (auto it = std::find(detected.begin(), detected.end(), word); it != detected.end()) {
+                detected.erase(it);
+                ++result.full;
+            } else {
+                ++result.missed;
+            }
+            continue;
+        }
+        used[i] = true;
+        result.latencies.push_back(std::chrono::duration<double>(hits[i].at - spoken).count());
+    }
+    result.extra = static_cast<size_t>(std::count(used.begin(), used.end(), false));
+}
+
+// `publisher` is null unless --feed is given.
+bool RunFixture(const std::filesystem::path& wav, const AppConfig& cfg, bool useVosk, bool fast, int queueLimit,
+                feed::FeedWriter* publisher, FixtureResult& result) {
+    result.name = wav.filename().string();
+    std::vector<TranscriptEntry> labels;
+    if (!LoadTranscript(WithExtension(wav, ".labels").string(), labels)) {
+        std::fprintf(stderr, "%s: no %s\n", result.name.c_str(), WithExtension(wav, ".labels").string().c_str());
+        return false;
+    }
+    result.labels = labels.size();
+
+    std::unique_ptr<ITranscriber> stt;
+    if (useVosk) {
+#ifdef STRAF_HAS_VOSK
+        stt = CreateTranscriberVosk(); // model from STRAF_VOSK_MODEL or ./models/vosk
+#endif
+    } else {
+        std::vector<TranscriptEntry> transcript;
+        if (!LoadTranscript(WithExtension(wav, ".txt").string(), transcript)) {
+            std::fprintf(stderr, "%s: no %s for the replay recognizer\n", result.name.c_str(),
+                         WithExtension(wav, ".txt").string().c_str());
+            return false;
+        }
+        stt = CreateTranscriberReplay(std::move(transcript));
+    }
+    if (!stt) return false;
+
+    auto recording = std::make_unique<RecordingOverlay>();
+    RecordingOverlay& overlay = *recording;
+    std::unique_ptr<IOverlayRenderer> sink = std::move(recording);
+    if (publisher) sink = feed::PublishingOverlay(std::move(sink), *publisher);
+    auto penalties = CreatePenaltyManager(sink.get());
+    penalties->Configure(queueLimit, std::chrono::seconds(cfg.penalty.durationSeconds),
+                         std::chrono::seconds(cfg.penalty.cooldownSeconds));
+    PenaltyPolicy policy;
+    policy.debounce = std::chrono::milliseconds(0);
+    policy.phraseCooldown = std::chrono::milliseconds(0);
+    penalties->SetPolicy(policy);
+    penalties->Start();
+
+    PhraseStreamOptions phraseOptions;
+    phraseOptions.window = std::chrono::milliseconds(cfg.detector.phraseWindowMs);
+    phraseOptions.silenceReset = std::chrono::milliseconds(cfg.detector.silenceResetMs);
+    auto detector = CreateTextAnalysisDetector(phraseOptions);
+    if (!detector->Initialize(cfg.words)) return false;
+    std::vector<WordId> detected; // recognizer thread; read after Stop()
+    detector->Start([&](const DetectionResult& r) {
+        detected.push_back(r.word);
+        DetectionEvent event;
+        event.word = r.word;
+        event.source = r.source;
+        event.confidence = r.confidence;
+        event.detectedAt = clock_type::now();
+        if (publisher) publisher->PublishDetection(r.word, r.confidence, r.source);
+        penalties->Submit(std::move(event));
+    });
+
+    std::promise<void> ended;
+    AudioFileOptions audioOptions;
+    audioOptions.realtime = !fast;
+    audioOptions.onEnd = [&ended] { ended.set_value(); };
+    auto timed = std::make_unique<TimedAudioSource>(CreateAudioFile(wav.string(), std::move(audioOptions)));
+    TimedAudioSource* audio = timed.get();
+    stt->Initialize({}, spdlog::default_logger());
+    stt->SetAudioSource(std::move(timed));
+    stt->SetPartialCallback([&](const std::string& text, float conf) {
+        if (!text.empty()) detector->AnalyzePartial(text, conf);
+    });
+
+    const auto start = clock_type::now();
+    stt->Start([&](const std::string& text, float conf) {
+        if (!text.empty()) detector->AnalyzeText(text, conf);
+    });
+    if (ended.get_future().wait_for(std::chrono::hours(1)) != std::future_status::ready) return false;
+    result.wallSeconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+    stt->Stop();
+    detector->Stop();
+    penalties->Stop(); // drains the detections still queued
+    result.audioSeconds = audio->Seconds();
+    result.busySeconds = audio->Busy().count();
+    Match(labels, overlay.Take(), std::move(detected), *audio, result);
+    return true;
+}
+
+// Noise recording at a common device format plus labels and transcript for it.
+bool WriteSynthetic(const std::filesystem::path& wav, double seconds, const std::vector<std::string>& words) {
+    constexpr int kRate = 48000, kChannels = 2;
+    const auto frames = static_cast<uint32_t>(seconds * kRate);
+    const uint32_t dataBytes = frames * kChannels * 2;
+    std::ofstream out(wav, std::ios::binary);
+    auto u32 = [&](uint32_t v) { out.write(reinterpret_cast<const char*>(&v), 4); };
+    auto u16 = [&](uint16_t v) { out.write(reinterpret_cast<const char*>(&v), 2); };
+    out.write("RIFF", 4); u32(36 + dataBytes); out.write("WAVEfmt ", 8);
+    u32(16); u16(1); u16(kChannels); u32(kRate); u32(kRate * kChannels * 2); u16(kChannels * 2); u16(16);
+    out.write("data", 4); u32(dataBytes);
+    std::mt19937 rng(7);
+    std::normal_distribution<float> noise(0.0f, 300.0f);
+    std::vector<int16_t> frame(kChannels);
+    for (uint32_t i = 0; i < frames; ++i) {
+        for (auto& s : frame) s = static_cast<int16_t>(std::clamp(noise(rng), -32768.0f, 32767.0f));
+        out.write(reinterpret_cast<const char*>(frame.data()), sizeof(int16_t) * kChannels);
+    }
+    std::ofstream labels(WithExtension(wav, ".labels")), transcript(WithExtension(wav, ".txt"));
+    size_t n = 0;
+    for (double end = 1.0; end + 0.3 < seconds; end += 2.5, ++n) {
+        const std::string& word = words[n % words.size()];
+        labels << end << ' ' << word << '\n';
+        transcript << end + 0.3 << " push b site " << word << '\n';
+    }
+    return static_cast<bool>(out) && n > 0;
+}
+
+double Percentile(std::vector<double> sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    const size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string configPath = "config.sample.json";
+    std::string stt;
+    std::string jsonPath;
+    std::string feedName;
+    bool fast = false;
+    int queueLimit = IPenaltyManager::kMaxQueueLimit;
+    double synthetic = 0;
+    std::vector<std::filesystem::path> fixtures;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) configPath = argv[++i];
+        else if (std::strcmp(argv[i], "--stt") == 0 && i + 1 < argc) stt = argv[++i];
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) jsonPath = argv[++i];
+        else if (std::strcmp(argv[i], "--feed") == 0 && i + 1 < argc) feedName = argv[++i];
+        else if (std::strcmp(argv[i], "--queue-limit") == 0 && i + 1 < argc) queueLimit = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--fast") == 0) fast = true;
+        else if (std::strcmp(argv[i], "--synthetic") == 0 && i + 1 < argc) synthetic = std::atof(argv[++i]);
+        else if (argv[i][0] == '-') return Usage();
+        else fixtures.emplace_back(argv[i]);
+    }
+    if (fixtures.empty() == (synthetic <= 0) || (!stt.empty() && stt != "replay" && stt != "vosk")) return Usage();
+    if (queueLimit < 1 || queueLimit > IPenaltyManager::kMaxQueueLimit) {
+        std::fprintf(stderr, "--queue-limit must be 1 to %d\n", IPenaltyManager::kMaxQueueLimit);
+        return 2;
+    }
+#ifndef STRAF_HAS_VOSK
+    if (stt == "vosk") {
+        std::fprintf(stderr, "built without Vosk; use --stt replay\n");
+        return 1;
+    }
+#endif
+
+    auto cfg = LoadConfig(configPath);
+    if (!cfg) {
+        std::fprintf(stderr, "cannot load %s\n", configPath.c_str());
+        return 1;
+    }
+    spdlog::set_level(spdlog::level::warn);
+
+    std::filesystem::path syntheticWav;
+    if (synthetic > 0) {
+        syntheticWav = std::filesystem::temp_directory_path() / "straf_pipeline_replay.wav";
+        if (cfg->words.empty() || !WriteSynthetic(syntheticWav, synthetic, cfg->words)) {
+            std::fprintf(stderr, "cannot write %s\n", syntheticWav.string().c_str());
+            return 1;
+        }
+        fixtures.push_back(syntheticWav);
+    }
+
+    std::unique_ptr<feed::FeedWriter> publisher;
+    if (!feedName.empty() && !(publisher = feed::FeedWriter::Create(feedName))) {
+        std::fprintf(stderr, "cannot create feed %s\n", feedName.c_str());
+        return 1;
+    }
+    auto feedServer = publisher ? feed::StartFeedServer(*publisher) : nullptr;
+
+    const auto cpuStart = platform::ProcessCpuTime();
+    std::vector<FixtureResult> results;
+    FixtureResult total;
+    total.name = "total";
+    for (const auto& wav : fixtures) {
+        bool useVosk = stt == "vosk";
+#ifdef STRAF_HAS_VOSK
+        if (stt.empty() && !std::filesystem::exists(WithExtension(wav, ".txt"))) useVosk = true;
+#endif
+        FixtureResult r;
+        if (!RunFixture(wav, *cfg, useVosk, fast, queueLimit, publisher.get(), r)) {
+            std::fprintf(stderr, "%s: replay failed\n", wav.string().c_str());
+            return 1;
+        }
+        total.audioSeconds += r.audioSeconds;
+        total.wallSeconds += r.wallSeconds;
+        total.busySeconds += r.busySeconds;
+        total.labels += r.labels;
+        total.missed += r.missed;
+        total.full += r.full;
+        total.extra += r.extra;
+        total.latencies.insert(total.latencies.end(), r.latencies.begin(), r.latencies.end());
+        results.push_back(std::move(r));
+    }
+    const double cpuSeconds = std::chrono::duration<double>(platform::ProcessCpuTime() - cpuStart).count();
+    const uint64_t peakRss = platform::PeakResidentBytes();
+    if (!syntheticWav.empty()) {
+        std::filesystem::remove(syntheticWav);
+        std::filesystem::remove(WithExtension(syntheticWav, ".labels"));
+        std::filesystem::remove(WithExtension(syntheticWav, ".txt"));
+    }
+
+    nlohmann::json json;
+    std::printf("%-28s %8s %8s %6s %6s %6s %6s %9s %9s %9s\n", "fixture", "audio s", "rtf", "hits", "missed", "full",
+                "extra", "p50 ms", "p95 ms", "p99 ms");
+    results.push_back(total);
+    for (auto& r : results) {
+        std::sort(r.latencies.begin(), r.latencies.end());
+        const double rtf = r.audioSeconds > 0 ? r.busySeconds / r.audioSeconds : 0.0;
+        const double p50 = Percentile(r.latencies, 0.50), p95 = Percentile(r.latencies, 0.95), p99 = Percentile(r.latencies, 0.99);
+        std::printf("%-28s %8.2f %8.4f %6zu %6zu %6zu %6zu %9.2f %9.2f %9.2f\n", r.name.c_str(), r.audioSeconds, rtf,
+                    r.latencies.size(), r.missed, r.full, r.extra, p50 * 1e3, p95 * 1e3, p99 * 1e3);
+        nlohmann::json entry = {{"name", r.name}, {"audioSeconds", r.audioSeconds}, {"wallSeconds", r.wallSeconds},
+                                {"rtf", rtf}, {"labels", r.labels}, {"matched", r.latencies.size()},
+                                {"missed", r.missed}, {"queueFull", r.full}, {"extra", r.extra},
+                                {"latencySeconds", {{"p50", p50}, {"p95", p95}, {"p99", p99},
+                                                    {"max", r.latencies.empty() ? 0.0 : r.latencies.back()}}}};
+        if (&r == &results.back()) json["total"] = std::move(entry);
+        else json["fixtures"].push_back(std::move(entry));
+    }
+    const double cpuPerSecond = total.audioSeconds > 0 ? cpuSeconds / total.audioSeconds : 0.0;
+    std::printf("wall:       %.2f s for %.2f s of audio (%s)\n", total.wallSeconds, total.audioSeconds,
+                fast ? "back to back" : "real time");
+    std::printf("cpu:        %.2f ms per audio second\n", cpuPerSecond * 1e3);
+    std::printf("peak rss:   %.1f MiB\n", static_cast<double>(peakRss) / (1024.0 * 1024.0));
+
+    if (!jsonPath.empty()) {
+        json["realtime"] = !fast;
+        json["queueLimit"] = queueLimit;
+        json["cpuSecondsPerAudioSecond"] = cpuPerSecond;
+        json["peakResidentBytes"] = peakRss;
+        std::ofstream out(jsonPath);
+        out << json.dump(2) << '\n';
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+    return total.missed == 0 ? 0 : 1;
+}
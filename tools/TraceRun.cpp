@@ -0,0 +1,165 @@
+// straf_trace_run: runs the detection pipeline on a WAV recording with
+// tracing on and writes the spans as Chrome trace-event JSON.
+//
+//   straf_trace_run [options] <audio.wav> <trace.json>
+//
+// Options:  --config PATH      vocabulary and penalty settings (default ./config.sample.json)
+//           --transcript PATH  replay recognizer output ("<seconds> <text>" lines)
+//                              instead of decoding with a Vosk model
+//           --fast             feed audio back to back instead of in real time
+//           --metrics PORT     serve Prometheus metrics on 127.0.0.1:PORT while running
+//
+// The pipeline is the agent's: file audio, resampling, recognizer,
+// TextAnalysisDetector, PenaltyManager and the headless overlay, each on its
+// own thread. Open the output in https://ui.perfetto.dev or chrome://tracing;
+// flow arrows follow each recognizer result to its detection, penalty and
+// overlay frames. Builds and runs without audio hardware or a display.
+#include "Straf/Audio.h"
+#include "Straf/Config.h"
+#include "Straf/Detector.h"
+#include "Straf/Metrics.h"
+#include "Straf/Overlay.h"
+#include "Straf/PenaltyManager.h"
+#include "Straf/STT.h"
+#include "Straf/Trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <string>
+#include <vector>
+
+using namespace Straf;
+
+namespace {
+
+int Usage() {
+    std::fprintf(stderr, "usage: straf_trace_run [--config PATH] [--transcript PATH] [--fast] [--metrics PORT] <audio.wav> <trace.json>\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string configPath = "config.sample.json";
+    std::string transcriptPath;
+    bool fast = false;
+    int metricsPort = -1;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--config") == 0 && i + 1 < argc) configPath = argv[++i];
+        else if (std::strcmp(argv[i], "--transcript") == 0 && i + 1 < argc) transcriptPath = argv[++i];
+        else if (std::strcmp(argv[i], "--fast") == 0) fast = true;
+        else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) metricsPort = std::atoi(argv[++i]);
+        else if (argv[i][0] == '-') return Usage();
+        else positional.emplace_back(argv[i]);
+    }
+    if (positional.size() != 2) return Usage();
+    const std::string& audioPath = positional[0];
+    const std::string& tracePath = positional[1];
+
+    auto cfg = LoadConfig(configPath);
+    if (!cfg) {
+        std::fprintf(stderr, "cannot load %s\n", configPath.c_str());
+        return 1;
+    }
+    std::unique_ptr<ITranscriber> stt;
+    if (!transcriptPath.empty()) {
+        std::vector<TranscriptEntry> transcript;
+        if (!LoadTranscript(transcriptPath, transcript)) {
+            std::fprintf(stderr, "cannot read %s\n", transcriptPath.c_str());
+            return 1;
+        }
+        stt = CreateTranscriberReplay(std::move(transcript));
+    } else {
+#ifdef STRAF_HAS_VOSK
+        stt = CreateTranscriberVosk(); // model from STRAF_VOSK_MODEL or ./models/vosk
+#else
+        std::fprintf(stderr, "built without Vosk; pass --transcript\n");
+        return 1;
+#endif
+    }
+
+    spdlog::set_level(spdlog::level::warn);
+    trace::Enable();
+    trace::SetThreadName("main");
+
+    auto overlay = CreateOverlayHeadless();
+    if (!overlay->Initialize()) return 1;
+    auto penalties = CreatePenaltyManager(overlay.get());
+    penalties->Configure(cfg->penalty.queueLimit, std::chrono::seconds(cfg->penalty.durationSeconds),
+                         std::chrono::seconds(cfg->penalty.cooldownSeconds));
+    penalties->Start();
+    const size_t penaltyCollector = AddPenaltyMetrics(*penalties);
+    std::unique_ptr<metrics::MetricsServer> metricsServer;
+    if (metricsPort >= 0 && metricsPort <= 65535) {
+        metrics::AddProcessCollector();
+        metricsServer = metrics::StartMetricsServer(static_cast<uint16_t>(metricsPort));
+        if (!metricsServer) {
+            std::fprintf(stderr, "cannot serve metrics on port %d\n", metricsPort);
+            return 1;
+        }
+        std::printf("metrics:    http://127.0.0.1:%u/metrics\n", metricsServer->Port());
+        std::fflush(stdout);
+    }
+
+    PhraseStreamOptions phraseOptions;
+    phraseOptions.window = std::chrono::milliseconds(cfg->detector.phraseWindowMs);
+    phraseOptions.silenceReset = std::chrono::milliseconds(cfg->detector.silenceResetMs);
+    auto detector = CreateTextAnalysisDetector(phraseOptions);
+    if (!detector->Initialize(cfg->words)) return 1;
+    std::atomic<uint64_t> detections{0};
+    detector->Start([&](const DetectionResult& r) {
+        ++detections;
+        DetectionEvent event;
+        event.word = r.word;
+        event.source = r.source;
+        event.confidence = r.confidence;
+        event.detectedAt = std::chrono::steady_clock::now();
+        event.flow = trace::CurrentFlow();
+        penalties->Submit(std::move(event));
+    });
+
+    std::promise<void> ended;
+    AudioFileOptions audioOptions;
+    audioOptions.realtime = !fast;
+    audioOptions.onEnd = [&ended] { ended.set_value(); };
+    stt->Initialize({}, spdlog::default_logger());
+    stt->SetAudioSource(CreateAudioFile(audioPath, std::move(audioOptions)));
+    stt->SetPartialCallback([&](const std::string& text, float conf) {
+        if (!text.empty()) detector->AnalyzePartial(text, conf);
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    stt->Start([&](const std::string& text, float conf) {
+        if (!text.empty()) detector->AnalyzeText(text, conf);
+    });
+    ended.get_future().wait();
+    const auto wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    stt->Stop();
+    detector->Stop();
+    penalties->Stop(); // drains the detections still queued
+    const auto queue = penalties->GetQueueStats();
+    const auto frames = overlay->GetFrameStats();
+    metricsServer.reset();
+    metrics::Metrics().RemoveCollector(penaltyCollector);
+    overlay.reset(); // joins the render thread before the trace is read
+
+    const auto spans = trace::GetStats();
+    if (!trace::WriteChromeJson(tracePath)) {
+        std::fprintf(stderr, "cannot write %s\n", tracePath.c_str());
+        return 1;
+    }
+    std::printf("wall time:  %.2f s\n", wall);
+    std::printf("detections: %llu, %llu applied, %llu dropped\n", static_cast<unsigned long long>(detections.load()),
+                static_cast<unsigned long long>(queue.applied), static_cast<unsigned long long>(queue.dropped));
+    std::printf("overlay:    %llu frames\n", static_cast<unsigned long long>(frames.frames));
+    std::printf("trace:      %llu spans on %llu threads (%llu overwritten) -> %s\n",
+                static_cast<unsigned long long>(spans.recorded), static_cast<unsigned long long>(spans.threads),
+                static_cast<unsigned long long>(spans.overwritten), tracePath.c_str());
+    return 0;
+}